@@ -18,12 +18,39 @@
 #include <TVirtualMC.h>
 #include <TGeoGlobalMagField.h>
 #include "GeneratorCosmics.h"
+#include <algorithm>
+#include <vector>
+
+// SoA buffers of the block mode and the queue of accepted muons
+struct GeneratorCosmics::Block {
+  std::vector<float> u, g, px, py, pz, ptot, rx, ry, rz, xpos, zpos;
+  std::vector<int> pdg, q, redo;
+  std::vector<unsigned char> ok;
+  std::vector<float> acc; // accepted muons: px, py, pz, x, y, z
+  std::vector<int> accPdg;
+  size_t next = 0; // first muon in the queue not used yet
+
+  void resize(int n)
+  {
+    for (auto v : {&u, &px, &py, &pz, &ptot, &rx, &ry, &rz, &xpos, &zpos}) {
+      v->resize(n);
+    }
+    g.resize(2 * n);
+    pdg.resize(n);
+    q.resize(n);
+    ok.resize(n);
+  }
+};
 
 //-----------------------------------------------------------------------------
 GeneratorCosmics::GeneratorCosmics() : TGenerator("GeneratorCosmics", "GeneratorCosmics")
 {
+  initMomentumSampler();
 }
 
+//-----------------------------------------------------------------------------
+GeneratorCosmics::~GeneratorCosmics() = default;
+
 //-----------------------------------------------------------------------------
 bool GeneratorCosmics::detectField()
 {
@@ -54,50 +81,66 @@ void GeneratorCosmics::GenerateEvent()
     throw std::runtime_error("Failed to fetch magnetic field");
   }
   fParticles->Clear();  
-  int npart = 0;
+  int npart = 0, nwanted = mNPart;
+  std::vector<float> times;
+  if (mTimeFrame > 0) { // Poisson number of muons with sorted uniform arrival times
+    if (mRate < 0) {
+      estimateRate();
+    }
+    nwanted = gRandom->Poisson(mRateEmitted * mTimeFrame * 1e-9);
+    times.resize(nwanted);
+    gRandom->RndmArray(nwanted, times.data());
+    for (auto& t : times) {
+      t *= mTimeFrame;
+    }
+    std::sort(times.begin(), times.end());
+  }
   //
-  while (npart < mNPart) { // until needed numbe of muons generated
+  while (npart < nwanted) { // until needed numbe of muons generated
     int trials = 0;
+    float tprod = times.empty() ? 0.f : times[npart];
+
+    if (mBlockSize > 0 && !mTargeted) {
+      if (!mBlock) {
+        mBlock = std::make_unique<Block>();
+      }
+      auto& blk = *mBlock;
+      while (blk.next == blk.accPdg.size()) {
+        if ((trials += mBlockSize) > mMaxTrials) {
+          throw std::runtime_error("max. trials reached");
+        }
+        generateBlock();
+      }
+      const auto* m = &blk.acc[6 * blk.next];
+      auto etot = std::sqrt(MuMass * MuMass + m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+      fParticles->Add(new TParticle(blk.accPdg[blk.next++], 1, -1, -1, -1, -1, m[0], m[1], m[2], etot, m[3], m[4], m[5], tprod));
+      npart++;
+      continue;
+    }
 
     do { // until particle passes all selections
       if (++trials > mMaxTrials) {
         throw std::runtime_error("max. trials reached");
       }
       int pdg = gRandom->Rndm() < MuMinusFraction ? MuMinusPDG : MuPlusPDG; // mu- : mu+
-      float r[3] = {0.f, mROrigin, 0.f}, p[3], ptot = 0, pt = 0;
-
-      if (mParam == GenParamType::ParamMI) {
-        ptot = mGenFun->GetRandom();
-        p[1] = -ptot;
-        if (gRandom->Rndm() > 0.9) {
-          p[0] = gRandom->Gaus(0.0, 0.4) * ptot;
-          p[2] = gRandom->Gaus(0.0, 0.4) * ptot;
-        } else {
-          p[0] = gRandom->Gaus(0.0, 0.2) * ptot;
-          p[2] = gRandom->Gaus(0.0, 0.2) * ptot;
-        }
-        ptot = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
-        pt = std::sqrt(p[0] * p[0] + p[1] * p[1]);
-      } else {
-        ptot = mGenFun->GetRandom();
-        float theta = 0, phi = 0;
-        do {
-          theta = gRandom->Gaus(0.5 * PiConst, 0.42);
-        } while (std::abs(theta - 0.5 * PiConst) > mMaxAngleWRTVertical);
-        do {
-          phi = gRandom->Gaus(-0.5 * PiConst, 0.42);
-        } while (std::abs(phi + 0.5 * PiConst) > mMaxAngleWRTVertical);
-
-        pt = ptot * std::sin(theta);
-        p[0] = pt * std::cos(phi);
-        p[1] = pt * std::sin(phi);
-        p[2] = ptot * std::cos(theta);
-      }
+      float r[3] = {0.f, mROrigin, 0.f}, p[3], ptot = 0;
 
-      if (ptot < mPMin || ptot > mPMax || std::acos(std::abs(p[1]) / ptot) > mMaxAngleWRTVertical) {
+      if (!generateMomentum(p, ptot)) {
         continue;
       }
 
+      if (mTargeted) { // crossing point drawn inside the acceptance
+        float weight = 1.f;
+        if (!backPropagate((2.f * gRandom->Rndm() - 1.f) * mXAcc, (2.f * gRandom->Rndm() - 1.f) * mZAcc, p, -pdg, r, weight)) {
+          continue;
+        }
+        auto etot = std::sqrt(MuMass * MuMass + ptot * ptot);
+        auto part = new TParticle(pdg, 1, -1, -1, -1, -1, p[0], p[1], p[2], etot, r[0], r[1], r[2], tprod);
+        part->SetWeight(weight);
+        fParticles->Add(part);
+        break;
+      }
+
       // estimate max deflection
       float xpos = 999, zpos = 999;
       if (!getXZatOrigin(xpos, zpos, r, p, -pdg)) {
@@ -136,7 +179,7 @@ void GeneratorCosmics::GenerateEvent()
       }
 
       auto etot = std::sqrt(MuMass * MuMass + ptot * ptot);
-      fParticles->Add( new TParticle(pdg, 1, -1, -1, -1, -1, p[0], p[1], p[2], etot, r[0], r[1], r[2], 0) );
+      fParticles->Add( new TParticle(pdg, 1, -1, -1, -1, -1, p[0], p[1], p[2], etot, r[0], r[1], r[2], tprod) );
       break;
     } while (1);
     npart++;
@@ -144,28 +187,357 @@ void GeneratorCosmics::GenerateEvent()
 }
 
 //-----------------------------------------------------------------------------
-void GeneratorCosmics::Init()
+bool GeneratorCosmics::generateMomentum(float p[3], float& ptot) const
 {
-  //
-  // Initialisation, check consistency of selected ranges
-  //
+  // draw momentum and direction at the source, false if outside of the momentum or angular range
+  ptot = sampleMomentum(gRandom->Rndm());
+  if (mParam == GenParamType::ParamMI) {
+    p[1] = -ptot;
+    if (gRandom->Rndm() > 0.9) {
+      p[0] = gRandom->Gaus(0.0, 0.4) * ptot;
+      p[2] = gRandom->Gaus(0.0, 0.4) * ptot;
+    } else {
+      p[0] = gRandom->Gaus(0.0, 0.2) * ptot;
+      p[2] = gRandom->Gaus(0.0, 0.2) * ptot;
+    }
+    ptot = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+  } else {
+    float theta = 0, phi = 0;
+    do {
+      theta = gRandom->Gaus(0.5 * PiConst, 0.42);
+    } while (std::abs(theta - 0.5 * PiConst) > mMaxAngleWRTVertical);
+    do {
+      phi = gRandom->Gaus(-0.5 * PiConst, 0.42);
+    } while (std::abs(phi + 0.5 * PiConst) > mMaxAngleWRTVertical);
+
+    auto pt = ptot * std::sin(theta);
+    p[0] = pt * std::cos(phi);
+    p[1] = pt * std::sin(phi);
+    p[2] = ptot * std::cos(theta);
+  }
+  return !(ptot < mPMin || ptot > mPMax || std::acos(std::abs(p[1]) / ptot) > mMaxAngleWRTVertical);
+}
+
+//-----------------------------------------------------------------------------
+void GeneratorCosmics::fillGaus(int n, float* g, float mean, float sigma)
+{
+  // n gaussian numbers, Box-Muller in place on bulk uniforms
+  constexpr float TwoPi = 2 * PiConst;
+  if (n < 1) {
+    return;
+  }
+  gRandom->RndmArray(n, g);
+  int npair = n / 2;
+  for (int i = 0; i < npair; i++) {
+    float rho = sigma * std::sqrt(-2.f * std::log(g[2 * i])), phi = TwoPi * g[2 * i + 1];
+    g[2 * i] = mean + rho * std::cos(phi);
+    g[2 * i + 1] = mean + rho * std::sin(phi);
+  }
+  if (n & 1) {
+    float rho = sigma * std::sqrt(-2.f * std::log(g[n - 1])), phi = TwoPi * float(gRandom->Rndm());
+    g[n - 1] = mean + rho * std::cos(phi);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void GeneratorCosmics::generateBlock()
+{
+  // Run the selection of the scalar loop on mBlockSize independent candidates and append the survivors
+  // to the queue. Every step is a loop over the block, failing candidates are only masked.
+  constexpr int MuMinusPDG = 13, MuPlusPDG = -13;
+  const int n = mBlockSize;
+  auto& blk = *mBlock;
+  blk.resize(n);
+  if (blk.next == blk.accPdg.size()) {
+    blk.acc.clear();
+    blk.accPdg.clear();
+    blk.next = 0;
+  }
+  auto u = blk.u.data(), g = blk.g.data(), px = blk.px.data(), py = blk.py.data(), pz = blk.pz.data(), ptot = blk.ptot.data();
+  auto rx = blk.rx.data(), ry = blk.ry.data(), rz = blk.rz.data(), xpos = blk.xpos.data(), zpos = blk.zpos.data();
+  auto pdg = blk.pdg.data(), q = blk.q.data();
+  auto ok = blk.ok.data();
+
+  // charge and momentum
+  gRandom->RndmArray(n, u);
+  for (int i = 0; i < n; i++) {
+    pdg[i] = u[i] < MuMinusFraction ? MuMinusPDG : MuPlusPDG;
+    q[i] = -pdg[i];
+  }
+  gRandom->RndmArray(n, ptot);
+  for (int i = 0; i < n; i++) {
+    ptot[i] = sampleMomentum(ptot[i]);
+  }
+
+  // direction
+  if (mParam == GenParamType::ParamMI) {
+    gRandom->RndmArray(n, u);
+    fillGaus(2 * n, g, 0.f, 1.f);
+    for (int i = 0; i < n; i++) {
+      float sig = u[i] > 0.9f ? 0.4f : 0.2f;
+      px[i] = g[2 * i] * sig * ptot[i];
+      py[i] = -ptot[i];
+      pz[i] = g[2 * i + 1] * sig * ptot[i];
+      ptot[i] = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+    }
+  } else {
+    // theta in g[0, n), phi in g[n, 2n), out of range values are drawn again
+    fillGaus(n, g, 0.5f * PiConst, 0.42f);
+    fillGaus(n, g + n, -0.5f * PiConst, 0.42f);
+    float* gi = g;
+    for (float mean : {0.5f * PiConst, -0.5f * PiConst}) {
+      do {
+        blk.redo.clear();
+        for (int i = 0; i < n; i++) {
+          if (std::abs(gi[i] - mean) > mMaxAngleWRTVertical) {
+            blk.redo.push_back(i);
+          }
+        }
+        fillGaus(blk.redo.size(), u, mean, 0.42f);
+        for (size_t j = 0; j < blk.redo.size(); j++) {
+          gi[blk.redo[j]] = u[j];
+        }
+      } while (!blk.redo.empty());
+      gi += n;
+    }
+    for (int i = 0; i < n; i++) {
+      float pt = ptot[i] * std::sin(g[i]);
+      px[i] = pt * std::cos(g[n + i]);
+      py[i] = pt * std::sin(g[n + i]);
+      pz[i] = ptot[i] * std::cos(g[i]);
+    }
+  }
+  // acos(|py| / p) > max. angle  <=>  |py| < p cos(max. angle)
+  const float cosMax = std::cos(mMaxAngleWRTVertical);
+  for (int i = 0; i < n; i++) {
+    ok[i] = ptot[i] >= mPMin && ptot[i] <= mPMax && std::abs(py[i]) >= ptot[i] * cosMax;
+  }
+
+  // max deflection from the top of the cylinder
+  std::fill(rx, rx + n, 0.f);
+  std::fill(ry, ry + n, mROrigin);
+  std::fill(rz, rz + n, 0.f);
+  getXZatOriginBlock(n, rx, ry, rz, px, py, pz, q, xpos, zpos, ok);
+
+  // start point in the window on the Y=mROrigin plane and straight line to the cylinder
+  gRandom->RndmArray(2 * n, g);
+  for (int i = 0; i < n; i++) {
+    float slpX = px[i] / py[i], slpZ = pz[i] / py[i];
+    float xp = xpos[i] + mROrigin * slpX, zp = zpos[i] + mROrigin * slpZ;
+    float xmin = -mXAcc - std::max(xp, 0.f), xmax = mXAcc - std::min(xp, 0.f);
+    float zmin = -mZAcc - std::max(zp, 0.f), zmax = mZAcc - std::min(zp, 0.f);
+    float x0 = mROrigin * slpX + xmin + g[i] * (xmax - xmin);
+    float z0 = mROrigin * slpZ + zmin + g[n + i] * (zmax - zmin);
+    float a = slpX * slpX + 1, xred = x0 - mROrigin * slpX, b = xred * slpX, det = b * b - a * (xred * xred - mROrigin * mROrigin);
+    ok[i] = ok[i] && det >= 0.f;
+    ry[i] = (-b + std::sqrt(std::max(det, 0.f))) / a;
+    rx[i] = x0 + (ry[i] - mROrigin) * slpX;
+    rz[i] = z0 + (ry[i] - mROrigin) * slpZ;
+  }
+
+  // trigger condition
+  getXZatOriginBlock(n, rx, ry, rz, px, py, pz, q, xpos, zpos, ok);
+  for (int i = 0; i < n; i++) {
+    ok[i] = ok[i] && std::abs(xpos[i]) <= mXAcc && std::abs(zpos[i]) <= mZAcc;
+  }
+
+  // compaction of the survivors
+  for (int i = 0; i < n; i++) {
+    if (ok[i]) {
+      blk.accPdg.push_back(pdg[i]);
+      blk.acc.insert(blk.acc.end(), {px[i], py[i], pz[i], rx[i], ry[i], rz[i]});
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void GeneratorCosmics::getXZatOriginBlock(int n, const float* rx, const float* ry, const float* rz, const float* px, const float* py,
+                                          const float* pz, const int* q, float* xpos, float* zpos, unsigned char* ok) const
+{
+  // getXZatOrigin for a block of tracks without branches, ok is cleared for the tracks which fail
+  constexpr float B2C = -0.299792458e-3, Almost0 = 1e-9, Almost1 = 1 - Almost0;
+  for (int i = 0; i < n; i++) {
+    float pt = std::sqrt(px[i] * px[i] + py[i] * py[i]), q2pt = (q[i] > 0 ? 1.f : -1.f) / pt;
+    float snp = px[i] / pt, tgl = pz[i] / pt; // sin(atan2(px, -py))
+    float crv = q2pt * mBkG * B2C, x2r = crv * ry[i], f1 = snp, f2 = f1 + x2r;
+    bool good = std::abs(f1) < Almost1 && std::abs(f2) < Almost1 && std::abs(q2pt) >= Almost0;
+    f1 = good ? f1 : 0.f;
+    f2 = good ? f2 : 0.f;
+    float r1 = std::sqrt((1.f - f1) * (1.f + f1)), r2 = std::sqrt((1.f - f2) * (1.f + f2));
+    good = good && r1 >= Almost0 && r2 >= Almost0;
+    float dy2dx = (f1 + f2) / (r1 + r2);
+    xpos[i] = rx[i] + ry[i] * dy2dx;
+    float rot = std::asin(std::min(std::max(r1 * f2 - r2 * f1, -1.f), 1.f));
+    rot = (f1 * f1 + f2 * f2 > 1 && f1 * f2 < 0) ? (f2 > 0 ? PiConst - rot : -PiConst - rot) : rot;
+    float crvSafe = std::abs(x2r) < 0.05f ? 1.f : crv;
+    zpos[i] = rz[i] + (std::abs(x2r) < 0.05f ? ry[i] * (r2 + f2 * dy2dx) * tgl : tgl / crvSafe * rot);
+    ok[i] = ok[i] && good;
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool GeneratorCosmics::backPropagate(float xacc, float zacc, const float p[3], int q, float r[3], float& weight) const
+{
+  // Find the point r on the origin cylinder from which the muon with momentum p crosses Y=0 at (xacc, zacc).
+  // The muons are uniform on the Y=mROrigin plane and move on straight lines down to the cylinder, inside of it
+  // on a helix. weight = |dx0/dX|, x0 being the start on the plane and X the crossing at Y=0, is the density
+  // of the flux relative to the uniform crossing points.
+  constexpr float B2C = -0.299792458e-3, Tolerance = 1e-4;
+  constexpr int MaxIterations = 10;
+  auto slpX = p[0] / p[1];
+  float xpos = 0, zpos = 0, org[3] = {0.f, mROrigin, 0.f};
+  if (!getXZatOrigin(xpos, zpos, org, p, q)) {
+    return false;
+  }
+  // helix parameters as in getXZatOrigin
+  auto pt = std::sqrt(p[0] * p[0] + p[1] * p[1]), q2pt = q > 0 ? 1.f / pt : -1.f / pt;
+  auto f1 = std::sin(std::atan2(p[0], -p[1])), r1 = std::sqrt((1.f - f1) * (1.f + f1));
+  auto crv = q2pt * mBkG * B2C;
+
+  double x0 = xacc - xpos, jac = 1.; // start from the crossing without the straight section
+  for (int it = 0; it <= MaxIterations; it++) {
+    // straight line from the plane down to the cylinder
+    double a = slpX * slpX + 1, xred = x0 - mROrigin * slpX, b = xred * slpX, det = b * b - a * (xred * xred - mROrigin * mROrigin);
+    if (det < 0.) {
+      return false;
+    }
+    r[1] = (-b + std::sqrt(det)) / a;
+    r[0] = x0 + (r[1] - mROrigin) * slpX;
+    r[2] = 0.f;
+    if (!getXZatOrigin(xpos, zpos, r, p, q)) {
+      return false;
+    }
+    // X = xc + yc * D(yc) with D = (f1 + f2) / (r1 + r2), f2 = f1 + crv * yc,
+    // evaluated at the current point so that the weight uses the final one
+    auto f2 = f1 + crv * r[1], r2 = std::sqrt((1.f - f2) * (1.f + f2)), sr = r1 + r2;
+    auto d = (f1 + f2) / sr, dd = crv * (sr + (f1 + f2) * f2 / r2) / (sr * sr);
+    auto dycdx0 = -r[0] / (r[0] * slpX + r[1]), dxcdx0 = 1 + slpX * dycdx0;
+    jac = dxcdx0 + (d + r[1] * dd) * dycdx0;
+    if (std::abs(jac) < 1e-6) {
+      return false;
+    }
+    if (it == MaxIterations || std::abs(xpos - xacc) < Tolerance) {
+      if (std::abs(xpos - xacc) >= Tolerance) {
+        return false;
+      }
+      break;
+    }
+    x0 -= (xpos - xacc) / jac;
+  }
+  // the crossing moves rigidly with the start point along Z
+  r[2] = zacc - zpos;
+  weight = 1. / std::abs(jac);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+double GeneratorCosmics::momentumPrimitive(double p) const
+{
+  // monotonic function of p to which the cumulative distribution of the source spectrum is proportional
   switch (mParam) {
     case GenParamType::ParamMI:
-      mGenFun.reset(new TF1("genFun", "exp(-x/30.)", mPMin, mPMax * 2));
-      break;
+      return -std::exp(-p / 30.);
     case GenParamType::ParamACORDE:
-      mGenFun.reset(new TF1("genFun", "x/(1.+(x/12.8)*(x/12.8))^1.96", mPMin, mPMax));
-      break;
-    case GenParamType::ParamTPC:
-      mGenFun.reset(new TF1("genFun", "x/(1.+(x/3.)*(x/3.))^1.", mPMin, mPMax));
-      break;
+      return -std::pow(1. + (p / 12.8) * (p / 12.8), 1. - 1.96);
+    default: // ParamTPC
+      return std::log1p((p / 3.) * (p / 3.));
   }
+}
+
+//-----------------------------------------------------------------------------
+void GeneratorCosmics::initMomentumSampler()
+{
+  mPrimMin = momentumPrimitive(mPMin);
+  mPrimMax = momentumPrimitive(mParam == GenParamType::ParamMI ? 2 * mPMax : mPMax);
+}
+
+//-----------------------------------------------------------------------------
+float GeneratorCosmics::sampleMomentum(double u) const
+{
+  // invert momentumPrimitive at the interpolated primitive
+  auto prim = mPrimMin + u * (mPrimMax - mPrimMin);
+  switch (mParam) {
+    case GenParamType::ParamMI:
+      return -30. * std::log(-prim);
+    case GenParamType::ParamACORDE:
+      return 12.8 * std::sqrt(std::max(std::pow(-prim, 1. / (1. - 1.96)) - 1., 0.));
+    default: // ParamTPC
+      return 3. * std::sqrt(std::expm1(prim));
+  }
+}
+
+//-----------------------------------------------------------------------------
+double GeneratorCosmics::getFluxFraction() const
+{
+  auto ref = momentumPrimitive(std::max(MaxPSource, mParam == GenParamType::ParamMI ? 2 * mPMax : mPMax)) - momentumPrimitive(MinPSource);
+  return (momentumPrimitive(mParam == GenParamType::ParamMI ? 2 * mPMax : mPMax) - momentumPrimitive(mPMin)) / ref;
+}
+
+//-----------------------------------------------------------------------------
+void GeneratorCosmics::estimateRate()
+{
+  // Muons are uniform on the Y=mROrigin plane, the area of the plane from which a muon reaches the acceptance
+  // is 4*mXAcc*mZAcc times the flux weight of backPropagate, averaged over the source momenta and directions
+  constexpr int NTrials = 100000;
+  constexpr int MuMinusPDG = 13, MuPlusPDG = -13;
+  if (mFlux <= 0) {
+    throw std::runtime_error("flux normalization is needed to estimate the rate");
+  }
+  if (!mFieldIsSet && !detectField()) {
+    throw std::runtime_error("Failed to fetch magnetic field");
+  }
+  double sumW = 0., sumN = 0.;
+  for (int i = 0; i < NTrials; i++) {
+    int pdg = gRandom->Rndm() < MuMinusFraction ? MuMinusPDG : MuPlusPDG;
+    float p[3], r[3], ptot = 0, weight = 0;
+    if (!generateMomentum(p, ptot)) {
+      continue;
+    }
+    if (backPropagate((2.f * gRandom->Rndm() - 1.f) * mXAcc, (2.f * gRandom->Rndm() - 1.f) * mZAcc, p, -pdg, r, weight)) {
+      sumW += weight;
+      sumN++;
+    }
+  }
+  auto norm = mFlux * getFluxFraction() * 4. * mXAcc * mZAcc / NTrials;
+  mRate = norm * sumW;
+  mRateEmitted = mTargeted ? norm * sumN : mRate;
+  printf("Rate of muons crossing the acceptance: %e Hz\n", mRate);
+}
+
+//-----------------------------------------------------------------------------
+double GeneratorCosmics::getRate()
+{
+  if (mRate < 0) {
+    estimateRate();
+  }
+  return mRate;
+}
+
+//-----------------------------------------------------------------------------
+void GeneratorCosmics::Init()
+{
+  //
+  // Initialisation, check consistency of selected ranges
+  //
+  initMomentumSampler();
   printf("Cosmics generator configuration:\n");
   printf("Parameterization type: %d with %e < p < %e\n", int(mParam), mPMin, mPMax);
+  printf("Fraction of the flux with %.1f < p < %.1f inside the window: %e\n", MinPSource, MaxPSource, getFluxFraction());
   printf("Tracks created at R=%.2f and requested to have |X|<%.2f  and |Z|<%.2f at Y=0\n", mROrigin, mXAcc, mZAcc); 
+  if (mTargeted) {
+    printf("Crossing points drawn inside the acceptance, tracks carry the flux weight\n");
+  }
+  if (mBlockSize > 0 && !mTargeted) {
+    printf("Candidates screened in blocks of %d\n", mBlockSize);
+  }
+  mBlock.reset(); // drop muons queued with the previous settings
+  mRate = mRateEmitted = -1.;
   if (detectField()) {
     printf("Magnetic field %f\n", mBkG);
   }
+  if (mTimeFrame > 0) {
+    printf("Timeframes of %.1f ns with %e muons/cm2/s through the horizontal plane\n", mTimeFrame, mFlux);
+  }
   return;
 }
 
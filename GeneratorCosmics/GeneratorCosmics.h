@@ -18,7 +18,7 @@
 
 #include <TGenerator.h>
 #include <TClonesArray.h>
-#include <TF1.h>
+#include <memory>
 
 // Generates requested number of cosmic muons per call, requiring them to pass through
 // certain |X|, |Z| at Y=0. The muons are generated on the surface of cylinder of the radius mROrigin
@@ -31,13 +31,17 @@ class GeneratorCosmics : public TGenerator
   enum class GenParamType : int { ParamMI, ParamACORDE, ParamTPC }; // source parameterizations
 
   GeneratorCosmics();
-  virtual ~GeneratorCosmics() {}
+  virtual ~GeneratorCosmics();
 
   virtual void GenerateEvent();
   virtual void Init();
   virtual int ImportParticles(TClonesArray *particles, Option_t *option);
   
-  void setParam(GenParamType p) { mParam = p; }
+  void setParam(GenParamType p)
+  {
+    mParam = p;
+    initMomentumSampler();
+  }
   GenParamType getParam() const { return mParam; }
   void setParamMI() { setParam(GenParamType::ParamMI); }
   void setParamACORDE() { setParam(GenParamType::ParamACORDE); }
@@ -62,11 +66,17 @@ class GeneratorCosmics : public TGenerator
   {
     mPMin = pmin < 0.5 ? 0.5 : pmin;
     mPMax = pmax < mPMin + 1e-3 ? mPMin + 1e-3 : pmax;
-    if (mGenFun) {
-      mGenFun->SetRange(pmin, pmax);
-    }
+    initMomentumSampler();
   }
 
+  // Source spectra: exp(-p/30) for ParamMI, p/(1+(p/12.8)^2)^1.96 for ParamACORDE, p/(1+(p/3)^2) for ParamTPC.
+  // Momenta are drawn inside the window by inverting their cumulative distributions (upper edge 2*pmax for
+  // ParamMI, whose momentum is rescaled by the direction). The fraction of the source flux above
+  // MinPSource (up to MaxPSource) falling inside the window normalizes the rate.
+  static constexpr float MinPSource = 0.5, MaxPSource = 1000.;
+  double getFluxFraction() const;
+  float sampleMomentum(double u) const; // inverse cumulative distribution at u in [0, 1]
+
   void requireXZAccepted(float x, float z)
   {
     mXAcc = x < 1 ? 1. : x;
@@ -81,13 +91,45 @@ class GeneratorCosmics : public TGenerator
   void requireITS6() { requireXZAccepted(39.33, 75.08); }
   void requireTPC() { requireXZAccepted(250, 250); }
 
+  // Draw the crossing point at Y=0 uniformly inside the |X|, |Z| acceptance and propagate the muon back to
+  // its origin instead of rejecting muons missing the acceptance. The muons are weighted with the flux
+  // density relative to the uniform crossing points (1 without field).
+  void setTargetedSampling(bool v = true) { mTargeted = v; }
+  bool getTargetedSampling() const { return mTargeted; }
+
+  // Screen the candidates in blocks of n with bulk random numbers and branch free kernels instead of one
+  // by one, 0 for the scalar loop. The survivors are queued for the following muons and events.
+  void setBlockSize(int n) { mBlockSize = n < 0 ? 0 : n; }
+  int getBlockSize() const { return mBlockSize; }
+
+  // Timeframe mode: instead of mNPart muons, every event contains a Poisson number of muons crossing the
+  // acceptance during lengthNS ns, with production times uniform in [0, lengthNS), in increasing order.
+  // The mean follows from the absolute flux (cm^-2 s^-1) of source muons with p > MinPSource through the
+  // horizontal plane, the flux fraction of the momentum window and the acceptance of the generation surface.
+  void setTimeFrame(float lengthNS) { mTimeFrame = lengthNS < 0 ? 0 : lengthNS; }
+  float getTimeFrame() const { return mTimeFrame; }
+  void setFlux(float f) { mFlux = f < 0 ? 0 : f; }
+  float getFlux() const { return mFlux; }
+  double getRate(); // rate (Hz) of muons crossing the acceptance
+
   bool getXZatOrigin(float& xpos, float& zpos, const float r[3], const float p[3], int q) const;
 
  private:
   bool detectField();
+  bool generateMomentum(float p[3], float& ptot) const;
+  bool backPropagate(float xacc, float zacc, const float p[3], int q, float r[3], float& weight) const;
+  void estimateRate();
+
+  void initMomentumSampler();
+  double momentumPrimitive(double p) const;
+
+  struct Block;
+  void generateBlock();
+  void getXZatOriginBlock(int n, const float* rx, const float* ry, const float* rz, const float* px, const float* py,
+                          const float* pz, const int* q, float* xpos, float* zpos, unsigned char* ok) const;
+  static void fillGaus(int n, float* g, float mean, float sigma);
   
   GenParamType mParam = GenParamType::ParamTPC;
-  std::unique_ptr<TF1> mGenFun;
 
   int mNPart = 1;                           // number of particle per event
   int mMaxTrials = 10000000;                // max trials to generat single muon
@@ -102,8 +144,20 @@ class GeneratorCosmics : public TGenerator
   float mZAcc = 250.; // max |Z| of track at Y = 0
 
   bool mFieldIsSet = false;
+  bool mTargeted = false; // draw the crossing points inside the acceptance
+  int mBlockSize = 0;     // candidates per block, 0 for the scalar loop
+
+  float mTimeFrame = 0.; // length of the timeframe in ns, 0 for fixed number of muons
+  float mFlux = 0.;      // flux of source muons through the horizontal plane, cm^-2 s^-1
+
+  double mRate = -1.;        //! rate of muons crossing the acceptance, < 0 if not estimated yet
+  double mRateEmitted = -1.; //! rate of generated (in targeted mode weighted) muons
+  double mPrimMin = 0.; //! primitive of the spectrum at the edges of the source window
+  double mPrimMax = 0.; //!
+
+  std::unique_ptr<Block> mBlock; //! block buffers and accepted muons
   
-  ClassDef(GeneratorCosmics, 1) // parametrized cosmics generator
+  ClassDef(GeneratorCosmics, 5) // parametrized cosmics generator
 };
 
 #endif
@@ -10,11 +10,22 @@
 
 
 #include "ExodusDecayer.h"
+#include <TClonesArray.h>
+#include <TParticle.h>
 #include <TRandom.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unistd.h>
 
 
 ClassImp(ExodusDecayer)
 
+const char ExodusDecayer::kTableMagic[9] = "EXODUSMT";
+
 
 ExodusDecayer::ExodusDecayer():
     fEPMassPion(0),
@@ -31,8 +42,15 @@ ExodusDecayer::ExodusDecayer():
     fEPMassJPsi(0),
     fEPMassPsi2S(0),
     fEPMassUpsilon(0),
-    fPol(new TF1("dsigdcostheta","1.+[0]*x*x",-1.,1.)), /* Polarization Function for resonances */
     fInit(0),
+    fTableNodes(4000),
+    fTableTolerance(1.e-4),
+    fMassLepton(0),
+    fMassPion(0),
+    fMassEta(0),
+    fMassOmega(0),
+    fMassProton(0),
+    fNLast(0),
     fDecayToDimuon(0)
 
 {
@@ -55,7 +73,6 @@ ExodusDecayer::~ExodusDecayer()
   delete fEPMassJPsi;
   delete fEPMassPsi2S;
   delete fEPMassUpsilon;
-  delete fPol;
 }
 
 
@@ -65,338 +82,395 @@ void ExodusDecayer::Init()
 // Initialisation
 //
    Int_t ibin, nbins;
-   Double_t min, maxpion, maxeta, maxomega, maxetaprime, maxetaprime_toOmega, maxphi, maxphi_toPi0, binwidth_pion, binwidth_eta, binwidth_omega, binwidth_etaprime, binwidth_etaprime_toOmega, binwidth_phi, binwidth_phi_toPi0;
-   Double_t pionmass, etamass, omegamass, etaprimemass, phimass, emass, proton_mass, omasspion, omasseta, omassgamma;
-   Double_t epsilon_pion, epsilon_eta, epsilon_omega, epsilon_etaprime, epsilon_etaprime_toOmega, epsilon_phi, epsilon_phi_toPi0;
-   Double_t delta_pion, delta_eta, delta_omega, delta_etaprime, delta_etaprime_toOmega, delta_phi, delta_phi_toPi0;
-   Double_t mLL_pion, mLL_eta, mLL_omega, mLL_etaprime, mLL_etaprime_toOmega, mLL_phi, mLL_phi_toPi0;
-   Double_t q_pion, q_eta, q_omega, q_etaprime, q_etaprime_toOmega, q_phi, q_phi_toPi0;
-   Double_t kwHelp_pion, kwHelp_eta, kwHelp_omega, kwHelp_etaprime, kwHelp_etaprime_toOmega, kwHelp_phi, kwHelp_phi_toPi0;
-   Double_t krollWada_pion, krollWada_eta, krollWada_omega, krollWada_etaprime, krollWada_etaprime_toOmega, krollWada_phi, krollWada_phi_toPi0;
-   Double_t formFactor_pion, formFactor_eta, formFactor_omega, formFactor_etaprime, formFactor_etaprime_toOmega, formFactor_phi, formFactor_phi_toPi0;
-   Double_t weight_pion, weight_eta_dalitz, weight_omega_dalitz, weight_etaprime, weight_etaprime_toOmega, weight_phi_dalitz, weight_phi_dalitz_toPi0;
-
-   Float_t  binwidth;
-   Float_t  mass_bin, mass_min, mass_max;
-   Double_t vmass_eta, vmass_rho, vmass_omega, vmass_phi, vmass_jpsi, vmass_psi2s, vmass_upsilon, vwidth_eta, vwidth_rho, vwidth_omega, vwidth_phi, vwidth_jpsi, vwidth_psi2s, vwidth_upsilon;
-   Double_t weight_eta, weight_rho, weight_omega, weight_phi, weight_jpsi, weight_psi2s, weight_upsilon;
+   Double_t pionmass, etamass, omegamass, etaprimemass, phimass, emass;
+   Double_t mass_min, mass_max, binwidth, mass_bin;
 
-//================================================================================//
-//          Create electron pair mass histograms from dalitz decays               //
-//================================================================================//
+   // Get the particle masses
+   // parent
+   nbins = 2000;
+   pionmass     = (TDatabasePDG::Instance()->GetParticle(111))->Mass();
+   etamass      = (TDatabasePDG::Instance()->GetParticle(221))->Mass();  
+   omegamass    = (TDatabasePDG::Instance()->GetParticle(223))->Mass();  
+   etaprimemass = (TDatabasePDG::Instance()->GetParticle(331))->Mass();  
+   phimass      = (TDatabasePDG::Instance()->GetParticle(333))->Mass();
+   // child - electron
+   if (fDecayToDimuon == 0) emass = (TDatabasePDG::Instance()->GetParticle(11))->Mass();
+   else emass = (TDatabasePDG::Instance()->GetParticle(13))->Mass();
 
-    // Get the particle masses
-    // parent
-    nbins = 2000;
-    mass_min = 0.;
-    mass_max = 0.;
-    pionmass     = (TDatabasePDG::Instance()->GetParticle(111))->Mass();
-    etamass      = (TDatabasePDG::Instance()->GetParticle(221))->Mass();  
-    omegamass    = (TDatabasePDG::Instance()->GetParticle(223))->Mass();  
-    etaprimemass = (TDatabasePDG::Instance()->GetParticle(331))->Mass();  
-    phimass      = (TDatabasePDG::Instance()->GetParticle(333))->Mass();
-    // child - electron
-    if (fDecayToDimuon == 0) emass = (TDatabasePDG::Instance()->GetParticle(11))->Mass();
-    else emass = (TDatabasePDG::Instance()->GetParticle(13))->Mass();
-    // child - other : third childs from Dalitz decays   
-    omasspion  = pionmass;
-    omasseta   = etamass;
-    omassgamma = 0.;
-       
-    min         = 2.0 * emass;
-    maxpion     = pionmass - omassgamma;
-    maxeta      = etamass - omassgamma;
-    maxomega    = omegamass - pionmass;
-    maxetaprime = etaprimemass - omassgamma;
-    maxetaprime_toOmega = etaprimemass - omegamass;
-    if (fDecayToDimuon == 0) maxphi = phimass - omasseta; 
-    else maxphi = phimass - omassgamma;
-    maxphi_toPi0      = phimass - pionmass; 
-
-    binwidth_pion     = (maxpion - min) / (Double_t)nbins;
-    binwidth_eta      = (maxeta - min) / (Double_t)nbins;
-    binwidth_omega    = (maxomega - min) / (Double_t)nbins;
-    binwidth_etaprime = (maxetaprime - min) / (Double_t)nbins;
-    binwidth_etaprime_toOmega = (maxetaprime_toOmega - min) / (Double_t)nbins;
-    binwidth_phi      = (maxphi - min) / (Double_t)nbins;
-    binwidth_phi_toPi0      = (maxphi_toPi0 - min) / (Double_t)nbins;
-
-
-    epsilon_pion     = (emass / pionmass) * (emass / pionmass);
-    epsilon_eta      = (emass / etamass) * (emass / etamass);
-    epsilon_omega    = (emass / omegamass) * (emass / omegamass);
-    epsilon_etaprime = (emass / etaprimemass) * (emass / etaprimemass);
-    epsilon_etaprime_toOmega = (emass / etaprimemass) * (emass / etaprimemass);
-    epsilon_phi      = (emass / phimass) * (emass / phimass);    
-    epsilon_phi_toPi0      = (emass / phimass) * (emass / phimass);    
-
-
-    delta_pion       = (omassgamma / pionmass) * (omassgamma / pionmass);
-    delta_eta        = (omassgamma / etamass) * (omassgamma / etamass);
-    delta_omega      = (omasspion / omegamass) * (omasspion / omegamass);
-    delta_etaprime   = (omassgamma / etaprimemass) * (omassgamma / etaprimemass);
-    delta_etaprime_toOmega   = (omegamass / etaprimemass) * (omegamass / etaprimemass);
-    if (fDecayToDimuon == 0) delta_phi = (omasseta / phimass) * (omasseta / phimass);    
-    else delta_phi = (omassgamma / phimass) * (omassgamma / phimass);    
-    delta_phi_toPi0        = (pionmass / phimass) * (pionmass / phimass);    
-
-    // create pair mass histograms for Dalitz decays of pi0, eta, omega, eta' and phi
-    fEPMassPion = new TH1F("fEPMassPion", "Dalitz electron pair from pion", nbins, min, maxpion);
-    fEPMassPion->SetDirectory(0);
-    fEPMassEtaDalitz = new TH1F("fEPMassEtaDalitz", "Dalitz electron pair from eta", nbins, min, maxeta);
-    fEPMassEtaDalitz->SetDirectory(0);
-    fEPMassOmegaDalitz = new TH1F("fEPMassOmegaDalitz", "Dalitz electron pair from omega ", nbins, min, maxomega);
-    fEPMassOmegaDalitz->SetDirectory(0);
-    fEPMassEtaPrime = new TH1F("fEPMassEtaPrime", "Dalitz electron pair from etaprime", nbins, min, maxetaprime);
-    fEPMassEtaPrime->SetDirectory(0);
-    fEPMassEtaPrime_toOmega = new TH1F("fEPMassEtaPrime_toOmega", "Dalitz electron pair from etaprime_toOmega", nbins, min, maxetaprime_toOmega);
-    fEPMassEtaPrime_toOmega->SetDirectory(0);
-    fEPMassPhiDalitz = new TH1F("fEPMassPhiDalitz", "Dalitz electron pair from phi ", nbins, min, maxphi);
-    fEPMassPhiDalitz->SetDirectory(0);
-    fEPMassPhiDalitz_toPi0  = new TH1F("fEPMassPhiDalitz_toPi0", "Dalitz electron pair from phi_toPi0 ", nbins, min, maxphi_toPi0);
-    fEPMassPhiDalitz_toPi0->SetDirectory(0);
-
-    mLL_pion =  mLL_eta = mLL_omega = mLL_etaprime = mLL_etaprime_toOmega = mLL_phi = mLL_phi_toPi0 = 0.;
-
-    for (ibin = 1; ibin <= nbins; ibin++ )
-        {
-         mLL_pion     = min + (Double_t)(ibin - 1) * binwidth_pion + binwidth_pion / 2.0;
-         mLL_eta      = min + (Double_t)(ibin - 1) * binwidth_eta + binwidth_eta / 2.0;
-         mLL_omega    = min + (Double_t)(ibin - 1) * binwidth_omega + binwidth_omega / 2.0;
-         mLL_etaprime = min + (Double_t)(ibin - 1) * binwidth_etaprime + binwidth_etaprime / 2.0;
-         mLL_etaprime_toOmega = min + (Double_t)(ibin - 1) * binwidth_etaprime_toOmega + binwidth_etaprime_toOmega / 2.0;
-         mLL_phi      = min + (Double_t)(ibin - 1) * binwidth_phi + binwidth_phi / 2.0;
-         mLL_phi_toPi0      = min + (Double_t)(ibin - 1) * binwidth_phi_toPi0 + binwidth_phi_toPi0 / 2.0;
-
-
-         q_pion        = (mLL_pion / pionmass) * (mLL_pion / pionmass);
-         q_eta         = (mLL_eta / etamass) * (mLL_eta / etamass);
-         q_omega       = (mLL_omega / omegamass)*(mLL_omega / omegamass);
-         q_etaprime    = (mLL_etaprime / etaprimemass) * (mLL_etaprime / etaprimemass);
-         q_etaprime_toOmega    = (mLL_etaprime_toOmega / etaprimemass) * (mLL_etaprime_toOmega / etaprimemass);
-         q_phi         = (mLL_phi / phimass) * (mLL_phi / phimass);
-         q_phi_toPi0         = (mLL_phi_toPi0 / phimass) * (mLL_phi_toPi0 / phimass);
-
-    if (fDecayToDimuon == 0)
-      {
-      if ( q_pion <= 4.0 * epsilon_pion || q_eta <= 4.0 * epsilon_eta || q_omega <= 4.0 * epsilon_omega || q_etaprime <= 4.0 * epsilon_etaprime || q_etaprime_toOmega <= 4.0 * epsilon_etaprime_toOmega || q_phi <= 4.0 * epsilon_phi || q_phi_toPi0 <= 4.0 * epsilon_phi_toPi0  )
-         {
-           printf("ExodusDecayer: Error in calculating Dalitz mass histogram binning!\n");
-         }
-      } else {
-      if ( q_eta <= 4.0 * epsilon_eta || q_omega <= 4.0 * epsilon_omega || q_etaprime <= 4.0 * epsilon_etaprime || q_phi <= 4.0 * epsilon_phi)
-         {
-           printf("ExodusDecayer: Error in calculating Dalitz mass histogram binning!\n");
-         }
-      }
-  
+   fMassLepton = emass;
+   fMassPion   = pionmass;
+   fMassEta    = etamass;
+   fMassOmega  = omegamass;
+   fMassProton = (TDatabasePDG::Instance()->GetParticle(2212))->Mass();
 
-    kwHelp_pion     = (1.0 + q_pion /  (1.0 - delta_pion)) * (1.0 + q_pion / (1.0 - delta_pion))
-                                     - 4.0 * q_pion / ((1.0 - delta_pion) * (1.0 - delta_pion));
+//================================================================================//
+//          Dalitz decays: parent and third child, pair mass from 2 m_l           //
+//================================================================================//
 
-    kwHelp_eta      = (1.0 + q_eta /  (1.0 - delta_eta)) * (1.0 + q_eta / (1.0 - delta_eta))
-                                    - 4.0 * q_eta / ((1.0 - delta_eta) * (1.0 - delta_eta));
+   SetChannel(kPion,             pionmass,     0., 0.);
+   SetChannel(kEtaDalitz,        etamass,      0., 0.);
+   SetChannel(kOmegaDalitz,      omegamass,    0., pionmass);
+   SetChannel(kEtaPrime,         etaprimemass, 0., 0.);
+   SetChannel(kEtaPrime_toOmega, etaprimemass, 0., omegamass);
+   SetChannel(kPhiDalitz,        phimass,      0., (fDecayToDimuon == 0) ? etamass : 0.);
+   SetChannel(kPhiDalitz_toPi0,  phimass,      0., pionmass);
+   for (Int_t i = kPion; i <= kPhiDalitz_toPi0; i++) {
+      fMassMin[i] = 2.0 * emass;
+      fMassMax[i] = fParentMass[i] - fThirdMass[i];
+   }
 
-    kwHelp_omega    = (1.0 + q_omega /  (1.0 - delta_omega)) * (1.0 + q_omega / (1.0 - delta_omega))
-                                      - 4.0 * q_omega / ((1.0 - delta_omega) * (1.0 - delta_omega));
+//===================================================================================//
+//         Resonance decays: line shape between 2 m_pi and 10 GeV                    //
+//===================================================================================//
 
-    kwHelp_etaprime = (1.0 + q_etaprime /  (1.0 - delta_etaprime)) * (1.0 + q_etaprime / (1.0 - delta_etaprime))
-                                         - 4.0 * q_etaprime / ((1.0 - delta_etaprime) * (1.0 - delta_etaprime));
-    kwHelp_etaprime_toOmega = (1.0 + q_etaprime_toOmega /  (1.0 - delta_etaprime_toOmega)) * (1.0 + q_etaprime_toOmega / (1.0 - delta_etaprime_toOmega))
-                                    - 4.0 * q_etaprime_toOmega / ((1.0 - delta_etaprime_toOmega) * (1.0 - delta_etaprime_toOmega));
-    kwHelp_phi      = (1.0 + q_phi /  (1.0 - delta_phi)) * (1.0 + q_phi / (1.0 - delta_phi))
-                                    - 4.0 * q_phi / ((1.0 - delta_phi) * (1.0 - delta_phi));
-    kwHelp_phi_toPi0      = (1.0 + q_phi_toPi0 /  (1.0 - delta_phi_toPi0)) * (1.0 + q_phi_toPi0 / (1.0 - delta_phi_toPi0))
-                                    - 4.0 * q_phi_toPi0 / ((1.0 - delta_phi_toPi0) * (1.0 - delta_phi_toPi0));
+   Double_t pimass = 0.13956995;
+   Int_t    pdgRes[7] = {221, 113, 223, 333, 443, 100443, 553};
+   Int_t    tabRes[7] = {kEta, kRho, kOmega, kPhi, kJPsi, kPsi2S, kUpsilon};
+   for (Int_t i = 0; i < 7; i++) {
+      TParticlePDG *res = TDatabasePDG::Instance()->GetParticle(pdgRes[i]);
+      Double_t vwidth = res->Width();
+      if (pdgRes[i] == 443 || pdgRes[i] == 100443 || pdgRes[i] == 553) {
+         if( vwidth < 1e-6 ){
+            printf("ExodusDecayer: Warning: Width of %d = %f (Mass = %f) < 1e-6, set to 1e-6\n", pdgRes[i], vwidth, res->Mass());
+            vwidth = 1e-6;
+         }
+      }
+      SetChannel(tabRes[i], res->Mass(), vwidth, 0.);
+      fMassMin[tabRes[i]] = 2.*pimass;
+      fMassMax[tabRes[i]] = 10.;
+   }
 
+//================================================================================//
+//          Pair mass histograms                                                  //
+//================================================================================//
 
+   const char* names[kNTables] = {"fEPMassPion", "fEPMassEta", "fEPMassEtaDalitz", "fEPMassEtaPrime",
+                                  "fEPMassEtaPrime_toOmega", "fEPMassRho", "fEPMassOmega", "fEPMassOmegaDalitz",
+                                  "fEPMassPhi", "fEPMassPhiDalitz", "fEPMassPhiDalitz_toPi0", "fEPMassJPsi",
+                                  "fEPMassPsi2S", "fEPMassUpsilon"};
+   const char* titles[kNTables] = {"Dalitz electron pair from pion", "mass eta", "Dalitz electron pair from eta",
+                                   "Dalitz electron pair from etaprime", "Dalitz electron pair from etaprime_toOmega",
+                                   "mass rho", "mass omega", "Dalitz electron pair from omega ", "mass phi",
+                                   "Dalitz electron pair from phi ", "Dalitz electron pair from phi_toPi0 ",
+                                   "mass jpsi", "mass psi2s", "mass upsilon"};
+   TH1F** histos[kNTables] = {&fEPMassPion, &fEPMassEta, &fEPMassEtaDalitz, &fEPMassEtaPrime,
+                              &fEPMassEtaPrime_toOmega, &fEPMassRho, &fEPMassOmega, &fEPMassOmegaDalitz,
+                              &fEPMassPhi, &fEPMassPhiDalitz, &fEPMassPhiDalitz_toPi0, &fEPMassJPsi,
+                              &fEPMassPsi2S, &fEPMassUpsilon};
+   for (Int_t i = 0; i < kNTables; i++) {
+      mass_min = fMassMin[i];
+      mass_max = fMassMax[i];
+      binwidth = (mass_max - mass_min) / (Double_t)nbins;
+      delete *histos[i];
+      *histos[i] = new TH1F(names[i], titles[i], nbins, mass_min, mass_max);
+      (*histos[i])->SetDirectory(0);
+      for (ibin = 1; ibin <= nbins; ibin++) {
+         mass_bin = mass_min + (Double_t)(ibin - 1) * binwidth + binwidth / 2.0;
+         (*histos[i])->AddBinContent(ibin, PairMassDensity(i, mass_bin));
+      }
+   }
 
+//================================================================================//
+//          Sampling tables                                                       //
+//================================================================================//
 
-    if (fDecayToDimuon == 0)
-      {
-      if ( kwHelp_pion <= 0.0 || kwHelp_eta <= 0.0 || kwHelp_omega <= 0.0 || kwHelp_etaprime <= 0.0 || kwHelp_etaprime_toOmega <= 0.0 || kwHelp_phi <= 0.0 || kwHelp_phi_toPi0 <= 0.0 )
-         {
-           printf("ExodusDecayer: Error in calculating Dalitz mass histogram binning!\n");
-         }
-      } else {
-      if ( kwHelp_eta <= 0.0 || kwHelp_omega <= 0.0 || kwHelp_etaprime <= 0.0 || kwHelp_phi <= 0.0)
-         {
-           printf("ExodusDecayer: Error in calculating Dalitz mass histogram binning!\n");
+   if (fTableCache.IsNull() || !ReadTables(fTableCache.Data())) {
+      for (Int_t i = 0; i < kNTables; i++) {
+         std::vector<Double_t> seeds;
+         if (fParentWidth[i] > 0.) {
+            // resolve the peak down to a fraction of its width
+            seeds.push_back(fParentMass[i]);
+            for (Double_t d = fParentWidth[i] / 8.; d < fMassMax[i] - fMassMin[i]; d *= 2.) {
+               seeds.push_back(fParentMass[i] - d);
+               seeds.push_back(fParentMass[i] + d);
+            }
          }
+         fTables[i].Build([this, i](Double_t m) { return PairMassDensity(i, m); },
+                          fMassMin[i], fMassMax[i], seeds, fTableNodes, fTableTolerance);
       }
+      if (!fTableCache.IsNull() && !WriteTables(fTableCache.Data()))
+         printf("ExodusDecayer: Warning: Could not write mass tables to %s\n", fTableCache.Data());
+   }
+   fInit=1;
+}
 
 
- // Invariant mass distributions of electron pairs from Dalitz decays
- // using Kroll-Wada function   
-
-      krollWada_pion     = (2.0 / mLL_pion) * TMath::Exp(1.5 * TMath::Log(kwHelp_pion))
-                                            * TMath::Sqrt(1.0 - 4.0 * epsilon_pion / q_pion)
-                                            * (1.0 + 2.0 * epsilon_pion / q_pion);
-    
-     
-      krollWada_eta      = (2.0 / mLL_eta) * TMath::Exp(1.5 * TMath::Log(kwHelp_eta))
-                                           * TMath::Sqrt(1.0 - 4.0 * epsilon_eta / q_eta)
-                                           * (1.0 + 2.0 * epsilon_eta / q_eta);
-   
-   
-      krollWada_omega    = (2.0 / mLL_omega) * TMath::Exp(1.5 * TMath::Log(kwHelp_omega))
-                                             * TMath::Sqrt(1.0 - 4.0 * epsilon_omega / q_omega)
-                                             * (1.0 + 2.0 * epsilon_omega / q_omega);
-   
-   
-      krollWada_etaprime = (2.0 / mLL_etaprime) * TMath::Exp(1.5 * TMath::Log(kwHelp_etaprime))
-                                                * TMath::Sqrt(1.0 - 4.0 * epsilon_etaprime / q_etaprime)
-                                                * (1.0 + 2.0 * epsilon_etaprime / q_etaprime);
-      krollWada_etaprime_toOmega = (2.0 / mLL_etaprime_toOmega) * TMath::Exp(1.5 * TMath::Log(kwHelp_etaprime_toOmega))
-                                                * TMath::Sqrt(1.0 - 4.0 * epsilon_etaprime_toOmega / q_etaprime_toOmega)
-                                                * (1.0 + 2.0 * epsilon_etaprime_toOmega / q_etaprime_toOmega);
-
-  
- 
-      krollWada_phi      = (2.0 / mLL_phi) * TMath::Exp(1.5 * TMath::Log(kwHelp_phi))
-                                           * TMath::Sqrt(1.0 - 4.0 * epsilon_phi / q_phi)
-                                           * (1.0 + 2.0 * epsilon_phi / q_phi);   
+void ExodusDecayer::SetChannel(Int_t table, Double_t mass, Double_t width, Double_t third)
+{
+   fParentMass[table]  = mass;
+   fParentWidth[table] = width;
+   fThirdMass[table]   = third;
+}
 
 
+Double_t ExodusDecayer::KrollWada(Double_t mLL, Double_t pmass, Double_t omass, Double_t emass)
+{
+// Invariant mass distributions of electron pairs from Dalitz decays
+// using Kroll-Wada function   
+
+   Double_t epsilon = (emass / pmass) * (emass / pmass);
+   Double_t delta   = (omass / pmass) * (omass / pmass);
+   Double_t q       = (mLL / pmass) * (mLL / pmass);
+   if ( q <= 4.0 * epsilon ) return 0.;
+   Double_t kwHelp  = (1.0 + q /  (1.0 - delta)) * (1.0 + q / (1.0 - delta))
+                      - 4.0 * q / ((1.0 - delta) * (1.0 - delta));
+   if ( kwHelp <= 0.0 ) return 0.;
+   return (2.0 / mLL) * TMath::Exp(1.5 * TMath::Log(kwHelp))
+                      * TMath::Sqrt(1.0 - 4.0 * epsilon / q)
+                      * (1.0 + 2.0 * epsilon / q);
+}
 
-      krollWada_phi_toPi0      = (2.0 / mLL_phi_toPi0) * TMath::Exp(1.5 * TMath::Log(kwHelp_phi_toPi0))
-                                           * TMath::Sqrt(1.0 - 4.0 * epsilon_phi_toPi0 / q_phi_toPi0)
-                                           * (1.0 + 2.0 * epsilon_phi_toPi0 / q_phi_toPi0);
 
+Double_t ExodusDecayer::PairMassDensity(Int_t table, Double_t mLL)
+{
+// Pair mass distribution of a channel, without normalisation
 
+   if (mLL <= fMassMin[table] || mLL >= fMassMax[table]) return 0.;
+   Double_t pmass = fParentMass[table];
+   Double_t kw = 0., formFactor = 1.;
+   switch (table) {
     // Form factors from Lepton-G  (etaprime is a private B-W fit to Lepton-G data)
-    formFactor_pion     = 1.0/(1.0-5.5*mLL_pion*mLL_pion);
-    formFactor_etaprime = (TMath::Power(TMath::Power(0.764,2),2))
-                          /(TMath::Power(TMath::Power(0.764,2)-TMath::Power(mLL_etaprime, 2), 2)
-                          + TMath::Power(0.1020, 2)*TMath::Power(0.764, 2));
-    formFactor_etaprime_toOmega = (TMath::Power(TMath::Power(0.764,2),2))
-                          /(TMath::Power(TMath::Power(0.764,2)-TMath::Power(mLL_etaprime_toOmega, 2), 2)
-                          + TMath::Power(0.1020, 2)*TMath::Power(0.764, 2));
+    case kPion:
+       kw = KrollWada(mLL, pmass, fThirdMass[table], fMassLepton);
+       formFactor = 1.0/(1.0-5.5*mLL*mLL);
+       return kw * formFactor * formFactor;
+    case kEtaPrime:
+    case kEtaPrime_toOmega:
+       kw = KrollWada(mLL, pmass, fThirdMass[table], fMassLepton);
+       formFactor = (TMath::Power(TMath::Power(0.764,2),2))
+                    /(TMath::Power(TMath::Power(0.764,2)-TMath::Power(mLL, 2), 2)
+                    + TMath::Power(0.1020, 2)*TMath::Power(0.764, 2));
+       return kw * formFactor;
     // Form factors from  NA60 (omega is a private B-W fit to NA60 data)
-    formFactor_eta      = 1.0/(1.0-1.934*mLL_eta*mLL_eta);
-    formFactor_omega    = (TMath::Power(TMath::Power(0.67070,2),2))
-                          /(TMath::Power(TMath::Power(0.67070,2)-TMath::Power(mLL_omega, 2), 2)
-                          + TMath::Power(0.0534321, 2)*TMath::Power(0.67070, 2));
+    case kEtaDalitz:
+       kw = KrollWada(mLL, pmass, fThirdMass[table], fMassLepton);
+       formFactor = 1.0/(1.0-1.934*mLL*mLL);
+       return kw * formFactor * formFactor;
+    case kOmegaDalitz:
+       kw = KrollWada(mLL, pmass, fThirdMass[table], fMassLepton);
+       formFactor = (TMath::Power(TMath::Power(0.67070,2),2))
+                    /(TMath::Power(TMath::Power(0.67070,2)-TMath::Power(mLL, 2), 2)
+                    + TMath::Power(0.0534321, 2)*TMath::Power(0.67070, 2));
+       return kw * formFactor;
     // No form factor for phi:
-    formFactor_phi      = 1.0; 
-    formFactor_phi_toPi0      = 1.0; 
+    case kPhiDalitz:
+    case kPhiDalitz_toPi0:
+       return KrollWada(mLL, pmass, fThirdMass[table], fMassLepton);
+    // Resonances
+    case kRho:
+       return RhoShapeFromNA60(mLL, pmass, fParentWidth[table], fMassLepton);
+    case kOmega:
+    case kPhi:
+       return GounarisSakurai(mLL, pmass, fParentWidth[table], fMassLepton);
+    case kEta:
+    case kJPsi:
+    case kPsi2S:
+    case kUpsilon:
+       return Lorentz(mLL, pmass, fParentWidth[table]);
+   }
+   return 0.;
+}
 
 
+void ExodusDecayer::MassTable::Build(const std::function<Double_t(Double_t)> &density,
+                                     Double_t xmin, Double_t xmax, const std::vector<Double_t> &seeds,
+                                     Int_t maxNodes, Double_t tolerance)
+{
+// Nodes for a piecewise linear approximation of the density. The starting
+// grid is uniform plus nodes approaching the threshold geometrically and the
+// seeds; the interval with the largest absolute error of its integral is
+// split until the summed error is below tolerance times the integral or
+// maxNodes is reached.
+
+   fX.clear();
+   fF.clear();
+   fCdf.clear();
+   if (!(xmax > xmin)) return;
+
+   std::vector<Double_t> x;
+   const Int_t nUniform = 64;
+   for (Int_t i = 0; i <= nUniform; i++) x.push_back(xmin + (xmax - xmin) * i / nUniform);
+   for (Double_t d = (xmax - xmin) / nUniform / 2.; d > 1.e-8 * (xmax - xmin); d /= 2.) x.push_back(xmin + d);
+   for (auto s : seeds) if (s > xmin && s < xmax) x.push_back(s);
+   std::sort(x.begin(), x.end());
+   x.erase(std::unique(x.begin(), x.end()), x.end());
+
+   // intervals ordered by the error of the trapezoidal integral
+   struct Interval { Double_t fA, fB, fFa, fFb, fFm, fErr; };
+   auto make = [&density](Double_t a, Double_t b, Double_t fa, Double_t fb) {
+      Double_t fm = density(0.5 * (a + b));
+      return Interval{a, b, fa, fb, fm, TMath::Abs(fm - 0.5 * (fa + fb)) * (b - a)};
+   };
+   auto less = [](const Interval &i1, const Interval &i2) { return i1.fErr < i2.fErr; };
+   std::vector<Interval> heap;
+   std::vector<Double_t> f(x.size());
+   for (UInt_t i = 0; i < x.size(); i++) f[i] = TMath::Max(density(x[i]), 0.);
+   Double_t total = 0., error = 0.;
+   for (UInt_t i = 0; i + 1 < x.size(); i++) {
+      heap.push_back(make(x[i], x[i + 1], f[i], f[i + 1]));
+      total += 0.5 * (x[i + 1] - x[i]) * (f[i] + f[i + 1]);
+      error += heap.back().fErr;
+   }
+   std::make_heap(heap.begin(), heap.end(), less);
+   Int_t nNodes = x.size();
+   while (nNodes < maxNodes && error > tolerance * total && !heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), less);
+      Interval worst = heap.back();
+      heap.pop_back();
+      Double_t m = 0.5 * (worst.fA + worst.fB);
+      Double_t fm = TMath::Max(worst.fFm, 0.);
+      Interval left = make(worst.fA, m, worst.fFa, fm);
+      Interval right = make(m, worst.fB, fm, worst.fFb);
+      total += 0.5 * (m - worst.fA) * (worst.fFa + fm) + 0.5 * (worst.fB - m) * (fm + worst.fFb)
+               - 0.5 * (worst.fB - worst.fA) * (worst.fFa + worst.fFb);
+      error += left.fErr + right.fErr - worst.fErr;
+      heap.push_back(left);
+      std::push_heap(heap.begin(), heap.end(), less);
+      heap.push_back(right);
+      std::push_heap(heap.begin(), heap.end(), less);
+      nNodes++;
+   }
 
+   // collect the nodes and integrate the linear interpolation
+   std::sort(heap.begin(), heap.end(), [](const Interval &i1, const Interval &i2) { return i1.fA < i2.fA; });
+   for (auto &interval : heap) {
+      fX.push_back(interval.fA);
+      fF.push_back(interval.fFa);
+   }
+   fX.push_back(heap.back().fB);
+   fF.push_back(heap.back().fFb);
+   Finalise();
+}
 
-    weight_pion         = krollWada_pion * formFactor_pion * formFactor_pion;
-    weight_eta_dalitz   = krollWada_eta * formFactor_eta * formFactor_eta;
-    weight_omega_dalitz = krollWada_omega * formFactor_omega;
-    weight_etaprime     = krollWada_etaprime * formFactor_etaprime;
-    weight_etaprime_toOmega     = krollWada_etaprime_toOmega * formFactor_etaprime_toOmega;
-    weight_phi_dalitz   = krollWada_phi * formFactor_phi * formFactor_phi;
-    weight_phi_dalitz_toPi0   = krollWada_phi_toPi0 * formFactor_phi_toPi0 * formFactor_phi_toPi0;
 
+void ExodusDecayer::MassTable::Finalise()
+{
+   fCdf.assign(fX.size(), 0.);
+   for (UInt_t i = 1; i < fX.size(); i++)
+      fCdf[i] = fCdf[i - 1] + 0.5 * (fX[i] - fX[i - 1]) * (fF[i - 1] + fF[i]);
+   Double_t total = fCdf.back();
+   if (total <= 0.) {
+      fX.clear();
+      fF.clear();
+      fCdf.clear();
+      return;
+   }
+   for (auto &c : fCdf) c /= total;
+   for (auto &v : fF) v /= total;
+}
 
-    // Fill histograms of electron pair masses from dalitz decays
-    fEPMassPion       ->AddBinContent(ibin, weight_pion);
-    fEPMassEtaDalitz  ->AddBinContent(ibin, weight_eta_dalitz);
-    fEPMassOmegaDalitz->AddBinContent(ibin, weight_omega_dalitz);
-    fEPMassEtaPrime   ->AddBinContent(ibin, weight_etaprime);
-    fEPMassEtaPrime_toOmega   ->AddBinContent(ibin, weight_etaprime_toOmega);
-    fEPMassPhiDalitz  ->AddBinContent(ibin, weight_phi_dalitz);
-    fEPMassPhiDalitz_toPi0  ->AddBinContent(ibin, weight_phi_dalitz_toPi0);
-    }
 
+Double_t ExodusDecayer::MassTable::Cdf(Double_t x) const
+{
+   if (x <= fX.front()) return 0.;
+   if (x >= fX.back()) return 1.;
+   Int_t i = std::upper_bound(fX.begin(), fX.end(), x) - fX.begin() - 1;
+   Double_t h = fX[i + 1] - fX[i];
+   Double_t t = (x - fX[i]) / h;
+   return fCdf[i] + h * t * (fF[i] + 0.5 * t * (fF[i + 1] - fF[i]));
+}
 
-   
 
-//===================================================================================//
-//         Create electron pair mass histograms from resonance decays                //
-//===================================================================================//
+Double_t ExodusDecayer::MassTable::Sample(Double_t r, Double_t xlo, Double_t xhi) const
+{
+// Inverse of the cumulative restricted to [xlo, xhi], exact for the
+// piecewise linear density
+   Double_t clo = Cdf(xlo);
+   Double_t chi = Cdf(xhi);
+   Double_t u = clo + r * (chi - clo);
+   Int_t n = fX.size();
+   Int_t i = std::upper_bound(fCdf.begin(), fCdf.end(), u) - fCdf.begin() - 1;
+   i = TMath::Max(0, TMath::Min(i, n - 2));
+   Double_t dcdf = fCdf[i + 1] - fCdf[i];
+   Double_t v = (dcdf > 0.) ? (u - fCdf[i]) / dcdf : 0.;
+   Double_t c0 = fF[i], c1 = fF[i + 1];
+   Double_t t = v;
+   Double_t sum = c0 + c1;
+   if (sum > 0. && TMath::Abs(c1 - c0) > 1.e-9 * sum)
+      t = (TMath::Sqrt(c0 * c0 + v * (c1 * c1 - c0 * c0)) - c0) / (c1 - c0);
+   Double_t x = fX[i] + t * (fX[i + 1] - fX[i]);
+   return TMath::Max(xlo, TMath::Min(x, xhi));
+}
 
-   Double_t pimass = 0.13956995;
 
-   // Get the particle masses
-   // parent
-   vmass_eta   = (TDatabasePDG::Instance()->GetParticle(221))->Mass();  
-   vmass_rho   = (TDatabasePDG::Instance()->GetParticle(113))->Mass();  
-   vmass_omega = (TDatabasePDG::Instance()->GetParticle(223))->Mass();  
-   vmass_phi   = (TDatabasePDG::Instance()->GetParticle(333))->Mass();  
-   vmass_jpsi  = (TDatabasePDG::Instance()->GetParticle(443))->Mass();
-   vmass_psi2s  = (TDatabasePDG::Instance()->GetParticle(100443))->Mass();
-   vmass_upsilon  = (TDatabasePDG::Instance()->GetParticle(553))->Mass();
-   // Get the particle widths
-   // parent
-   vwidth_eta   = (TDatabasePDG::Instance()->GetParticle(221))->Width();  
-   vwidth_rho   = (TDatabasePDG::Instance()->GetParticle(113))->Width();   
-   vwidth_omega = (TDatabasePDG::Instance()->GetParticle(223))->Width();  
-   vwidth_phi   = (TDatabasePDG::Instance()->GetParticle(333))->Width();  
-   vwidth_jpsi  = (TDatabasePDG::Instance()->GetParticle(443))->Width();
-   vwidth_psi2s  = (TDatabasePDG::Instance()->GetParticle(100443))->Width();
-   vwidth_upsilon  = (TDatabasePDG::Instance()->GetParticle(553))->Width();
-
-   if( vwidth_jpsi < 1e-6 ){
-    printf(Form("ExodusDecayer: Warning: Width JPsi = %f (Mass = %f) < 1e-6, set to 1e-6\n",vwidth_jpsi,vmass_jpsi));
-    vwidth_jpsi = 1e-6;
-  }
-  if( vwidth_psi2s < 1e-6 ){
-    printf(Form("ExodusDecayer: Warning: Width Psi2S = %f (Mass = %f) < 1e-6, set to 1e-6\n",vwidth_psi2s,vmass_psi2s));
-    vwidth_psi2s = 1e-6;
-  }
-  if( vwidth_upsilon < 1e-6 ){
-    printf(Form("ExodusDecayer: Warning: Width Upsilon = %f (Mass = %f) < 1e-6, set to 1e-6\n",vwidth_upsilon,vmass_upsilon));
-    vwidth_upsilon = 1e-6;
-  }
+Bool_t ExodusDecayer::WriteTables(const char *fileName) const
+{
+// Binary dump of the sampling tables, written to a temporary file first
+   std::string tmpName = std::string(fileName) + ".tmp" + std::to_string(getpid());
+   std::ofstream out(tmpName, std::ios::binary);
+   if (!out) return kFALSE;
+   std::vector<Double_t> key = TableKey();
+   UInt_t version = kTableVersion;
+   UInt_t nkey = key.size();
+   out.write(kTableMagic, 8);
+   out.write((const char *)&version, sizeof(version));
+   out.write((const char *)&nkey, sizeof(nkey));
+   out.write((const char *)key.data(), nkey * sizeof(Double_t));
+   for (Int_t i = 0; i < kNTables; i++) {
+      UInt_t n = fTables[i].fX.size();
+      out.write((const char *)&n, sizeof(n));
+      out.write((const char *)fTables[i].fX.data(), n * sizeof(Double_t));
+      out.write((const char *)fTables[i].fF.data(), n * sizeof(Double_t));
+      out.write((const char *)fTables[i].fCdf.data(), n * sizeof(Double_t));
+   }
+   out.close();
+   if (!out || std::rename(tmpName.c_str(), fileName) != 0) {
+      std::remove(tmpName.c_str());
+      return kFALSE;
+   }
+   return kTRUE;
+}
 
 
-       if ( mass_min == 0. && mass_max == 0. )
-          {
-           mass_min  = 2.*pimass;
-           mass_max  = 10.;
-          }
-
-     binwidth  = (mass_max-mass_min)/(Double_t)nbins;
-
-     // create pair mass histograms for resonances of rho, omega, phi, jpsi, psi2s and upsilon
-     fEPMassEta    = new TH1F("fEPMassEta","mass eta",nbins,mass_min,mass_max);
-     fEPMassEta->SetDirectory(0);
-     fEPMassRho    = new TH1F("fEPMassRho","mass rho",nbins,mass_min,mass_max);
-     fEPMassRho->SetDirectory(0);
-     fEPMassOmega  = new TH1F("fEPMassOmega","mass omega",nbins,mass_min,mass_max);
-     fEPMassOmega->SetDirectory(0);
-     fEPMassPhi    = new TH1F("fEPMassPhi","mass phi",nbins,mass_min,mass_max);
-     fEPMassPhi->SetDirectory(0);
-     fEPMassJPsi   = new TH1F("fEPMassJPsi","mass jpsi",nbins,mass_min,mass_max);
-     fEPMassJPsi->SetDirectory(0);
-     fEPMassPsi2S   = new TH1F("fEPMassPsi2S","mass psi2s",nbins,mass_min,mass_max);
-     fEPMassPsi2S->SetDirectory(0);
-     fEPMassUpsilon   = new TH1F("fEPMassUpsilon","mass upsilon",nbins,mass_min,mass_max);
-     fEPMassUpsilon->SetDirectory(0);
-
-     for (ibin=1; ibin<=nbins; ibin++ )
-     {
-     mass_bin = mass_min+(Double_t)(ibin-1)*binwidth+binwidth/2.0;
-
-//     weight_rho     = (Float_t)GounarisSakurai(mass_bin,vmass_rho,vwidth_rho,emass);
-     weight_eta     = (Float_t)Lorentz(mass_bin,vmass_eta,vwidth_eta);
-     weight_rho     = (Float_t)RhoShapeFromNA60(mass_bin,vmass_rho,vwidth_rho,emass);
-
-     weight_omega   = (Float_t)GounarisSakurai(mass_bin,vmass_omega,vwidth_omega,emass);
-     weight_phi     = (Float_t)GounarisSakurai(mass_bin,vmass_phi,vwidth_phi,emass); 
-     weight_jpsi    = (Float_t)Lorentz(mass_bin,vmass_jpsi,vwidth_jpsi);
-     weight_psi2s    = (Float_t)Lorentz(mass_bin,vmass_psi2s,vwidth_psi2s);
-     weight_upsilon    = (Float_t)Lorentz(mass_bin,vmass_upsilon,vwidth_upsilon);
-
-     // Fill histograms of electron pair masses from resonance decays
-     fEPMassEta  ->AddBinContent(ibin,weight_eta);
-     fEPMassRho  ->AddBinContent(ibin,weight_rho);
-     fEPMassOmega->AddBinContent(ibin,weight_omega);
-     fEPMassPhi  ->AddBinContent(ibin,weight_phi);
-     fEPMassJPsi ->AddBinContent(ibin,weight_jpsi);
-     fEPMassPsi2S ->AddBinContent(ibin,weight_psi2s);
-     fEPMassUpsilon ->AddBinContent(ibin,weight_upsilon);
-    }  
-    fInit=1;
+Bool_t ExodusDecayer::ReadTables(const char *fileName)
+{
+// Read tables written by WriteTables for the same masses and table settings
+   std::ifstream in(fileName, std::ios::binary);
+   if (!in) return kFALSE;
+   char magic[8];
+   UInt_t version = 0, nkey = 0;
+   in.read(magic, 8);
+   in.read((char *)&version, sizeof(version));
+   in.read((char *)&nkey, sizeof(nkey));
+   std::vector<Double_t> key = TableKey();
+   if (!in || memcmp(magic, kTableMagic, 8) || version != kTableVersion || nkey != key.size()) return kFALSE;
+   std::vector<Double_t> stored(nkey);
+   in.read((char *)stored.data(), nkey * sizeof(Double_t));
+   if (!in || stored != key) return kFALSE;
+   MassTable tables[kNTables];
+   for (Int_t i = 0; i < kNTables; i++) {
+      UInt_t n = 0;
+      in.read((char *)&n, sizeof(n));
+      if (!in || n > 100000000) return kFALSE;
+      tables[i].fX.resize(n);
+      tables[i].fF.resize(n);
+      tables[i].fCdf.resize(n);
+      in.read((char *)tables[i].fX.data(), n * sizeof(Double_t));
+      in.read((char *)tables[i].fF.data(), n * sizeof(Double_t));
+      in.read((char *)tables[i].fCdf.data(), n * sizeof(Double_t));
+      if (!in) return kFALSE;
+   }
+   for (Int_t i = 0; i < kNTables; i++) fTables[i] = std::move(tables[i]);
+   return kTRUE;
 }
 
 
-Double_t ExodusDecayer::GounarisSakurai(Float_t mass, Double_t vmass, Double_t vwidth, Double_t emass)
+std::vector<Double_t> ExodusDecayer::TableKey() const
+{
+// Everything the tables depend on
+   std::vector<Double_t> key = {(Double_t)fTableNodes, fTableTolerance, (Double_t)fDecayToDimuon, fMassLepton};
+   for (Int_t i = 0; i < kNTables; i++) {
+      key.push_back(fParentMass[i]);
+      key.push_back(fParentWidth[i]);
+      key.push_back(fThirdMass[i]);
+      key.push_back(fMassMin[i]);
+      key.push_back(fMassMax[i]);
+   }
+   return key;
+}
+
+
+Double_t ExodusDecayer::GounarisSakurai(Double_t mass, Double_t vmass, Double_t vwidth, Double_t emass)
 {
 // Invariant mass distributions of electron pairs from resonance decays
 // of rho (not anymore, now using the shape from NA60), omega and phi
@@ -427,7 +501,7 @@ Double_t ExodusDecayer::GounarisSakurai(Float_t mass, Double_t vmass, Double_t v
 
 
 
-Double_t ExodusDecayer::RhoShapeFromNA60(Float_t mass, Double_t vmass, Double_t vwidth, Double_t emass)
+Double_t ExodusDecayer::RhoShapeFromNA60(Double_t mass, Double_t vmass, Double_t vwidth, Double_t emass)
 {
   // Invariant mass distributions of electron pairs from rho decay
   // Using NA06 shape and measured temperature parameter from Physics Letters B 757 (2016) 437–444
@@ -476,7 +550,7 @@ Double_t ExodusDecayer::RhoShapeFromNA60(Float_t mass, Double_t vmass, Double_t
 
 
 
-Double_t ExodusDecayer::Lorentz(Float_t mass, Double_t vmass, Double_t vwidth)
+Double_t ExodusDecayer::Lorentz(Double_t mass, Double_t vmass, Double_t vwidth)
 {
 // Invariant mass distributions of electron pairs from resonance decay
 // of jpsi (and it can also be used for other particles except rho, omega and phi) 
@@ -491,104 +565,101 @@ Double_t ExodusDecayer::Lorentz(Float_t mass, Double_t vmass, Double_t vwidth)
 }
 
 
-void ExodusDecayer::Decay(Int_t idpart, TLorentzVector* pparent)
+
+
+Double_t ExodusDecayer::SampleCosTheta(Double_t lambda, Double_t r)
 {
- 
-    if (!fInit) {
-        Init();
-        fInit=1;  
+// cos(theta) distributed according to 1 + lambda cos^2(theta), lambda > -1,
+// by inverting the cumulative: c^3 + p c + q = 0 with p = 3/lambda and
+// q = (3/lambda + 1)(1 - 2r)
+    if (TMath::Abs(lambda) < 1.e-6) return 2.0*r - 1.0;
+    Double_t p = 3.0/lambda;
+    Double_t q = (p + 1.0)*(1.0 - 2.0*r);
+    Double_t costheta;
+    if (p > 0.) {
+     // one real root (Cardano)
+     Double_t d = TMath::Sqrt(q*q/4.0 + p*p*p/27.0);
+     costheta = std::cbrt(-q/2.0 + d) + std::cbrt(-q/2.0 - d);
+    } else {
+     // three real roots, the cumulative is monotonic so one lies in [-1,1]
+     Double_t m = 2.0*TMath::Sqrt(-p/3.0);
+     Double_t arg = TMath::Max(-1.0, TMath::Min(1.0, 3.0*q/(p*m)));
+     Double_t theta = TMath::ACos(arg)/3.0;
+     costheta = m*TMath::Cos(theta);
+     for (Int_t k = 1; k < 3 && TMath::Abs(costheta) > 1.0 + 1.e-9; k++)
+      costheta = m*TMath::Cos(theta - 2.0*TMath::Pi()*k/3.0);
     }
+    return TMath::Max(-1.0, TMath::Min(1.0, costheta));
+}
 
 
-   // -------- get id of the partner from idpart  ------- //
-   Int_t idpartner=idpart/1000;
-   if (idpart!=100443){ //protect psi(2S) pdg code (100443)
-    idpart=idpart%1000;
-   } else {
-    idpartner=0;
-   }
+Int_t ExodusDecayer::DecayDalitz(Int_t idpart, Int_t idpartner, const TLorentzVector &pparent,
+                                 TRandom *ran, TLorentzVector *products, Int_t &idthird) const
+{
+//-----------------------------------------------------------------------------//
+//             Generate Dalitz decays: Pi0/Eta/Omega/EtaPrime/Phi              //
+//-----------------------------------------------------------------------------//
+// products[0,1]: lepton pair, products[2]: third child
 
-   //local variables for dalitz/2-body decay:
    Double_t pmass, epmass, realp_mass, e1, p1, e3, p3;
-   Double_t wp_res, mp_res, md_res, epmass_res, Ed_res, pd_res;
-   Double_t PolPar;
-   TLorentzVector fProducts_res[2], fProducts_dalitz[3];
-   Int_t idRho=113;
-   Int_t idOmega=223;
-   Int_t idPhi=333;
-   Int_t idJPsi=443;
-   Int_t idPi0=111;
-   Int_t idEta=221;
-   Int_t idEtaPrime=331;
-   Int_t idPsi2S=100443;
-   Int_t idUpsilon=553;
-
-   // Get the particle masses of daughters
-   Double_t emass, proton_mass, omass_pion, omass_eta, omass_gamma, omass_omega;
-   if (fDecayToDimuon == 0) emass = (TDatabasePDG::Instance()->GetParticle(11))->Mass();
-   else emass = (TDatabasePDG::Instance()->GetParticle(13))->Mass();
-   proton_mass = (TDatabasePDG::Instance()->GetParticle(2212)) ->Mass();  
-   omass_pion  = (TDatabasePDG::Instance()->GetParticle(111))->Mass();
-   omass_eta   = (TDatabasePDG::Instance()->GetParticle(221))->Mass();  
-   omass_gamma = (TDatabasePDG::Instance()->GetParticle(22)) ->Mass();   
-   omass_omega = (TDatabasePDG::Instance()->GetParticle(223)) ->Mass();   
+   Double_t emass = fMassLepton;
 
    //flat angular distributions
    Double_t costheta, sintheta, cosphi, sinphi, phi;
    Double_t beta_square, lambda;
-   costheta = (2.0 * gRandom->Rndm()) - 1.;
+   costheta = (2.0 * ran->Rndm()) - 1.;
    sintheta = TMath::Sqrt((1. + costheta) * (1. - costheta));
-   phi      = 2.0 * TMath::ACos(-1.) * gRandom->Rndm();
+   phi      = 2.0 * TMath::ACos(-1.) * ran->Rndm();
    sinphi   = TMath::Sin(phi);
    cosphi   = TMath::Cos(phi); 
 
-
-//-----------------------------------------------------------------------------//
-//             Generate Dalitz decays: Pi0/Eta/Omega/EtaPrime/Phi              //
-//-----------------------------------------------------------------------------//
-
-  if((idpart==idPi0||idpart==idEta||idpart==idOmega||idpart==idEtaPrime||idpart==idPhi)&&(idpartner!=0)){
+   // pair-mass table and third child of the channel
+   const MassTable *table = 0;
+   if(idpart==111){
+    table = &fTables[kPion];
+    realp_mass=0.;
+   }else if(idpart==221){
+    table = &fTables[kEtaDalitz];
+    realp_mass=0.;
+   }else if(idpart==223){
+    table = &fTables[kOmegaDalitz];
+    realp_mass=fMassPion;
+   }else if(idpart==331){
+    if(idpartner==22){
+     table = &fTables[kEtaPrime];
+     realp_mass=0.;
+    }else if (idpartner==223 && fDecayToDimuon == 0){
+     table = &fTables[kEtaPrime_toOmega];
+     realp_mass=fMassOmega;
+    }
+   }else if(idpart==333){
+    if(idpartner==221 && fDecayToDimuon == 0){
+     table = &fTables[kPhiDalitz];
+     realp_mass=fMassEta;
+    }else if (idpartner==111 && fDecayToDimuon == 0){
+     table = &fTables[kPhiDalitz_toPi0];
+     realp_mass=fMassPion;
+    }else if (idpartner==22 && fDecayToDimuon == 1){
+     table = &fTables[kPhiDalitz];
+     realp_mass=0.;
+    }
+   }
+   if (!table) {
+    printf("ExodusDecayer: ERROR: Dalitz mass parametrization not found \n");
+    return 0;
+   }
+   idthird = idpartner;
 
    //get the parent mass
-   pmass = pparent->M();
-
-   // Sample the electron pair mass from a histogram
-   for(;;){
-        if(idpart==idPi0){
-         epmass = fEPMassPion->GetRandom();
-         realp_mass=omass_gamma;
-        }else if(idpart==idEta){
-         epmass = fEPMassEtaDalitz->GetRandom();
-         realp_mass=omass_gamma;
-        }else if(idpart==idOmega){
-         epmass = fEPMassOmegaDalitz->GetRandom();
-         realp_mass=omass_pion;
-        }else if(idpart==idEtaPrime){
-         if(idpartner==22){
-          epmass = fEPMassEtaPrime->GetRandom();
-          realp_mass=omass_gamma;
-         }else if (idpartner==223 && fDecayToDimuon == 0){
-          epmass = fEPMassEtaPrime_toOmega->GetRandom();
-          realp_mass=omass_omega;
-         }
-        }else if(idpart==idPhi){
-         if(idpartner==221 && fDecayToDimuon == 0){
-          epmass = fEPMassPhiDalitz->GetRandom();
-          realp_mass=omass_eta;
-         }else if (idpartner==111 && fDecayToDimuon == 0){
-          epmass = fEPMassPhiDalitz_toPi0->GetRandom();
-          realp_mass=omass_pion;
-         }else if (idpartner==22 && fDecayToDimuon == 1){
-          epmass = fEPMassPhiDalitz->GetRandom();
-          realp_mass=omass_gamma;
-         }
-
-        }else{ printf("ExodusDecyer: ERROR: Dalitz mass parametrization not found \n");
-               return;
-        }
-        if(pmass-realp_mass>epmass && epmass/2.>emass) break;
+   pmass = pparent.M();
+   if (table->Empty() || pmass - realp_mass <= 2. * emass) {
+    printf("ExodusDecayer: Dalitz decay kinematically impossible! \n");
+    return 0;
    }
 
+   // Sample the electron pair mass below the kinematic limit
+   epmass = table->Sample(ran->Rndm(), 2. * emass, pmass - realp_mass);
+
    // electron pair kinematics in virtual photon rest frame
    e1 = epmass / 2.;
    p1 = TMath::Sqrt((e1 + emass) * (e1 - emass));
@@ -598,163 +669,122 @@ void ExodusDecayer::Decay(Int_t idpart, TLorentzVector* pparent)
    if ( realp_mass<0.01 ){
     beta_square = 1.0 - 4.0*(emass*emass)/(epmass*epmass);
     lambda      = beta_square/(2.0-beta_square);
-    do{
-     costheta = (2.0*gRandom->Rndm())-1.;
-    }
-    while ( (1.0+lambda*costheta*costheta)<(2.0*gRandom->Rndm()) );
+    costheta = SampleCosTheta(lambda, ran->Rndm());
     sintheta = TMath::Sqrt((1. + costheta) * (1. - costheta));
-    phi      = 2.0 * TMath::ACos(-1.) * gRandom->Rndm();
+    phi      = 2.0 * TMath::ACos(-1.) * ran->Rndm();
     sinphi   = TMath::Sin(phi);
     cosphi   = TMath::Cos(phi); 
    }
 
    // momentum vectors of electrons in virtual photon rest frame
-   Double_t pProd1[3] = {p1 * sintheta * cosphi,
-                         p1 * sintheta * sinphi,
-                         p1 * costheta};
-   Double_t pProd2[3] = {-1.0 * p1 * sintheta * cosphi,
-                         -1.0 * p1 * sintheta * sinphi,
-                         -1.0 * p1 * costheta};
-   fProducts_dalitz[0].SetPx(pProd1[0]);
-   fProducts_dalitz[0].SetPy(pProd1[1]);
-   fProducts_dalitz[0].SetPz(pProd1[2]);
-   fProducts_dalitz[0].SetE(e1);
-   fProducts_dalitz[1].SetPx(pProd2[0]);
-   fProducts_dalitz[1].SetPy(pProd2[1]);
-   fProducts_dalitz[1].SetPz(pProd2[2]);
-   fProducts_dalitz[1].SetE(e1);
+   products[0].SetPxPyPzE(p1 * sintheta * cosphi,
+                          p1 * sintheta * sinphi,
+                          p1 * costheta, e1);
+   products[1].SetPxPyPzE(-1.0 * p1 * sintheta * cosphi,
+                          -1.0 * p1 * sintheta * sinphi,
+                          -1.0 * p1 * costheta, e1);
 
    // third child kinematics in parent meson rest frame
    e3 = (pmass*pmass + realp_mass*realp_mass - epmass*epmass)/(2. * pmass);
    p3 = TMath::Sqrt((e3+realp_mass) * (e3-realp_mass));
    
    // third child 4-vector in parent meson rest frame
-   costheta = (2.0 * gRandom->Rndm()) - 1.;
+   costheta = (2.0 * ran->Rndm()) - 1.;
    sintheta = TMath::Sqrt((1. + costheta) * (1. - costheta));
-   phi      = 2.0 * TMath::ACos(-1.) * gRandom->Rndm();
+   phi      = 2.0 * TMath::ACos(-1.) * ran->Rndm();
    sinphi   = TMath::Sin(phi);
    cosphi   = TMath::Cos(phi); 
-   fProducts_dalitz[2].SetPx(p3 * sintheta * cosphi);
-   fProducts_dalitz[2].SetPy(p3 * sintheta * sinphi);
-   fProducts_dalitz[2].SetPz(p3 * costheta);
-   fProducts_dalitz[2].SetE(e3);
+   products[2].SetPxPyPzE(p3 * sintheta * cosphi,
+                          p3 * sintheta * sinphi,
+                          p3 * costheta, e3);
 
    // boost the dielectron into the parent meson's rest frame
    Double_t eLPparent = TMath::Sqrt(p3*p3 + epmass*epmass);
-   TVector3 boostPair( -1.0 * fProducts_dalitz[2].Px() / eLPparent,
-                       -1.0 * fProducts_dalitz[2].Py() / eLPparent,
-                       -1.0 * fProducts_dalitz[2].Pz() / eLPparent);
-   fProducts_dalitz[0].Boost(boostPair);
-   fProducts_dalitz[1].Boost(boostPair);
+   TVector3 boostPair( -1.0 * products[2].Px() / eLPparent,
+                       -1.0 * products[2].Py() / eLPparent,
+                       -1.0 * products[2].Pz() / eLPparent);
+   products[0].Boost(boostPair);
+   products[1].Boost(boostPair);
 
    // boost all decay products into the lab frame
-   TVector3 boostLab(pparent->Px() / pparent->E(),
-                     pparent->Py() / pparent->E(),
-                     pparent->Pz() / pparent->E());
-   fProducts_dalitz[0].Boost(boostLab);
-   fProducts_dalitz[1].Boost(boostLab);
-   fProducts_dalitz[2].Boost(boostLab);
-
-   if(idpart==idPi0) {
-     fProducts_pion[0]=fProducts_dalitz[0];
-     fProducts_pion[1]=fProducts_dalitz[1];
-     fProducts_pion[2]=fProducts_dalitz[2];
-   }else if(idpart==idEta){
-     fProducts_eta_dalitz[0]=fProducts_dalitz[0];
-     fProducts_eta_dalitz[1]=fProducts_dalitz[1];
-     fProducts_eta_dalitz[2]=fProducts_dalitz[2];
-   }else if(idpart==idOmega){
-     fProducts_omega_dalitz[0]=fProducts_dalitz[0];
-     fProducts_omega_dalitz[1]=fProducts_dalitz[1];
-     fProducts_omega_dalitz[2]=fProducts_dalitz[2];
-   }else if(idpart==idEtaPrime){
-     fProducts_etaprime[0]=fProducts_dalitz[0];
-     fProducts_etaprime[1]=fProducts_dalitz[1];
-     fProducts_etaprime[2]=fProducts_dalitz[2];
-   }else if(idpart==idPhi){
-     fProducts_phi_dalitz[0]=fProducts_dalitz[0];
-     fProducts_phi_dalitz[1]=fProducts_dalitz[1];
-     fProducts_phi_dalitz[2]=fProducts_dalitz[2];
-   }
-
-  }
+   TVector3 boostLab(pparent.Px() / pparent.E(),
+                     pparent.Py() / pparent.E(),
+                     pparent.Pz() / pparent.E());
+   products[0].Boost(boostLab);
+   products[1].Boost(boostLab);
+   products[2].Boost(boostLab);
+   return 3;
+}
 
 
+Int_t ExodusDecayer::DecayResonance(Int_t idpart, const TLorentzVector &pparent, TRandom *ran,
+                                    TLorentzVector *products) const
+{
 //-----------------------------------------------------------------------------//
 //   Generate 2-body resonance decays: Rho/Omega/Phi/JPsi/Psi2S/Upsilon        //
 //-----------------------------------------------------------------------------//
-  if(((idpart==idEta)||idpart==idRho||idpart==idOmega||idpart==idPhi||idpart==idJPsi||idpart==idPsi2S||idpart==idUpsilon)&&(idpartner==0)){
+
+   Double_t mp_res, md_res, epmass_res, Ed_res, pd_res;
+   Double_t PolPar = 0.;
+
+   //flat angular distributions
+   Double_t costheta, sintheta, cosphi, sinphi, phi;
+   costheta = (2.0 * ran->Rndm()) - 1.;
+   phi      = 2.0 * TMath::ACos(-1.) * ran->Rndm();
+   sinphi   = TMath::Sin(phi);
+   cosphi   = TMath::Cos(phi); 
+
+   const MassTable *table = 0;
+   if(idpart==221)         table = &fTables[kEta];
+   else if(idpart==113)    table = &fTables[kRho];
+   else if(idpart==223)    table = &fTables[kOmega];
+   else if(idpart==333)    table = &fTables[kPhi];
+   else if(idpart==443)    table = &fTables[kJPsi];
+   else if(idpart==100443) table = &fTables[kPsi2S];
+   else if(idpart==553)    table = &fTables[kUpsilon];
+   if (!table) {
+    printf("ExodusDecayer: ERROR: Resonance mass G-S parametrization not found \n");
+    return 0;
+   }
 
    //get the parent mass
-   mp_res = pparent->M();
+   mp_res = pparent.M();
 
    //check daughters mass
-   md_res=emass;
-   if ( mp_res < 2.*md_res ){
+   md_res=fMassLepton;
+   if ( mp_res < 2.*md_res || table->Empty() || mp_res/2. >= table->Max() ){
         printf("ExodusDecayer: res into ee Decay kinematically impossible! \n");
-        return;
-   }
-   // Sample the electron pair mass from a histogram and set Polarization
-   for( ;; ) {
-        if(idpart==idEta){
-         epmass_res = fEPMassEta->GetRandom();
-         PolPar=0.;
-        }else if(idpart==idRho){
-         epmass_res = fEPMassRho->GetRandom();
-	 PolPar=0.;
-        }else if(idpart==idOmega){
-	 epmass_res = fEPMassOmega->GetRandom();
-	 PolPar=0.;
-        }else if(idpart==idPhi){
-	 epmass_res = fEPMassPhi->GetRandom();
-	 PolPar=0.;
-        }else if(idpart==idPhi){
-	 epmass_res = fEPMassPhi->GetRandom();
-	 PolPar=0.;
-        }else if(idpart==idJPsi){
-	 epmass_res = fEPMassJPsi->GetRandom();
-	 PolPar=0.;
-        }else if(idpart==idPsi2S){
-     epmass_res = fEPMassPsi2S->GetRandom();
-     PolPar=0.;
-        } else if(idpart==idUpsilon){
-     epmass_res = fEPMassUpsilon->GetRandom();
-     PolPar=0.;
-        }else{ printf("ExodusDecayer: ERROR: Resonance mass G-S parametrization not found \n");
-               return;
-        }
-        if ( mp_res < 2.*epmass_res ) break;
+        return 0;
    }
+   // Sample the electron pair mass in the accepted range above mp_res/2
+   epmass_res = table->Sample(ran->Rndm(), mp_res/2., table->Max());
 
    // electron pair kinematics in virtual photon rest frame
    Ed_res = epmass_res/2.;
    pd_res = TMath::Sqrt((Ed_res+md_res)*(Ed_res-md_res));
 
    // momentum vectors of electrons in virtual photon rest frame 
-   fPol->SetParameter(0,PolPar);
-   costheta = fPol->GetRandom();
+   costheta = SampleCosTheta(PolPar, ran->Rndm());
    sintheta = TMath::Sqrt((1. + costheta)*(1. - costheta));
-   fProducts_res[0].SetPx(pd_res * sintheta * cosphi);
-   fProducts_res[0].SetPy(pd_res * sintheta * sinphi);
-   fProducts_res[0].SetPz(pd_res * costheta);
-   fProducts_res[0].SetE(Ed_res);
-   fProducts_res[1].SetPx(-1.0 * pd_res * sintheta * cosphi);
-   fProducts_res[1].SetPy(-1.0 * pd_res * sintheta * sinphi);
-   fProducts_res[1].SetPz(-1.0 * pd_res * costheta);
-   fProducts_res[1].SetE(Ed_res);
+   products[0].SetPxPyPzE(pd_res * sintheta * cosphi,
+                          pd_res * sintheta * sinphi,
+                          pd_res * costheta, Ed_res);
+   products[1].SetPxPyPzE(-1.0 * pd_res * sintheta * cosphi,
+                          -1.0 * pd_res * sintheta * sinphi,
+                          -1.0 * pd_res * costheta, Ed_res);
 
    // Beam parameters in LAB frame
    TLorentzVector pProj, pTarg; 
    Double_t BeamE=3500.;
-   pProj.SetPxPyPzE(0.,0.,-1.*BeamE,TMath::Sqrt(BeamE*BeamE+proton_mass*proton_mass)); // Beam 1
-   pTarg.SetPxPyPzE(0.,0.,BeamE,TMath::Sqrt(BeamE*BeamE+proton_mass*proton_mass)); // Beam 2
+   pProj.SetPxPyPzE(0.,0.,-1.*BeamE,TMath::Sqrt(BeamE*BeamE+fMassProton*fMassProton)); // Beam 1
+   pTarg.SetPxPyPzE(0.,0.,BeamE,TMath::Sqrt(BeamE*BeamE+fMassProton*fMassProton)); // Beam 2
 
    //re-build parent with G-S mass
    TLorentzVector pparent_corr;
-   pparent_corr.SetPx(pparent->Px());
-   pparent_corr.SetPy(pparent->Py());
-   pparent_corr.SetPz(pparent->Pz());
-   pparent_corr.SetE(sqrt(pow(pparent->P(),2)+pow(epmass_res,2)));
+   pparent_corr.SetPx(pparent.Px());
+   pparent_corr.SetPy(pparent.Py());
+   pparent_corr.SetPz(pparent.Pz());
+   pparent_corr.SetE(sqrt(pow(pparent.P(),2)+pow(epmass_res,2)));
 
    //Boost Beam from CM to Resonance rest frame
    TVector3 betaResCM;
@@ -765,40 +795,131 @@ void ExodusDecayer::Decay(Int_t idpart, TLorentzVector* pparent)
    //Define Zaxis in C-S frame and rotate legs to it
    TVector3 zaxisCS;
    zaxisCS=(((pProj.Vect()).Unit())-((pTarg.Vect()).Unit())).Unit();
-   fProducts_res[0].RotateUz(zaxisCS);
-   fProducts_res[1].RotateUz(zaxisCS);
+   products[0].RotateUz(zaxisCS);
+   products[1].RotateUz(zaxisCS);
 
    // boost decay products into the lab frame 
    TVector3 boostLab_res_corr(pparent_corr.Px() / pparent_corr.E(),
                          pparent_corr.Py() / pparent_corr.E(),
                          pparent_corr.Pz() / pparent_corr.E());
-   fProducts_res[0].Boost(boostLab_res_corr);
-   fProducts_res[1].Boost(boostLab_res_corr);
-
-   if(idpart==idEta) {
-    fProducts_eta[0]=fProducts_res[0];
-    fProducts_eta[1]=fProducts_res[1];
-   }else if(idpart==idRho) {
-    fProducts_rho[0]=fProducts_res[0];
-    fProducts_rho[1]=fProducts_res[1];
-   }else if(idpart==idOmega){
-    fProducts_omega[0]=fProducts_res[0];
-    fProducts_omega[1]=fProducts_res[1];
-   }else  if(idpart==idPhi){
-    fProducts_phi[0]=fProducts_res[0];
-    fProducts_phi[1]=fProducts_res[1];
-   }else  if(idpart==idJPsi){
-    fProducts_jpsi[0]=fProducts_res[0];
-    fProducts_jpsi[1]=fProducts_res[1];
-   }else  if(idpart==idPsi2S){
-    fProducts_psi2s[0]=fProducts_res[0];
-    fProducts_psi2s[1]=fProducts_res[1];
-   }else  if(idpart==idUpsilon){
-    fProducts_upsilon[0]=fProducts_res[0];
-    fProducts_upsilon[1]=fProducts_res[1];
+   products[0].Boost(boostLab_res_corr);
+   products[1].Boost(boostLab_res_corr);
+   return 2;
+}
+
+
+Int_t ExodusDecayer::Decay(Int_t idpart, Int_t idpartner, const TLorentzVector &pparent,
+                           TRandom *ran, ExodusTrack *out, Int_t nmax) const
+{
+// Decay into the caller's buffer. All state is either passed in or read-only
+// after Init, so concurrent calls with different random generators are safe.
+// Output order: parent, [third child,] lepton, antilepton.
+
+   if (!fInit) {
+        printf("ExodusDecayer: ERROR: Decay called before Init \n");
+        return -1;
+   }
+   if (!ran) ran = gRandom;
+
+   TLorentzVector products[3];
+   Int_t idthird = 0;
+   Int_t nd = 0;
+   if((idpart==111||idpart==221||idpart==223||idpart==331||idpart==333)&&(idpartner!=0)){
+    nd = DecayDalitz(idpart, idpartner, pparent, ran, products, idthird);
+   } else if((idpart==221||idpart==113||idpart==223||idpart==333||idpart==443||idpart==100443||idpart==553)&&(idpartner==0)){
+    nd = DecayResonance(idpart, pparent, ran, products);
+   }
+   if (nd == 0) return -1;
+   if (nmax < nd + 1) {
+        printf("ExodusDecayer: ERROR: Output buffer too small (%d < %d) \n", nmax, nd + 1);
+        return -1;
+   }
+
+   Int_t idlepton = (fDecayToDimuon == 0) ? 11 : 13;
+   out[0].fPdg = idpart;
+   out[0].fMother = -1;
+   out[0].fFirstDaughter = 1;
+   out[0].fLastDaughter = nd;
+   pparent.GetXYZT(out[0].fP);
+   for (Int_t i = 1; i <= nd; i++) {
+    // products are stored in reversed order
+    const TLorentzVector &vec = products[nd - i];
+    out[i].fPdg = (i == nd) ? -idlepton : ((i == nd - 1) ? idlepton : idthird);
+    out[i].fMother = 0;
+    out[i].fFirstDaughter = -1;
+    out[i].fLastDaughter = -1;
+    vec.GetXYZT(out[i].fP);
    }
+   return nd + 1;
+}
+
+
+void ExodusDecayer::Decay(Int_t idpart, TLorentzVector* pparent)
+{
+// Decay using gRandom, the products are kept for ImportParticles and the
+// Products_* accessors. idpart carries the partner of Dalitz decays as
+// idpart + 1000 * pdg(partner)
+ 
+    if (!fInit) {
+        Init();
+        fInit=1;  
+    }
+    fNLast = 0;
+    if (!pparent) return;
+
+    // -------- get id of the partner from idpart  ------- //
+    Int_t id = idpart, idpartner = idpart/1000;
+    if (idpart!=100443){ //protect psi(2S) pdg code (100443)
+     id = idpart%1000;
+    } else {
+     idpartner = 0;
+    }
+    Int_t n = Decay(id, idpartner, *pparent, gRandom, fLast, kMaxTracks);
+    if (n < 0) return;
+    fNLast = n;
+
+    TLorentzVector *products = 0;
+    switch (idpart) {
+     case 111 + 1000 * 22:  products = fProducts_pion; break;
+     case 221 + 1000 * 22:  products = fProducts_eta_dalitz; break;
+     case 223 + 1000 * 111: products = fProducts_omega_dalitz; break;
+     case 331 + 1000 * 22:
+     case 331 + 1000 * 223: products = fProducts_etaprime; break;
+     case 333 + 1000 * 221:
+     case 333 + 1000 * 111:
+     case 333 + 1000 * 22:  products = fProducts_phi_dalitz; break;
+     case 221: products = fProducts_eta; break;
+     case 113: products = fProducts_rho; break;
+     case 223: products = fProducts_omega; break;
+     case 333: products = fProducts_phi; break;
+     case 443: products = fProducts_jpsi; break;
+     case 100443: products = fProducts_psi2s; break;
+     case 553: products = fProducts_upsilon; break;
+    }
+    if (!products) return;
+    for (Int_t i = 1; i < n; i++) {
+     products[n - 1 - i].SetPxPyPzE(fLast[i].fP[0], fLast[i].fP[1], fLast[i].fP[2], fLast[i].fP[3]);
+    }
+}
+
 
- }
-  
- return;
+Int_t ExodusDecayer::ImportParticles(TClonesArray *particles)
+{
+// Products of the last call to Decay(Int_t, TLorentzVector*), with Fortran
+// style mother/daughter indices as for the Pythia decayers
+    if (!particles) return 0;
+    TClonesArray &clonesParticles = *particles;
+    clonesParticles.Clear();
+    for (Int_t i = 0; i < fNLast; i++) {
+     const ExodusTrack &track = fLast[i];
+     new(clonesParticles[i]) TParticle(track.fPdg,
+                                       (track.fFirstDaughter < 0) ? 1 : 11,
+                                       track.fMother + 1,
+                                       -1,
+                                       track.fFirstDaughter + 1,
+                                       track.fLastDaughter + 1,
+                                       track.fP[0], track.fP[1], track.fP[2], track.fP[3],
+                                       0., 0., 0., 0.);
+    }
+    return fNLast;
 }
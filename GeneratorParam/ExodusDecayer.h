@@ -33,9 +33,23 @@
 #include <TF1.h>
 #include <TH1.h>
 #include "TDatabasePDG.h"
+#include <TString.h>
+#include <functional>
+#include <vector>
 
 //class TH1F;
 //class TClonesArray;
+class TRandom;
+
+// Entry of the decay output buffer. Indices refer to the position in the
+// buffer, -1 if there is no mother/daughter.
+struct ExodusTrack {
+    Int_t    fPdg;            // PDG code
+    Int_t    fMother;         // index of the mother
+    Int_t    fFirstDaughter;  // index of the first daughter
+    Int_t    fLastDaughter;   // index of the last daughter
+    Double_t fP[4];           // px, py, pz, E
+};
 
 class ExodusDecayer : public TVirtualMCDecayer
 {
@@ -44,13 +58,28 @@ class ExodusDecayer : public TVirtualMCDecayer
     virtual ~ExodusDecayer();
     virtual void    Init();
     virtual void    Decay(Int_t idpart,TLorentzVector* pparent);
-    virtual Int_t   ImportParticles(TClonesArray *particles) {return -1;}
+    // Re-entrant decay: the parent and its daughters are written to out[0..n),
+    // n is returned. Returns -1 if the channel is not handled by Exodus or
+    // the buffer is too small. idpartner is the PDG code of the third
+    // particle of Dalitz decays, 0 for the direct decay into a lepton pair.
+    // Requires Init() to have been called.
+    Int_t           Decay(Int_t idpart, Int_t idpartner, const TLorentzVector &pparent,
+                          TRandom *ran, ExodusTrack *out, Int_t nmax) const;
+    static const Int_t kMaxTracks = 4; // parent plus up to 3 daughters
+    virtual Int_t   ImportParticles(TClonesArray *particles);
     virtual void    SetForceDecay(Int_t)                      {;}
     virtual void    ForceDecay()                              {;}
-    virtual Float_t GetPartialBranchingRatio(Int_t /*ipart*/) {return -1;}
+    virtual Float_t GetPartialBranchingRatio(Int_t /*ipart*/) {return 1;}
     virtual Float_t GetLifetime(Int_t /*kf*/)                 {return -1;}
     virtual void    ReadDecayTable()                          {;}
     virtual void    DecayToDimuons()                          {fDecayToDimuon = 1;}
+    // Pair-mass sampling tables: maximum number of nodes and target relative
+    // error of the integral of the piecewise linear line shape
+    void            SetMassTableParameters(Int_t maxNodes = 4000, Double_t tolerance = 1.e-4)
+                                                              {fTableNodes = maxNodes; fTableTolerance = tolerance;}
+    // Read the tables from fileName if they match the configuration,
+    // otherwise build them in Init and write them there
+    void            SetMassTableCache(const char* fileName)   {fTableCache = fileName;}
     
     virtual TH1F*   ElectronPairMassHistoPion()          {return  fEPMassPion;}
     virtual TH1F*   ElectronPairMassHistoEta()           {return  fEPMassEta;}
@@ -98,8 +127,6 @@ class ExodusDecayer : public TVirtualMCDecayer
     TH1F*         fEPMassPsi2S;
     TH1F*         fEPMassUpsilon;
 
-    TF1* fPol;
-
     // Decay products
     TLorentzVector  fProducts_pion[3];  
     TLorentzVector  fProducts_eta[2];  
@@ -120,11 +147,58 @@ class ExodusDecayer : public TVirtualMCDecayer
     Bool_t fInit;
 
  private:
-    Double_t GounarisSakurai(Float_t mass, Double_t vmass, Double_t vwidth, Double_t emass);
-    Double_t RhoShapeFromNA60(Float_t mass, Double_t vmass, Double_t vwidth, Double_t emass);
-    Double_t Lorentz(Float_t mass, Double_t vmass, Double_t vwidth); 
+    // Piecewise linear line shape on a variable grid, read-only after Init
+    struct MassTable {
+        std::vector<Double_t> fX;    // nodes
+        std::vector<Double_t> fF;    // normalised density at the nodes
+        std::vector<Double_t> fCdf;  // cumulative at the nodes
+        void     Build(const std::function<Double_t(Double_t)> &density, Double_t xmin, Double_t xmax,
+                       const std::vector<Double_t> &seeds, Int_t maxNodes, Double_t tolerance);
+        void     Finalise();
+        Bool_t   Empty() const {return fX.size() < 2;}
+        Double_t Max() const {return fX.back();}
+        Double_t Cdf(Double_t x) const;
+        Double_t Sample(Double_t r, Double_t xlo, Double_t xhi) const;
+    };
+    enum { kPion, kEta, kEtaDalitz, kEtaPrime, kEtaPrime_toOmega, kRho, kOmega, kOmegaDalitz,
+           kPhi, kPhiDalitz, kPhiDalitz_toPi0, kJPsi, kPsi2S, kUpsilon, kNTables };
+
+    Int_t    DecayDalitz(Int_t idpart, Int_t idpartner, const TLorentzVector &pparent,
+                         TRandom *ran, TLorentzVector *products, Int_t &idthird) const;
+    Int_t    DecayResonance(Int_t idpart, const TLorentzVector &pparent, TRandom *ran,
+                            TLorentzVector *products) const;
+    static Double_t SampleCosTheta(Double_t lambda, Double_t r);
+    void     SetChannel(Int_t table, Double_t mass, Double_t width, Double_t third);
+    Double_t PairMassDensity(Int_t table, Double_t mLL);
+    static Double_t KrollWada(Double_t mLL, Double_t pmass, Double_t omass, Double_t emass);
+    std::vector<Double_t> TableKey() const;
+    Bool_t   WriteTables(const char *fileName) const;
+    Bool_t   ReadTables(const char *fileName);
+    static const char kTableMagic[9];
+    static const UInt_t kTableVersion = 1;
+
+    MassTable fTables[kNTables];   //! pair-mass tables
+    Double_t  fParentMass[kNTables];  //! parent mass of the channel
+    Double_t  fParentWidth[kNTables]; //! parent width (resonances)
+    Double_t  fThirdMass[kNTables];   //! mass of the third child (Dalitz)
+    Double_t  fMassMin[kNTables];     //! lower limit of the pair mass
+    Double_t  fMassMax[kNTables];     //! upper limit of the pair mass
+    Int_t     fTableNodes;         //  maximum number of nodes per table
+    Double_t  fTableTolerance;     //  relative error of the tables
+    TString   fTableCache;         //  file caching the tables
+    Double_t  fMassLepton;         //! lepton mass
+    Double_t  fMassPion;           //! pi0 mass
+    Double_t  fMassEta;            //! eta mass
+    Double_t  fMassOmega;          //! omega mass
+    Double_t  fMassProton;         //! proton mass
+    ExodusTrack fLast[kMaxTracks]; //! output of the last call to Decay(Int_t, TLorentzVector*)
+    Int_t     fNLast;              //! number of entries in fLast
+
+    Double_t GounarisSakurai(Double_t mass, Double_t vmass, Double_t vwidth, Double_t emass);
+    Double_t RhoShapeFromNA60(Double_t mass, Double_t vmass, Double_t vwidth, Double_t emass);
+    Double_t Lorentz(Double_t mass, Double_t vmass, Double_t vwidth); 
     Bool_t fDecayToDimuon;    // Decay to dimuons instead of dielectrons
 
-    ClassDef(ExodusDecayer, 1)
+    ClassDef(ExodusDecayer, 3)
 };
 #endif
@@ -30,6 +30,9 @@
 
 #include "GeneratorParam.h"
 #include "GeneratorParamLibBase.h"
+#include "GeneratorParamPtYSampler.h"
+#include "GeneratorParamVirtualGammaSampler.h"
+#include "PythiaDecayBuffer.h"
 
 ClassImp(GeneratorParam)
     //____________________________________________________________
@@ -49,6 +52,7 @@ GeneratorParam::GeneratorParam(Int_t npart,
   fYParaFunc = Library->GetY(param, tname);
   fIpParaFunc = Library->GetIp(param, tname);
   fV2ParaFunc = Library->GetV2(param, tname);
+  fPtYDistribution = Library->GetPtY(param, tname);
 }
 
 //____________________________________________________________
@@ -107,6 +111,9 @@ GeneratorParam::~GeneratorParam() {
   delete fYPara;
   delete fV2Para;
   delete fdNdPhi;
+  delete fPtYSampler;
+  delete fVirtualGammaSampler;
+  delete fDecayBuffer;
 }
 
 //____________________________________________________________
@@ -181,12 +188,62 @@ void GeneratorParam::Init() {
   }
   fParentWeight = fYWgt*fPtWgt*phiWgt/fNpart;
   //
+  // Joint pt-y sampling
+  delete fPtYSampler;
+  fPtYSampler = 0;
+  if (fJointPtY) {
+    if (!fPtYDistribution) {
+      Fatal("Init", "Joint pt-y sampling requested but no pt-y distribution available \n");
+    }
+    if (fAnalog != kAnalog) {
+      Fatal("Init", "Joint pt-y sampling requires analog weighting \n");
+    }
+    fPtYSampler = new GeneratorParamPtYSampler();
+    if (!fPtYSampler->Build(fPtYDistribution, fPtMin, fPtMax, fYMin, fYMax)) {
+      Fatal("Init", "Could not build pt-y sampling table \n");
+    }
+    if (fPtYSampler->GetdNdy0() <= 0) {
+      Fatal("Init", "pt-y distribution has no yield at y=0 \n");
+    }
+    // yield inside the window relative to dN/dy at y=0
+    fParentWeight = fPtYSampler->GetIntegral()/fPtYSampler->GetdNdy0()*phiWgt/fNpart;
+  }
+  //
+  // Joint pt-mass sampling of virtual photons
+  delete fVirtualGammaSampler;
+  fVirtualGammaSampler = 0;
+  if (fJointVirtualGamma) {
+    if (fAnalog != kAnalog) {
+      Fatal("Init", "Joint pt-mass sampling requires analog weighting \n");
+    }
+    if (fPtYSampler) {
+      Fatal("Init", "Joint pt-mass and joint pt-y sampling cannot be combined \n");
+    }
+    fVirtualGammaSampler = new GeneratorParamVirtualGammaSampler();
+    if (!fVirtualGammaSampler->Build(fPtParaFunc, fPtMin, fPtMax, TMath::Max(npx, 1))) {
+      Fatal("Init", "Could not build pt-mass sampling table \n");
+    }
+  }
+  //
   //
   // Initialize the decayer
   fDecayer->SetForceDecay(fForceDecay);
   fDecayer->Init();
+  // products of PythiaDecayerConfig are read without intermediate particles
+  fBatchDecayer = dynamic_cast<PythiaDecayerConfig *>(fDecayer);
+  if (!fDecayBuffer)
+    fDecayBuffer = new PythiaDecayBuffer();
   // initialise selection of decay products
   InitChildSelect();
+  if (fPruneDecays) {
+    if (!fBatchDecayer) {
+      Fatal("Init", "Decay pruning requires PythiaDecayerConfig \n");
+    }
+    if (!fSelectAll) {
+      Int_t npruned = fBatchDecayer->PruneDecays(fChildSelect.GetArray(), fChildSelect.GetSize());
+      printf("GeneratorParam: %d species not leading to selected children left undecayed\n", npruned);
+    }
+  }
 }
 
 void GeneratorParam::GenerateEvent() {
@@ -270,10 +327,24 @@ void GeneratorParam::GenerateEvent() {
 
       //
       // y
-      ty = TMath::TanH(fYPara->GetRandom());
+      if (!fPtYSampler)
+        ty = TMath::TanH(fYPara->GetRandom());
       //
       // pT
-      if (fAnalog == kAnalog) {
+      fVirtualGammaMass = -1.;
+      if (fVirtualGammaSampler && iTemp == 220001) {
+        // pT and pair mass drawn jointly
+        fVirtualGammaSampler->Sample(gRandom, pt, fVirtualGammaMass);
+        wgtp = fParentWeight;
+        wgtch = fChildWeight;
+      } else if (fPtYSampler) {
+        // pT and y drawn jointly
+        Double_t yJoint;
+        fPtYSampler->Sample(gRandom, pt, yJoint);
+        ty = TMath::TanH(yJoint);
+        wgtp = fParentWeight;
+        wgtch = fChildWeight;
+      } else if (fAnalog == kAnalog) {
         pt = fPtPara->GetRandom();
         wgtp = fParentWeight;
         wgtch = fChildWeight;
@@ -330,18 +401,28 @@ void GeneratorParam::GenerateEvent() {
       if (fForceDecay != kNoDecay) {
         // Using lujet to decay particle
         TLorentzVector pmom(p[0], p[1], p[2], energy);
-        fDecayer->Decay(pdg, &pmom);
+        fDecayBuffer->Clear();
+        if (fBatchDecayer && !fForceConv && !(iTemp >= 220000 && iTemp <= 220001)) {
+          // products read directly from the decay record
+          fBatchDecayer->DecayBatch(1, &pdg, &pmom, *fDecayBuffer);
+        } else {
+          fDecayer->Decay(pdg, &pmom);
+          Int_t nimp = fDecayer->ImportParticles(particles);
+          if (iTemp >= 220000 & iTemp <= 220001) {
+            TParticle *gamma = (TParticle *)particles->At(0);
+            gamma->SetPdgCode(iTemp);
+            nimp = VirtualGammaPairProduction(particles, nimp);
+          }
+          if (fForceConv)
+            nimp = ForceGammaConversion(particles, nimp);
+          fDecayBuffer->AddParticles(particles, nimp, fIncFortran);
+          particles->Clear();
+        }
+        pdg = iTemp;
         //
         // select decay particles
-        Int_t np = fDecayer->ImportParticles(particles);
-        pdg = iTemp;
-        if (pdg >= 220000 & pdg <= 220001) {
-          TParticle *gamma = (TParticle *)particles->At(0);
-          gamma->SetPdgCode(pdg);
-          np = VirtualGammaPairProduction(particles, np);
-        }
-        if (fForceConv)
-          np = ForceGammaConversion(particles, np);
+        const PythiaDecayBuffer &products = *fDecayBuffer;
+        Int_t np = products.GetN();
 
         auto ncsel = 0;
         vFlags.reserve(np);
@@ -352,18 +433,18 @@ void GeneratorParam::GenerateEvent() {
 
         if (np > 1) {
           decayed = kTRUE;
-          TParticle *iparticle = 0;
           Int_t ipF, ipL;
+          // children are cut through the virtual KinematicSelection
+          TParticle child;
           for (i = 1; i < np; i++) {
 
-            iparticle = (TParticle *)particles->At(i);
-            Int_t kf = iparticle->GetPdgCode();
-            Int_t ks = iparticle->GetStatusCode();
+            Int_t kf = products.fPdg[i];
+            Int_t ks = products.fStatus[i];
             // flagged particle
             if (!fPreserveFullDecayChain) {
               if (vFlags[i]) {
-                ipF = iparticle->GetFirstDaughter() + fIncFortran;
-                ipL = iparticle->GetLastDaughter() + fIncFortran;
+                ipF = products.fFirstDaughter[i];
+                ipL = products.fLastDaughter[i];
                 if (ipF > 0)
                   for (j = ipF; j <= ipL; j++)
                     vFlags[j] = true;
@@ -375,8 +456,8 @@ void GeneratorParam::GenerateEvent() {
             if (ks != 1) {
               Double_t lifeTime = fDecayer->GetLifetime(kf);
               if (lifeTime > (Double_t)fMaxLifeTime) {
-                ipF = iparticle->GetFirstDaughter() + fIncFortran;
-                ipL = iparticle->GetLastDaughter() + fIncFortran;
+                ipF = products.fFirstDaughter[i];
+                ipL = products.fLastDaughter[i];
                 if (ipF > 0) {
                   for (j = ipF; j <= ipL; j++)
                     vFlags[j] = 1;
@@ -393,10 +474,11 @@ void GeneratorParam::GenerateEvent() {
                  fSelectAll)) {
 
               if (fCutOnChild) {
-                pc[0] = iparticle->Px();
-                pc[1] = iparticle->Py();
-                pc[2] = iparticle->Pz();
-                Bool_t childok = KinematicSelection(iparticle, 1);
+                child.SetPdgCode(kf);
+                child.SetStatusCode(ks);
+                child.SetMomentum(products.fPx[i], products.fPy[i], products.fPz[i], products.fE[i]);
+                child.SetProductionVertex(products.fVx[i], products.fVy[i], products.fVz[i], products.fT[i]);
+                Bool_t childok = KinematicSelection(&child, 1);
                 if (childok) {
                   vSelected[i] = true;
                   ncsel++;
@@ -440,18 +522,17 @@ void GeneratorParam::GenerateEvent() {
           //
           for (i = 1; i < np; i++) {
             if (vSelected[i]) {
-              TParticle *iparticle = (TParticle *)particles->At(i);
-              auto kf = iparticle->GetPdgCode();
-              auto ksc = iparticle->GetStatusCode();
-              auto jpa = iparticle->GetFirstMother() + fIncFortran;
-        Double_t weight = iparticle->GetWeight();
-              och[0] = origin0[0] + iparticle->Vx();
-              och[1] = origin0[1] + iparticle->Vy();
-              och[2] = origin0[2] + iparticle->Vz();
-              pc[0] = iparticle->Px();
-              pc[1] = iparticle->Py();
-              pc[2] = iparticle->Pz();
-              Double_t ec = iparticle->Energy();
+              auto kf = products.fPdg[i];
+              auto ksc = products.fStatus[i];
+              auto jpa = products.fMother[i];
+              Double_t weight = products.fWeight[i];
+              och[0] = origin0[0] + products.fVx[i];
+              och[1] = origin0[1] + products.fVy[i];
+              och[2] = origin0[2] + products.fVz[i];
+              pc[0] = products.fPx[i];
+              pc[1] = products.fPy[i];
+              pc[2] = products.fPz[i];
+              Double_t ec = products.fE[i];
 
               if (jpa > -1) {
                 iparent = vParent[jpa];
@@ -465,7 +546,7 @@ void GeneratorParam::GenerateEvent() {
               parentP->SetLastDaughter(nt);
               auto particle = new TParticle(kf, ksc, iparent, -1, -1, -1, pc[0],
                                             pc[1], pc[2], ec, och0[0], och0[1],
-                                            och0[2], time0 + iparticle->T());
+                                            och0[2], time0 + products.fT[i]);
               particle->SetWeight(weight * wgtch);
               fParticles->Add(particle);
 
@@ -475,7 +556,6 @@ void GeneratorParam::GenerateEvent() {
             } // Selected
           }   // Particle loop
         }     // Decays by Lujet
-        particles->Clear();
         vFlags.clear();
         vParent.clear();
         vSelected.clear();
@@ -589,15 +669,22 @@ void GeneratorParam::InitChildSelect() {
 
 Bool_t GeneratorParam::KinematicSelection(const TParticle *particle,
                                           Int_t flag) const {
-  // Perform kinematic selection
-  Double_t pz = particle->Pz();
-  Double_t pt = particle->Pt();
-  Double_t p = particle->P();
-  Double_t theta = particle->Theta();
-  Double_t mass = particle->GetCalcMass();
+  return KinematicSelection(particle->Px(), particle->Py(), particle->Pz(),
+                            particle->Energy(), flag);
+}
+
+//____________________________________________________________
+Bool_t GeneratorParam::KinematicSelection(Double_t px, Double_t py,
+                                          Double_t pz, Double_t e,
+                                          Int_t flag) const {
+  // Perform kinematic selection, angles as defined by TParticle
+  Double_t pt = TMath::Sqrt(px * px + py * py);
+  Double_t p = TMath::Sqrt(pt * pt + pz * pz);
+  Double_t theta = (pz == 0.) ? TMath::PiOver2() : TMath::ACos(pz / p);
+  Double_t m2 = e * e - p * p;
+  Double_t mass = (m2 >= 0.) ? TMath::Sqrt(m2) : -TMath::Sqrt(-m2);
   Double_t mt2 = pt * pt + mass * mass;
-  Double_t phi = particle->Phi();
-  Double_t e = particle->Energy();
+  Double_t phi = TMath::Pi() + TMath::ATan2(-py, -px);
 
   if (e == 0.)
     e = TMath::Sqrt(p * p + mass * mass);
@@ -907,7 +994,7 @@ Int_t GeneratorParam::VirtualGammaPairProduction(TClonesArray *particles,
       continue;
     if (gamma->Pt() < 0.002941)
       continue; // approximation of kw in AliGenEMlib is 0 below 0.002941
-    double mass = RandomMass(gamma->Pt());
+    double mass = (fVirtualGammaMass > 0.) ? fVirtualGammaMass : RandomMass(gamma->Pt());
 
     // lepton pair kinematics in virtual photon rest frame
     double Ee = mass / 2;
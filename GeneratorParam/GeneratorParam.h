@@ -25,6 +25,10 @@
 #include <TVirtualMCDecayer.h>
 #include <map>
 class TF1;
+class TH2;
+class GeneratorParamPtYSampler;
+class GeneratorParamVirtualGammaSampler;
+class PythiaDecayBuffer;
 typedef enum { kNoSmear, kPerEvent, kPerTrack } VertexSmear_t;
 typedef enum { kAnalog, kNonAnalog } Weighting_t;
 
@@ -54,6 +58,10 @@ public:
   virtual void SetParam(Int_t param) { fParam = param; }
   // Setting the flag for Background transportation while using SetForceDecay()
   void SetSelectAll(Bool_t selectall) { fSelectAll = selectall; }
+  // Leave species undecayed whose decays cannot lead to a selected child.
+  // The children are selected as without pruning; a pruned species is
+  // written as one undecayed particle instead of its decay products.
+  void SetPruneDecays(Bool_t prune = kTRUE) { fPruneDecays = prune; }
   virtual void SetMomentumRange(Float_t pmin = 0, Float_t pmax = 1.e10);
   virtual void SetPtRange(Float_t ptmin = 0, Float_t ptmax = 1.e10);
   virtual void SetPhiRange(Float_t phimin = 0., Float_t phimax = 360.);
@@ -63,6 +71,9 @@ public:
   virtual Int_t NumberParticles() const { return fNpart; }
   virtual Bool_t KinematicSelection(const TParticle *particle,
                                     Int_t flag) const;
+  // Cuts of the virtual method on a four-momentum, without a TParticle
+  Bool_t KinematicSelection(Double_t px, Double_t py, Double_t pz, Double_t e,
+                            Int_t flag) const;
   // Kinematic cuts on decay products
   virtual void SetForceDecay(Decay_t decay = kAll) { fForceDecay = decay; }
   virtual void SetCutOnChild(Int_t flag = 0) { fCutOnChild = flag; }
@@ -108,6 +119,13 @@ public:
     // complete forced decay chain
 
   virtual void SetWeighting(Weighting_t flag = kAnalog) {fAnalog = flag;}
+  // Sample pt and y jointly from a two-dimensional density (analog weighting
+  // only). The density defaults to the one provided by the library.
+  virtual void SetJointPtYSampling(Bool_t flag = kTRUE) { fJointPtY = flag; }
+  virtual void SetPtYDistribution(const TH2 *dist) { fPtYDistribution = dist; }
+  // Sample pt and pair mass of virtual direct photons (pdg 220001) from one
+  // precomputed table (analog weighting only)
+  virtual void SetJointVirtualGammaSampling(Bool_t flag = kTRUE) { fJointVirtualGamma = flag; }
 
   virtual void Draw(const char *opt);
   TF1 *GetPt() { return fPtPara; }
@@ -134,6 +152,7 @@ public:
     fYParaFunc = Library->GetY(param, tname);
     fIpParaFunc = Library->GetIp(param, tname);
     fV2ParaFunc = Library->GetV2(param, tname);
+    fPtYDistribution = Library->GetPtY(param, tname);
   }
 
   // retrive particle type
@@ -161,6 +180,7 @@ protected:
                              // using SetForceDecay()
   TVirtualMCDecayer *fDecayer = 0; // ! Pointer to virtual decyer
   Bool_t fForceConv = false;       // force converson of gammas
+  Bool_t fPruneDecays = false;     // switch off decays irrelevant for fChildSelect
   Bool_t fKeepParent =
       false; //  Store parent even if it does not have childs within cuts
   Bool_t fKeepIfOneChildSelected = true; // Accept parent and child even if
@@ -205,6 +225,14 @@ protected:
   Float_t fPtWgt = 1.;
   Float_t fdNdy0 = 1.;
   Weighting_t fAnalog = kAnalog;
+  Bool_t fJointPtY = false; // sample pt and y from fPtYDistribution
+  const TH2 *fPtYDistribution = 0;          //! joint pt-y density (not owned)
+  GeneratorParamPtYSampler *fPtYSampler = 0; //! compiled pt-y sampling table
+  Bool_t fJointVirtualGamma = false; // sample pt and mass of virtual photons jointly
+  GeneratorParamVirtualGammaSampler *fVirtualGammaSampler = 0; //! compiled pt-mee table
+  Double_t fVirtualGammaMass = -1.; //! pair mass drawn with the current virtual photon
+  PythiaDecayerConfig *fBatchDecayer = 0; //! fDecayer if products can be read directly
+  PythiaDecayBuffer *fDecayBuffer = 0;    //! decay products of the current parent
   
   TArrayI fChildSelect; //! Decay products to be selected
   enum {
@@ -223,6 +251,6 @@ private:
   GeneratorParam(const GeneratorParam &Param);
   GeneratorParam &operator=(const GeneratorParam &rhs);
 
-  ClassDef(GeneratorParam, 2) // Generator using parameterised pt- and y-distribution
+  ClassDef(GeneratorParam, 5) // Generator using parameterised pt- and y-distribution
 };
 #endif
@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Walker alias table for O(1) sampling of discrete distributions
+//
+
+#include "GeneratorParamAliasTable.h"
+#include <TRandom.h>
+
+//____________________________________________________________
+Bool_t GeneratorParamAliasTable::Set(const std::vector<Double_t> &weights) {
+  // The table is built aside and only replaces the current one on success
+  Int_t n = weights.size();
+  std::vector<Double_t> w(n, 0.), prob(n, 1.);
+  std::vector<Int_t> alias(n);
+  Double_t total = 0.;
+  for (Int_t i = 0; i < n; i++) {
+    w[i] = (weights[i] > 0.) ? weights[i] : 0.;
+    total += w[i];
+    alias[i] = i;
+  }
+  if (n == 0 || total <= 0.) {
+    printf("GeneratorParamAliasTable: ERROR: No positive weight given\n");
+    return kFALSE;
+  }
+
+  // split columns into under- and overfull ones and pair them up
+  std::vector<Double_t> scaled(n);
+  std::vector<Int_t> small, large;
+  for (Int_t i = 0; i < n; i++) {
+    scaled[i] = w[i] * n / total;
+    if (scaled[i] < 1.)
+      small.push_back(i);
+    else
+      large.push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    Int_t s = small.back();
+    small.pop_back();
+    Int_t l = large.back();
+    prob[s] = scaled[s];
+    alias[s] = l;
+    scaled[l] -= 1. - scaled[s];
+    if (scaled[l] < 1.) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // remaining columns are full up to rounding
+  for (auto i : small)
+    prob[i] = 1.;
+  for (auto i : large)
+    prob[i] = 1.;
+
+  fN = n;
+  fTotal = total;
+  fWeights.swap(w);
+  fProb.swap(prob);
+  fAlias.swap(alias);
+  return kTRUE;
+}
+
+//____________________________________________________________
+Int_t GeneratorParamAliasTable::Sample(TRandom *ran) const {
+  return Sample(ran->Rndm());
+}
+
+//____________________________________________________________
+void GeneratorParamAliasTable::Sample(TRandom *ran, Int_t n,
+                                      Int_t *result) const {
+  // Draw n indices, the random numbers are generated in one go
+  std::vector<Double_t> u(n);
+  ran->RndmArray(n, u.data());
+  for (Int_t i = 0; i < n; i++)
+    result[i] = Sample(u[i]);
+}
@@ -0,0 +1,55 @@
+#ifndef GENERATORPARAMALIASTABLE_H
+#define GENERATORPARAMALIASTABLE_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Walker alias table: draws an index i in [0, n) with probability
+// w[i]/sum(w) using a single uniform random number per draw.
+
+#include <Rtypes.h>
+#include <vector>
+
+class TRandom;
+
+class GeneratorParamAliasTable {
+public:
+  GeneratorParamAliasTable() = default;
+  explicit GeneratorParamAliasTable(const std::vector<Double_t> &weights) {
+    Set(weights);
+  }
+
+  // Build the table, negative weights are treated as zero
+  Bool_t Set(const std::vector<Double_t> &weights);
+
+  // Index for a uniform random number u in [0,1)
+  Int_t Sample(Double_t u) const {
+    Double_t x = u * fN;
+    Int_t i = (Int_t)x;
+    if (i >= fN)
+      i = fN - 1;
+    return (x - i < fProb[i]) ? i : fAlias[i];
+  }
+  Int_t Sample(TRandom *ran) const;
+  void Sample(TRandom *ran, Int_t n, Int_t *result) const;
+
+  Int_t GetN() const { return fN; }
+  Double_t GetTotal() const { return fTotal; }
+  Double_t GetProbability(Int_t i) const {
+    return (fTotal > 0.) ? fWeights[i] / fTotal : 0.;
+  }
+
+private:
+  Int_t fN = 0;                   // number of entries
+  Double_t fTotal = 0.;           // sum of the weights
+  std::vector<Double_t> fWeights; // input weights
+  std::vector<Double_t> fProb;    // probability to keep the column
+  std::vector<Int_t> fAlias;      // alias of the column
+};
+#endif
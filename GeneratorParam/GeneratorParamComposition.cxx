@@ -0,0 +1,73 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Table driven particle species composition
+//
+
+#include "GeneratorParamComposition.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+
+//____________________________________________________________
+Bool_t GeneratorParamComposition::Set(
+    const std::vector<std::pair<Int_t, Double_t>> &table) {
+  // a rejected table leaves the current composition untouched
+  std::vector<Int_t> pdg;
+  std::vector<Double_t> fractions;
+  for (auto &entry : table) {
+    pdg.push_back(entry.first);
+    fractions.push_back(entry.second);
+  }
+  if (!fTable.Set(fractions))
+    return kFALSE;
+  fPdg.swap(pdg);
+  return kTRUE;
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamComposition::ReadFile(const char *fileName) {
+  std::ifstream file(fileName);
+  if (!file) {
+    printf("GeneratorParamComposition: ERROR: File %s not found\n", fileName);
+    return kFALSE;
+  }
+  std::vector<std::pair<Int_t, Double_t>> table;
+  std::string line;
+  while (std::getline(file, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    Int_t pdg;
+    Double_t fraction;
+    if (fields >> pdg >> fraction)
+      table.emplace_back(pdg, fraction);
+  }
+  if (table.empty()) {
+    printf("GeneratorParamComposition: ERROR: File %s contains no composition\n", fileName);
+    return kFALSE;
+  }
+  return Set(table);
+}
+
+//____________________________________________________________
+void GeneratorParamComposition::Sample(TRandom *ran, Int_t n,
+                                       Int_t *pdg) const {
+  // Draw n species, the random numbers are generated in one go
+  fTable.Sample(ran, n, pdg);
+  for (Int_t i = 0; i < n; i++)
+    pdg[i] = fPdg[pdg[i]];
+}
+
+//____________________________________________________________
+void GeneratorParamComposition::Print() const {
+  for (Int_t i = 0; i < GetN(); i++)
+    printf("GeneratorParamComposition: %10d %10.6f\n", fPdg[i], GetFraction(i));
+}
@@ -0,0 +1,48 @@
+#ifndef GENERATORPARAMCOMPOSITION_H
+#define GENERATORPARAMCOMPOSITION_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Particle species composition given as table of (PDG code, fraction).
+// Species are drawn in O(1) from a Walker alias table. Fractions need not
+// be normalised. A table can be read from a text file with one
+// "pdg fraction" pair per line; everything after '#' is a comment.
+
+#include "GeneratorParamAliasTable.h"
+#include <Rtypes.h>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+class TRandom;
+
+class GeneratorParamComposition {
+public:
+  GeneratorParamComposition() = default;
+  GeneratorParamComposition(std::initializer_list<std::pair<Int_t, Double_t>> table) {
+    Set(table);
+  }
+
+  Bool_t Set(const std::vector<std::pair<Int_t, Double_t>> &table);
+  Bool_t ReadFile(const char *fileName);
+
+  Int_t Sample(TRandom *ran) const { return fPdg[fTable.Sample(ran)]; }
+  void Sample(TRandom *ran, Int_t n, Int_t *pdg) const;
+
+  Int_t GetN() const { return fPdg.size(); }
+  Int_t GetPdg(Int_t i) const { return fPdg[i]; }
+  Double_t GetFraction(Int_t i) const { return fTable.GetProbability(i); }
+  void Print() const;
+
+private:
+  std::vector<Int_t> fPdg;        // PDG codes
+  GeneratorParamAliasTable fTable; // species selection
+};
+#endif
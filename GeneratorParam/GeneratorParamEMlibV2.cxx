@@ -19,9 +19,10 @@
 #include "TFile.h"
 #include "TFormula.h"
 #include "GeneratorParamEMlibV2.h"
+#include "GeneratorParamMtScaling.h"
 #include "TH1D.h"
 #include <TObjString.h>
-#include <nlohmann/json.hpp>
+#include "GeneratorParamEMlibV2Store.h"
 
 ClassImp(GeneratorParamEMlibV2)
 
@@ -1225,72 +1226,30 @@ TF1* GeneratorParamEMlibV2::MtScal(Int_t np, TString name, Bool_t isMeson)
   // function that calculates the pt distribution of a given particle np
   // by mt scaling the pi0 pt distribution for mesons and the proton pt
   // distribution for baryons
+  // The reference parametrization is evaluated directly by a
+  // GeneratorParamMtScaling functor, no new formula is compiled.
 
   Double_t xmin, xmax;
-  Int_t nPar;
-  TString formulaBaseScaled, scaledPt;
+  TF1*     base;
+  Double_t refMass;
 
   // value meson/pi0 (baryon/p) at 5 GeV/c
   Double_t NormPt       = 5.;
-  Double_t scaledNormPt, norm;
 
   if (!isMeson && fPtParametrizationProton) {
     // scale baryons from protons
-    fPtParametrizationProton->GetRange(xmin, xmax);
-    nPar                  = fPtParametrizationProton->GetNpar();
-    formulaBaseScaled     = fPtParametrizationProton->GetExpFormula();
-    scaledPt              = Form("(TMath::Sqrt(x*x + %.7f*%.7f - %.7f*%.7f))",fgkHM[np],fgkHM[np],0.9382720,0.9382720);
-    scaledNormPt          = TMath::Sqrt(NormPt*NormPt + fgkHM[np]*fgkHM[np] - 0.9382720*0.9382720);
-    norm                  = fMtFactorHisto->GetBinContent(np+1) * fPtParametrizationProton->Eval(NormPt) / fPtParametrizationProton->Eval(scaledNormPt);
+    base                  = fPtParametrizationProton;
+    refMass               = 0.9382720;
   } else {
     // scale mesons from pi0 (also baryons if proton is not provided)
-    fPtParametrization[0]->GetRange(xmin, xmax);
-    nPar                  = fPtParametrization[0]->GetNpar();
-    formulaBaseScaled     = fPtParametrization[0]->GetExpFormula();
-    scaledPt              = Form("(TMath::Sqrt(x*x + %.7f*%.7f - %.7f*%.7f))",fgkHM[np],fgkHM[np],fgkHM[0],fgkHM[0]);
-    scaledNormPt          = TMath::Sqrt(NormPt*NormPt + fgkHM[np]*fgkHM[np] - fgkHM[0]*fgkHM[0]);
-    norm                  = fMtFactorHisto->GetBinContent(np+1) * fPtParametrization[0]->Eval(NormPt) / fPtParametrization[0]->Eval(scaledNormPt);
+    base                  = fPtParametrization[0];
+    refMass               = fgkHM[0];
   }
-
-  TString formulaBaseScaledTemp = "";
-  TString sub1                  = "";
-  TString sub2                  = "";
-  TString sub3                  = "";
-  for (Int_t i=0; i<formulaBaseScaled.Length(); i++) {
-    if (i>0) sub1               = formulaBaseScaled(i-1, 1);
-    else sub1                   = "";
-    sub2                        = formulaBaseScaled(i, 1);
-    if (i<formulaBaseScaled.Length()-1)
-      sub3                      = formulaBaseScaled(i+1, 1);
-    else sub3                   = "";
-
-    if (sub2.CompareTo("x")!=0) {
-      formulaBaseScaledTemp += sub2;
-    } else if (sub2.CompareTo("x")==0) {
-      if (i==0) {
-        formulaBaseScaledTemp += scaledPt;
-      } else if (sub1.CompareTo("e")!=0 && sub3.CompareTo("p")!=0) {
-        formulaBaseScaledTemp += scaledPt;
-      } else {
-        formulaBaseScaledTemp += sub2;
-      }
-    } else {
-      formulaBaseScaledTemp += sub2;
-    }
-  }
-  formulaBaseScaled = formulaBaseScaledTemp;
+  base->GetRange(xmin, xmax);
+  Double_t norm = GeneratorParamMtScaling::Normalisation(base, fgkHM[np], refMass, fMtFactorHisto->GetBinContent(np+1), NormPt);
 
   printf("GeneratorParamEMlibV2: Create TF1 for %s from isMeson = %d with norm = %f\n",name.Data(),isMeson,norm);
-  TF1* result = new TF1(name.Data(), Form("%.10f * (x/%s) * (%s)", norm, scaledPt.Data(), formulaBaseScaled.Data()), xmin, xmax);
-  if (!isMeson && fPtParametrizationProton) {
-    for (Int_t i=0; i<nPar; i++) {
-      result->SetParameter(i, fPtParametrizationProton->GetParameter(i));
-    }
-  } else {
-    for (Int_t i=0; i<nPar; i++) {
-      result->SetParameter(i, fPtParametrization[0]->GetParameter(i));
-    }
-  }
+  TF1* result = new TF1(name.Data(), GeneratorParamMtScaling(base, fgkHM[np], refMass, norm), xmin, xmax, 0);
   printf("GeneratorParamEMlibV2: ...done\n");
   return result;
 }
@@ -1444,37 +1403,35 @@ Bool_t GeneratorParamEMlibV2::SetPtParametrizations(TString fileName, TString di
   }
   else{ // read the JSON file        
     // open parametrizations file
-    std::ifstream file(fileName.Data());
-    if (!file){
+    GeneratorParamEMlibV2Store* store = GeneratorParamEMlibV2Store::Open(fileName.Data());
+    if (!store){
       printf("GeneratorParamEMlibV2: ERROR: File %s not found\n",fileName.Data());
       return kFALSE;
     }
-    nlohmann::json paramfile = nlohmann::json::parse(file);
-    if (!paramfile.contains(dirName.Data())) {
+    std::string dir = dirName.Data();
+    if (!store->HasDirectory(dir)) {
       printf("GeneratorParamEMlibV2: ERROR: Directory %s not found\n",dirName.Data());
       return kFALSE;
     } 
-    nlohmann::json dir = paramfile[dirName.Data()];
 
 
     // check for pi0 parametrization
     printf("GeneratorParamEMlibV2: Get pi0 parametrization\n");
-    if (!dir.contains("111_pt")){
+    std::string name = "111_pt";
+    std::string formula;
+    if (!store->GetFormula(dir, name, formula)){
       printf("GeneratorParamEMlibV2: ERROR: File %s doesn't contain pi0 parametrization\n",fileName.Data());
       return kFALSE;
     }
-    std::string name = "111_pt";
-    std::string formula = dir[name];
     fPtParametrization[0] = new TF1(TString(name),TString(formula),0,300);
 
     // check for proton parametrization (base for baryon mt scaling)
     printf("GeneratorParamEMlibV2: Get proton parametrization\n");
-    if (!dir.contains("2212_pt")) {
+    name = "2212_pt";
+    if (!store->GetFormula(dir, name, formula)) {
       printf("GeneratorParamEMlibV2: WARNING: File %s does not contain parametrization, scaling baryons from pi0.\n",fileName.Data());
       fPtParametrizationProton = NULL;
     } else {
-      name = "2212_pt";
-      formula = dir[name];
       fPtParametrizationProton = new TF1(TString(name),TString(formula),0,300);
     }
 
@@ -1486,8 +1443,7 @@ Bool_t GeneratorParamEMlibV2::SetPtParametrizations(TString fileName, TString di
       Int_t ip = (Int_t)(lib.GetIp(i, ""))(rndm);
       printf("GeneratorParamEMlibV2: Get %d parametrization.\n",ip);
       name = Form("%d_pt", ip);
-      if (dir.contains(name)) {
-        formula = dir[name];
+      if (store->GetFormula(dir, name, formula)) {
         fPtParametrization[i] = new TF1(TString(name),TString(formula),0,300);
       } else {
         if (i==kSigma0 || i==kDeltaPlPl || i==kDeltaPl || i==kDeltaZero || i==kDeltaMi || i==kLambda || i==kOmegaPl || i==kOmegaMi || i==kXiPl || i==kXiMi || i==kSigmaPl || i==kSigmaMi)
@@ -1566,34 +1522,31 @@ Bool_t GeneratorParamEMlibV2::SetFlowParametrizations(TString fileName, TString
     return kTRUE;
   } 
   else{ // read the JSON file
-    std::ifstream file(fileName.Data());
-    if (!file){
+    GeneratorParamEMlibV2Store* store = GeneratorParamEMlibV2Store::Open(fileName.Data());
+    if (!store){
       printf("GeneratorParamEMlibV2: ERROR: File %s not found\n",fileName.Data());
       return kFALSE;
     }
-    nlohmann::json paramfile = nlohmann::json::parse(file);
-    if (!paramfile.contains(dirName.Data())) {
+    std::string dir = dirName.Data();
+    if (!store->HasDirectory(dir)) {
       printf("GeneratorParamEMlibV2: ERROR: Directory %s not found\n",dirName.Data());
       return kFALSE;
     } 
-    nlohmann::json dir = paramfile[dirName.Data()];
     
     // check for pi0 parametrization
-    if (!dir.contains("111_v2_def")){
+    std::string formula;
+    if (!store->GetFormula(dir, "111_v2_def", formula)){
       printf("GeneratorParamEMlibV2: ERROR: File %s, dir %s doesn't contain pi0 parametrization\n",fileName.Data(),dirName.Data());
       return kFALSE;
     }
-    std::string formula = dir["111_v2_def"];
     fV2Parametrization[0] = new TF1("111_v2_def",TString(formula),0.,200.); //todo: check range
       
 
     // check for kaon parametrization (base for eta/omega mt scaling)
-    TF1* fv2ParametrizationK = new TF1();
-    if (!dir.contains("310_v2_def")){
+    TF1* fv2ParametrizationK = NULL;
+    if (!store->GetFormula(dir, "310_v2_def", formula)){
       printf("GeneratorParamEMlibV2: WARNING: File %s, dir %s does not contain kaon parametrization, scaling v2 mesons from pi0.\n",fileName.Data(),dirName.Data());
-      fv2ParametrizationK = NULL;
     } else {
-      formula = dir["310_v2_def"];
       fv2ParametrizationK = new TF1("310_v2_def",TString(formula),0.,200.); //todo: check range
     }
 
@@ -1606,8 +1559,7 @@ Bool_t GeneratorParamEMlibV2::SetFlowParametrizations(TString fileName, TString
       Int_t ip = (Int_t)(lib.GetIp(i, ""))(rndm);
 
       std::string name = Form("%d_v2_def", ip);
-      if (dir.contains(name)){ //Parameterization stored in the file
-        formula = dir[name];
+      if (store->GetFormula(dir, name, formula)){ //Parameterization stored in the file
         fV2Parametrization[i] = new TF1(TString(name),TString(formula),0.,200.); //todo: check range
         fV2RefParameterization[i]=i; //same ref. particle
       } else if (fv2ParametrizationK){
@@ -1743,30 +1695,24 @@ void GeneratorParamEMlibV2::SetMtScalingFactors(TString fileName, TString dirNam
       fMtFactorHisto->SetBinContent(i+1, fgkMtFactor[selectedCol][i]); //first set all factors to hard coded value
     }
 
-    std::ifstream file(fileName.Data());
-    if (file){
-      nlohmann::json paramFile = nlohmann::json::parse(file);
-      if (paramFile.contains(dirName.Data())) {
-        nlohmann::json dir = paramFile[dirName.Data()];
-        if (dir.contains("histoMtScaleFactor")){
-          GeneratorParamEMlibV2 lib;
-          TRandom* rndm=NULL;
-          for (Int_t i=0; i<kNHadrons; i++) {
-            Int_t ip = (Int_t)(lib.GetIp(i, ""))(rndm);
-            Double_t factor = -999.;
-            nlohmann::json hist = dir["histoMtScaleFactor"];
-            for (auto& bin : hist.items()){
-              TString tempLabel = bin.key();
-              if (tempLabel.Atoi()==ip) {
-                factor = bin.value();
-                break;
-              }
-            }
-            if (factor>0){
-              fMtFactorHisto->SetBinContent(i+1, factor);
-            }
+    GeneratorParamEMlibV2Store* store = GeneratorParamEMlibV2Store::Open(fileName.Data());
+    std::vector<std::pair<std::string, Double_t>> hist;
+    if (store && store->GetMtFactors(dirName.Data(), "histoMtScaleFactor", hist)){
+      GeneratorParamEMlibV2 lib;
+      TRandom* rndm=NULL;
+      for (Int_t i=0; i<kNHadrons; i++) {
+        Int_t ip = (Int_t)(lib.GetIp(i, ""))(rndm);
+        Double_t factor = -999.;
+        for (auto& bin : hist){
+          TString tempLabel = bin.first;
+          if (tempLabel.Atoi()==ip) {
+            factor = bin.second;
+            break;
           }
         }
+        if (factor>0){
+          fMtFactorHisto->SetBinContent(i+1, factor);
+        }
       }
     }
   }
@@ -1825,35 +1771,31 @@ Bool_t GeneratorParamEMlibV2::SetPtYDistributions(TString fileName, TString dirN
     return kTRUE;
   }
   else{ // read the JSON file
-    std::ifstream file(fileName.Data());
-    if (!file){
+    GeneratorParamEMlibV2Store* store = GeneratorParamEMlibV2Store::Open(fileName.Data());
+    if (!store){
       printf("GeneratorParamEMlibV2: ERROR: File %s not found\n",fileName.Data());
       return kFALSE;
     }
-    nlohmann::json paramFile = nlohmann::json::parse(file);
-    if (!paramFile.contains(dirName.Data())) {
+    std::string dir = dirName.Data();
+    if (!store->HasDirectory(dir)) {
       printf("GeneratorParamEMlibV2: ERROR: Directory %s not found\n",dirName.Data());
       return kFALSE;
     }
-    nlohmann::json dir = paramFile[dirName.Data()];
     // check for pt-y parametrizations
     GeneratorParamEMlibV2 lib;
     TRandom* rndm=NULL;
+    std::vector<double> ptBins, yBins, weights;
     for (Int_t i=0; i<kNHadrons; i++) {
       Int_t ip = (Int_t)(lib.GetIp(i, ""))(rndm);
       std::string name = Form("%d_pt_y", ip);
-      if (dir.contains(name)) {
+      if (store->GetPtY(dir, name, ptBins, yBins, weights)) {
         printf("GeneratorParamEMlibV2: Reading PtYDistribution %d_pt_y from %s\n",ip,fileName.Data());
-        nlohmann::json histo = dir[name];
-        std::vector<double> ptBins = histo["ptBins"];
-        std::vector<double> yBins = histo["yBins"];
         int nPtBins = ptBins.size()-1;
         int nYBins = yBins.size()-1;
         fPtYDistribution[i] = new TH2F(Form("%d_pt_y", ip),Form("%d_pt_y", ip),nPtBins,&ptBins[0],nYBins,&yBins[0]);
-        std::vector<std::vector<double>> weights = histo["weights"];
         for (int ptBin=1;ptBin<nPtBins+1;ptBin++){
           for (int yBin=1;yBin<nYBins+1;yBin++){
-            fPtYDistribution[i]->SetBinContent(ptBin,yBin,weights[ptBin-1][yBin-1]);
+            fPtYDistribution[i]->SetBinContent(ptBin,yBin,weights[(ptBin-1)*nYBins+yBin-1]);
           }
         }
       } else {
@@ -1867,6 +1809,16 @@ Bool_t GeneratorParamEMlibV2::SetPtYDistributions(TString fileName, TString dirN
 }
 
 
+//--------------------------------------------------------------------------
+//
+//                 binary cache of JSON parametrization files
+//
+//--------------------------------------------------------------------------
+void GeneratorParamEMlibV2::SetUseBinaryCache(Bool_t flag) {
+  GeneratorParamEMlibV2Store::SetUseBinaryCache(flag);
+}
+
+
 //--------------------------------------------------------------------------
 //
 //                     return pt-y distribution
@@ -2303,3 +2255,11 @@ GenFunc GeneratorParamEMlibV2::GetV2(Int_t param, const char * tname) const
   }
   return func;
 }
+
+const TH2* GeneratorParamEMlibV2::GetPtY(Int_t param, const char * /*tname*/) const
+{
+  // Return pointer to the pt-y distribution, if read from file
+  if (param>=0 && param<kNHadrons)
+    return fPtYDistribution[param];
+  return 0;
+}
@@ -47,6 +47,7 @@ public:
   GenFunc   GetY(Int_t param, const char * tname=0) const;
   GenFuncIp GetIp(Int_t param, const char * tname=0) const;
   GenFunc   GetV2(Int_t param, const char * tname=0) const;
+  const TH2* GetPtY(Int_t param, const char * tname=0) const;
   
   // General functions
   static Bool_t SetPtParametrizations(TString fileName, TString dirName);
@@ -56,6 +57,8 @@ public:
   static TF1*   GetPtParametrization(Int_t np);
   static TH1D*  GetMtScalingFactors();
   static TH2F*  GetPtYDistribution(Int_t np);
+  // parse each JSON parametrisation file once and keep a binary sidecar <file>.bin
+  static void   SetUseBinaryCache(Bool_t flag = kTRUE);
 
   static Int_t fgSelectedCollisionsSystem;                                                      // selected pT parameter
   static Int_t fgSelectedCentrality;                                                            // selected Centrality
@@ -0,0 +1,416 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Single-parse store for GeneratorParamEMlibV2 JSON parametrisation files
+//
+// Layout of the binary sidecar (all numbers in native byte order):
+//   header : char[8] magic, UInt_t version, UInt_t nEntries,
+//            ULong64_t source size, Long64_t source mtime,
+//            ULong64_t index size, UInt_t index checksum, UInt_t 0
+//   index  : per entry UInt_t dir length, key length, type, checksum,
+//            ULong64_t payload offset, payload size, then dir and key
+//   payload: kFormula  : characters
+//            kMtFactors: UInt_t n, n x (UInt_t length, label, Double_t)
+//            kPtY      : UInt_t nPt, nY, Double_t ptBins[nPt+1],
+//                        yBins[nY+1], weights[nPt*nY]
+//
+
+#include "GeneratorParamEMlibV2Store.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+Bool_t GeneratorParamEMlibV2Store::fgUseBinaryCache = kFALSE;
+std::map<std::string, std::unique_ptr<GeneratorParamEMlibV2Store>> GeneratorParamEMlibV2Store::fgStores;
+
+namespace {
+const char kMagic[8] = {'E', 'M', 'L', 'I', 'B', 'V', '2', 'B'};
+
+struct Header {
+  char fMagic[8];
+  UInt_t fVersion;
+  UInt_t fNEntries;
+  ULong64_t fSourceSize;
+  Long64_t fSourceTime;
+  ULong64_t fIndexSize;
+  UInt_t fIndexChecksum;
+  UInt_t fReserved;
+};
+
+template <typename T> void Append(std::string &buffer, const T &value) {
+  buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Append the elements of array to values, kFALSE if it is not an array of
+// numbers
+Bool_t ReadNumbers(const nlohmann::json &array, std::vector<Double_t> &values) {
+  if (!array.is_array())
+    return kFALSE;
+  for (auto &x : array) {
+    if (!x.is_number())
+      return kFALSE;
+    values.push_back(x.get<Double_t>());
+  }
+  return kTRUE;
+}
+
+template <typename T> T Take(const char *&data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return value;
+}
+} // namespace
+
+//____________________________________________________________
+GeneratorParamEMlibV2Store::~GeneratorParamEMlibV2Store() {
+  if (fMapped)
+    munmap(fMapped, fMappedSize);
+}
+
+//____________________________________________________________
+GeneratorParamEMlibV2Store *GeneratorParamEMlibV2Store::Open(const char *fileName) {
+  auto iter = fgStores.find(fileName);
+  if (iter != fgStores.end())
+    return iter->second.get();
+
+  struct stat info;
+  if (stat(fileName, &info) != 0)
+    return nullptr;
+
+  std::unique_ptr<GeneratorParamEMlibV2Store> store(new GeneratorParamEMlibV2Store());
+  store->fSourceSize = info.st_size;
+  store->fSourceTime = info.st_mtime;
+  std::string cacheName = BinaryCacheName(fileName);
+  if (fgUseBinaryCache &&
+      store->MapBinary(cacheName.c_str(), store->fSourceSize, store->fSourceTime)) {
+    printf("GeneratorParamEMlibV2Store: Using binary cache %s\n", cacheName.c_str());
+  } else {
+    if (!store->ReadJSON(fileName))
+      return nullptr;
+    if (fgUseBinaryCache && !store->WriteBinary(cacheName.c_str()))
+      printf("GeneratorParamEMlibV2Store: WARNING: Could not write binary cache %s\n", cacheName.c_str());
+  }
+  auto result = store.get();
+  fgStores[fileName] = std::move(store);
+  return result;
+}
+
+//____________________________________________________________
+void GeneratorParamEMlibV2Store::Clear() { fgStores.clear(); }
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::ReadJSON(const char *fileName) {
+  // Parse the whole document once and keep only the compact entries
+  std::ifstream file(fileName);
+  if (!file)
+    return kFALSE;
+  nlohmann::json paramFile = nlohmann::json::parse(file, nullptr, false);
+  if (paramFile.is_discarded() || !paramFile.is_object()) {
+    printf("GeneratorParamEMlibV2Store: ERROR: Could not parse %s\n", fileName);
+    return kFALSE;
+  }
+  for (auto &dir : paramFile.items()) {
+    if (!dir.value().is_object())
+      continue;
+    auto &entries = fIndex[dir.key()];
+    for (auto &item : dir.value().items()) {
+      const nlohmann::json &value = item.value();
+      Entry entry;
+      if (value.is_string()) {
+        entry.fType = kFormula;
+        entry.fFormula = value.get<std::string>();
+      } else if (value.is_object() && value.contains("ptBins")) {
+        entry.fType = kPtY;
+        // weights hold one row of y bins per pt bin
+        Bool_t ok = value.contains("yBins") && value.contains("weights") &&
+                    ReadNumbers(value["ptBins"], entry.fPtBins) &&
+                    ReadNumbers(value["yBins"], entry.fYBins) && value["weights"].is_array();
+        if (ok)
+          for (auto &row : value["weights"])
+            ok = ok && row.size() == entry.fYBins.size() - 1 && ReadNumbers(row, entry.fWeights);
+        // at least one bin on each axis and one weight per bin
+        if (!ok || entry.fPtBins.size() < 2 || entry.fYBins.size() < 2 ||
+            entry.fWeights.size() != (entry.fPtBins.size() - 1) * (entry.fYBins.size() - 1)) {
+          printf("GeneratorParamEMlibV2Store: ERROR: Invalid pt-y table %s/%s in %s\n",
+                 dir.key().c_str(), item.key().c_str(), fileName);
+          return kFALSE;
+        }
+      } else if (value.is_object()) {
+        entry.fType = kMtFactors;
+        for (auto &bin : value.items()) {
+          if (bin.value().is_number())
+            entry.fFactors.emplace_back(bin.key(), bin.value().get<Double_t>());
+        }
+      } else {
+        continue;
+      }
+      entries[item.key()] = std::move(entry);
+    }
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::MapBinary(const char *fileName,
+                                              ULong64_t sourceSize,
+                                              Long64_t sourceTime) {
+  // Map the sidecar and read its index; payloads are decoded on request
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0)
+    return kFALSE;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (ULong64_t)info.st_size < sizeof(Header)) {
+    close(fd);
+    return kFALSE;
+  }
+  void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    return kFALSE;
+  fMapped = mapped;
+  fMappedSize = info.st_size;
+
+  const char *begin = static_cast<const char *>(mapped);
+  Header header;
+  memcpy(&header, begin, sizeof(Header));
+  Bool_t valid = memcmp(header.fMagic, kMagic, sizeof(kMagic)) == 0 &&
+                 header.fVersion == fgkVersion &&
+                 header.fSourceSize == sourceSize &&
+                 header.fSourceTime == sourceTime &&
+                 sizeof(Header) + header.fIndexSize <= fMappedSize &&
+                 Checksum(begin + sizeof(Header), header.fIndexSize) == header.fIndexChecksum;
+  const char *data = begin + sizeof(Header);
+  for (UInt_t i = 0; valid && i < header.fNEntries; i++) {
+    UInt_t dirLength = Take<UInt_t>(data);
+    UInt_t keyLength = Take<UInt_t>(data);
+    Entry entry;
+    entry.fType = Take<UInt_t>(data);
+    entry.fChecksum = Take<UInt_t>(data);
+    ULong64_t offset = Take<ULong64_t>(data);
+    entry.fSize = Take<ULong64_t>(data);
+    if (offset + entry.fSize > fMappedSize) {
+      valid = kFALSE;
+      break;
+    }
+    entry.fData = begin + offset;
+    std::string dir(data, dirLength);
+    data += dirLength;
+    std::string key(data, keyLength);
+    data += keyLength;
+    fIndex[dir][key] = entry;
+  }
+  if (!valid) {
+    printf("GeneratorParamEMlibV2Store: WARNING: Binary cache %s is outdated or corrupt, ignoring it\n", fileName);
+    fIndex.clear();
+    munmap(fMapped, fMappedSize);
+    fMapped = nullptr;
+    fMappedSize = 0;
+  }
+  return valid;
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::WriteBinary(const char *fileName) const {
+  std::string index, payload;
+  UInt_t nEntries = 0;
+  ULong64_t indexSize = 0;
+  std::vector<std::string> encoded;
+  for (auto &dir : fIndex) {
+    for (auto &item : dir.second) {
+      encoded.push_back(Encode(item.second));
+      indexSize += 4 * sizeof(UInt_t) + 2 * sizeof(ULong64_t) + dir.first.size() + item.first.size();
+      nEntries++;
+    }
+  }
+  // payloads follow the index
+  ULong64_t offset = sizeof(Header) + indexSize;
+  UInt_t iEntry = 0;
+  for (auto &dir : fIndex) {
+    for (auto &item : dir.second) {
+      const std::string &data = encoded[iEntry++];
+      Append<UInt_t>(index, dir.first.size());
+      Append<UInt_t>(index, item.first.size());
+      Append<UInt_t>(index, item.second.fType);
+      Append<UInt_t>(index, Checksum(data.data(), data.size()));
+      Append<ULong64_t>(index, offset);
+      Append<ULong64_t>(index, data.size());
+      index += dir.first;
+      index += item.first;
+      offset += data.size();
+      payload += data;
+    }
+  }
+
+  Header header;
+  memcpy(header.fMagic, kMagic, sizeof(kMagic));
+  header.fVersion = fgkVersion;
+  header.fNEntries = nEntries;
+  header.fSourceSize = fSourceSize;
+  header.fSourceTime = fSourceTime;
+  header.fIndexSize = index.size();
+  header.fIndexChecksum = Checksum(index.data(), index.size());
+  header.fReserved = 0;
+
+  // write to a temporary file first so that concurrent jobs never see a partial cache
+  std::string tmpName = std::string(fileName) + "." + std::to_string(getpid());
+  std::ofstream file(tmpName, std::ios::binary);
+  if (!file)
+    return kFALSE;
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  file.write(index.data(), index.size());
+  file.write(payload.data(), payload.size());
+  file.close();
+  if (!file || rename(tmpName.c_str(), fileName) != 0) {
+    unlink(tmpName.c_str());
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+std::string GeneratorParamEMlibV2Store::Encode(const Entry &entry) {
+  std::string data;
+  switch (entry.fType) {
+  case kFormula:
+    data = entry.fFormula;
+    break;
+  case kMtFactors:
+    Append<UInt_t>(data, entry.fFactors.size());
+    for (auto &factor : entry.fFactors) {
+      Append<UInt_t>(data, factor.first.size());
+      data += factor.first;
+      Append<Double_t>(data, factor.second);
+    }
+    break;
+  case kPtY:
+    Append<UInt_t>(data, entry.fPtBins.size() - 1);
+    Append<UInt_t>(data, entry.fYBins.size() - 1);
+    data.append(reinterpret_cast<const char *>(entry.fPtBins.data()), entry.fPtBins.size() * sizeof(Double_t));
+    data.append(reinterpret_cast<const char *>(entry.fYBins.data()), entry.fYBins.size() * sizeof(Double_t));
+    data.append(reinterpret_cast<const char *>(entry.fWeights.data()), entry.fWeights.size() * sizeof(Double_t));
+    break;
+  }
+  return data;
+}
+
+//____________________________________________________________
+UInt_t GeneratorParamEMlibV2Store::Checksum(const char *data, ULong64_t size) {
+  // 32 bit FNV-1a
+  UInt_t hash = 2166136261u;
+  for (ULong64_t i = 0; i < size; i++) {
+    hash ^= (unsigned char)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+//____________________________________________________________
+const GeneratorParamEMlibV2Store::Entry *
+GeneratorParamEMlibV2Store::Find(const std::string &dir, const std::string &key,
+                                  Int_t type) const {
+  auto iterDir = fIndex.find(dir);
+  if (iterDir == fIndex.end())
+    return nullptr;
+  auto iter = iterDir->second.find(key);
+  if (iter == iterDir->second.end() || iter->second.fType != type)
+    return nullptr;
+  const Entry *entry = &iter->second;
+  if (entry->fData && Checksum(entry->fData, entry->fSize) != entry->fChecksum) {
+    printf("GeneratorParamEMlibV2Store: ERROR: Checksum mismatch for %s/%s\n", dir.c_str(), key.c_str());
+    return nullptr;
+  }
+  return entry;
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::HasDirectory(const std::string &dir) const {
+  return fIndex.find(dir) != fIndex.end();
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::Contains(const std::string &dir,
+                                            const std::string &key) const {
+  auto iterDir = fIndex.find(dir);
+  return iterDir != fIndex.end() && iterDir->second.count(key);
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::GetFormula(const std::string &dir,
+                                              const std::string &key,
+                                              std::string &formula) const {
+  const Entry *entry = Find(dir, key, kFormula);
+  if (!entry)
+    return kFALSE;
+  if (entry->fData)
+    formula.assign(entry->fData, entry->fSize);
+  else
+    formula = entry->fFormula;
+  return kTRUE;
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::GetMtFactors(
+    const std::string &dir, const std::string &key,
+    std::vector<std::pair<std::string, Double_t>> &factors) const {
+  const Entry *entry = Find(dir, key, kMtFactors);
+  if (!entry)
+    return kFALSE;
+  if (!entry->fData) {
+    factors = entry->fFactors;
+    return kTRUE;
+  }
+  const char *data = entry->fData;
+  UInt_t n = Take<UInt_t>(data);
+  factors.clear();
+  factors.reserve(n);
+  for (UInt_t i = 0; i < n; i++) {
+    UInt_t length = Take<UInt_t>(data);
+    std::string label(data, length);
+    data += length;
+    factors.emplace_back(label, Take<Double_t>(data));
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamEMlibV2Store::GetPtY(const std::string &dir,
+                                          const std::string &key,
+                                          std::vector<Double_t> &ptBins,
+                                          std::vector<Double_t> &yBins,
+                                          std::vector<Double_t> &weights) const {
+  const Entry *entry = Find(dir, key, kPtY);
+  if (!entry)
+    return kFALSE;
+  if (!entry->fData) {
+    ptBins = entry->fPtBins;
+    yBins = entry->fYBins;
+    weights = entry->fWeights;
+    return kTRUE;
+  }
+  const char *data = entry->fData;
+  UInt_t nPt = Take<UInt_t>(data);
+  UInt_t nY = Take<UInt_t>(data);
+  ptBins.resize(nPt + 1);
+  yBins.resize(nY + 1);
+  weights.resize(nPt * nY);
+  memcpy(ptBins.data(), data, ptBins.size() * sizeof(Double_t));
+  data += ptBins.size() * sizeof(Double_t);
+  memcpy(yBins.data(), data, yBins.size() * sizeof(Double_t));
+  data += yBins.size() * sizeof(Double_t);
+  memcpy(weights.data(), data, weights.size() * sizeof(Double_t));
+  return kTRUE;
+}
@@ -0,0 +1,103 @@
+#ifndef GENERATORPARAMEMLIBV2STORE_H
+#define GENERATORPARAMEMLIBV2STORE_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// In-memory index of a GeneratorParamEMlibV2 JSON parametrisation file.
+// The JSON document is parsed once per file and converted into compact
+// entries addressed by (directory, key), i.e. (centrality, species):
+//   - formula strings        ("111_pt", "111_v2_def", ...)
+//   - mt scaling factors     ("histoMtScaleFactor")
+//   - pt-y distributions     ("111_pt_y", ...)
+//
+// Optionally a binary sidecar <file>.bin is written next to the JSON file
+// and reused by later jobs. The sidecar is versioned, tied to the size and
+// modification time of the JSON file and carries a checksum for the index
+// and for every entry. It is memory mapped and entries are only decoded
+// when they are requested.
+
+#include <Rtypes.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class GeneratorParamEMlibV2Store {
+public:
+  enum EntryType_t { kFormula = 1, kMtFactors = 2, kPtY = 3 };
+
+  ~GeneratorParamEMlibV2Store();
+
+  // Return the store for fileName, parsing the file (or mapping its
+  // binary sidecar) on first use. Returns nullptr if the file can not be read.
+  static GeneratorParamEMlibV2Store *Open(const char *fileName);
+  // Drop all stores, e.g. after a parametrisation file has been replaced
+  static void Clear();
+  // Write <file>.bin after parsing a JSON file and use it when it is valid
+  static void SetUseBinaryCache(Bool_t flag = kTRUE) { fgUseBinaryCache = flag; }
+  static Bool_t GetUseBinaryCache() { return fgUseBinaryCache; }
+  static std::string BinaryCacheName(const char *fileName) {
+    return std::string(fileName) + ".bin";
+  }
+
+  Bool_t HasDirectory(const std::string &dir) const;
+  Bool_t Contains(const std::string &dir, const std::string &key) const;
+  Bool_t GetFormula(const std::string &dir, const std::string &key,
+                    std::string &formula) const;
+  Bool_t GetMtFactors(const std::string &dir, const std::string &key,
+                      std::vector<std::pair<std::string, Double_t>> &factors) const;
+  Bool_t GetPtY(const std::string &dir, const std::string &key,
+                std::vector<Double_t> &ptBins, std::vector<Double_t> &yBins,
+                std::vector<Double_t> &weights) const;
+
+  Bool_t WriteBinary(const char *fileName) const;
+  Bool_t IsMapped() const { return fMapped != nullptr; }
+
+private:
+  struct Entry {
+    Int_t fType = 0;
+    // decoded content (JSON input)
+    std::string fFormula;
+    std::vector<std::pair<std::string, Double_t>> fFactors;
+    std::vector<Double_t> fPtBins;
+    std::vector<Double_t> fYBins;
+    std::vector<Double_t> fWeights; // nPt x nY, pt major
+    // encoded content (binary input)
+    const char *fData = nullptr;
+    ULong64_t fSize = 0;
+    UInt_t fChecksum = 0;
+  };
+  typedef std::map<std::string, std::map<std::string, Entry>> Index_t;
+
+  GeneratorParamEMlibV2Store() = default;
+  GeneratorParamEMlibV2Store(const GeneratorParamEMlibV2Store &) = delete;
+  GeneratorParamEMlibV2Store &operator=(const GeneratorParamEMlibV2Store &) = delete;
+
+  Bool_t ReadJSON(const char *fileName);
+  Bool_t MapBinary(const char *fileName, ULong64_t sourceSize,
+                   Long64_t sourceTime);
+  const Entry *Find(const std::string &dir, const std::string &key,
+                    Int_t type) const;
+  static std::string Encode(const Entry &entry);
+  static UInt_t Checksum(const char *data, ULong64_t size);
+
+  Index_t fIndex;                // entries per directory and key
+  ULong64_t fSourceSize = 0;     // size of the JSON file
+  Long64_t fSourceTime = 0;      // modification time of the JSON file
+  void *fMapped = nullptr;       // mapped sidecar
+  ULong64_t fMappedSize = 0;     // size of the mapped sidecar
+
+  static Bool_t fgUseBinaryCache; // use and write binary sidecars
+  static std::map<std::string, std::unique_ptr<GeneratorParamEMlibV2Store>> fgStores;
+
+  static const UInt_t fgkVersion = 1;
+};
+#endif
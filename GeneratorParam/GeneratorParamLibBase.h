@@ -18,6 +18,7 @@
 #include <TObject.h>
 
 class TRandom;
+class TH2;
 
 class GeneratorParamLibBase : public TObject {
 public:
@@ -30,6 +31,8 @@ public:
   virtual GenFuncIp GetIp(Int_t param, const char *tname) const = 0;
   virtual GenFunc GetV2(Int_t, const char *) const { return NoV2; }
   static Double_t NoV2(const Double_t *, const Double_t *) { return 0; }
+  // optional joint pt-y density (x: pt, y: rapidity)
+  virtual const TH2 *GetPtY(Int_t, const char *) const { return nullptr; }
   ClassDef(GeneratorParamLibBase,
            0) // Library providing y and pT parameterisations
 };
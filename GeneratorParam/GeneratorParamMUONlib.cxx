@@ -17,6 +17,21 @@
 
 #include "GeneratorParamMUONlib.h"
 
+namespace {
+// Default species compositions of the particle families, they can be
+// replaced through GeneratorParamMUONlib::GetComposition/SetComposition
+GeneratorParamComposition gCompositionPion({{211, 0.5}, {-211, 0.5}});
+GeneratorParamComposition gCompositionKaon({{321, 0.5}, {-321, 0.5}});
+GeneratorParamComposition gCompositionJpsiFamily({{443, 0.98}, {100443, 0.02}});
+GeneratorParamComposition gCompositionUpsilonFamily({{553, 0.687}, {100553, 0.216}, {200553, 0.097}});
+//  Taux de production Carrer & Dainese : ALICE-INT-2003-019 v.3
+GeneratorParamComposition gCompositionCharm({{421, 0.30}, {-421, 0.30}, {411, 0.10}, {-411, 0.10},
+                                            {431, 0.06}, {-431, 0.06}, {4122, 0.04}, {-4122, 0.04}});
+GeneratorParamComposition gCompositionBeauty({{511, 0.20}, {-511, 0.20}, {521, 0.205}, {-521, 0.205},
+                                             {531, 0.06}, {-531, 0.06}, {5122, 0.035}, {-5122, 0.035}});
+GeneratorParamComposition gCompositionChic({{10441, 0.001}, {20443, 0.376}, {445, 0.623}});
+} // namespace
+
 ClassImp(GeneratorParamMUONlib)
     //
     //  Pions
@@ -65,11 +80,7 @@ Double_t GeneratorParamMUONlib::YPion(const Double_t *py,
 //
 Int_t GeneratorParamMUONlib::IpPion(TRandom *ran) {
   // Pion composition
-  if (ran->Rndm() < 0.5) {
-    return 211;
-  } else {
-    return -211;
-  }
+  return gCompositionPion.Sample(ran);
 }
 
 //____________________________________________________________
@@ -127,11 +138,7 @@ Double_t GeneratorParamMUONlib::YKaon(const Double_t *py,
 //
 Int_t GeneratorParamMUONlib::IpKaon(TRandom *ran) {
   // Kaon composition
-  if (ran->Rndm() < 0.5) {
-    return 321;
-  } else {
-    return -321;
-  }
+  return gCompositionKaon.Sample(ran);
 }
 
 //                    J/Psi
@@ -1601,16 +1608,9 @@ Int_t GeneratorParamMUONlib::IpPsiP(TRandom *) {
   // Psi prime composition
   return 100443;
 }
-Int_t GeneratorParamMUONlib::IpJpsiFamily(TRandom *) {
+Int_t GeneratorParamMUONlib::IpJpsiFamily(TRandom *ran) {
   // J/Psi composition
-  Int_t ip;
-  Float_t r = gRandom->Rndm();
-  if (r < 0.98) {
-    ip = 443;
-  } else {
-    ip = 100443;
-  }
-  return ip;
+  return gCompositionJpsiFamily.Sample(ran);
 }
 
 //                      Upsilon
@@ -2951,22 +2951,11 @@ Int_t GeneratorParamMUONlib::IpUpsilonPP(TRandom *) {
   // y composition
   return 200553;
 }
-Int_t GeneratorParamMUONlib::IpUpsilonFamily(TRandom *) {
+Int_t GeneratorParamMUONlib::IpUpsilonFamily(TRandom *ran) {
   // y composition
   // Using the LHCb pp data at 7 TeV: CERN-PH-EP-2012-051
   // (L. Manceau, S. Grigoryan)
-  Int_t ip;
-  Float_t r = gRandom->Rndm();
-  if (r < 0.687) {
-    //  if (r < 0.712) {
-    ip = 553;
-  } else if (r < 0.903) {
-    //  } else if (r < 0.896) {
-    ip = 100553;
-  } else {
-    ip = 200553;
-  }
-  return ip;
+  return gCompositionUpsilonFamily.Sample(ran);
 }
 
 //
@@ -3486,32 +3475,9 @@ Double_t GeneratorParamMUONlib::YCharmF0M0S6PP(const Double_t *px,
 
 Int_t GeneratorParamMUONlib::IpCharm(TRandom *ran) {
   // Charm composition
-  Float_t random;
-  Int_t ip;
-  //    411,421,431,4122
-  random = ran->Rndm();
   //  Taux de production Carrer & Dainese : ALICE-INT-2003-019 v.3
   //  >>>>> cf. tab 4 p 11
-
-  if (random < 0.30) {
-    ip = 421;
-  } else if (random < 0.60) {
-    ip = -421;
-  } else if (random < 0.70) {
-    ip = 411;
-  } else if (random < 0.80) {
-    ip = -411;
-  } else if (random < 0.86) {
-    ip = 431;
-  } else if (random < 0.92) {
-    ip = -431;
-  } else if (random < 0.96) {
-    ip = 4122;
-  } else {
-    ip = -4122;
-  }
-
-  return ip;
+  return gCompositionCharm.Sample(ran);
 }
 
 //
@@ -3909,32 +3875,9 @@ Double_t GeneratorParamMUONlib::YBeautyF0M0S6PP(const Double_t *px,
 
 Int_t GeneratorParamMUONlib::IpBeauty(TRandom *ran) {
   // Beauty Composition
-  Float_t random;
-  Int_t ip;
-  random = ran->Rndm();
-
   //  Taux de production Carrer & Dainese : ALICE-INT-2003-019 v.3
   //  >>>>> cf. tab 4 p 11
-
-  if (random < 0.20) {
-    ip = 511;
-  } else if (random < 0.40) {
-    ip = -511;
-  } else if (random < 0.605) {
-    ip = 521;
-  } else if (random < 0.81) {
-    ip = -521;
-  } else if (random < 0.87) {
-    ip = 531;
-  } else if (random < 0.93) {
-    ip = -531;
-  } else if (random < 0.965) {
-    ip = 5122;
-  } else {
-    ip = -5122;
-  }
-
-  return ip;
+  return gCompositionBeauty.Sample(ran);
 }
 
 typedef Double_t (*GenFunc)(const Double_t *, const Double_t *);
@@ -4737,18 +4680,41 @@ Int_t GeneratorParamMUONlib::IpChic2(TRandom *) {
   // Chi_c2 prime composition
   return 445;
 }
-Int_t GeneratorParamMUONlib::IpChic(TRandom *) {
+Int_t GeneratorParamMUONlib::IpChic(TRandom *ran) {
   // Chi composition
-  Int_t ip;
-  Float_t r = gRandom->Rndm();
-  if (r < 0.001) {
-    ip = 10441;
-  } else if (r < 0.377) {
-    ip = 20443;
-  } else {
-    ip = 445;
+  return gCompositionChic.Sample(ran);
+}
+
+//_____________________________________________________________
+GeneratorParamComposition *GeneratorParamMUONlib::GetComposition(Int_t param) {
+  // Return the species composition used by the family param
+  switch (param) {
+  case kPion:
+    return &gCompositionPion;
+  case kKaon:
+    return &gCompositionKaon;
+  case kJpsiFamily:
+    return &gCompositionJpsiFamily;
+  case kUpsilonFamily:
+    return &gCompositionUpsilonFamily;
+  case kCharm:
+    return &gCompositionCharm;
+  case kBeauty:
+    return &gCompositionBeauty;
+  case kChic:
+    return &gCompositionChic;
+  default:
+    printf("<GeneratorParamMUONlib::GetComposition> no composition table for %d\n", param);
+    return 0;
   }
-  return ip;
+}
+
+Bool_t GeneratorParamMUONlib::SetComposition(Int_t param, const char *fileName) {
+  // Read the species composition of family param from a text file
+  GeneratorParamComposition *composition = GetComposition(param);
+  if (!composition)
+    return kFALSE;
+  return composition->ReadFile(fileName);
 }
 
 //_____________________________________________________________
@@ -1,6 +1,7 @@
 #ifndef GENERATORPARAMMUONLIB_H
 #define GENERATORPARAMMUONLIB_H
 #include "GeneratorParamLibBase.h"
+#include "GeneratorParamComposition.h"
 
 class GeneratorParamMUONlib : public GeneratorParamLibBase {
 public:
@@ -30,6 +31,10 @@ public:
   GenFunc GetPt(Int_t param, const char *tname = 0) const;
   GenFunc GetY(Int_t param, const char *tname = 0) const;
   GenFuncIp GetIp(Int_t param, const char *tname = 0) const;
+  // species composition of the families kPion, kKaon, kJpsiFamily,
+  // kUpsilonFamily, kCharm, kBeauty and kChic
+  static GeneratorParamComposition *GetComposition(Int_t param);
+  static Bool_t SetComposition(Int_t param, const char *fileName);
 
 private:
   // pions
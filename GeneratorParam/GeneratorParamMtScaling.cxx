@@ -0,0 +1,65 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// mT-scaling of a reference pT spectrum
+//
+
+#include "GeneratorParamMtScaling.h"
+#include <TF1.h>
+#include <TMath.h>
+#include <vector>
+
+GeneratorParamMtScaling::GeneratorParamMtScaling(const TF1 *base, Double_t mass,
+                                                 Double_t refMass, Double_t norm)
+    : fBase(new TF1(*base)), fMass(mass), fRefMass(refMass), fNorm(norm),
+      fDeltaM2(mass * mass - refMass * refMass) {}
+
+//____________________________________________________________
+Double_t GeneratorParamMtScaling::Normalisation(const TF1 *base, Double_t mass,
+                                                Double_t refMass,
+                                                Double_t factor,
+                                                Double_t ptNorm) {
+  // factor * f(ptNorm) / f(ptNorm'), i.e. the ratio of the scaled to the
+  // reference spectrum at ptNorm (without the Jacobian) equals factor
+  Double_t scaledNormPt =
+      TMath::Sqrt(ptNorm * ptNorm + mass * mass - refMass * refMass);
+  return factor * base->Eval(ptNorm) / base->Eval(scaledNormPt);
+}
+
+//____________________________________________________________
+Double_t GeneratorParamMtScaling::ScaledPt(Double_t pt) const {
+  Double_t pt2 = pt * pt + fDeltaM2;
+  return (pt2 > 0.) ? TMath::Sqrt(pt2) : 0.;
+}
+
+//____________________________________________________________
+Double_t GeneratorParamMtScaling::Eval(Double_t pt) const {
+  Double_t scaledPt = ScaledPt(pt);
+  if (scaledPt <= 0.)
+    return 0.;
+  return fNorm * (pt / scaledPt) * fBase->Eval(scaledPt);
+}
+
+//____________________________________________________________
+void GeneratorParamMtScaling::Eval(Int_t n, const Double_t *pt,
+                                   Double_t *result) const {
+  // Evaluate the scaled spectrum for n values of pT.
+  // The scaled momenta are computed in one go before the reference
+  // spectrum is evaluated.
+  std::vector<Double_t> scaledPt(n);
+  for (Int_t i = 0; i < n; i++)
+    scaledPt[i] = ScaledPt(pt[i]);
+  for (Int_t i = 0; i < n; i++) {
+    result[i] = (scaledPt[i] > 0.)
+                    ? fNorm * (pt[i] / scaledPt[i]) * fBase->Eval(scaledPt[i])
+                    : 0.;
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef GENERATORPARAMMTSCALING_H
+#define GENERATORPARAMMTSCALING_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// mT-scaled pT spectrum of a particle with mass m derived from the
+// spectrum f of a reference particle with mass mref:
+//
+//   f_m(pT) = norm * pT/pT' * f(pT'),   pT' = sqrt(pT^2 + m^2 - mref^2)
+//
+// The reference spectrum is evaluated directly, so no formula has to be
+// rewritten and compiled for the scaled species. Objects of this class can
+// be used as functor for a TF1. They evaluate a copy of the reference
+// spectrum, shared between copies of the functor, so the TF1 they are put
+// in does not depend on the lifetime of the reference.
+
+#include <Rtypes.h>
+#include <memory>
+
+class TF1;
+
+class GeneratorParamMtScaling {
+public:
+  GeneratorParamMtScaling() = default;
+  GeneratorParamMtScaling(const TF1 *base, Double_t mass, Double_t refMass,
+                          Double_t norm = 1.);
+
+  // normalisation such that f_m(ptNorm)/f(ptNorm) equals factor
+  static Double_t Normalisation(const TF1 *base, Double_t mass,
+                                Double_t refMass, Double_t factor,
+                                Double_t ptNorm = 5.);
+
+  Double_t ScaledPt(Double_t pt) const;
+  Double_t Eval(Double_t pt) const;
+  void Eval(Int_t n, const Double_t *pt, Double_t *result) const;
+  Double_t operator()(const Double_t *x, const Double_t * /*par*/) const {
+    return Eval(x[0]);
+  }
+
+  const TF1 *GetBase() const { return fBase.get(); }
+  Double_t GetMass() const { return fMass; }
+  Double_t GetRefMass() const { return fRefMass; }
+  Double_t GetNorm() const { return fNorm; }
+
+private:
+  std::shared_ptr<const TF1> fBase; // copy of the reference spectrum
+  Double_t fMass = 0.;        // mass of the scaled particle
+  Double_t fRefMass = 0.;     // mass of the reference particle
+  Double_t fNorm = 1.;        // normalisation factor
+  Double_t fDeltaM2 = 0.;     // m^2 - mref^2
+};
+#endif
@@ -0,0 +1,171 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Joint (pT, y) sampling from a two-dimensional histogram
+//
+
+#include "GeneratorParamPtYSampler.h"
+#include <TH2.h>
+#include <TMath.h>
+#include <TRandom.h>
+#include <algorithm>
+
+namespace {
+// sorted nodes: window edges plus all centres strictly inside the window
+std::vector<Double_t> MakeNodes(const std::vector<Double_t> &centres,
+                                Double_t xmin, Double_t xmax) {
+  std::vector<Double_t> nodes;
+  nodes.push_back(xmin);
+  for (auto c : centres)
+    if (c > xmin && c < xmax)
+      nodes.push_back(c);
+  nodes.push_back(xmax);
+  return nodes;
+}
+} // namespace
+
+//____________________________________________________________
+Bool_t GeneratorParamPtYSampler::Build(const TH2 *dist, Double_t ptMin,
+                                       Double_t ptMax, Double_t yMin,
+                                       Double_t yMax) {
+  const TAxis *xaxis = dist->GetXaxis();
+  const TAxis *yaxis = dist->GetYaxis();
+  Int_t nx = xaxis->GetNbins();
+  Int_t ny = yaxis->GetNbins();
+
+  // density per unit area at the bin centres
+  fCentrePt.resize(nx);
+  fCentreY.resize(ny);
+  fDensity.resize(nx * ny);
+  for (Int_t ix = 0; ix < nx; ix++)
+    fCentrePt[ix] = xaxis->GetBinCenter(ix + 1);
+  for (Int_t iy = 0; iy < ny; iy++)
+    fCentreY[iy] = yaxis->GetBinCenter(iy + 1);
+  for (Int_t ix = 0; ix < nx; ix++) {
+    for (Int_t iy = 0; iy < ny; iy++) {
+      Double_t area = xaxis->GetBinWidth(ix + 1) * yaxis->GetBinWidth(iy + 1);
+      Double_t content = dist->GetBinContent(ix + 1, iy + 1);
+      fDensity[ix * ny + iy] = (content > 0. && area > 0.) ? content / area : 0.;
+    }
+  }
+
+  // dN/dy at y = 0 over the full pT range, the density is linear in pT
+  // between the nodes
+  std::vector<Double_t> nodes = MakeNodes(fCentrePt, xaxis->GetXmin(), xaxis->GetXmax());
+  fdNdy0 = 0.;
+  for (UInt_t i = 0; i + 1 < nodes.size(); i++)
+    fdNdy0 += 0.5 * (nodes[i + 1] - nodes[i]) * (Density(nodes[i], 0.) + Density(nodes[i + 1], 0.));
+
+  // cells inside the kinematic window
+  Double_t xlo = TMath::Max(ptMin, xaxis->GetXmin());
+  Double_t xhi = TMath::Min(ptMax, xaxis->GetXmax());
+  Double_t ylo = TMath::Max(yMin, yaxis->GetXmin());
+  Double_t yhi = TMath::Min(yMax, yaxis->GetXmax());
+  if (xlo >= xhi || ylo >= yhi) {
+    printf("GeneratorParamPtYSampler: ERROR: Window does not overlap with %s\n", dist->GetName());
+    return kFALSE;
+  }
+  fNodePt = MakeNodes(fCentrePt, xlo, xhi);
+  fNodeY = MakeNodes(fCentreY, ylo, yhi);
+  Int_t mx = fNodePt.size();
+  Int_t my = fNodeY.size();
+  fCorner.resize(mx * my);
+  for (Int_t i = 0; i < mx; i++)
+    for (Int_t j = 0; j < my; j++)
+      fCorner[i * my + j] = Density(fNodePt[i], fNodeY[j]);
+
+  std::vector<Double_t> weights((mx - 1) * (my - 1));
+  for (Int_t i = 0; i < mx - 1; i++) {
+    for (Int_t j = 0; j < my - 1; j++) {
+      Double_t area = (fNodePt[i + 1] - fNodePt[i]) * (fNodeY[j + 1] - fNodeY[j]);
+      weights[i * (my - 1) + j] =
+          0.25 * area * (fCorner[i * my + j] + fCorner[(i + 1) * my + j] +
+                         fCorner[i * my + j + 1] + fCorner[(i + 1) * my + j + 1]);
+    }
+  }
+  return fTable.Set(weights);
+}
+
+//____________________________________________________________
+Double_t GeneratorParamPtYSampler::Interpolate(const std::vector<Double_t> &nodes,
+                                               Double_t x, Int_t &i) {
+  // Lower node index i and fraction between node i and i+1,
+  // constant extrapolation outside of the nodes
+  Int_t n = nodes.size();
+  if (n < 2 || x <= nodes[0]) {
+    i = 0;
+    return 0.;
+  }
+  if (x >= nodes[n - 1]) {
+    i = n - 2;
+    return 1.;
+  }
+  i = std::upper_bound(nodes.begin(), nodes.end(), x) - nodes.begin() - 1;
+  return (x - nodes[i]) / (nodes[i + 1] - nodes[i]);
+}
+
+//____________________________________________________________
+Double_t GeneratorParamPtYSampler::Density(Double_t pt, Double_t y) const {
+  Int_t ix, iy;
+  Double_t tx = Interpolate(fCentrePt, pt, ix);
+  Double_t ty = Interpolate(fCentreY, y, iy);
+  Int_t ny = fCentreY.size();
+  Int_t ix1 = TMath::Min(ix + 1, (Int_t)fCentrePt.size() - 1);
+  Int_t iy1 = TMath::Min(iy + 1, ny - 1);
+  return (1. - tx) * (1. - ty) * fDensity[ix * ny + iy] +
+         tx * (1. - ty) * fDensity[ix1 * ny + iy] +
+         (1. - tx) * ty * fDensity[ix * ny + iy1] +
+         tx * ty * fDensity[ix1 * ny + iy1];
+}
+
+//____________________________________________________________
+Double_t GeneratorParamPtYSampler::SampleLinear(Double_t c0, Double_t c1,
+                                                Double_t r) {
+  // Invert the cumulative of the density c0*(1-u) + c1*u on [0,1]
+  Double_t sum = c0 + c1;
+  if (sum <= 0. || TMath::Abs(c1 - c0) < 1.e-9 * sum)
+    return r;
+  return (TMath::Sqrt(c0 * c0 + r * (c1 * c1 - c0 * c0)) - c0) / (c1 - c0);
+}
+
+//____________________________________________________________
+void GeneratorParamPtYSampler::SampleCell(Int_t cell, Double_t r1, Double_t r2,
+                                          Double_t &pt, Double_t &y) const {
+  Int_t my = fNodeY.size();
+  Int_t i = cell / (my - 1);
+  Int_t j = cell % (my - 1);
+  Double_t f00 = fCorner[i * my + j];
+  Double_t f10 = fCorner[(i + 1) * my + j];
+  Double_t f01 = fCorner[i * my + j + 1];
+  Double_t f11 = fCorner[(i + 1) * my + j + 1];
+  // marginal in pT, then y conditional on pT
+  Double_t u = SampleLinear(f00 + f01, f10 + f11, r1);
+  Double_t v = SampleLinear(f00 * (1. - u) + f10 * u, f01 * (1. - u) + f11 * u, r2);
+  pt = fNodePt[i] + u * (fNodePt[i + 1] - fNodePt[i]);
+  y = fNodeY[j] + v * (fNodeY[j + 1] - fNodeY[j]);
+}
+
+//____________________________________________________________
+void GeneratorParamPtYSampler::Sample(TRandom *ran, Double_t &pt,
+                                      Double_t &y) const {
+  Double_t r[3];
+  ran->RndmArray(3, r);
+  SampleCell(fTable.Sample(r[0]), r[1], r[2], pt, y);
+}
+
+//____________________________________________________________
+void GeneratorParamPtYSampler::Sample(TRandom *ran, Int_t n, Double_t *pt,
+                                      Double_t *y) const {
+  std::vector<Double_t> r(3 * n);
+  ran->RndmArray(3 * n, r.data());
+  for (Int_t k = 0; k < n; k++)
+    SampleCell(fTable.Sample(r[3 * k]), r[3 * k + 1], r[3 * k + 2], pt[k], y[k]);
+}
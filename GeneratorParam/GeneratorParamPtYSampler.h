@@ -0,0 +1,62 @@
+#ifndef GENERATORPARAMPTYSAMPLER_H
+#define GENERATORPARAMPTYSAMPLER_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Joint sampling of (pT, y) from a two-dimensional density given as
+// histogram (x: pT, y: rapidity). The density per unit area is
+// interpolated bilinearly between the bin centres. The pT-y window is cut
+// into cells bounded by the bin centres and the window edges, inside of
+// which the interpolated density is exactly bilinear. A cell is chosen
+// from an alias table and the point inside the cell is obtained by
+// inverting the bilinear density, so every draw costs three random numbers
+// and no rejection.
+
+#include "GeneratorParamAliasTable.h"
+#include <Rtypes.h>
+#include <vector>
+
+class TH2;
+class TRandom;
+
+class GeneratorParamPtYSampler {
+public:
+  GeneratorParamPtYSampler() = default;
+
+  // Compile the table for the window [ptMin, ptMax] x [yMin, yMax]
+  Bool_t Build(const TH2 *dist, Double_t ptMin, Double_t ptMax, Double_t yMin,
+               Double_t yMax);
+  void Sample(TRandom *ran, Double_t &pt, Double_t &y) const;
+  void Sample(TRandom *ran, Int_t n, Double_t *pt, Double_t *y) const;
+
+  // Interpolated density per unit pT and y
+  Double_t Density(Double_t pt, Double_t y) const;
+  // Integral of the density inside the window
+  Double_t GetIntegral() const { return fTable.GetTotal(); }
+  // Integral over the full pT range of the density at y = 0
+  Double_t GetdNdy0() const { return fdNdy0; }
+
+private:
+  void SampleCell(Int_t cell, Double_t r1, Double_t r2, Double_t &pt,
+                  Double_t &y) const;
+  static Double_t SampleLinear(Double_t c0, Double_t c1, Double_t r);
+  static Double_t Interpolate(const std::vector<Double_t> &nodes, Double_t x,
+                              Int_t &i);
+
+  std::vector<Double_t> fCentrePt;  // bin centres in pT
+  std::vector<Double_t> fCentreY;   // bin centres in y
+  std::vector<Double_t> fDensity;   // density at the bin centres, pT major
+  std::vector<Double_t> fNodePt;    // cell boundaries in pT
+  std::vector<Double_t> fNodeY;     // cell boundaries in y
+  std::vector<Double_t> fCorner;    // density at the cell corners, pT major
+  GeneratorParamAliasTable fTable;  // cell selection
+  Double_t fdNdy0 = 0.;             // dN/dy at y = 0
+};
+#endif
@@ -0,0 +1,156 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Tabulated (pT, mee) sampling for virtual direct photons
+//
+
+#include "GeneratorParamVirtualGammaSampler.h"
+#include <TMath.h>
+#include <TRandom.h>
+#include <algorithm>
+
+namespace {
+const Double_t kMe = 0.000511;
+const Int_t kMaxNPt = 1000000; // largest number of pT bins
+
+// invert the cumulative of the density c0*(1-u) + c1*u on [0,1]
+Double_t SampleLinear(Double_t c0, Double_t c1, Double_t r) {
+  Double_t sum = c0 + c1;
+  if (sum <= 0. || TMath::Abs(c1 - c0) < 1.e-9 * sum)
+    return r;
+  return (TMath::Sqrt(c0 * c0 + r * (c1 * c1 - c0 * c0)) - c0) / (c1 - c0);
+}
+} // namespace
+
+//____________________________________________________________
+Double_t GeneratorParamVirtualGammaSampler::KrollWada(Double_t mee,
+                                                      Double_t mh) {
+  if (mee <= 2. * kMe || mee >= mh)
+    return 0.;
+  Double_t r2 = kMe * kMe / mee / mee;
+  return 2.0 / 3.0 / 137.036 / TMath::Pi() / mee * TMath::Sqrt(1 - 4 * r2) *
+         (1 + 2 * r2) * TMath::Power(1 - mee * mee / mh / mh, 3);
+}
+
+//____________________________________________________________
+Bool_t GeneratorParamVirtualGammaSampler::Build(GenFunc ptSpectrum,
+                                                Double_t ptMin, Double_t ptMax,
+                                                Int_t nPt, Int_t nMh,
+                                                Int_t nX) {
+  if (ptMax <= ptMin || nPt < 1 || nMh < 2 || nX < 1) {
+    printf("GeneratorParamVirtualGammaSampler: ERROR: Invalid table definition\n");
+    return kFALSE;
+  }
+  if (nPt > kMaxNPt) {
+    printf("GeneratorParamVirtualGammaSampler: WARNING: %d pT bins requested, using %d\n", nPt, kMaxNPt);
+    nPt = kMaxNPt;
+  }
+
+  // pT table, linear interpolation of the spectrum within a bin
+  fPt.resize(nPt + 1);
+  fPtDensity.resize(nPt + 1);
+  Double_t dummy = 0.;
+  for (Int_t i = 0; i <= nPt; i++) {
+    fPt[i] = ptMin + (ptMax - ptMin) * i / nPt;
+    Double_t density = ptSpectrum(&fPt[i], &dummy);
+    fPtDensity[i] = (density > 0.) ? density : 0.;
+  }
+  std::vector<Double_t> weights(nPt);
+  for (Int_t i = 0; i < nPt; i++)
+    weights[i] = 0.5 * (fPt[i + 1] - fPt[i]) * (fPtDensity[i] + fPtDensity[i + 1]);
+  if (!fTable.Set(weights))
+    return kFALSE;
+
+  // mass tables on a logarithmic mh grid covering the pT range
+  Double_t mhMin = MinimumMass();
+  Double_t mhMax = TMath::Max(ptMax, 2. * mhMin);
+  fNMh = nMh;
+  fNX = nX;
+  fLogMhMin = TMath::Log(mhMin);
+  fLogMhStep = (TMath::Log(mhMax) - fLogMhMin) / (nMh - 1);
+  fCdf.assign(nMh * (nX + 1), 0.);
+  fDensityX.assign(nMh * (nX + 1), 0.);
+  for (Int_t iMh = 0; iMh < nMh; iMh++) {
+    Double_t mh = TMath::Exp(fLogMhMin + iMh * fLogMhStep);
+    Double_t range = TMath::Log(mh / 2. / kMe);
+    Double_t *cdf = &fCdf[iMh * (nX + 1)];
+    Double_t *density = &fDensityX[iMh * (nX + 1)];
+    for (Int_t ix = 0; ix <= nX; ix++) {
+      // dN/dx = dN/dmee * mee * ln(mh/2me)
+      Double_t mee = 2. * kMe * TMath::Exp(range * ix / nX);
+      density[ix] = KrollWada(mee, mh) * mee * range;
+      if (ix > 0)
+        cdf[ix] = cdf[ix - 1] + 0.5 * (density[ix - 1] + density[ix]) / nX;
+    }
+    if (cdf[nX] <= 0.) {
+      // degenerate table, sample uniformly in x
+      for (Int_t ix = 0; ix <= nX; ix++) {
+        density[ix] = 1.;
+        cdf[ix] = Double_t(ix) / nX;
+      }
+    } else {
+      for (Int_t ix = 0; ix <= nX; ix++)
+        cdf[ix] /= cdf[nX];
+    }
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+Double_t GeneratorParamVirtualGammaSampler::SampleX(Int_t iMh,
+                                                    Double_t r) const {
+  const Double_t *cdf = &fCdf[iMh * (fNX + 1)];
+  const Double_t *density = &fDensityX[iMh * (fNX + 1)];
+  Int_t ix = std::upper_bound(cdf, cdf + fNX + 1, r) - cdf - 1;
+  ix = TMath::Max(0, TMath::Min(ix, fNX - 1));
+  Double_t width = cdf[ix + 1] - cdf[ix];
+  Double_t u = (width > 0.) ? (r - cdf[ix]) / width : 0.;
+  return (ix + SampleLinear(density[ix], density[ix + 1], u)) / fNX;
+}
+
+//____________________________________________________________
+Double_t GeneratorParamVirtualGammaSampler::SampleMass(Double_t pt,
+                                                       Double_t r1,
+                                                       Double_t r2) const {
+  if (pt < MinimumMass())
+    return 0.;
+  // pick one of the neighbouring mh nodes with the interpolation weight
+  Double_t t = (TMath::Log(pt) - fLogMhMin) / fLogMhStep;
+  Int_t iMh = TMath::Max(0, TMath::Min((Int_t)t, fNMh - 2));
+  if (r1 < t - iMh)
+    iMh++;
+  Double_t x = SampleX(iMh, r2);
+  // the table is expressed in units of the actual upper limit mh = pT
+  return 2. * kMe * TMath::Exp(x * TMath::Log(pt / 2. / kMe));
+}
+
+//____________________________________________________________
+void GeneratorParamVirtualGammaSampler::Sample(TRandom *ran, Double_t &pt,
+                                               Double_t &mass) const {
+  Double_t r[4];
+  ran->RndmArray(4, r);
+  Int_t i = fTable.Sample(r[0]);
+  pt = fPt[i] + (fPt[i + 1] - fPt[i]) * SampleLinear(fPtDensity[i], fPtDensity[i + 1], r[1]);
+  mass = SampleMass(pt, r[2], r[3]);
+}
+
+//____________________________________________________________
+void GeneratorParamVirtualGammaSampler::Sample(TRandom *ran, Int_t n,
+                                               Double_t *pt,
+                                               Double_t *mass) const {
+  std::vector<Double_t> r(4 * n);
+  ran->RndmArray(4 * n, r.data());
+  for (Int_t k = 0; k < n; k++) {
+    Int_t i = fTable.Sample(r[4 * k]);
+    pt[k] = fPt[i] + (fPt[i + 1] - fPt[i]) * SampleLinear(fPtDensity[i], fPtDensity[i + 1], r[4 * k + 1]);
+    mass[k] = SampleMass(pt[k], r[4 * k + 2], r[4 * k + 3]);
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef GENERATORPARAMVIRTUALGAMMASAMPLER_H
+#define GENERATORPARAMVIRTUALGAMMASAMPLER_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Joint sampling of pT and e+e- pair mass of virtual direct photons.
+//
+// The pT spectrum of virtual photons (real photon spectrum times the
+// integrated Kroll-Wada factor) is tabulated in bins of pT and a bin is
+// chosen from an alias table. The pair mass follows the Kroll-Wada
+// distribution with S=1 and the upper limit mh = pT, as in
+// GeneratorParam::RandomMass. Its inverse cumulative is tabulated in
+// x = ln(mee/2me)/ln(mh/2me) on a logarithmic grid of mh. For a given pT
+// one of the two neighbouring grid points is picked with the linear
+// interpolation weight, so (pT, mee) come from one table draw without
+// rejection.
+
+#include "GeneratorParamAliasTable.h"
+#include <Rtypes.h>
+#include <vector>
+
+class TRandom;
+
+class GeneratorParamVirtualGammaSampler {
+public:
+  typedef Double_t (*GenFunc)(const Double_t *, const Double_t *);
+
+  GeneratorParamVirtualGammaSampler() = default;
+
+  // ptSpectrum is the pT spectrum of the virtual photons; nPt is limited
+  // to 10^6 bins
+  Bool_t Build(GenFunc ptSpectrum, Double_t ptMin, Double_t ptMax,
+               Int_t nPt = 10000, Int_t nMh = 256, Int_t nX = 200);
+  void Sample(TRandom *ran, Double_t &pt, Double_t &mass) const;
+  void Sample(TRandom *ran, Int_t n, Double_t *pt, Double_t *mass) const;
+
+  // Kroll-Wada density of the pair mass for a photon of mass mh (S=1)
+  static Double_t KrollWada(Double_t mee, Double_t mh);
+  // Lower limit of mh, below the pair is not produced
+  static Double_t MinimumMass() { return 0.002941; }
+
+private:
+  Double_t SampleMass(Double_t pt, Double_t r1, Double_t r2) const;
+  Double_t SampleX(Int_t iMh, Double_t r) const;
+
+  std::vector<Double_t> fPt;       // pT bin edges
+  std::vector<Double_t> fPtDensity; // spectrum at the bin edges
+  GeneratorParamAliasTable fTable;  // pT bin selection
+  Double_t fLogMhMin = 0.;          // ln of the lowest mh node
+  Double_t fLogMhStep = 0.;         // step of the mh grid in ln(mh)
+  Int_t fNMh = 0;                   // number of mh nodes
+  Int_t fNX = 0;                    // number of x intervals
+  std::vector<Double_t> fCdf;       // cumulative in x, nMh x (nX+1)
+  std::vector<Double_t> fDensityX;  // density in x, nMh x (nX+1)
+};
+#endif
@@ -0,0 +1,78 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Columnar output of batch decays
+//
+
+#include "PythiaDecayBuffer.h"
+#include <TClonesArray.h>
+#include <TParticle.h>
+
+//____________________________________________________________
+void PythiaDecayBuffer::Clear() {
+  // The capacity is kept for the next batch
+  for (auto column : {&fPdg, &fStatus, &fMother, &fFirstDaughter, &fLastDaughter, &fParent})
+    column->clear();
+  for (auto column : {&fPx, &fPy, &fPz, &fE, &fVx, &fVy, &fVz, &fT, &fWeight})
+    column->clear();
+  fFirst.clear();
+}
+
+//____________________________________________________________
+void PythiaDecayBuffer::Reserve(Int_t n) {
+  for (auto column : {&fPdg, &fStatus, &fMother, &fFirstDaughter, &fLastDaughter, &fParent})
+    column->reserve(n);
+  for (auto column : {&fPx, &fPy, &fPz, &fE, &fVx, &fVy, &fVz, &fT, &fWeight})
+    column->reserve(n);
+}
+
+//____________________________________________________________
+Int_t PythiaDecayBuffer::Add(Int_t pdg, Int_t status, Int_t mother,
+                             Int_t firstDaughter, Int_t lastDaughter,
+                             const Double_t *p, const Double_t *v,
+                             Double_t weight) {
+  fPdg.push_back(pdg);
+  fStatus.push_back(status);
+  fMother.push_back(mother);
+  fFirstDaughter.push_back(firstDaughter);
+  fLastDaughter.push_back(lastDaughter);
+  fParent.push_back(GetNParents() - 1);
+  fPx.push_back(p[0]);
+  fPy.push_back(p[1]);
+  fPz.push_back(p[2]);
+  fE.push_back(p[3]);
+  fVx.push_back(v[0]);
+  fVy.push_back(v[1]);
+  fVz.push_back(v[2]);
+  fT.push_back(v[3]);
+  fWeight.push_back(weight);
+  return GetN() - 1;
+}
+
+//____________________________________________________________
+void PythiaDecayBuffer::AddParticles(const TClonesArray *particles, Int_t np,
+                                     Int_t offset) {
+  Int_t first = GetN();
+  BeginParent();
+  for (Int_t i = 0; i < np; i++) {
+    const TParticle *particle = (const TParticle *)particles->At(i);
+    Int_t mother = particle->GetFirstMother() + offset;
+    Int_t firstDaughter = particle->GetFirstDaughter() + offset;
+    Int_t lastDaughter = particle->GetLastDaughter() + offset;
+    Double_t p[4] = {particle->Px(), particle->Py(), particle->Pz(), particle->Energy()};
+    Double_t v[4] = {particle->Vx(), particle->Vy(), particle->Vz(), particle->T()};
+    Add(particle->GetPdgCode(), particle->GetStatusCode(),
+        (mother < 0) ? -1 : first + mother,
+        (firstDaughter <= 0) ? -1 : first + firstDaughter,
+        (firstDaughter <= 0) ? -1 : first + lastDaughter, p, v,
+        particle->GetWeight());
+  }
+}
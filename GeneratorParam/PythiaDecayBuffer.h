@@ -0,0 +1,59 @@
+#ifndef PYTHIADECAYBUFFER_H
+#define PYTHIADECAYBUFFER_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Columnar output of batch decays. The products of parent i of the batch
+// are stored in [GetFirst(i), GetFirst(i + 1)), the parent itself first.
+// Mother and daughter indices refer to the position in the buffer, -1 if
+// there is none. Momenta in GeV, vertices in mm and mm/c.
+
+#include <Rtypes.h>
+#include <vector>
+
+class TClonesArray;
+
+class PythiaDecayBuffer {
+public:
+  PythiaDecayBuffer() = default;
+
+  void Clear();
+  void Reserve(Int_t n);
+  // Start the block of the next parent
+  void BeginParent() { fFirst.push_back(GetN()); }
+  // Append an entry to the current block, returns its index
+  Int_t Add(Int_t pdg, Int_t status, Int_t mother, Int_t firstDaughter,
+            Int_t lastDaughter, const Double_t *p, const Double_t *v,
+            Double_t weight = 1.);
+  // Append np particles of a decayer record as a new block; offset is added
+  // to the mother and daughter links (-1 for Fortran counting)
+  void AddParticles(const TClonesArray *particles, Int_t np, Int_t offset);
+
+  Int_t GetN() const { return fPdg.size(); }
+  Int_t GetNParents() const { return fFirst.size(); }
+  Int_t GetFirst(Int_t parent) const {
+    return (parent < GetNParents()) ? fFirst[parent] : GetN();
+  }
+
+  // columns, one entry per particle
+  std::vector<Int_t> fPdg;           // PDG code
+  std::vector<Int_t> fStatus;        // 1 stable, 11 decayed
+  std::vector<Int_t> fMother;        // index of the mother
+  std::vector<Int_t> fFirstDaughter; // index of the first daughter
+  std::vector<Int_t> fLastDaughter;  // index of the last daughter
+  std::vector<Int_t> fParent;        // index of the parent in the batch
+  std::vector<Double_t> fPx, fPy, fPz, fE; // four-momentum
+  std::vector<Double_t> fVx, fVy, fVz, fT; // production vertex
+  std::vector<Double_t> fWeight;           // particle weight
+
+private:
+  std::vector<Int_t> fFirst; // first entry of each parent
+};
+#endif
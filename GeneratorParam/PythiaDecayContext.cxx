@@ -0,0 +1,225 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Switchable decay table configurations for the shared Pythia6 instance
+//
+
+#include "PythiaDecayContext.h"
+#include <TPythia6.h>
+#include <algorithm>
+
+Int_t PythiaDecayContext::fgMSTJ21 = 0;
+std::vector<Int_t> PythiaDecayContext::fgMDCY;
+std::vector<Int_t> PythiaDecayContext::fgMDME;
+std::vector<Double_t> PythiaDecayContext::fgBRAT;
+std::vector<Int_t> PythiaDecayContext::fgFirst;
+std::vector<Int_t> PythiaDecayContext::fgNChannels;
+std::vector<PythiaDecayContext *> PythiaDecayContext::fgContexts;
+UInt_t PythiaDecayContext::fgGeneration = 0;
+PythiaDecayContext *PythiaDecayContext::fgActive = nullptr;
+
+namespace {
+const Int_t kNKC = 500;
+} // namespace
+
+//____________________________________________________________
+PythiaDecayContext &PythiaDecayContext::operator=(const PythiaDecayContext &context) {
+  if (this != &context) {
+    if (IsActive())
+      fgActive = nullptr; // the table keeps the entries, they are no longer tracked
+    fMSTJ21 = context.fMSTJ21;
+    fMDCY = context.fMDCY;
+    fMDME = context.fMDME;
+    fBRAT = context.fBRAT;
+    fGeneration = context.fGeneration;
+  }
+  return *this;
+}
+
+//____________________________________________________________
+PythiaDecayContext::~PythiaDecayContext() {
+  if (IsActive())
+    ActivateBaseline(TPythia6::Instance());
+  fgContexts.erase(std::find(fgContexts.begin(), fgContexts.end(), this));
+}
+
+//____________________________________________________________
+void PythiaDecayContext::CaptureBaseline(TPythia6 *pythia) {
+  Pydat3_t *pydat3 = pythia->GetPydat3();
+  fgMSTJ21 = pythia->GetMSTJ(21);
+  fgMDCY.assign(pydat3->MDCY[0], pydat3->MDCY[0] + kNKC);
+  fgMDME.assign(&pydat3->MDME[0][0], &pydat3->MDME[0][0] + 2 * KNDCAY);
+  fgBRAT.assign(pydat3->BRAT, pydat3->BRAT + KNDCAY);
+  fgFirst.assign(pydat3->MDCY[1], pydat3->MDCY[1] + kNKC);
+  fgNChannels.assign(pydat3->MDCY[2], pydat3->MDCY[2] + kNKC);
+  fgGeneration++;
+  fgActive = nullptr;
+}
+
+//____________________________________________________________
+void PythiaDecayContext::ResetBaseline(TPythia6 *pythia) {
+  if (fgMDCY.empty()) {
+    CaptureBaseline(pythia);
+    return;
+  }
+  // channel -> kc - 1 in the old table
+  std::vector<Int_t> channelKC(KNDCAY, -1);
+  for (Int_t i = 0; i < kNKC; i++)
+    for (Int_t j = 0; j < fgNChannels[i]; j++)
+      if (fgFirst[i] > 0 && fgFirst[i] + j <= KNDCAY)
+        channelKC[fgFirst[i] - 1 + j] = i;
+  std::vector<Int_t> first(fgFirst);
+  UInt_t generation = fgGeneration;
+  CaptureBaseline(pythia);
+  for (auto context : fgContexts) {
+    if (context->fGeneration != generation)
+      continue;
+    Int_t ndropped = context->Rebase(channelKC, first);
+    if (ndropped)
+      printf("PythiaDecayContext: Warning: %d entries of a context refer to channels not in the new table\n",
+             ndropped);
+  }
+}
+
+//____________________________________________________________
+Int_t PythiaDecayContext::Rebase(const std::vector<Int_t> &channelKC, const std::vector<Int_t> &first) {
+  // Move the entries to the channels with the same position in the new
+  // table and drop those equal to the new baseline. Returns the number of
+  // entries without channel in the new table.
+  Int_t ndropped = 0;
+  auto channel = [&](Int_t i) {
+    Int_t kc = channelKC[i];
+    if (kc < 0 || i - (first[kc] - 1) >= fgNChannels[kc]) {
+      ndropped++;
+      return -1;
+    }
+    return fgFirst[kc] - 1 + i - (first[kc] - 1);
+  };
+  std::vector<std::pair<Int_t, Int_t>> mdcy, mdme;
+  std::vector<std::pair<Int_t, Double_t>> brat;
+  for (auto &entry : fMDCY)
+    if (entry.second != fgMDCY[entry.first])
+      mdcy.push_back(entry);
+  for (auto &entry : fMDME) {
+    Int_t i = channel(entry.first % KNDCAY);
+    Int_t index = (entry.first / KNDCAY) * KNDCAY + i;
+    if (i >= 0 && entry.second != fgMDME[index])
+      mdme.emplace_back(index, entry.second);
+  }
+  for (auto &entry : fBRAT) {
+    Int_t i = channel(entry.first);
+    if (i >= 0 && entry.second != fgBRAT[i])
+      brat.emplace_back(i, entry.second);
+  }
+  fMDCY.swap(mdcy);
+  fMDME.swap(mdme);
+  fBRAT.swap(brat);
+  fGeneration = fgGeneration;
+  return ndropped;
+}
+
+//____________________________________________________________
+void PythiaDecayContext::Revert(TPythia6 *pythia, const PythiaDecayContext *context) {
+  Pydat3_t *pydat3 = pythia->GetPydat3();
+  Int_t *mdme = &pydat3->MDME[0][0];
+  pythia->SetMSTJ(21, fgMSTJ21);
+  for (auto &entry : context->fMDCY)
+    pydat3->MDCY[0][entry.first] = fgMDCY[entry.first];
+  for (auto &entry : context->fMDME)
+    mdme[entry.first] = fgMDME[entry.first];
+  for (auto &entry : context->fBRAT)
+    pydat3->BRAT[entry.first] = fgBRAT[entry.first];
+}
+
+//____________________________________________________________
+void PythiaDecayContext::ActivateBaseline(TPythia6 *pythia) {
+  if (fgMDCY.empty()) {
+    CaptureBaseline(pythia);
+    return;
+  }
+  if (fgActive)
+    Revert(pythia, fgActive);
+  fgActive = nullptr;
+}
+
+//____________________________________________________________
+void PythiaDecayContext::Capture(TPythia6 *pythia) {
+  if (fgMDCY.empty())
+    CaptureBaseline(pythia);
+  Pydat3_t *pydat3 = pythia->GetPydat3();
+  const Int_t *mdme = &pydat3->MDME[0][0];
+  fMSTJ21 = pythia->GetMSTJ(21);
+  fMDCY.clear();
+  fMDME.clear();
+  fBRAT.clear();
+  for (Int_t i = 0; i < kNKC; i++)
+    if (pydat3->MDCY[0][i] != fgMDCY[i])
+      fMDCY.emplace_back(i, pydat3->MDCY[0][i]);
+  for (Int_t i = 0; i < 2 * KNDCAY; i++)
+    if (mdme[i] != fgMDME[i])
+      fMDME.emplace_back(i, mdme[i]);
+  for (Int_t i = 0; i < KNDCAY; i++)
+    if (pydat3->BRAT[i] != fgBRAT[i])
+      fBRAT.emplace_back(i, pydat3->BRAT[i]);
+  fGeneration = fgGeneration;
+  fgActive = this;
+}
+
+//____________________________________________________________
+void PythiaDecayContext::Activate(TPythia6 *pythia) {
+  if (IsActive())
+    return;
+  if (!IsValid()) {
+    printf("PythiaDecayContext: ERROR: Decay table context not captured\n");
+    return;
+  }
+  if (fgActive)
+    Revert(pythia, fgActive);
+  Pydat3_t *pydat3 = pythia->GetPydat3();
+  Int_t *mdme = &pydat3->MDME[0][0];
+  pythia->SetMSTJ(21, fMSTJ21);
+  for (auto &entry : fMDCY)
+    pydat3->MDCY[0][entry.first] = entry.second;
+  for (auto &entry : fMDME)
+    mdme[entry.first] = entry.second;
+  for (auto &entry : fBRAT)
+    pydat3->BRAT[entry.first] = entry.second;
+  fgActive = this;
+}
+
+//____________________________________________________________
+void PythiaDecayContext::SetMDCY(TPythia6 *pythia, Int_t kc, Int_t value) {
+  if (IsValid())
+    Activate(pythia);
+  pythia->GetPydat3()->MDCY[0][kc - 1] = value;
+  if (!IsValid())
+    return;
+  auto entry = std::find_if(fMDCY.begin(), fMDCY.end(),
+                            [kc](const std::pair<Int_t, Int_t> &e) { return e.first == kc - 1; });
+  if (value == fgMDCY[kc - 1]) {
+    if (entry != fMDCY.end())
+      fMDCY.erase(entry);
+  } else if (entry != fMDCY.end()) {
+    entry->second = value;
+  } else {
+    fMDCY.emplace_back(kc - 1, value);
+  }
+}
+
+//____________________________________________________________
+void PythiaDecayContext::Reset() {
+  if (IsActive())
+    fgActive = nullptr;
+  fMDCY.clear();
+  fMDME.clear();
+  fBRAT.clear();
+  fGeneration = 0;
+}
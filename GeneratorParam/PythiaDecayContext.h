@@ -0,0 +1,79 @@
+#ifndef PYTHIADECAYCONTEXT_H
+#define PYTHIADECAYCONTEXT_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Decay table configuration of the shared Pythia6 instance. A context
+// records the decay switch MSTJ(21) and the entries of MDCY(kc,1), MDME and
+// BRAT that differ from the table as it was before any context was
+// captured (the baseline).
+// Activating a context reverts the entries of the previously active one
+// and applies its own, so switching costs O(changed entries).
+// When the table is reread the contexts are rebased: their entries are
+// carried over to the new table, channels by their position in the list
+// of their particle.
+
+#include <Rtypes.h>
+#include <utility>
+#include <vector>
+
+class TPythia6;
+
+class PythiaDecayContext {
+public:
+  PythiaDecayContext() { fgContexts.push_back(this); }
+  PythiaDecayContext(const PythiaDecayContext &context)
+      : fMSTJ21(context.fMSTJ21), fMDCY(context.fMDCY), fMDME(context.fMDME),
+        fBRAT(context.fBRAT), fGeneration(context.fGeneration) { fgContexts.push_back(this); }
+  PythiaDecayContext &operator=(const PythiaDecayContext &context);
+  ~PythiaDecayContext();
+
+  // Bring the table back to the baseline, capturing it on first use
+  static void ActivateBaseline(TPythia6 *pythia);
+  // The table was rewritten (e.g. by Pyupda) after ActivateBaseline: the
+  // current table becomes the new baseline and the existing contexts are
+  // rebased onto it. Entries of channels missing in the new table are dropped.
+  static void ResetBaseline(TPythia6 *pythia);
+
+  // Record the current table; the context becomes the active one
+  void Capture(TPythia6 *pythia);
+  void Activate(TPythia6 *pythia);
+  // Set MDCY(kc,1) in the table and, if captured, in the context
+  void SetMDCY(TPythia6 *pythia, Int_t kc, Int_t value);
+  void Reset();
+
+  Bool_t IsValid() const { return fGeneration != 0 && fGeneration == fgGeneration; }
+  Bool_t IsActive() const { return fgActive == this; }
+  Int_t GetNChanges() const {
+    return (fMSTJ21 != fgMSTJ21) + fMDCY.size() + fMDME.size() + fBRAT.size();
+  }
+
+private:
+  static void CaptureBaseline(TPythia6 *pythia);
+  static void Revert(TPythia6 *pythia, const PythiaDecayContext *context);
+  Int_t Rebase(const std::vector<Int_t> &channelKC, const std::vector<Int_t> &first);
+
+  Int_t fMSTJ21 = 0;                             // MSTJ(21), decays on/off
+  std::vector<std::pair<Int_t, Int_t>> fMDCY;    // (kc - 1, MDCY(kc,1))
+  std::vector<std::pair<Int_t, Int_t>> fMDME;    // (flat index, MDME value)
+  std::vector<std::pair<Int_t, Double_t>> fBRAT; // (channel - 1, BRAT)
+  UInt_t fGeneration = 0;                        // baseline the context refers to
+
+  static Int_t fgMSTJ21;               // baseline MSTJ(21)
+  static std::vector<Int_t> fgMDCY;    // baseline MDCY(kc,1)
+  static std::vector<Int_t> fgMDME;    // baseline MDME, both columns
+  static std::vector<Double_t> fgBRAT; // baseline BRAT
+  static std::vector<Int_t> fgFirst;   // baseline MDCY(kc,2), first channel
+  static std::vector<Int_t> fgNChannels; // baseline MDCY(kc,3), number of channels
+  static std::vector<PythiaDecayContext *> fgContexts; // all existing contexts
+  static UInt_t fgGeneration;          // current baseline, 0 if not captured
+  static PythiaDecayContext *fgActive; // context applied to the table
+};
+#endif
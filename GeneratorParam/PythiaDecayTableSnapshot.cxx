@@ -0,0 +1,158 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Binary image of the Pythia6 particle data and decay tables
+//
+
+#include "PythiaDecayTableSnapshot.h"
+#include <TPythia6.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+const char PythiaDecayTableSnapshot::kMagic[9] = "PY6DECAY";
+
+namespace {
+// header following the magic and the format version
+struct Header {
+  Int_t fPythiaVersion;    // MSTP(181)
+  Int_t fPythiaSubVersion; // MSTP(182)
+  Int_t fNDecay;           // KNDCAY
+  UInt_t fSize[3];         // sizes of Pydat2 KCHG + PMAS, Pydat3, Pydat4
+};
+
+// the blocks in the order they are stored
+struct Block {
+  void *fData;
+  UInt_t fSize;
+};
+
+void Blocks(TPythia6 *pythia, Block *blocks) {
+  Pydat2_t *pydat2 = pythia->GetPydat2();
+  blocks[0] = {pydat2->KCHG, sizeof(pydat2->KCHG)};
+  blocks[1] = {pydat2->PMAS, sizeof(pydat2->PMAS)};
+  blocks[2] = {pythia->GetPydat3(), sizeof(Pydat3_t)};
+  blocks[3] = {pythia->GetPydat4(), sizeof(Pydat4_t)};
+}
+const Int_t kNBlocks = 4;
+
+ULong64_t Checksum(const char *data, size_t n, ULong64_t hash) {
+  // FNV-1a
+  for (size_t i = 0; i < n; i++) {
+    hash ^= (unsigned char)data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+const ULong64_t kChecksumSeed = 14695981039346656037ULL;
+
+Header MakeHeader(TPythia6 *pythia) {
+  Header header;
+  header.fPythiaVersion = pythia->GetMSTP(181);
+  header.fPythiaSubVersion = pythia->GetMSTP(182);
+  header.fNDecay = KNDCAY;
+  header.fSize[0] = sizeof(Pydat2_t::KCHG) + sizeof(Pydat2_t::PMAS);
+  header.fSize[1] = sizeof(Pydat3_t);
+  header.fSize[2] = sizeof(Pydat4_t);
+  return header;
+}
+} // namespace
+
+//____________________________________________________________
+Bool_t PythiaDecayTableSnapshot::Write(TPythia6 *pythia, const char *fileName) {
+  // Written to a temporary file first, so concurrent readers never see a
+  // partial image
+  std::string tmpName = std::string(fileName) + ".tmp" + std::to_string(getpid());
+  std::ofstream out(tmpName, std::ios::binary);
+  if (!out) {
+    printf("PythiaDecayTableSnapshot: ERROR: Cannot open %s\n", tmpName.c_str());
+    return kFALSE;
+  }
+  Header header = MakeHeader(pythia);
+  UInt_t version = kVersion;
+  Block blocks[kNBlocks];
+  Blocks(pythia, blocks);
+  ULong64_t checksum = kChecksumSeed;
+  out.write(kMagic, 8);
+  out.write((const char *)&version, sizeof(version));
+  out.write((const char *)&header, sizeof(header));
+  for (Int_t i = 0; i < kNBlocks; i++) {
+    out.write((const char *)blocks[i].fData, blocks[i].fSize);
+    checksum = Checksum((const char *)blocks[i].fData, blocks[i].fSize, checksum);
+  }
+  out.write((const char *)&checksum, sizeof(checksum));
+  out.close();
+  if (!out || std::rename(tmpName.c_str(), fileName) != 0) {
+    std::remove(tmpName.c_str());
+    printf("PythiaDecayTableSnapshot: ERROR: Could not write %s\n", fileName);
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+Bool_t PythiaDecayTableSnapshot::IsSnapshot(const char *fileName) {
+  std::ifstream in(fileName, std::ios::binary);
+  char magic[8];
+  in.read(magic, 8);
+  return in && !memcmp(magic, kMagic, 8);
+}
+
+//____________________________________________________________
+Bool_t PythiaDecayTableSnapshot::Read(TPythia6 *pythia, const char *fileName) {
+  std::ifstream in(fileName, std::ios::binary);
+  if (!in) {
+    printf("PythiaDecayTableSnapshot: ERROR: Cannot open %s\n", fileName);
+    return kFALSE;
+  }
+  char magic[8];
+  UInt_t version = 0;
+  Header header;
+  in.read(magic, 8);
+  in.read((char *)&version, sizeof(version));
+  in.read((char *)&header, sizeof(header));
+  if (!in || memcmp(magic, kMagic, 8) || version != kVersion) {
+    printf("PythiaDecayTableSnapshot: ERROR: %s is not a decay table snapshot of version %u\n",
+           fileName, kVersion);
+    return kFALSE;
+  }
+  Header expected = MakeHeader(pythia);
+  if (memcmp(&header, &expected, sizeof(Header))) {
+    printf("PythiaDecayTableSnapshot: ERROR: %s was written with Pythia %d.%d, linked is %d.%d\n",
+           fileName, header.fPythiaVersion, header.fPythiaSubVersion,
+           expected.fPythiaVersion, expected.fPythiaSubVersion);
+    return kFALSE;
+  }
+
+  // the image is validated completely before the common blocks are touched
+  Block blocks[kNBlocks];
+  Blocks(pythia, blocks);
+  std::vector<char> image[kNBlocks];
+  ULong64_t checksum = kChecksumSeed, stored = 0;
+  for (Int_t i = 0; i < kNBlocks; i++) {
+    image[i].resize(blocks[i].fSize);
+    in.read(image[i].data(), blocks[i].fSize);
+    checksum = Checksum(image[i].data(), blocks[i].fSize, checksum);
+  }
+  in.read((char *)&stored, sizeof(stored));
+  if (!in || stored != checksum) {
+    printf("PythiaDecayTableSnapshot: ERROR: %s is corrupted\n", fileName);
+    return kFALSE;
+  }
+  for (Int_t i = 0; i < kNBlocks; i++)
+    memcpy(blocks[i].fData, image[i].data(), blocks[i].fSize);
+  // the KF -> KC lookup of Pycomp has to be rebuilt, as after Pyupda
+  pythia->SetMSTU(20, 0);
+  return kTRUE;
+}
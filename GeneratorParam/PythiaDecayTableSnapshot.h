@@ -0,0 +1,36 @@
+#ifndef PYTHIADECAYTABLESNAPSHOT_H
+#define PYTHIADECAYTABLESNAPSHOT_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Binary image of the Pythia6 particle data and decay tables (KCHG, PMAS,
+// MDCY, CHAF, MDME, BRAT, KFDP), i.e. everything Pyupda(3) reads from a
+// text table. The image records the Pythia version (MSTP(181), MSTP(182))
+// and the array sizes and carries a checksum of the payload, so it is only
+// loaded into the Pythia it was written with.
+
+#include <Rtypes.h>
+
+class TPythia6;
+
+class PythiaDecayTableSnapshot {
+public:
+  // Write the current tables of pythia to fileName
+  static Bool_t Write(TPythia6 *pythia, const char *fileName);
+  // Restore the tables from fileName, the tables are untouched on failure
+  static Bool_t Read(TPythia6 *pythia, const char *fileName);
+  // kTRUE if fileName starts like a snapshot
+  static Bool_t IsSnapshot(const char *fileName);
+
+private:
+  static const char kMagic[9];
+  static const UInt_t kVersion = 1;
+};
+#endif
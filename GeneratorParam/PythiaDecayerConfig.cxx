@@ -18,29 +18,36 @@
 // Author: andreas.morsch@cern.ch
 
 #include "PythiaDecayerConfig.h"
+#include "PythiaDecayBuffer.h"
+#include "PythiaDecayTableSnapshot.h"
 #include <TClonesArray.h>
 #include <TPDGCode.h>
 #include <TParticle.h>
 #include <TPythia6.h>
 #include <TRandom.h>
+#include <algorithm>
 
 ClassImp(PythiaDecayerConfig)
 
     PythiaDecayerConfig::PythiaDecayerConfig()
     : TVirtualMCDecayer(), fDecay(kAll), fHeavyFlavour(kTRUE), fLongLived(kFALSE),
-      fPatchOmegaDalitz(0), fDecayerExodus(nullptr), fPi0(1), fDecayToDimuon(0) {
+      fPatchOmegaDalitz(0), fDecayerExodus(nullptr), fPi0(1), fExodusFlags(0), fNNative(0), fDecayToDimuon(0), fNativeDecays(kFALSE) {
   // Default Constructor
   for (Int_t i = 0; i < 501; i++)
     fBraPart[i] = 1.;
+  for (Int_t i = 0; i < kNExodusFlags; i++)
+    fExodusSaved[i] = 1;
 }
 
 PythiaDecayerConfig::PythiaDecayerConfig(const PythiaDecayerConfig &decayer)
     : fDecay(kAll), fHeavyFlavour(kTRUE), fLongLived(kFALSE),
-      fPatchOmegaDalitz(0), fDecayerExodus(nullptr), fPi0(1), fDecayToDimuon(0) {
+      fPatchOmegaDalitz(0), fDecayerExodus(nullptr), fPi0(1), fExodusFlags(0), fNNative(0), fDecayToDimuon(0), fNativeDecays(kFALSE) {
   // Copy Constructor
   decayer.Copy(*this);
   for (Int_t i = 0; i < 501; i++)
     fBraPart[i] = 0.;
+  for (Int_t i = 0; i < kNExodusFlags; i++)
+    fExodusSaved[i] = 1;
 }
 
 void PythiaDecayerConfig::Init() {
@@ -52,6 +59,10 @@ void PythiaDecayerConfig::Init() {
 
   // Switch on heavy flavor decays
   fPythia = TPythia6::Instance();
+  SetExodusFlags(0);
+  // start from the table as it was before any decayer configured it
+  fContext.Reset();
+  PythiaDecayContext::ActivateBaseline(fPythia);
   Int_t kc, i, j;
   Int_t heavy[14] = {411, 421, 431, 4122, 4132, 4232, 4332,
                      511, 521, 531, 5122, 5132, 5232, 5332};
@@ -90,11 +101,14 @@ void PythiaDecayerConfig::Init() {
 
 void PythiaDecayerConfig::SwitchOffParticle(Int_t kf) {
   // switch off decay for particle "kf"
+  ActivateContext();
   fPythia->SetMDCY(fPythia->Pycomp(kf), 1, 0);
+  CaptureContext();
 }
 
 void PythiaDecayerConfig::ForceDecay() {
   // Force a particle decay mode
+  ActivateContext();
   // Switch heavy flavour production off if requested
   if (!fHeavyFlavour)
     SwitchOffHeavyFlavour();
@@ -474,6 +488,7 @@ void PythiaDecayerConfig::ForceDecay() {
   default:
     break;
   }
+  CaptureContext();
 }
 
 void PythiaDecayerConfig::SwitchOffHeavyFlavour() {
@@ -887,10 +902,81 @@ void PythiaDecayerConfig::ForceLambda() {
 
 void PythiaDecayerConfig::SwitchOffBDecay() {
   // Switch off B-decays
+  ActivateContext();
   Int_t heavyB[] = {511, 521, 531, 5122, 5132, 5232, 5332};
   for (int i = 0; i < 4; i++) {
     fPythia->SetMDCY(fPythia->Pycomp(heavyB[i]), 1, 0);
   }
+  CaptureContext();
+}
+
+Int_t PythiaDecayerConfig::PruneDecays(const Int_t *select, Int_t n) {
+  // Switch off the decays of all species which cannot lead to a particle
+  // in select (absolute PDG codes, 0 entries are ignored). Such species are
+  // left undecayed. Selected species keep their decays. Returns the number
+  // of species switched off.
+  std::vector<Int_t> selected;
+  for (Int_t i = 0; i < n; i++)
+    if (select[i])
+      selected.push_back(TMath::Abs(select[i]));
+  if (selected.empty())
+    return 0;
+  ActivateContext();
+  std::vector<Int_t> state(501, 0);
+  Int_t npruned = 0;
+  for (Int_t kc = 1; kc <= 500; kc++) {
+    Int_t kf = fPythia->GetKCHG(kc, 4);
+    if (kf <= 0 || fPythia->GetMDCY(kc, 1) == 0)
+      continue;
+    if (std::find(selected.begin(), selected.end(), kf) != selected.end())
+      continue;
+    Bool_t cycle = kFALSE;
+    if (!LeadsToSelection(kc, selected, state, cycle)) {
+      fPythia->SetMDCY(kc, 1, 0);
+      npruned++;
+    }
+  }
+  CaptureContext();
+  return npruned;
+}
+
+Bool_t PythiaDecayerConfig::LeadsToSelection(Int_t kc, const std::vector<Int_t> &selected,
+                                             std::vector<Int_t> &state, Bool_t &cycle) {
+  // kTRUE if a decay chain of kc through the active channels can produce
+  // a selected particle. Channels with partons in the final state are
+  // assumed to do so. state: 0 unknown, 1 in progress, 2 yes, 3 no.
+  // cycle is set if a species in progress was met; a "no" found then is
+  // only final for the species the search started from and is not kept.
+  if (state[kc] == 1) {
+    cycle = kTRUE;
+    return kFALSE;
+  }
+  if (state[kc] > 1)
+    return state[kc] == 2;
+  state[kc] = 1;
+  Bool_t leads = kFALSE;
+  if (fPythia->GetMDCY(kc, 1) != 0) {
+    Int_t first = fPythia->GetMDCY(kc, 2);
+    for (Int_t idc = first; idc < first + fPythia->GetMDCY(kc, 3) && !leads; idc++) {
+      if (fPythia->GetMDME(idc, 1) <= 0)
+        continue;
+      if (fPythia->GetMDME(idc, 2) >= 100) {
+        leads = kTRUE;
+        break;
+      }
+      for (Int_t j = 1; j <= 5 && !leads; j++) {
+        Int_t kf = TMath::Abs(fPythia->GetKFDP(idc, j));
+        if (kf == 0)
+          continue;
+        Int_t kcp = fPythia->Pycomp(kf);
+        leads = std::find(selected.begin(), selected.end(), kf) != selected.end() ||
+                kcp <= 0 || fPythia->GetKCHG(kcp, 2) != 0 ||
+                LeadsToSelection(kcp, selected, state, cycle);
+      }
+    }
+  }
+  state[kc] = leads ? 2 : (cycle ? 0 : 3);
+  return leads;
 }
 
 Float_t PythiaDecayerConfig::GetPartialBranchingRatio(Int_t kf) {
@@ -907,7 +993,19 @@ Float_t PythiaDecayerConfig::GetLifetime(Int_t kf) {
 
 Int_t PythiaDecayerConfig::ImportParticles(TClonesArray *particles)
 {
-   return fPythia->ImportParticles(particles,"All");
+   if (!fNNative)
+      return fPythia->ImportParticles(particles,"All");
+   // same layout as TPythia6::ImportParticles, links are 1-based
+   TClonesArray &clonesParticles = *particles;
+   clonesParticles.Clear();
+   for (Int_t i = 0; i < fNNative; i++) {
+      const PythiaDecayTrack &track = fNativeTracks[i];
+      new(clonesParticles[i]) TParticle(track.fPdg, track.fStatus, track.fMother + 1, -1,
+                                        track.fFirstDaughter + 1, track.fLastDaughter + 1,
+                                        track.fP[0], track.fP[1], track.fP[2], track.fP[3],
+                                        track.fV[0], track.fV[1], track.fV[2], track.fV[3]);
+   }
+   return fNNative;
 }
 
 void PythiaDecayerConfig::ReadDecayTable()
@@ -916,10 +1014,34 @@ void PythiaDecayerConfig::ReadDecayTable()
       printf("PythiaDeceayerConfig: Warning: ReadDecayTable: No file set\n");
       return;
    }
-   Int_t lun = 15;
-   fPythia->OpenFortranFile(lun,const_cast<char*>(fDecayTableFile.Data()));
-   fPythia->Pyupda(3,lun);
-   fPythia->CloseFortranFile(lun);
+   SetExodusFlags(0);
+   // other decayers keep their configuration on top of the new table
+   PythiaDecayContext::ActivateBaseline(fPythia);
+   if (PythiaDecayTableSnapshot::IsSnapshot(fDecayTableFile.Data())) {
+      // binary image written by WriteDecayTableSnapshot
+      if (!PythiaDecayTableSnapshot::Read(fPythia, fDecayTableFile.Data()))
+         Fatal("ReadDecayTable", "Could not load %s\n", fDecayTableFile.Data());
+   } else {
+      Int_t lun = 15;
+      fPythia->OpenFortranFile(lun,const_cast<char*>(fDecayTableFile.Data()));
+      fPythia->Pyupda(3,lun);
+      fPythia->CloseFortranFile(lun);
+   }
+   // the new table is the reference for all decayers, this one uses it as read
+   PythiaDecayContext::ResetBaseline(fPythia);
+   CaptureContext();
+}
+
+Bool_t PythiaDecayerConfig::WriteDecayTableSnapshot(const char* name)
+{
+   // Binary image of the table as read by ReadDecayTable, to be passed to
+   // SetDecayTableFile in production instead of the text table
+   if (!fPythia)
+      fPythia = TPythia6::Instance();
+   SetExodusFlags(0);
+   if (fContext.IsValid())
+      PythiaDecayContext::ActivateBaseline(fPythia);
+   return PythiaDecayTableSnapshot::Write(fPythia, name);
 }
 
 void PythiaDecayerConfig::Decay(Int_t idpart, TLorentzVector* p) {
@@ -928,367 +1050,182 @@ void PythiaDecayerConfig::Decay(Int_t idpart, TLorentzVector* p) {
   Float_t energy = p->Energy();
   Float_t theta  = p->Theta();
   Float_t phi    = p->Phi();
-  
+
+  // chains with only implemented channels do not need Pythia
+  fNNative = 0;
+  if (fNativeDecays && !fDecayerExodus && fNative.IsInitialised()) {
+    if (fNativeTracks.empty())
+      fNativeTracks.resize(kMaxNativeTracks);
+    Int_t n = fNative.Decay(idpart, *p, gRandom, fNativeTracks.data(), kMaxNativeTracks);
+    if (n > 0) {
+      fNNative = n;
+      return;
+    }
+  }
+
+  // another decayer may have configured the shared table in the meantime
+  if (!fContext.IsActive())
+    ActivateContext();
+
   if(!fDecayerExodus) {
+    SetExodusFlags(0);
     fPythia->Py1ent(0, idpart, energy, theta, phi);
   } else {
 
   // EXODUS decayer
+  // daughters whose kinematics are replaced by Exodus must not be decayed
+  // by Pythia; the flags are only changed when the parent species changes
+    SetExodusFlags(ExodusFlags(idpart));
     fPythia->SetMSTU(10,1);
     fPythia->SetP(1,5,p->M()) ;
-    if(idpart == 111){
-      fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 0);
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      PizeroDalitz();
-      fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 1);
-    }
-    else if(idpart == 221){
-      fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 0);
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      if (fDecayToDimuon == 1) EtaDirect();
-      EtaDalitz();
-      fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 1);
-    }
-    else if(idpart == 113){
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      RhoDirect();
-    }
-    else if(idpart == 223){
-      fPythia->SetMDCY(fPythia->Pycomp(111) ,1, 0);
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      OmegaDirect();
-      OmegaDalitz();
-      fPythia->SetMDCY(fPythia->Pycomp(111) ,1, 1);
-    }
-    else if(idpart == 331){
-      fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 0);
-      if (fDecayToDimuon == 0) fPythia->SetMDCY(fPythia->Pycomp(223) ,1, 0);
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      EtaprimeDalitz();
-      if (fDecayToDimuon == 0) fPythia->SetMDCY(fPythia->Pycomp(223) ,1, 1);
-      fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 1);
-    }
-    else if(idpart == 333){
-      if (fDecayToDimuon == 0) {
-        fPythia->SetMDCY(fPythia->Pycomp(221) ,1, 0);
-        fPythia->SetMDCY(fPythia->Pycomp(111) ,1, 0);
-      } else {
-        fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 0);
-      }
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      PhiDirect();
-      PhiDalitz();
-      if (fDecayToDimuon == 0) {
-        fPythia->SetMDCY(fPythia->Pycomp(111) ,1, 1);
-        fPythia->SetMDCY(fPythia->Pycomp(221) ,1, 1);
-      } else {
-        fPythia->SetMDCY(fPythia->Pycomp(22) ,1, 1);
-      }
-    }
-    else if(idpart == 443){
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      JPsiDirect();
-    }  
-    else if(idpart == 100443){
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      Psi2SDirect();
-    }
-    else if(idpart == 553){
-      fPythia->Py1ent(0, idpart, energy, theta, phi);
-      UpsilonDirect();
-    }
+    fPythia->Py1ent(0, idpart, energy, theta, phi);
+    ExodusPatch(idpart);
   }
   fPythia->SetMSTU(10,2);
   fPythia->GetPrimaries();
 }
 
-void PythiaDecayerConfig::PizeroDalitz(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 111) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 2) continue;
-    if ((fPythia->GetK(fd+1,2) != 22) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 11) ) continue;
-    TLorentzVector pizero(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg+1000*fPythia->GetK(fd+1,2), &pizero);
-    for (Int_t j = 0; j < 3; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_pion())[2-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
-  }
+void PythiaDecayerConfig::CaptureContext() {
+  // Record the table of this decayer, the native decayer follows it
+  fContext.Capture(fPythia);
+  if (fNativeDecays && !fNative.Init(fPythia))
+    printf("PythiaDecayerConfig: Warning: Native decays disabled\n");
 }
 
-void PythiaDecayerConfig::EtaDirect(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 221) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
-    TLorentzVector eta(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &eta);
-    for (Int_t j = 0; j < 2; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_eta())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
-  }
+void PythiaDecayerConfig::ActivateContext() {
+  // Bring the shared decay table into the configuration of this decayer,
+  // with the decays switched off for Exodus restored
+  if (fContext.IsValid())
+    fContext.Activate(fPythia);
+  SetExodusFlags(0);
 }
 
-void PythiaDecayerConfig::EtaDalitz(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 221) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 2) continue;
-    if (fDecayToDimuon == 0) {
-      if ((fPythia->GetK(fd+1,2) != 22) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 11) ) continue;
-    } else {
-      if ((fPythia->GetK(fd+1,2) != 22) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 13) ) continue;
-    }
-    TLorentzVector eta(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg+1000*fPythia->GetK(fd+1,2), &eta);
-    for (Int_t j = 0; j < 3; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_eta_dalitz())[2-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
+Int_t PythiaDecayerConfig::DecayBatch(Int_t n, const Int_t *pdg, const TLorentzVector *p,
+                                      PythiaDecayBuffer &out) {
+  // Decay n parents and append the products of each parent as a block of
+  // out. The products are read from PYJETS (or the native decayer) without
+  // intermediate particle objects. Returns the number of appended entries.
+  Int_t nold = out.GetN();
+  for (Int_t i = 0; i < n; i++) {
+    TLorentzVector pmom(p[i]);
+    Decay(pdg[i], &pmom);
+    Int_t first = out.GetN();
+    out.BeginParent();
+    if (fNNative) {
+      for (Int_t j = 0; j < fNNative; j++) {
+        const PythiaDecayTrack &track = fNativeTracks[j];
+        out.Add(track.fPdg, track.fStatus,
+                (track.fMother < 0) ? -1 : first + track.fMother,
+                (track.fFirstDaughter < 0) ? -1 : first + track.fFirstDaughter,
+                (track.fLastDaughter < 0) ? -1 : first + track.fLastDaughter,
+                track.fP, track.fV);
       }
+      continue;
     }
-  }
-}
-
-void PythiaDecayerConfig::RhoDirect(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 113) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if (fDecayToDimuon == 0) {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 11)) continue;
-    } else {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
-    }
-    TLorentzVector rho(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &rho);
-    for (Int_t j = 0; j < 2; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_rho())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
+    // links in PYJETS are 1-based, 0 if there is none
+    Pyjets_t *pyjets = fPythia->GetPyjets();
+    for (Int_t j = 0; j < pyjets->N; j++) {
+      Double_t pj[4] = {pyjets->P[0][j], pyjets->P[1][j], pyjets->P[2][j], pyjets->P[3][j]};
+      Double_t vj[4] = {pyjets->V[0][j], pyjets->V[1][j], pyjets->V[2][j], pyjets->V[3][j]};
+      out.Add(pyjets->K[1][j], pyjets->K[0][j],
+              (pyjets->K[2][j] > 0) ? first + pyjets->K[2][j] - 1 : -1,
+              (pyjets->K[3][j] > 0) ? first + pyjets->K[3][j] - 1 : -1,
+              (pyjets->K[3][j] > 0) ? first + pyjets->K[4][j] - 1 : -1, pj, vj);
     }
   }
+  return out.GetN() - nold;
 }
 
-void PythiaDecayerConfig::OmegaDalitz(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 223) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 2) continue;
-    if (fDecayToDimuon == 0) {
-      if ((fPythia->GetK(fd+1,2) != 111) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 11)) continue;
-    } else {
-      if ((fPythia->GetK(fd+1,2) != 111) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 13)) continue;
-    }
-    TLorentzVector omegadalitz(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg+1000*fPythia->GetK(fd+1,2), &omegadalitz);
-    for (Int_t j = 0; j < 3; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_omega_dalitz())[2-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
-  }
-}
-
-void PythiaDecayerConfig::OmegaDirect(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 223) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if (fDecayToDimuon == 0) {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 11)) continue;
-    } else {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
-    }
-    TLorentzVector omegadirect(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &omegadirect);
-    for (Int_t j = 0; j < 2; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_omega())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
+UInt_t PythiaDecayerConfig::ExodusFlags(Int_t idpart) const {
+  // Decays to be switched off while a parent of type idpart is decayed
+  switch (idpart) {
+  case 111:
+  case 221:
+    return kExodusGamma;
+  case 223:
+    return kExodusPi0;
+  case 331:
+    return (fDecayToDimuon == 0) ? (kExodusGamma | kExodusOmega) : kExodusGamma;
+  case 333:
+    return (fDecayToDimuon == 0) ? (kExodusEta | kExodusPi0) : kExodusGamma;
   }
+  return 0;
 }
 
-void PythiaDecayerConfig::EtaprimeDalitz(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 331) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 2) continue;
-    if (fDecayToDimuon == 0) {
-      if ((fPythia->GetK(fd+1,2) != 22 && fPythia->GetK(fd+1,2) != 223) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 11)) continue;
+void PythiaDecayerConfig::SetExodusFlags(UInt_t flags) {
+  // Switch off the decays in flags and restore all others. The changes
+  // are part of the context, so they are reverted and reapplied with it.
+  static const Int_t kf[kNExodusFlags] = {22, 111, 221, 223};
+  UInt_t change = flags ^ fExodusFlags;
+  if (!change) return;
+  for (Int_t i = 0; i < kNExodusFlags; i++) {
+    if (!(change & (1 << i))) continue;
+    Int_t kc = fPythia->Pycomp(kf[i]);
+    if (flags & (1 << i)) {
+      if (fContext.IsValid())
+        fContext.Activate(fPythia);
+      fExodusSaved[i] = fPythia->GetMDCY(kc, 1);
+      fContext.SetMDCY(fPythia, kc, 0);
     } else {
-      if (fPythia->GetK(fd+1,2) != 22 || (TMath::Abs(fPythia->GetK(fd+2,2)) != 13)) continue;
-    }
-    TLorentzVector etaprime(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg+1000*fPythia->GetK(fd+1,2), &etaprime);
-    for (Int_t j = 0; j < 3; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_etaprime())[2-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
+      fContext.SetMDCY(fPythia, kc, fExodusSaved[i]);
     }
   }
+  fExodusFlags = flags;
 }
 
-void PythiaDecayerConfig::PhiDalitz(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 333) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 2) continue;
-    if (fDecayToDimuon == 0) {
-      if ((fPythia->GetK(fd+1,2) != 221 && fPythia->GetK(fd+1,2) != 111 ) || (TMath::Abs(fPythia->GetK(fd+2,2)) != 11)) continue;
-    } else {
-      if (fPythia->GetK(fd+1,2) != 22 || (TMath::Abs(fPythia->GetK(fd+2,2)) != 13)) continue;
-    }
-    TLorentzVector phidalitz(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg+1000*fPythia->GetK(fd+1,2), &phidalitz);
-    for (Int_t j = 0; j < 3; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_phi_dalitz())[2-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
+Bool_t PythiaDecayerConfig::IsExodusChannel(Int_t idpart, Int_t partner) const {
+  // Channels patched by Exodus, partner = 0 for the direct decay into a
+  // lepton pair and the third daughter for Dalitz decays
+  if (partner == 0) {
+    switch (idpart) {
+    case 113: case 223: case 333: case 443: case 100443: case 553:
+      return kTRUE;
+    case 221:
+      return (fDecayToDimuon == 1);
     }
+    return kFALSE;
   }
-}
-
-void PythiaDecayerConfig::PhiDirect(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 333) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if (fDecayToDimuon == 0) {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 11)) continue;
-    } else {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
-    }
-    TLorentzVector phi(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &phi);
-    for (Int_t j = 0; j < 2; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_phi())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
-  }
-}
-
-void PythiaDecayerConfig::JPsiDirect(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 443) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if (fDecayToDimuon == 0) {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 11)) continue;
-    } else {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
-    }
-    TLorentzVector jpsi(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &jpsi);
-    for (Int_t j = 0; j < 2; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_jpsi())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
-  }
-}
-
-void PythiaDecayerConfig::Psi2SDirect(){
-  Int_t nt = fPythia->GetN();
-  for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 100443) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
-    if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if (fDecayToDimuon == 0) {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 11)) continue;
-    } else {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
-    }
-    TLorentzVector psi2s(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &psi2s);
-    for (Int_t j = 0; j < 2; j++) {
-      for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_psi2s())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
-      }
-    }
+  switch (idpart) {
+  case 111: case 221:
+    return (partner == 22);
+  case 223:
+    return (partner == 111);
+  case 331:
+    return (partner == 22 || (partner == 223 && fDecayToDimuon == 0));
+  case 333:
+    if (fDecayToDimuon == 0) return (partner == 221 || partner == 111);
+    return (partner == 22);
   }
+  return kFALSE;
 }
 
-void PythiaDecayerConfig::UpsilonDirect(){
-  Int_t nt = fPythia->GetN();
+void PythiaDecayerConfig::ExodusPatch(Int_t idpart) {
+  // One pass over PYJETS: every decay of the parent species into a lepton
+  // pair (direct or Dalitz) gets its daughter momenta from Exodus
+  Pyjets_t *jets = fPythia->GetPyjets();
+  Int_t lepton = (fDecayToDimuon == 0) ? 11 : 13;
+  ExodusTrack products[ExodusDecayer::kMaxTracks];
+  Int_t nt = jets->N;
   for (Int_t i = 0; i < nt; i++) {
-    if (fPythia->GetK(i+1,2) != 553) continue;
-    Int_t fd = fPythia->GetK(i+1,4) - 1;
-    Int_t ld = fPythia->GetK(i+1,5) - 1;
+    if (jets->K[1][i] != idpart) continue;
+    Int_t fd = jets->K[3][i] - 1;
     if (fd < 0) continue;
-    if ((ld - fd) != 1) continue;
-    if (fDecayToDimuon == 0) {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 11)) continue;
+    Int_t nd = jets->K[4][i] - jets->K[3][i] + 1;
+    Int_t partner;
+    if (nd == 2) {
+      partner = 0;
+      if (TMath::Abs(jets->K[1][fd]) != lepton || !IsExodusChannel(idpart, partner)) continue;
+    } else if (nd == 3) {
+      partner = jets->K[1][fd];
+      if (TMath::Abs(jets->K[1][fd+1]) != lepton || !IsExodusChannel(idpart, partner)) continue;
     } else {
-      if ((TMath::Abs(fPythia->GetK(fd+1,2)) != 13)) continue;
+      continue;
     }
-    TLorentzVector upsilon(fPythia->GetP(i+1,1), fPythia->GetP(i+1,2), fPythia->GetP(i+1,3), fPythia->GetP(i+1,4));
-    Int_t pdg = TMath::Abs(fPythia->GetK(i+1,2));
-    fDecayerExodus->Decay(pdg, &upsilon);
-    for (Int_t j = 0; j < 2; j++) {
+    TLorentzVector parent(jets->P[0][i], jets->P[1][i], jets->P[2][i], jets->P[3][i]);
+    if (fDecayerExodus->Decay(idpart, partner, parent, gRandom, products, ExodusDecayer::kMaxTracks) != nd + 1) continue;
+    for (Int_t j = 0; j < nd; j++) {
       for (Int_t k = 0; k < 4; k++) {
-        TLorentzVector vec = (fDecayerExodus->Products_upsilon())[1-j];
-        fPythia->SetP(fd+j+1,k+1,vec[k]);
+        jets->P[k][fd+j] = products[j+1].fP[k];
       }
     }
   }
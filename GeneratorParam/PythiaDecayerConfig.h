@@ -21,8 +21,12 @@
 
 #include <TLorentzVector.h>
 #include "ExodusDecayer.h"
+#include "PythiaDecayContext.h"
+#include "PythiaNativeDecayer.h"
+#include <vector>
 
 class TPythia6;
+class PythiaDecayBuffer;
 
 typedef enum {
   kBSemiElectronic,
@@ -102,25 +106,22 @@ public:
   virtual Float_t GetLifetime(Int_t kf);
   virtual Int_t ImportParticles(TClonesArray *particles);
   virtual void ReadDecayTable();
+  // Text table read by Pyupda or a binary snapshot of it
   virtual void SetDecayTableFile(const char* name) {fDecayTableFile = name;}
+  Bool_t WriteDecayTableSnapshot(const char* name);
   virtual void Decay(Int_t idpart, TLorentzVector* p);
+  // Decay n parents into a columnar buffer, one block per parent
+  Int_t DecayBatch(Int_t n, const Int_t *pdg, const TLorentzVector *p,
+                   PythiaDecayBuffer &out);
   virtual void SwitchOffBDecay();
   virtual void SwitchOffPi0() { fPi0 = 0; }
   virtual void SwitchOffParticle(Int_t kf);
+  // Leave species undecayed whose decays cannot produce any of select
+  Int_t PruneDecays(const Int_t *select, Int_t n);
   virtual void DecayToDimuons(){fDecayToDimuon = 1;}
-
-  void PizeroDalitz();
-  void EtaDirect();
-  void EtaDalitz();
-  void RhoDirect();
-  void OmegaDalitz();
-  void OmegaDirect();
-  void EtaprimeDalitz();
-  void PhiDalitz();
-  void PhiDirect();
-  void JPsiDirect();
-  void Psi2SDirect();
-  void UpsilonDirect();
+  // Decay parents whose full chain is implemented by PythiaNativeDecayer
+  // without calling Pythia. Not used together with Exodus.
+  virtual void SetNativeDecays(Bool_t flag = kTRUE) {fNativeDecays = flag;}
 
 private:
   Int_t CountProducts(Int_t channel, Int_t particle);
@@ -135,6 +136,14 @@ private:
   void ForceBeautyUpgrade();
   void ForceHFYellowReport();
   Float_t GetBraPart(Int_t kf);
+  Bool_t LeadsToSelection(Int_t kc, const std::vector<Int_t> &selected,
+                          std::vector<Int_t> &state, Bool_t &cycle);
+  void CaptureContext();
+  void ActivateContext();
+  UInt_t ExodusFlags(Int_t idpart) const;
+  void SetExodusFlags(UInt_t flags);
+  Bool_t IsExodusChannel(Int_t idpart, Int_t partner) const;
+  void ExodusPatch(Int_t idpart);
   void Copy(TObject &decayer) const;
 
   PythiaDecayerConfig &operator=(const PythiaDecayerConfig &decayerconfig) {
@@ -152,9 +161,19 @@ private:
   ExodusDecayer *fDecayerExodus;    //! Pointer to EXODUS decayer
   Bool_t fPi0;              //! Flag for pi0 decay
   static Bool_t fgInit;     //! initialization flag
+  // decays switched off during Exodus patching: gamma, pi0, eta, omega
+  enum { kExodusGamma = 1, kExodusPi0 = 2, kExodusEta = 4, kExodusOmega = 8, kNExodusFlags = 4 };
+  UInt_t fExodusFlags;                  //! decays switched off in fContext
+  Int_t fExodusSaved[kNExodusFlags];    //! MDCY(kc,1) before switching off
+  PythiaDecayContext fContext;  //! decay table configuration of this decayer
+  PythiaNativeDecayer fNative;  //! decay table imported for native decays
+  enum { kMaxNativeTracks = 4000 }; // as PYJETS
+  std::vector<PythiaDecayTrack> fNativeTracks; //! output of the native decayer
+  Int_t fNNative;           //! entries of the last native decay, 0 if Pythia
   TString fDecayTableFile;   // Decay table to be read
   Bool_t fDecayToDimuon;    // Decay to dimuons instead of dielectrons
+  Bool_t fNativeDecays;     // Use native decays where possible
 
-  ClassDef(PythiaDecayerConfig, 1) // AliDecayer implementation using Pythia
+  ClassDef(PythiaDecayerConfig, 2) // AliDecayer implementation using Pythia
 };
 #endif
@@ -0,0 +1,478 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Hadron decays in C++ driven by the Pythia6 decay table
+//
+
+#include "PythiaNativeDecayer.h"
+#include <TLorentzVector.h>
+#include <TMath.h>
+#include <TPythia6.h>
+#include <TRandom.h>
+#include <algorithm>
+
+namespace {
+const Int_t kNKC = 500;      // size of the compressed code tables
+const Int_t kMaxDepth = 20;  // maximum length of a decay chain
+const Int_t kMaxTries = 100; // attempts to find an open channel
+} // namespace
+
+//____________________________________________________________
+Bool_t PythiaNativeDecayer::Init(TPythia6 *pythia) {
+  fInit = kFALSE;
+  fSpecies.assign(kNKC + 1, Species());
+  fChannels.clear();
+  fKC.clear();
+
+  Int_t mstj22 = pythia->GetMSTJ(22);
+  if (mstj22 > 2) {
+    printf("PythiaNativeDecayer: ERROR: Decay volume MSTJ(22) = %d not implemented\n", mstj22);
+    return kFALSE;
+  }
+  fDecayShortOnly = (mstj22 == 2);
+  fCTauMax = pythia->GetPARJ(71);
+  Bool_t decays = (pythia->GetMSTJ(21) != 0);
+
+  // particle data, coloured objects cannot be handled
+  for (Int_t kc = 1; kc <= kNKC; kc++) {
+    Species &species = fSpecies[kc];
+    species.fKF = pythia->GetKCHG(kc, 4);
+    if (species.fKF <= 0)
+      continue;
+    fKC[species.fKF] = kc;
+    species.fAnti = (pythia->GetKCHG(kc, 3) == 1);
+    species.fMass = pythia->GetPMAS(kc, 1);
+    species.fWidth = pythia->GetPMAS(kc, 2);
+    species.fMaxDev = pythia->GetPMAS(kc, 3);
+    species.fCTau = pythia->GetPMAS(kc, 4);
+    species.fDecays = decays && pythia->GetMDCY(kc, 1) != 0 &&
+                      (!fDecayShortOnly || species.fCTau <= fCTauMax);
+    if (pythia->GetKCHG(kc, 2) != 0)
+      species.fSupported = -1;
+  }
+
+  // channels switched on for particle and antiparticle
+  for (Int_t kc = 1; kc <= kNKC; kc++) {
+    Species &species = fSpecies[kc];
+    if (!species.fDecays)
+      continue;
+    std::vector<Double_t> weights[2];
+    Int_t first = pythia->GetMDCY(kc, 2);
+    for (Int_t idc = first; idc < first + pythia->GetMDCY(kc, 3); idc++) {
+      Int_t onoff = pythia->GetMDME(idc, 1);
+      if (onoff == 4 || onoff == 5)
+        species.fSupported = -1; // correlated decays of pairs
+      Bool_t on[2] = {onoff == 1 || onoff == 2, onoff == 1 || onoff == 3};
+      Double_t br = pythia->GetBRAT(idc);
+      if (!(on[0] || on[1]) || br <= 0.)
+        continue;
+      Channel channel;
+      channel.fME = pythia->GetMDME(idc, 2);
+      channel.fN = 0;
+      for (Int_t j = 1; j <= 5; j++) {
+        Int_t kf = pythia->GetKFDP(idc, j);
+        if (kf == 0)
+          continue;
+        channel.fKC[channel.fN] = Compress(TMath::Abs(kf));
+        channel.fSign[channel.fN] = (kf > 0) ? 1 : -1;
+        channel.fN++;
+      }
+      fChannels.push_back(channel);
+      for (Int_t anti = 0; anti < 2; anti++) {
+        if (!on[anti])
+          continue;
+        species.fChannel[anti].push_back(fChannels.size() - 1);
+        weights[anti].push_back(br);
+      }
+    }
+    for (Int_t anti = 0; anti < 2; anti++)
+      if (!weights[anti].empty())
+        species.fSelect[anti].Set(weights[anti]);
+    if (species.fChannel[0].empty() && species.fChannel[1].empty())
+      species.fDecays = kFALSE;
+  }
+
+  for (Int_t kc = 1; kc <= kNKC; kc++)
+    if (fSpecies[kc].fKF > 0)
+      CheckSupported(kc);
+  fInit = kTRUE;
+  return kTRUE;
+}
+
+//____________________________________________________________
+Int_t PythiaNativeDecayer::Compress(Int_t pdg) const {
+  // Compressed code, 0 if unknown. Negative codes need an antiparticle.
+  auto it = fKC.find(TMath::Abs(pdg));
+  if (it == fKC.end())
+    return 0;
+  if (pdg < 0 && !fSpecies[it->second].fAnti)
+    return 0;
+  return it->second;
+}
+
+//____________________________________________________________
+Bool_t PythiaNativeDecayer::CheckSupported(Int_t kc) {
+  // A species is supported if all channels it can decay into are
+  // implemented, all products are supported themselves and the chain is
+  // shorter than kMaxDepth. Species reaching a cycle are not supported.
+  Species &species = fSpecies[kc];
+  if (species.fSupported == 2) {
+    printf("PythiaNativeDecayer: Warning: decay cycle through %d, not decayed natively\n", species.fKF);
+    return kFALSE;
+  }
+  if (species.fSupported != 0)
+    return species.fSupported > 0;
+  species.fSupported = 2;
+  Bool_t ok = kTRUE;
+  Int_t length = 0;
+  for (Int_t anti = 0; anti < 2 && ok && species.fDecays; anti++) {
+    for (auto idc : species.fChannel[anti]) {
+      const Channel &channel = fChannels[idc];
+      if (channel.fME == 1) {
+        ok = (channel.fN == 3);
+      } else if (channel.fME == 2) {
+        Int_t ngamma = 0;
+        for (Int_t j = 0; j < channel.fN; j++)
+          if (fSpecies[channel.fKC[j]].fKF == 22)
+            ngamma++;
+        ok = (channel.fN == 3 && ngamma == 1);
+      } else {
+        ok = (channel.fME == 0 && channel.fN > 0);
+      }
+      for (Int_t j = 0; j < channel.fN && ok; j++) {
+        ok = (channel.fKC[j] > 0 && CheckSupported(channel.fKC[j]));
+        if (ok)
+          length = TMath::Max(length, fSpecies[channel.fKC[j]].fChainLength + 1);
+      }
+      if (!ok)
+        break;
+    }
+  }
+  ok = ok && length < kMaxDepth;
+  species.fChainLength = length;
+  species.fSupported = ok ? 1 : -1;
+  return ok;
+}
+
+//____________________________________________________________
+Bool_t PythiaNativeDecayer::IsSupported(Int_t pdg) const {
+  Int_t kc = Compress(pdg);
+  return fInit && kc > 0 && fSpecies[kc].fSupported > 0;
+}
+
+//____________________________________________________________
+Double_t PythiaNativeDecayer::Pdk(Double_t a, Double_t b, Double_t c) {
+  // Momentum of the products in the two-body decay a -> b c
+  Double_t x = (a - b - c) * (a + b + c) * (a - b + c) * (a + b - c);
+  return (x > 0.) ? TMath::Sqrt(x) / (2. * a) : 0.;
+}
+
+//____________________________________________________________
+void PythiaNativeDecayer::Boost(const Double_t *parent, Double_t *p) {
+  // Boost p (px, py, pz, E) from the rest frame of parent (px, py, pz, E, m)
+  Double_t bx = parent[0] / parent[3];
+  Double_t by = parent[1] / parent[3];
+  Double_t bz = parent[2] / parent[3];
+  Double_t b2 = bx * bx + by * by + bz * bz;
+  if (b2 <= 0.)
+    return;
+  Double_t gamma = parent[3] / parent[4];
+  Double_t bp = bx * p[0] + by * p[1] + bz * p[2];
+  Double_t gamma2 = (gamma - 1.) / b2;
+  Double_t f = gamma2 * bp + gamma * p[3];
+  p[0] += f * bx;
+  p[1] += f * by;
+  p[2] += f * bz;
+  p[3] = gamma * (p[3] + bp);
+}
+
+//____________________________________________________________
+Double_t PythiaNativeDecayer::SampleMass(const Species &species, Double_t mmax,
+                                         TRandom *ran) const {
+  // Breit-Wigner truncated at the nominal mass +- fMaxDev and at mmax,
+  // sampled by inversion
+  if (species.fWidth <= 0. || species.fMaxDev <= 0.)
+    return species.fMass;
+  Double_t lo = TMath::Max(species.fMass - species.fMaxDev, 0.);
+  Double_t hi = TMath::Min(species.fMass + species.fMaxDev, mmax);
+  if (hi <= lo)
+    return species.fMass;
+  Double_t hw = 0.5 * species.fWidth;
+  Double_t a = TMath::ATan((lo - species.fMass) / hw);
+  Double_t b = TMath::ATan((hi - species.fMass) / hw);
+  return species.fMass + hw * TMath::Tan(a + ran->Rndm() * (b - a));
+}
+
+//____________________________________________________________
+Bool_t PythiaNativeDecayer::PhaseSpace(Int_t np, const Double_t *mass,
+                                       Double_t mparent, TRandom *ran,
+                                       Double_t (*p)[4], Double_t &weight) const {
+  // n-body phase space in the parent rest frame (Raubold-Lynch, as in
+  // TGenPhaseSpace). weight is normalised to its maximum.
+  Double_t tecm = mparent;
+  for (Int_t i = 0; i < np; i++)
+    tecm -= mass[i];
+  if (tecm <= 0.)
+    return kFALSE;
+
+  Double_t invMas[5], pd[5], rno[5];
+  Double_t emmax = tecm + mass[0];
+  Double_t emmin = 0.;
+  Double_t wtmax = 1.;
+  for (Int_t i = 1; i < np; i++) {
+    emmin += mass[i - 1];
+    emmax += mass[i];
+    wtmax *= Pdk(emmax, emmin, mass[i]);
+  }
+  rno[0] = 0.;
+  for (Int_t i = 1; i < np - 1; i++)
+    rno[i] = ran->Rndm();
+  std::sort(rno + 1, rno + np - 1);
+  rno[np - 1] = 1.;
+  Double_t sum = 0.;
+  for (Int_t i = 0; i < np; i++) {
+    sum += mass[i];
+    invMas[i] = rno[i] * tecm + sum;
+  }
+  Double_t wt = 1.;
+  for (Int_t i = 0; i < np - 1; i++) {
+    pd[i] = Pdk(invMas[i + 1], invMas[i], mass[i + 1]);
+    wt *= pd[i];
+  }
+  weight = (wtmax > 0.) ? wt / wtmax : 1.;
+
+  p[0][0] = 0.;
+  p[0][1] = pd[0];
+  p[0][2] = 0.;
+  p[0][3] = TMath::Sqrt(pd[0] * pd[0] + mass[0] * mass[0]);
+  p[1][0] = 0.;
+  p[1][1] = -pd[0];
+  p[1][2] = 0.;
+  p[1][3] = TMath::Sqrt(pd[0] * pd[0] + mass[1] * mass[1]);
+  for (Int_t i = 1;; i++) {
+    // random rotation of the particles generated so far
+    Double_t cz = 2. * ran->Rndm() - 1.;
+    Double_t sz = TMath::Sqrt(1. - cz * cz);
+    Double_t angY = 2. * TMath::Pi() * ran->Rndm();
+    Double_t cy = TMath::Cos(angY);
+    Double_t sy = TMath::Sin(angY);
+    for (Int_t j = 0; j <= i; j++) {
+      Double_t x = cz * p[j][0] - sz * p[j][1];
+      Double_t y = sz * p[j][0] + cz * p[j][1];
+      Double_t z = p[j][2];
+      p[j][0] = cy * x + sy * z;
+      p[j][1] = y;
+      p[j][2] = -sy * x + cy * z;
+    }
+    if (i == np - 1)
+      break;
+    // boost along y into the rest frame of the next subsystem
+    Double_t beta = pd[i] / TMath::Sqrt(pd[i] * pd[i] + invMas[i] * invMas[i]);
+    Double_t gamma = 1. / TMath::Sqrt(1. - beta * beta);
+    for (Int_t j = 0; j <= i; j++) {
+      Double_t e = p[j][3];
+      p[j][3] = gamma * (e + beta * p[j][1]);
+      p[j][1] = gamma * (p[j][1] + beta * e);
+    }
+    p[i + 1][0] = 0.;
+    p[i + 1][1] = -pd[i];
+    p[i + 1][2] = 0.;
+    p[i + 1][3] = TMath::Sqrt(pd[i] * pd[i] + mass[i + 1] * mass[i + 1]);
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+void PythiaNativeDecayer::Dalitz(const Double_t *mass, Int_t igamma,
+                                 Double_t mparent, TRandom *ran,
+                                 Double_t (*p)[4]) const {
+  // P -> gamma l+ l- in the parent rest frame. The pair mass follows
+  // Kroll-Wada, the lepton angle in the pair frame 1 + cos^2 + 4 ml^2/m^2 sin^2
+  Int_t il1 = (igamma == 0) ? 1 : 0;
+  Int_t il2 = (igamma == 2) ? 1 : 2;
+  Double_t ml2 = mass[il1] * mass[il1];
+  Double_t mmin2 = (mass[il1] + mass[il2]) * (mass[il1] + mass[il2]);
+  Double_t mmax2 = (mparent - mass[igamma]) * (mparent - mass[igamma]);
+  Double_t m2, ratio;
+  do {
+    // dm^2/m^2 times the remaining factors, which are bounded by 1
+    m2 = mmin2 * TMath::Power(mmax2 / mmin2, ran->Rndm());
+    ratio = 1. - m2 / (mparent * mparent);
+  } while ((1. + 2. * ml2 / m2) * TMath::Sqrt(TMath::Max(1. - 4. * ml2 / m2, 0.)) *
+               ratio * ratio * ratio < ran->Rndm());
+  Double_t m = TMath::Sqrt(m2);
+
+  // photon and pair back to back
+  Double_t pg = Pdk(mparent, mass[igamma], m);
+  Double_t cost = 2. * ran->Rndm() - 1.;
+  Double_t sint = TMath::Sqrt(1. - cost * cost);
+  Double_t phi = 2. * TMath::Pi() * ran->Rndm();
+  Double_t n[3] = {sint * TMath::Cos(phi), sint * TMath::Sin(phi), cost};
+  for (Int_t k = 0; k < 3; k++)
+    p[igamma][k] = pg * n[k];
+  p[igamma][3] = TMath::Sqrt(pg * pg + mass[igamma] * mass[igamma]);
+  Double_t pair[5] = {-pg * n[0], -pg * n[1], -pg * n[2], TMath::Sqrt(pg * pg + m2), m};
+
+  // lepton direction relative to the pair direction n
+  Double_t c;
+  do {
+    c = 2. * ran->Rndm() - 1.;
+  } while (0.5 * (1. + c * c + 4. * ml2 / m2 * (1. - c * c)) < ran->Rndm());
+  Double_t s = TMath::Sqrt(1. - c * c);
+  Double_t psi = 2. * TMath::Pi() * ran->Rndm();
+  Double_t u[3] = {cost * TMath::Cos(phi), cost * TMath::Sin(phi), -sint};
+  Double_t v[3] = {-TMath::Sin(phi), TMath::Cos(phi), 0.};
+  Double_t pl = Pdk(m, mass[il1], mass[il2]);
+  for (Int_t k = 0; k < 3; k++) {
+    Double_t d = c * n[k] + s * (TMath::Cos(psi) * u[k] + TMath::Sin(psi) * v[k]);
+    p[il1][k] = pl * d;
+    p[il2][k] = -pl * d;
+  }
+  p[il1][3] = TMath::Sqrt(pl * pl + ml2);
+  p[il2][3] = TMath::Sqrt(pl * pl + mass[il2] * mass[il2]);
+  Boost(pair, p[il1]);
+  Boost(pair, p[il2]);
+}
+
+//____________________________________________________________
+Bool_t PythiaNativeDecayer::DecayTrack(Int_t i, TRandom *ran,
+                                       PythiaDecayTrack *out, Int_t &n,
+                                       Int_t nmax) const {
+  // Decay out[i] if it is unstable, the products are appended at n.
+  // kFALSE if no channel is kinematically open or the buffer is full.
+  PythiaDecayTrack &track = out[i];
+  const Species &species = fSpecies[Compress(track.fPdg)];
+  Int_t anti = (track.fPdg < 0) ? 1 : 0;
+  if (!species.fDecays || species.fChannel[anti].empty())
+    return kTRUE;
+  Double_t mparent = track.fP[4];
+
+  Double_t mass[5], p[5][4];
+  const Channel *channel = nullptr;
+  for (Int_t itry = 0; itry < kMaxTries && !channel; itry++) {
+    const Channel &candidate =
+        fChannels[species.fChannel[anti][species.fSelect[anti].Sample(ran->Rndm())]];
+    Double_t summin = 0.;
+    for (Int_t j = 0; j < candidate.fN; j++) {
+      const Species &product = fSpecies[candidate.fKC[j]];
+      summin += product.fMass - ((product.fWidth > 0.) ? product.fMaxDev : 0.);
+    }
+    if (candidate.fN == 1) {
+      mass[0] = mparent;
+      channel = &candidate;
+      break;
+    }
+    for (Int_t imass = 0; imass < 10 && !channel; imass++) {
+      Double_t sum = 0.;
+      for (Int_t j = 0; j < candidate.fN; j++) {
+        const Species &product = fSpecies[candidate.fKC[j]];
+        Double_t mmin = product.fMass - ((product.fWidth > 0.) ? product.fMaxDev : 0.);
+        mass[j] = SampleMass(product, mparent - summin + mmin, ran);
+        sum += mass[j];
+      }
+      if (sum < mparent)
+        channel = &candidate;
+    }
+  }
+  if (!channel)
+    return kFALSE;
+  Int_t np = channel->fN;
+  if (n + np > nmax)
+    return kFALSE;
+
+  // momenta in the rest frame
+  if (np == 1) {
+    p[0][0] = p[0][1] = p[0][2] = 0.;
+    p[0][3] = mparent;
+  } else if (channel->fME == 2) {
+    Int_t igamma = 0;
+    while (fSpecies[channel->fKC[igamma]].fKF != 22)
+      igamma++;
+    Dalitz(mass, igamma, mparent, ran, p);
+  } else {
+    Double_t bound = 1.;
+    if (channel->fME == 1) {
+      // |p1 x p2|^2 for omega/phi -> 3 pi, bounded by the maximum momenta
+      bound = Pdk(mparent, mass[0], mass[1] + mass[2]) *
+              Pdk(mparent, mass[1], mass[0] + mass[2]);
+      bound *= bound;
+    }
+    Double_t weight;
+    do {
+      PhaseSpace(np, mass, mparent, ran, p, weight);
+      if (channel->fME == 1) {
+        Double_t cx = p[0][1] * p[1][2] - p[0][2] * p[1][1];
+        Double_t cy = p[0][2] * p[1][0] - p[0][0] * p[1][2];
+        Double_t cz = p[0][0] * p[1][1] - p[0][1] * p[1][0];
+        weight *= (cx * cx + cy * cy + cz * cz) / bound;
+      }
+    } while (weight < ran->Rndm());
+  }
+
+  // decay point from the proper lifetime
+  Double_t tau = (species.fCTau > 0.) ? -species.fCTau * TMath::Log(ran->Rndm()) : 0.;
+  Double_t vertex[4];
+  for (Int_t k = 0; k < 3; k++)
+    vertex[k] = track.fV[k] + tau * track.fP[k] / mparent;
+  vertex[3] = track.fV[3] + tau * track.fP[3] / mparent;
+  track.fV[4] = tau;
+  track.fStatus = 11;
+  track.fFirstDaughter = n;
+  track.fLastDaughter = n + np - 1;
+
+  for (Int_t j = 0; j < np; j++) {
+    const Species &product = fSpecies[channel->fKC[j]];
+    PythiaDecayTrack &daughter = out[n + j];
+    Int_t sign = anti ? -channel->fSign[j] : channel->fSign[j];
+    daughter.fStatus = 1;
+    daughter.fPdg = (product.fAnti && sign < 0) ? -product.fKF : product.fKF;
+    daughter.fMother = i;
+    daughter.fFirstDaughter = -1;
+    daughter.fLastDaughter = -1;
+    Boost(out[i].fP, p[j]);
+    for (Int_t k = 0; k < 4; k++) {
+      daughter.fP[k] = p[j][k];
+      daughter.fV[k] = vertex[k];
+    }
+    daughter.fP[4] = mass[j];
+    daughter.fV[4] = 0.;
+  }
+  n += np;
+  return kTRUE;
+}
+
+//____________________________________________________________
+Int_t PythiaNativeDecayer::Decay(Int_t pdg, const TLorentzVector &pparent,
+                                 TRandom *ran, PythiaDecayTrack *out,
+                                 Int_t nmax) const {
+  if (!IsSupported(pdg) || nmax < 1)
+    return -1;
+  PythiaDecayTrack &parent = out[0];
+  parent.fStatus = 1;
+  parent.fPdg = pdg;
+  parent.fMother = -1;
+  parent.fFirstDaughter = -1;
+  parent.fLastDaughter = -1;
+  parent.fP[0] = pparent.Px();
+  parent.fP[1] = pparent.Py();
+  parent.fP[2] = pparent.Pz();
+  parent.fP[3] = pparent.E();
+  parent.fP[4] = pparent.M();
+  for (Int_t k = 0; k < 5; k++)
+    parent.fV[k] = 0.;
+
+  // the products are appended behind the record, as in PYJETS
+  Int_t n = 1;
+  for (Int_t i = 0; i < n; i++)
+    if (!DecayTrack(i, ran, out, n, nmax))
+      return -1;
+  return n;
+}
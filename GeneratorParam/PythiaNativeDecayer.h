@@ -0,0 +1,104 @@
+#ifndef PYTHIANATIVEDECAYER_H
+#define PYTHIANATIVEDECAYER_H
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Hadron decays in C++ driven by the Pythia6 decay table. Init() copies
+// masses, widths, lifetimes and the active channels (MDCY, MDME, BRAT,
+// KFDP) of the current table, including channels forced by
+// PythiaDecayerConfig. Decay() is const and only uses the random generator
+// it is given, so it can run concurrently with other instances and with
+// Pythia itself.
+//
+// Implemented are isotropic n-body phase space (MDME(idc,2) = 0), the
+// omega/phi -> 3 pi matrix element (1) and Dalitz decays P -> gamma l+ l-
+// (2). A parent whose decay chain can reach any other channel (e.g. V-A
+// semileptonic decays or partonic final states) is rejected and has to
+// be decayed by Pythia.
+
+#include "GeneratorParamAliasTable.h"
+#include <Rtypes.h>
+#include <unordered_map>
+#include <vector>
+
+class TLorentzVector;
+class TPythia6;
+class TRandom;
+
+// Entry of the decay output buffer, laid out as a PYJETS line. Indices
+// refer to the position in the buffer, -1 if there is none.
+struct PythiaDecayTrack {
+  Int_t fStatus;        // 1 stable, 11 decayed (K(i,1))
+  Int_t fPdg;           // PDG code (K(i,2))
+  Int_t fMother;        // index of the mother (K(i,3))
+  Int_t fFirstDaughter; // index of the first daughter (K(i,4))
+  Int_t fLastDaughter;  // index of the last daughter (K(i,5))
+  Double_t fP[5];       // px, py, pz, E, m (GeV)
+  Double_t fV[5];       // production vertex x, y, z, t (mm, mm/c), proper lifetime
+};
+
+class PythiaNativeDecayer {
+public:
+  PythiaNativeDecayer() = default;
+
+  // Import the decay table of pythia, kFALSE if the decay settings
+  // (MSTJ(21), MSTJ(22)) cannot be reproduced
+  Bool_t Init(TPythia6 *pythia);
+  Bool_t IsInitialised() const { return fInit; }
+  // kTRUE if the full decay chain of pdg is implemented
+  Bool_t IsSupported(Int_t pdg) const;
+  // Decay the parent and all unstable products into out[0..n), the parent
+  // is at index 0 with vertex 0. Returns n, or -1 if the parent is not
+  // supported or the buffer is too small.
+  Int_t Decay(Int_t pdg, const TLorentzVector &pparent, TRandom *ran,
+              PythiaDecayTrack *out, Int_t nmax) const;
+
+private:
+  struct Channel {
+    Int_t fME;          // matrix element code MDME(idc,2)
+    Int_t fN;           // number of products
+    Int_t fKC[5];       // compressed codes of the products
+    Int_t fSign[5];     // sign of the product code in the particle decay
+  };
+  struct Species {
+    Int_t fKF = 0;                          // PDG code of the particle
+    Bool_t fAnti = kFALSE;                  // antiparticle exists
+    Bool_t fDecays = kFALSE;                // decayed at all
+    Double_t fMass = 0.;                    // nominal mass
+    Double_t fWidth = 0.;                   // Breit-Wigner width
+    Double_t fMaxDev = 0.;                  // maximum deviation from the nominal mass
+    Double_t fCTau = 0.;                    // mean proper lifetime (mm)
+    Int_t fSupported = 0;                   // chain implemented: 1 yes, -1 no, 0 not yet
+                                            // known, 2 being checked
+    Int_t fChainLength = 0;                 // longest decay chain, if supported
+    std::vector<Int_t> fChannel[2];         // channels of particle, antiparticle
+    GeneratorParamAliasTable fSelect[2];    // channel selection
+  };
+
+  Int_t Compress(Int_t pdg) const;
+  Bool_t CheckSupported(Int_t kc);
+  Double_t SampleMass(const Species &species, Double_t mmax, TRandom *ran) const;
+  Bool_t DecayTrack(Int_t i, TRandom *ran, PythiaDecayTrack *out, Int_t &n,
+                    Int_t nmax) const;
+  Bool_t PhaseSpace(Int_t np, const Double_t *mass, Double_t mparent,
+                    TRandom *ran, Double_t (*p)[4], Double_t &weight) const;
+  void Dalitz(const Double_t *mass, Int_t igamma, Double_t mparent, TRandom *ran,
+              Double_t (*p)[4]) const;
+  static Double_t Pdk(Double_t a, Double_t b, Double_t c);
+  static void Boost(const Double_t *parent, Double_t *p);
+
+  Bool_t fInit = kFALSE;                   // tables imported
+  Bool_t fDecayShortOnly = kFALSE;         // MSTJ(22) = 2
+  Double_t fCTauMax = 0.;                  // PARJ(71)
+  std::vector<Species> fSpecies;           // by compressed code
+  std::vector<Channel> fChannels;          // all active channels
+  std::unordered_map<Int_t, Int_t> fKC;    // PDG code (> 0) -> compressed code
+};
+#endif
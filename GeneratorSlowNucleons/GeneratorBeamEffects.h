@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_GENERATORBEAMEFFECTS_H
+#define O2_GENERATORBEAMEFFECTS_H
+
+//
+// Beam crossing angle and beam divergence as a single rotation of the
+// momenta, shared by GeneratorSlowNucleons and GeneratorSpectators.
+// The crossing angle rotates in the horizontal (x-z, plane 1) or vertical
+// (y-z, plane 2) plane. The divergence tilts the beam axis by the polar
+// angle sigma*|Gaus(0,1)| at a uniform azimuth, drawn once per event
+// (kPerEvent) or for every particle (kPerParticle). The rotation is
+// composed once as 3x3 matrix and applied to all momenta of the event.
+// Header only, so that the generator libraries do not depend on each other.
+//
+
+#include <TMath.h>
+#include <TRandom.h>
+
+class GeneratorBeamEffects {
+public:
+  enum EDivergenceMode { kPerEvent, kPerParticle };
+
+  GeneratorBeamEffects() { Configure(0., 2, 0., kPerEvent); }
+
+  // Crossing angle (rad) in plane (1 horizontal, 2 vertical), divergence
+  // (rad) and divergence mode
+  void Configure(Double_t crossingAngle, Int_t crossingPlane,
+                 Double_t divergence, Int_t mode) {
+    fDivergence = divergence;
+    fMode = mode;
+    fAngle = 0.;
+    Double_t c = TMath::Cos(crossingAngle), s = TMath::Sin(crossingAngle);
+    Double_t id[9] = {1., 0., 0., 0., 1., 0., 0., 0., 1.};
+    for (Int_t i = 0; i < 9; i++)
+      fCrossing[i] = id[i];
+    Int_t k = crossingPlane == 1 ? 0 : 1; // rotated transverse axis
+    fCrossing[4 * k] = c;
+    fCrossing[3 * k + 2] = s;
+    fCrossing[6 + k] = -s;
+    fCrossing[8] = c;
+    for (Int_t i = 0; i < 9; i++)
+      fMatrix[i] = fCrossing[i];
+  }
+  Bool_t IsActive() const {
+    return TMath::Abs(fDivergence) > 0. || fCrossing[8] != 1.;
+  }
+
+  // Rotation of the next event, draws the divergence in kPerEvent mode
+  void NewEvent(TRandom *ran) {
+    if (fMode == kPerEvent && TMath::Abs(fDivergence) > 0.)
+      Compose(ran, fMatrix, fAngle);
+  }
+  // Polar angle of the divergence of the current event (kPerEvent)
+  Double_t GetDivergenceAngle() const { return fAngle; }
+
+  // Rotate the momenta p[3*i], p[3*i+1], p[3*i+2] of n particles
+  template <typename T> void Apply(Int_t n, T *p, TRandom *ran) const {
+    if (fMode == kPerParticle && TMath::Abs(fDivergence) > 0.) {
+      Double_t m[9], angle;
+      for (Int_t i = 0; i < n; i++) {
+        Compose(ran, m, angle);
+        Rotate(m, 1, p + 3 * i);
+      }
+    } else if (IsActive()) {
+      Rotate(fMatrix, n, p);
+    }
+  }
+
+private:
+  // Divergence rotation, which takes the z axis to the tilted beam axis,
+  // times the crossing rotation
+  void Compose(TRandom *ran, Double_t *m, Double_t &angle) const {
+    angle = fDivergence * TMath::Abs(ran->Gaus(0., 1.));
+    Double_t phi = TMath::TwoPi() * ran->Rndm();
+    Double_t ct = TMath::Cos(angle), st = TMath::Sin(angle);
+    Double_t cp = TMath::Cos(phi), sp = TMath::Sin(phi);
+    Double_t d[9] = {ct * cp * cp + sp * sp, (ct - 1.) * cp * sp, st * cp,
+                     (ct - 1.) * cp * sp, ct * sp * sp + cp * cp, st * sp,
+                     -st * cp, -st * sp, ct};
+    for (Int_t i = 0; i < 3; i++)
+      for (Int_t j = 0; j < 3; j++)
+        m[3 * i + j] = d[3 * i] * fCrossing[j] + d[3 * i + 1] * fCrossing[3 + j] +
+                       d[3 * i + 2] * fCrossing[6 + j];
+  }
+  template <typename T>
+  static void Rotate(const Double_t *m, Int_t n, T *p) {
+    for (Int_t i = 0; i < n; i++, p += 3) {
+      Double_t x = p[0], y = p[1], z = p[2];
+      p[0] = m[0] * x + m[1] * y + m[2] * z;
+      p[1] = m[3] * x + m[4] * y + m[5] * z;
+      p[2] = m[6] * x + m[7] * y + m[8] * z;
+    }
+  }
+
+  Double_t fDivergence;   // beam divergence (rad)
+  Int_t fMode;            // EDivergenceMode
+  Double_t fCrossing[9];  // crossing rotation, row major
+  Double_t fMatrix[9];    // rotation of the current event, row major
+  Double_t fAngle;        // divergence angle of the current event
+};
+#endif
@@ -37,7 +37,9 @@ ClassImp(GeneratorSlowNucleons)
       fNbp(0), fNbn(0), fDebug(0), fDebugHist1(0), fDebugHist2(0),
       fThetaDistribution(), fCosThetaGrayHist(), fCosTheta(),
       fBeamCrossingAngle(0.), fBeamDivergence(0.), fBeamDivEvent(0.),
-      fSmearMode(2), fNcoll(0), fSlowNucleonModel(0) {
+      fBeamDivergenceMode(GeneratorBeamEffects::kPerEvent), fSmearMode(2), fNcoll(0), fNcollMaxTable(0), fSlowNucleonModel(0),
+      fMassProton(0.),
+      fMassNeutron(0.), fMaxwellSamplers(), fBeamEffects(), fMomenta() {
   // Default constructor
 }
 
@@ -48,8 +50,10 @@ GeneratorSlowNucleons::GeneratorSlowNucleons(Int_t npart)
       fBetaSourceB(0.), fNgp(0), fNgn(0), fNbp(0), fNbn(0), fDebug(0),
       fDebugHist1(0), fDebugHist2(0), fThetaDistribution(), fCosThetaGrayHist(),
       fCosTheta(), fBeamCrossingAngle(0.), fBeamDivergence(0.),
-      fBeamDivEvent(0.), fSmearMode(2), fNcoll(0),
-      fSlowNucleonModel(new SlowNucleonModel())
+      fBeamDivEvent(0.), fBeamDivergenceMode(GeneratorBeamEffects::kPerEvent),
+      fSmearMode(2), fNcoll(0), fNcollMaxTable(0),
+      fSlowNucleonModel(new SlowNucleonModel()), fMassProton(0.),
+      fMassNeutron(0.), fMaxwellSamplers(), fBeamEffects(), fMomenta()
 
 {
   // Constructor
@@ -72,9 +76,10 @@ void GeneratorSlowNucleons::Init() {
   //
   // Initialization
   //
-  Double_t kMass = TDatabasePDG::Instance()->GetParticle(kProton)->Mass();
+  fMassProton = TDatabasePDG::Instance()->GetParticle(kProton)->Mass();
+  fMassNeutron = TDatabasePDG::Instance()->GetParticle(kNeutron)->Mass();
   fMomentum = fCMS / 2. * Float_t(fZTarget) / Float_t(fATarget);
-  fBeta = fMomentum / TMath::Sqrt(kMass * kMass + fMomentum * fMomentum);
+  fBeta = fMomentum / TMath::Sqrt(fMassProton * fMassProton + fMomentum * fMomentum);
   printf("  fMomentum %f    fBeta %1.10f\n", fMomentum, fBeta);
   if (fDebug) {
     fDebugHist1 =
@@ -95,6 +100,29 @@ void GeneratorSlowNucleons::Init() {
                 -1., 1.);
   }
 
+  //
+  // momentum distributions of gray and black protons and neutrons
+  //
+  if (fTemperatureG <= 0. || fTemperatureB <= 0.) {
+    Fatal("Init", "Source temperatures %f, %f must be positive, see SetTemperature \n",
+          fTemperatureG, fTemperatureB);
+  }
+  fMaxwellSamplers.clear();
+  for (Double_t t : {fTemperatureG, fTemperatureB})
+    for (Double_t m : {fMassProton, fMassNeutron})
+      GetMaxwellSampler(m, t);
+
+  //
+  // multiplicity distributions
+  //
+  if (fNcollMaxTable > 0 && fSlowNucleonModel)
+    fSlowNucleonModel->Tabulate(fSmearMode, fNcollMaxTable);
+
+  //
+  // beam crossing angle (vertical plane) and divergence
+  //
+  fBeamEffects.Configure(fBeamCrossingAngle, 2, fBeamDivergence,
+                         fBeamDivergenceMode);
   if (TMath::Abs(fBeamCrossingAngle) > 0.)
     printf("\n  GeneratorSlowNucleons: applying crossing angle %f mrad to slow "
            "nucleons\n",
@@ -120,11 +148,8 @@ void GeneratorSlowNucleons::GenerateEvent() {
   //
   // Generate one event
   //
-  const Float_t mp = (TDatabasePDG::Instance()->GetParticle(kProton))->Mass();
-  const Float_t mn = (TDatabasePDG::Instance()->GetParticle(kNeutron))->Mass();
-  const Float_t k2PI = 2. * TMath::Pi();
-  const Float_t kRaddeg = 180. / TMath::Pi();
-  const Float_t kDegrad = TMath::Pi() / 180.;
+  const Float_t mp = fMassProton;
+  const Float_t mn = fMassNeutron;
   fParticles->Clear();
   //
   // Communication with Gray Particle Model
@@ -151,74 +176,47 @@ void GeneratorSlowNucleons::GenerateEvent() {
     //	    fDebugHist2->Fill(Float_t(fNgp + fNgn + fNbp + fNbn), b, 1.);
   }
   //
-  Float_t p[3] = {0., 0., 0.}, theta = 0;
-  Float_t polar[3] = {0., 0., 0.};
-  Int_t nt, i, j;
-  Int_t kf;
-  Double_t energy;
-
-  // Extracting 1 value per event for the divergence angle
-  Double_t rvec = gRandom->Gaus(0.0, 1.0);
-  fBeamDivEvent = fBeamDivergence * TMath::Abs(rvec);
-  if (TMath::Abs(fBeamDivEvent) > 0.)
-    printf("\n  GeneratorSlowNucleons: applying beam divergence %f mrad to "
-           "slow nucleons\n",
-           fBeamDivEvent * 1000.);
-  //
-  //  Gray protons
-  //
-  fCharge = 1;
-  kf = kProton;
-  for (i = 0; i < fNgp; i++) {
-    GenerateSlow(fCharge, fTemperatureG, fBetaSourceG, p, theta);
-    if (fDebug)
-      fCosThetaGrayHist->Fill(TMath::Cos(theta));
-    energy = TMath::Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + mp * mp);
-    auto part = new TParticle(kf, 1, -1, -1, -1, -1, p[0], p[1], p[2], energy,
-                              0., 0., 0., 0.);
-    part->SetUniqueID(kGrayProcess);
-    fParticles->Add(part);
-  }
-  //
-  //  Gray neutrons
-  //
-  fCharge = 0;
-  kf = kNeutron;
-  for (i = 0; i < fNgn; i++) {
-    GenerateSlow(fCharge, fTemperatureG, fBetaSourceG, p, theta);
-    if (fDebug)
-      fCosThetaGrayHist->Fill(TMath::Cos(theta));
-    energy = TMath::Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + mn * mn);
-    auto part = new TParticle(kf, 1, -1, -1, -1, -1, p[0], p[1], p[2], energy,
-                              0., 0., 0., 0.);
-    part->SetUniqueID(kGrayProcess);
-    fParticles->Add(part);
-  }
-  //
-  //  Black protons
+  // gray protons, gray neutrons, black protons, black neutrons
   //
-  fCharge = 1;
-  kf = kProton;
-  for (i = 0; i < fNbp; i++) {
-    GenerateSlow(fCharge, fTemperatureB, fBetaSourceB, p, theta);
-    energy = TMath::Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + mp * mp);
-    auto part = new TParticle(kf, 1, -1, -1, -1, -1, p[0], p[1], p[2], energy,
-                              0., 0., 0., 0.);
-    part->SetUniqueID(kBlackProcess);
-    fParticles->Add(part);
+  const Int_t nslow[4] = {fNgp, fNgn, fNbp, fNbn};
+  const Int_t kf[4] = {kProton, kNeutron, kProton, kNeutron};
+  const Float_t mass[4] = {mp, mn, mp, mn};
+  Int_t ntot = 0;
+  for (Int_t is = 0; is < 4; is++)
+    ntot += TMath::Max(nslow[is], 0);
+  fMomenta.resize(3 * ntot);
+
+  Float_t theta = 0;
+  Int_t k = 0;
+  for (Int_t is = 0; is < 4; is++) {
+    Bool_t gray = is < 2;
+    fCharge = (kf[is] == kProton) ? 1 : 0;
+    for (Int_t i = 0; i < nslow[is]; i++, k++) {
+      if (gray)
+        GenerateSlow(fCharge, fTemperatureG, fBetaSourceG, &fMomenta[3 * k], theta);
+      else
+        GenerateSlow(fCharge, fTemperatureB, fBetaSourceB, &fMomenta[3 * k], theta);
+      if (fDebug && gray)
+        fCosThetaGrayHist->Fill(TMath::Cos(theta));
+    }
   }
-  //
-  //  Black neutrons
-  //
-  fCharge = 0;
-  kf = kNeutron;
-  for (i = 0; i < fNbn; i++) {
-    GenerateSlow(fCharge, fTemperatureB, fBetaSourceB, p, theta);
-    energy = TMath::Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + mn * mn);
-    auto part = new TParticle(kf, 1, -1, -1, -1, -1, p[0], p[1], p[2], energy,
-                              0., 0., 0., 0.);
-    part->SetUniqueID(kBlackProcess);
-    fParticles->Add(part);
+
+  // crossing angle and divergence, one rotation for the whole event
+  fBeamEffects.NewEvent(gRandom);
+  fBeamDivEvent = fBeamEffects.GetDivergenceAngle();
+  fBeamEffects.Apply(ntot, fMomenta.data(), gRandom);
+
+  k = 0;
+  for (Int_t is = 0; is < 4; is++) {
+    for (Int_t i = 0; i < nslow[is]; i++, k++) {
+      const Float_t *p = &fMomenta[3 * k];
+      Double_t energy =
+          TMath::Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2] + mass[is] * mass[is]);
+      auto part = new TParticle(kf[is], 1, -1, -1, -1, -1, p[0], p[1], p[2],
+                                energy, 0., 0., 0., 0.);
+      part->SetUniqueID(is < 2 ? kGrayProcess : kBlackProcess);
+      fParticles->Add(part);
+    }
   }
 }
 
@@ -249,29 +247,16 @@ void GeneratorSlowNucleons::GenerateSlow(Int_t charge, Double_t T,
 
   //printf("Generating slow nuc. with: charge %d. temp. %1.4f, beta %f \n",charge,T,beta);
 
-  Double_t m=0, pmax=0, p=0, f=0, phi=0;
-  TDatabasePDG *pdg = TDatabasePDG::Instance();
-  const Double_t kMassProton = pdg->GetParticle(kProton)->Mass();
-  const Double_t kMassNeutron = pdg->GetParticle(kNeutron)->Mass();
+  Double_t m=0, p=0, phi=0;
 
   /* Select nucleon type */
   if (charge == 0)
-    m = kMassNeutron;
+    m = fMassNeutron;
   else
-    m = kMassProton;
-
-  /* Momentum at maximum of Maxwell-distribution */
-
-  pmax = TMath::Sqrt(2. * T * (T + TMath::Sqrt(T * T + m * m)));
+    m = fMassProton;
 
-  /* Try until proper momentum                                  */
-  /* for lack of primitive function of the Maxwell-distribution */
-  /* a brute force trial-accept loop, normalized at pmax        */
-
-  do {
-    p = gRandom->Rndm() * fPmax;
-    f = Maxwell(m, p, T) / Maxwell(m, pmax, T);
-  } while (f < gRandom->Rndm());
+  /* Momentum from the tabulated inverse of the cumulative Maxwell-distribution */
+  p = GetMaxwellSampler(m, T).Sample(gRandom->Rndm());
 
   /* Spherical symmetric emission for black particles (beta=0)*/
   if (beta == 0 || fThetaDistribution == 0)
@@ -305,122 +290,48 @@ void GeneratorSlowNucleons::GenerateSlow(Int_t charge, Double_t T,
   q[2] *= fProtonDirection;
   if (fDebug == 1)
     printf("\n Momentum after LHC boost: p = (%f, %f, %f)\n", q[0], q[1], q[2]);
-
-  if (TMath::Abs(fBeamCrossingAngle) > 0.)
-    BeamCrossing(q); // applying crossing angle
-  if (TMath::Abs(fBeamDivergence) > 0.)
-    BeamDivergence(q); // applying divergence
 }
 
 Double_t GeneratorSlowNucleons::Maxwell(Double_t m, Double_t p, Double_t T) {
   /* Relativistic Maxwell-distribution */
-  Double_t ekin = TMath::Sqrt(p * p + m * m) - m;
-  return (p * p * exp(-ekin / T));
+  return SlowNucleonMaxwellSampler::Density(m, p, T);
 }
 
 //_____________________________________________________________________________
-void GeneratorSlowNucleons::Lorentz(Double_t m, Double_t beta, Float_t *q) {
-  /* Lorentz transform in the direction of q[2] */
-
-  Double_t gamma = 1. / TMath::Sqrt((1. - beta) * (1. + beta));
-  Double_t energy =
-      TMath::Sqrt(m * m + q[0] * q[0] + q[1] * q[1] + q[2] * q[2]);
-  q[2] = gamma * (q[2] + beta * energy);
-}
-
-//_____________________________________________________________________________
-void GeneratorSlowNucleons::BeamCrossing(Float_t *pLab) {
-  // Applying beam crossing angle
-  //
-  pLab[1] = pLab[2] * TMath::Sin(fBeamCrossingAngle) +
-            pLab[1] * TMath::Cos(fBeamCrossingAngle);
-  pLab[2] = pLab[2] * TMath::Cos(fBeamCrossingAngle) -
-            pLab[1] * TMath::Sin(fBeamCrossingAngle);
-  if (fDebug == 1) {
-    printf(" Beam crossing angle = %f mrad ", fBeamCrossingAngle * 1000.);
-    printf("  p = (%f, %f, %f)\n", pLab[0], pLab[1], pLab[2]);
+void GeneratorSlowNucleons::SetTemperature(Float_t t1, Float_t t2) {
+  // Source temperatures of gray and black nucleons [GeV]
+  if (t1 <= 0. || t2 <= 0.) {
+    printf("GeneratorSlowNucleons: ERROR: Temperatures %f, %f rejected, they "
+           "must be positive\n",
+           t1, t2);
+    return;
   }
+  fTemperatureG = t1;
+  fTemperatureB = t2;
 }
+
 //_____________________________________________________________________________
-void GeneratorSlowNucleons::BeamDivergence(Float_t *pLab) {
-  // Applying beam divergence
-  //
-  const Float_t k2PI = 2. * TMath::Pi();
-  const Float_t kRaddeg = 180. / TMath::Pi();
-  const Float_t kDegrad = TMath::Pi() / 180.;
-  Double_t pmod =
-      TMath::Sqrt(pLab[0] * pLab[0] + pLab[1] * pLab[1] + pLab[2] * pLab[2]);
-
-  Double_t tetdiv = fBeamDivEvent;
-  Double_t fidiv = (gRandom->Rndm()) * 2. * TMath::Pi();
-
-  Double_t tetpart =
-      TMath::ATan2(TMath::Sqrt(pLab[0] * pLab[0] + pLab[1] * pLab[1]), pLab[2]);
-  Double_t fipart = 0.;
-  if (TMath::Abs(pLab[1]) > 0. || TMath::Abs(pLab[0]) > 0.)
-    fipart = TMath::ATan2(pLab[1], pLab[0]);
-  if (fipart < 0.) {
-    fipart = fipart + 2. * TMath::Pi();
-  }
-  tetdiv = tetdiv * kRaddeg;
-  fidiv = fidiv * kRaddeg;
-  tetpart = tetpart * kRaddeg;
-  fipart = fipart * kRaddeg;
-
-  Double_t angleSum[2] = {0., 0.};
-  AddAngle(tetpart, fipart, tetdiv, fidiv, angleSum);
-
-  Double_t tetsum = angleSum[0];
-  Double_t fisum = angleSum[1];
-  // printf("tetpart %f fipart %f tetdiv %f fidiv %f angleSum %f
-  // %f\n",tetpart,fipart,tetdiv,fidiv,angleSum[0],angleSum[1]);
-  tetsum = tetsum * kDegrad;
-  fisum = fisum * kDegrad;
-
-  pLab[0] = pmod * TMath::Sin(tetsum) * TMath::Cos(fisum);
-  pLab[1] = pmod * TMath::Sin(tetsum) * TMath::Sin(fisum);
-  pLab[2] = pmod * TMath::Cos(tetsum);
-  if (fDebug == 1) {
-    printf(" Beam divergence %f mrad ", fBeamDivEvent * 1000.);
-    printf("  p = (%f, %f, %f)\n", pLab[0], pLab[1], pLab[2]);
+const SlowNucleonMaxwellSampler &
+GeneratorSlowNucleons::GetMaxwellSampler(Double_t m, Double_t t) {
+  // Cached momentum sampler for mass m and temperature t, built in Init or
+  // on first use
+  for (const auto &sampler : fMaxwellSamplers)
+    if (sampler.Matches(m, t, fPmax))
+      return sampler;
+  SlowNucleonMaxwellSampler sampler;
+  if (!sampler.Build(m, t, fPmax)) {
+    Fatal("GetMaxwellSampler", "No momentum distribution for mass %f and temperature %f \n", m, t);
   }
+  fMaxwellSamplers.push_back(sampler);
+  return fMaxwellSamplers.back();
 }
 
 //_____________________________________________________________________________
-void GeneratorSlowNucleons::AddAngle(Double_t theta1, Double_t phi1,
-                                     Double_t theta2, Double_t phi2,
-                                     Double_t *angleSum) {
-  // Calculating the sum of 2 angles
-  Double_t temp = -1.;
-  Double_t conv = 180. / TMath::ACos(temp);
-
-  Double_t ct1 = TMath::Cos(theta1 / conv);
-  Double_t st1 = TMath::Sin(theta1 / conv);
-  Double_t cp1 = TMath::Cos(phi1 / conv);
-  Double_t sp1 = TMath::Sin(phi1 / conv);
-  Double_t ct2 = TMath::Cos(theta2 / conv);
-  Double_t st2 = TMath::Sin(theta2 / conv);
-  Double_t cp2 = TMath::Cos(phi2 / conv);
-  Double_t sp2 = TMath::Sin(phi2 / conv);
-  Double_t cx = ct1 * cp1 * st2 * cp2 + st1 * cp1 * ct2 - sp1 * st2 * sp2;
-  Double_t cy = ct1 * sp1 * st2 * cp2 + st1 * sp1 * ct2 + cp1 * st2 * sp2;
-  Double_t cz = ct1 * ct2 - st1 * st2 * cp2;
-
-  Double_t rtetsum = TMath::ACos(cz);
-  Double_t tetsum = conv * rtetsum;
-  if (TMath::Abs(tetsum) < 1e-4 || tetsum == 180.)
-    return;
-
-  temp = cx / TMath::Sin(rtetsum);
-  if (temp > 1.)
-    temp = 1.;
-  if (temp < -1.)
-    temp = -1.;
-  Double_t fisum = conv * TMath::ACos(temp);
-  if (cy < 0) {
-    fisum = 360. - fisum;
-  }
+void GeneratorSlowNucleons::Lorentz(Double_t m, Double_t beta, Float_t *q) {
+  /* Lorentz transform in the direction of q[2] */
 
-  angleSum[0] = tetsum;
-  angleSum[1] = fisum;
+  Double_t gamma = 1. / TMath::Sqrt((1. - beta) * (1. + beta));
+  Double_t energy =
+      TMath::Sqrt(m * m + q[0] * q[0] + q[1] * q[1] + q[2] * q[2]);
+  q[2] = gamma * (q[2] + beta * energy);
 }
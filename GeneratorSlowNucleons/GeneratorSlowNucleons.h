@@ -17,7 +17,10 @@
 //  Original code by  Ferenc Sikler  <sikler@rmki.kfki.hu>
 //  This class: andreas.morsch@cern.ch
 //
+#include "GeneratorBeamEffects.h"
+#include "SlowNucleonMaxwellSampler.h"
 #include <TGenerator.h>
+#include <vector>
 
 class SlowNucleonModel;
 class TH2F;
@@ -43,10 +46,8 @@ public:
   //    {AliGenerator::SetTarget(s, a, z);}
   virtual void SetProtonDirection(Float_t dir = 1.);
   virtual void SetCharge(Int_t c = 1) { fCharge = c; }
-  virtual void SetTemperature(Float_t t1 = 0.04, Float_t t2 = 0.004) {
-    fTemperatureG = t1;
-    fTemperatureB = t2;
-  }
+  // Temperatures must be positive, other values are rejected
+  virtual void SetTemperature(Float_t t1 = 0.04, Float_t t2 = 0.004);
   virtual void SetBetaSource(Float_t b1 = 0.05, Float_t b2 = 0.) {
     fBetaSourceG = b1;
     fBetaSourceB = b2;
@@ -74,6 +75,8 @@ public:
   virtual void SetBeamDivergence(Float_t divergence) {
     fBeamDivergence = divergence;
   }
+  // Divergence drawn per event or per particle, see GeneratorBeamEffects
+  virtual void SetBeamDivergenceMode(Int_t mode) { fBeamDivergenceMode = mode; }
   //
   virtual Int_t GetNGrayProtons() { return fNgp; }
   virtual Int_t GetNGrayNeutrons() { return fNgn; }
@@ -81,16 +84,17 @@ public:
   virtual Int_t GetNBlackNeutrons() { return fNbn; }
   //
   virtual void SetModelSmear(Int_t imode) { fSmearMode = imode; }
+  // Tabulate the multiplicities of the model up to ncollMax in Init,
+  // 0 to draw them directly
+  virtual void SetTabulatedNcoll(Int_t ncollMax) { fNcollMaxTable = ncollMax; }
 
 protected:
   void GenerateSlow(Int_t charge, Double_t T, Double_t beta, Float_t *q,
                     Float_t &theta);
   Double_t Maxwell(Double_t m, Double_t p, Double_t t);
+  // Cached sampler, fatal if it cannot be built (t not positive)
+  const SlowNucleonMaxwellSampler &GetMaxwellSampler(Double_t m, Double_t t);
   void Lorentz(Double_t m, Double_t beta, Float_t *q);
-  void BeamDivergence(Float_t *pLab);
-  void BeamCrossing(Float_t *pLab);
-  void AddAngle(Double_t theta1, Double_t phi1, Double_t theta2, Double_t phi2,
-                Double_t *angle);
 
 protected:
   Float_t fCMS;             // Center of mass energy
@@ -120,11 +124,19 @@ protected:
   Float_t fBeamCrossingAngle; // beam crossing angle (in radians)
   Float_t fBeamDivergence;    // beam divergence	(in radians)
   Float_t fBeamDivEvent;      // beam divergence	(in radians)
+  Int_t fBeamDivergenceMode;  // divergence per event or per particle
   //
   Int_t fSmearMode; // 0=Skler (no smear), =1 smearing Ncoll, =2 smearing Nslow
   //
   Int_t fNcoll; // number of collisions provided by external generator
+  Int_t fNcollMaxTable; // largest ncoll tabulated by the model
   SlowNucleonModel *fSlowNucleonModel; // The slow nucleon model
+  //
+  Double_t fMassProton;  //! proton mass
+  Double_t fMassNeutron; //! neutron mass
+  std::vector<SlowNucleonMaxwellSampler> fMaxwellSamplers; //! momentum samplers by mass and temperature
+  GeneratorBeamEffects fBeamEffects; //! crossing angle and divergence
+  std::vector<Float_t> fMomenta;     //! momenta of the current event
 
   enum { kGrayProcess = 200, kBlackProcess = 300 };
 
@@ -132,6 +144,6 @@ private:
   GeneratorSlowNucleons(const GeneratorSlowNucleons &sn);
   GeneratorSlowNucleons &operator=(const GeneratorSlowNucleons &rhs);
 
-  ClassDef(GeneratorSlowNucleons, 1) // Slow Nucleon Generator
+  ClassDef(GeneratorSlowNucleons, 2) // Slow Nucleon Generator
 };
 #endif
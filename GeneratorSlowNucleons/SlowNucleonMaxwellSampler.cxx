@@ -0,0 +1,118 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "SlowNucleonMaxwellSampler.h"
+#include <TMath.h>
+#include <algorithm>
+
+//____________________________________________________________
+Double_t SlowNucleonMaxwellSampler::Density(Double_t m, Double_t p,
+                                            Double_t t) {
+  /* Relativistic Maxwell-distribution */
+  Double_t ekin = TMath::Sqrt(p * p + m * m) - m;
+  return p * p * TMath::Exp(-ekin / t);
+}
+
+//____________________________________________________________
+Bool_t SlowNucleonMaxwellSampler::Build(Double_t m, Double_t t, Double_t pmax,
+                                        Double_t tolerance) {
+  const Int_t kNStart = 64;
+  const Int_t kMaxDepth = 30;
+  const Double_t kTail = 1.e-16; // density negligible w.r.t. the maximum
+  fP.clear();
+  fF.clear();
+  fCumulative.clear();
+  if (t <= 0. || pmax <= 0.) {
+    printf("SlowNucleonMaxwellSampler: ERROR: Invalid temperature %f or pmax "
+           "%f\n",
+           t, pmax);
+    return kFALSE;
+  }
+  fMass = m;
+  fTemperature = t;
+  fPmax = pmax;
+
+  // momentum at the maximum, and end of the relevant tail
+  Double_t ppeak = TMath::Sqrt(2. * t * (t + TMath::Sqrt(t * t + m * m)));
+  Double_t fpeak = Density(m, TMath::Min(ppeak, pmax), t);
+  Double_t pcut = ppeak;
+  while (pcut < pmax && Density(m, pcut, t) > kTail * fpeak)
+    pcut *= 1.5;
+  pcut = TMath::Min(pcut, pmax);
+
+  // bisect the intervals in which the linear interpolation is off at the
+  // midpoint or the quarter points
+  std::vector<Double_t> stack;
+  fP.push_back(0.);
+  fF.push_back(0.);
+  for (Int_t i = kNStart; i > 0; i--)
+    stack.push_back(pcut * i / kNStart);
+  std::vector<Int_t> depth(stack.size(), 0);
+  while (!stack.empty()) {
+    Double_t a = fP.back(), fa = fF.back();
+    Double_t b = stack.back();
+    Int_t d = depth.back();
+    Double_t fb = Density(m, b, t);
+    Bool_t split = kFALSE;
+    if (d < kMaxDepth) {
+      for (Double_t x : {0.25, 0.5, 0.75}) {
+        Double_t lin = fa + x * (fb - fa);
+        if (TMath::Abs(Density(m, a + x * (b - a), t) - lin) > tolerance * fpeak) {
+          split = kTRUE;
+          break;
+        }
+      }
+    }
+    if (split) {
+      depth.back() = d + 1;
+      stack.push_back(0.5 * (a + b));
+      depth.push_back(d + 1);
+    } else {
+      fP.push_back(b);
+      fF.push_back(fb);
+      stack.pop_back();
+      depth.pop_back();
+    }
+  }
+
+  fCumulative.resize(fP.size());
+  fCumulative[0] = 0.;
+  for (UInt_t i = 1; i < fP.size(); i++)
+    fCumulative[i] = fCumulative[i - 1] + 0.5 * (fP[i] - fP[i - 1]) * (fF[i] + fF[i - 1]);
+  if (fCumulative.back() <= 0.) {
+    printf("SlowNucleonMaxwellSampler: ERROR: Empty distribution for m=%f "
+           "T=%f\n",
+           m, t);
+    fP.clear();
+    fF.clear();
+    fCumulative.clear();
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+Double_t SlowNucleonMaxwellSampler::Sample(Double_t r) const {
+  if (fCumulative.empty())
+    return 0.;
+  Double_t target = r * fCumulative.back();
+  Int_t i = std::upper_bound(fCumulative.begin(), fCumulative.end(), target) -
+            fCumulative.begin() - 1;
+  i = TMath::Max(0, TMath::Min(i, (Int_t)fP.size() - 2));
+  Double_t h = fP[i + 1] - fP[i];
+  Double_t area = fCumulative[i + 1] - fCumulative[i];
+  Double_t s = area > 0. ? (target - fCumulative[i]) / area : 0.;
+  // invert the cumulative of the linear density inside the interval
+  Double_t c0 = fF[i], c1 = fF[i + 1];
+  Double_t u = s;
+  if (TMath::Abs(c1 - c0) > 1.e-9 * (c0 + c1))
+    u = (TMath::Sqrt(c0 * c0 + s * (c1 * c1 - c0 * c0)) - c0) / (c1 - c0);
+  return fP[i] + u * h;
+}
@@ -0,0 +1,45 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_SLOWNUCLEONMAXWELLSAMPLER_H
+#define O2_SLOWNUCLEONMAXWELLSAMPLER_H
+
+//
+// Inverse-CDF sampling of the relativistic Maxwell momentum distribution
+// p^2 exp(-(E - m)/T) on [0, pmax]. The density is tabulated on nodes
+// refined until linear interpolation deviates by less than tolerance times
+// the maximum, and the interpolant is sampled exactly with one random number.
+//
+#include <Rtypes.h>
+#include <vector>
+
+class SlowNucleonMaxwellSampler {
+public:
+  SlowNucleonMaxwellSampler() = default;
+
+  Bool_t Build(Double_t m, Double_t t, Double_t pmax,
+               Double_t tolerance = 1.e-4);
+  Bool_t Matches(Double_t m, Double_t t, Double_t pmax) const {
+    return fMass == m && fTemperature == t && fPmax == pmax;
+  }
+  Bool_t IsValid() const { return !fCumulative.empty(); }
+  // momentum at the cumulative probability r in [0, 1), 0 if not built
+  Double_t Sample(Double_t r) const;
+  static Double_t Density(Double_t m, Double_t p, Double_t t);
+
+private:
+  Double_t fMass = -1.;              // nucleon mass
+  Double_t fTemperature = -1.;       // source temperature
+  Double_t fPmax = -1.;              // upper momentum limit
+  std::vector<Double_t> fP;          // nodes
+  std::vector<Double_t> fF;          // density at the nodes
+  std::vector<Double_t> fCumulative; // integral up to the nodes
+};
+#endif
@@ -8,4 +8,55 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 #include "SlowNucleonModel.h"
+#include <TRandom.h>
 ClassImp(SlowNucleonModel)
+
+//____________________________________________________________
+SlowNucleonModel::~SlowNucleonModel() {
+  delete fTable;
+}
+
+//____________________________________________________________
+Bool_t SlowNucleonModel::Tabulate(Int_t smearMode, Int_t ncollMax) {
+  delete fTable;
+  fTable = new SlowNucleonMultiplicityTable();
+  fTableMode = smearMode;
+  std::vector<SlowNucleonMultiplicityComponent> components;
+  for (Int_t ncoll = 0; ncoll <= ncollMax; ncoll++) {
+    components.clear();
+    if (!GetComponents(smearMode, ncoll, components) ||
+        !fTable->Set(ncoll, components)) {
+      printf("SlowNucleonModel: ERROR: Cannot tabulate mode %d for ncoll=%d\n",
+             smearMode, ncoll);
+      delete fTable;
+      fTable = 0;
+      fTableMode = -1;
+      return kFALSE;
+    }
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+Double_t SlowNucleonModel::GetProbability(Int_t ncoll, Int_t ngp, Int_t ngn,
+                                          Int_t nbp, Int_t nbn) const {
+  Int_t n[4] = {ngp, ngn, nbp, nbn};
+  return fTable ? fTable->GetProbability(ncoll, n) : 0.;
+}
+
+//____________________________________________________________
+Bool_t SlowNucleonModel::GetTabulatedNumbers(Int_t smearMode, Int_t ncoll,
+                                             Int_t &ngp, Int_t &ngn,
+                                             Int_t &nbp, Int_t &nbn) const {
+  if (!IsTabulated(smearMode, ncoll))
+    return kFALSE;
+  Int_t n[4];
+  Double_t r[5];
+  gRandom->RndmArray(5, r);
+  fTable->Sample(ncoll, r, n);
+  ngp = n[SlowNucleonMultiplicityTable::kGrayProtons];
+  ngn = n[SlowNucleonMultiplicityTable::kGrayNeutrons];
+  nbp = n[SlowNucleonMultiplicityTable::kBlackProtons];
+  nbn = n[SlowNucleonMultiplicityTable::kBlackNeutrons];
+  return kTRUE;
+}
@@ -11,11 +11,12 @@
 #ifndef O2_SLOWNUCLEONMODEL
 #define O2_SLOWNUCLEONMODEL
 
+#include "SlowNucleonMultiplicityTable.h"
 #include "TObject.h"
 class SlowNucleonModel : public TObject {
 public:
-  SlowNucleonModel() { ; }
-  virtual ~SlowNucleonModel() { ; }
+  SlowNucleonModel() : fTable(0), fTableMode(-1) { ; }
+  virtual ~SlowNucleonModel();
   virtual void GetNumberOfSlowNucleons(Int_t /*ncoll*/, Int_t & /*ngp*/,
                                        Int_t & /*ngn*/, Int_t & /*nbp*/,
                                        Int_t & /*nbn*/) const {
@@ -31,8 +32,38 @@ public:
                                          Int_t & /*nbn*/) const {
     ;
   }
+  //
+  // Precompute P(ngp, ngn, nbp, nbn | ncoll) for 0 <= ncoll <= ncollMax in
+  // the smearing mode of GeneratorSlowNucleons (0: GetNumberOfSlowNucleons,
+  // 1: ...2, 2: ...2s). The matching function then draws the four numbers
+  // from a table lookup. Has to be repeated after changing the
+  // parameters.
+  Bool_t Tabulate(Int_t smearMode, Int_t ncollMax);
+  Bool_t IsTabulated(Int_t smearMode, Int_t ncoll) const {
+    return fTable && fTableMode == smearMode && fTable->IsTabulated(ncoll);
+  }
+  Double_t GetProbability(Int_t ncoll, Int_t ngp, Int_t ngn, Int_t nbp,
+                          Int_t nbn) const;
 
 protected:
-  ClassDef(SlowNucleonModel, 1) // Gray Particle Model
+  // Distribution for ncoll as mixture of independent distributions of the
+  // four numbers, kFALSE if the model does not provide it
+  virtual Bool_t
+  GetComponents(Int_t /*smearMode*/, Int_t /*ncoll*/,
+                std::vector<SlowNucleonMultiplicityComponent> & /*comp*/) const {
+    return kFALSE;
+  }
+  // Draw from the table if ncoll is tabulated in smearMode
+  Bool_t GetTabulatedNumbers(Int_t smearMode, Int_t ncoll, Int_t &ngp,
+                             Int_t &ngn, Int_t &nbp, Int_t &nbn) const;
+
+  SlowNucleonMultiplicityTable *fTable; //! tabulated multiplicities
+  Int_t fTableMode;                     //! smearing mode of fTable
+
+private:
+  SlowNucleonModel(const SlowNucleonModel &model);
+  SlowNucleonModel &operator=(const SlowNucleonModel &rhs);
+
+  ClassDef(SlowNucleonModel, 2) // Gray Particle Model
 };
 #endif
@@ -41,16 +41,103 @@ ClassImp(SlowNucleonModelExp)
   %f}\n\n",fLCPparam,fSlownparam[0],fSlownparam[1],fSlownparam[2]); */
 }
 
-void SlowNucleonModelExp::GetNumberOfSlowNucleons(Int_t ncoll, Int_t &ngp,
-                                                  Int_t &ngn, Int_t &nbp,
-                                                  Int_t &nbn) const {
-  //
-  // Return the number of black and gray nucleons
-  //
-  // Number of collisions
+namespace {
+const Int_t kNLatent = 128;     // nodes for the integration over the smearing
+const Double_t kTail = 1.e-14;  // negligible probability of a single number
+
+Double_t Normal(Double_t x) { return 0.5 * TMath::Erfc(-x / TMath::Sqrt2()); }
+
+// Clamped gaussian max(Gaus(mean, sigma), 0) as nodes (value, weight)
+void LatentNodes(Double_t mean, Double_t sigma,
+                 std::vector<std::pair<Double_t, Double_t>> &nodes) {
+  nodes.clear();
+  if (!(sigma > 0.)) {
+    nodes.emplace_back(TMath::Max(mean, 0.), 1.);
+    return;
+  }
+  Double_t lo = mean - 8. * sigma, hi = mean + 8. * sigma;
+  if (hi <= 0.) {
+    nodes.emplace_back(0., 1.);
+    return;
+  }
+  // values below 0 are clamped, the outermost bins extend to infinity
+  Double_t w0 = lo < 0. ? Normal(-mean / sigma) : 0.;
+  if (w0 > 0.)
+    nodes.emplace_back(0., w0);
+  lo = TMath::Max(lo, 0.);
+  Double_t h = (hi - lo) / kNLatent;
+  for (Int_t i = 0; i < kNLatent; i++) {
+    Double_t a = (i == 0 && w0 == 0.) ? -TMath::Infinity() : lo + i * h;
+    Double_t b = (i == kNLatent - 1) ? TMath::Infinity() : lo + (i + 1) * h;
+    nodes.emplace_back(lo + (i + 0.5) * h,
+                       Normal((b - mean) / sigma) - Normal((a - mean) / sigma));
+  }
+}
 
-  Float_t nu = (Float_t)(ncoll);
+// TRandom::Binomial(n, p), 0 for p outside of [0, 1]
+void BinomialProbs(Int_t n, Double_t p, Int_t &min,
+                   std::vector<Double_t> &prob) {
+  prob.clear();
+  min = 0;
+  if (p <= 0. || p > 1. || n <= 0) {
+    prob.push_back(1.);
+    return;
+  }
+  if (p == 1.) {
+    min = n;
+    prob.push_back(1.);
+    return;
+  }
+  Double_t lp = TMath::Log(p), lq = TMath::Log(1. - p);
+  Double_t lnf = TMath::LnGamma(n + 1.);
+  Int_t kmin = n, kmax = 0;
+  std::vector<Double_t> all(n + 1);
+  for (Int_t k = 0; k <= n; k++) {
+    all[k] = TMath::Exp(lnf - TMath::LnGamma(k + 1.) - TMath::LnGamma(n - k + 1.) + k * lp + (n - k) * lq);
+    if (all[k] > kTail) {
+      kmin = TMath::Min(kmin, k);
+      kmax = TMath::Max(kmax, k);
+    }
+  }
+  min = kmin;
+  prob.assign(all.begin() + kmin, all.begin() + kmax + 1);
+}
+
+// Int_t(Gaus(mean, sigma)), the conversion truncates towards 0
+void TruncatedGausProbs(Double_t mean, Double_t sigma, Int_t &min,
+                        std::vector<Double_t> &prob) {
+  prob.clear();
+  if (!(sigma > 0.)) {
+    min = Int_t(mean);
+    prob.push_back(1.);
+    return;
+  }
+  Int_t kmin = Int_t(TMath::Floor(mean - 9. * sigma)) - 1;
+  Int_t kmax = Int_t(TMath::Ceil(mean + 9. * sigma)) + 1;
+  min = kmax;
+  Int_t last = kmin;
+  std::vector<Double_t> all;
+  for (Int_t k = kmin; k <= kmax; k++) {
+    Double_t a = k > 0 ? k : k - 1., b = k < 0 ? k : k + 1.;
+    Double_t pk = Normal((b - mean) / sigma) - Normal((a - mean) / sigma);
+    all.push_back(pk);
+    if (pk > kTail) {
+      min = TMath::Min(min, k);
+      last = k;
+    }
+  }
+  prob.assign(all.begin() + (min - kmin), all.begin() + (last - kmin) + 1);
+}
+} // namespace
+
+Float_t SlowNucleonModelExp::MeanGrayProtons2(Float_t nu) const {
+  // based on E910 model
+  Float_t poverpd = 0.843;
+  Float_t zAu2zPb = 82. / 79.;
+  return (-0.27 + 0.63 * nu - 0.0008 * nu * nu) * poverpd * zAu2zPb;
+}
 
+void SlowNucleonModelExp::MeanNumbers(Float_t nu, Float_t *mean) const {
   // Mean number of gray nucleons
 
   Float_t nGray = fAlphaGray * nu;
@@ -66,23 +153,112 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons(Int_t ncoll, Int_t &ngp,
   Float_t nBlackNeutrons = nBlack * 0.84;
   Float_t nBlackProtons = nBlack - nBlackNeutrons;
 
+  mean[SlowNucleonMultiplicityTable::kGrayProtons] = nGrayProtons;
+  mean[SlowNucleonMultiplicityTable::kGrayNeutrons] = nGrayNeutrons;
+  mean[SlowNucleonMultiplicityTable::kBlackProtons] = nBlackProtons;
+  mean[SlowNucleonMultiplicityTable::kBlackNeutrons] = nBlackNeutrons;
+}
+
+void SlowNucleonModelExp::MeanNumbers2(Float_t nu, Float_t *mean) const {
+  Float_t nGrayp = MeanGrayProtons2(nu);
+  // Float_t blackovergray = 3./7.;// from spallation
+  Float_t blackovergray = 0.65; // from COSY
+  Float_t nBlackp = blackovergray * nGrayp;
+  mean[SlowNucleonMultiplicityTable::kGrayProtons] = nGrayp;
+  mean[SlowNucleonMultiplicityTable::kBlackProtons] = nBlackp;
+
+  if (nu < 3.) {
+    nGrayp = -0.836 + 0.9112 * nu - 0.05381 * nu * nu;
+    nBlackp = blackovergray * nGrayp;
+  }
+
+  Float_t nGrayNeutrons = 0.;
+  Float_t nBlackNeutrons = 0.;
+  Float_t cp = (nGrayp + nBlackp) / fLCPparam;
+
+  if (cp > 0.) {
+    Float_t nSlow = fSlownparam[0] + fSlownparam[1] / (-fSlownparam[2] - cp);
+    Float_t paramRetta =
+        fSlownparam[0] + fSlownparam[1] / (-fSlownparam[2] - 3);
+    if (cp < 3.)
+      nSlow = 0. + (paramRetta - 0.) / (3. - 0.) * (cp - 0.);
+
+    nGrayNeutrons = nSlow * 0.1;
+    nBlackNeutrons = nSlow - nGrayNeutrons;
+  } else {
+    // Sikler "pasturato" (qui non entra mai!!!!)
+    nGrayNeutrons = 0.47 * fAlphaGray * nu;
+    nBlackNeutrons = 0.88 * fAlphaBlack * nu;
+  }
+  mean[SlowNucleonMultiplicityTable::kGrayNeutrons] = nGrayNeutrons;
+  mean[SlowNucleonMultiplicityTable::kBlackNeutrons] = nBlackNeutrons;
+}
+
+void SlowNucleonModelExp::MeanNumbers2s(Float_t nu, Float_t nGrayp,
+                                        Float_t *mean) const {
+  // Float_t blackovergray = 3./7.;// from spallation
+  Float_t blackovergray = 0.65; // from COSY
+  Float_t nBlackp = blackovergray * nGrayp;
+  if (nBlackp < 0.)
+    nBlackp = 0.;
+
+  Float_t nGrayNeutrons = 0.;
+  Float_t nBlackNeutrons = 0.;
+  Float_t cp = (nGrayp + nBlackp) / fLCPparam;
+
+  if (cp > 0.) {
+    Float_t nSlow = fSlownparam[0] + fSlownparam[1] / (-fSlownparam[2] - cp);
+
+    nGrayNeutrons = nSlow * 0.1;
+    nBlackNeutrons = nSlow - nGrayNeutrons;
+  } else {
+    // Sikler "pasturato" (qui non entra mai!!!!)
+    nGrayNeutrons = 0.47 * fAlphaGray * nu;
+    nBlackNeutrons = 0.88 * fAlphaBlack * nu;
+  }
+  //
+  if (nGrayNeutrons < 0.)
+    nGrayNeutrons = 0.;
+  if (nBlackNeutrons < 0.)
+    nBlackNeutrons = 0.;
+
+  mean[SlowNucleonMultiplicityTable::kGrayProtons] = nGrayp;
+  mean[SlowNucleonMultiplicityTable::kGrayNeutrons] = nGrayNeutrons;
+  mean[SlowNucleonMultiplicityTable::kBlackProtons] = nBlackp;
+  mean[SlowNucleonMultiplicityTable::kBlackNeutrons] = nBlackNeutrons;
+}
+
+void SlowNucleonModelExp::GetNumberOfSlowNucleons(Int_t ncoll, Int_t &ngp,
+                                                  Int_t &ngn, Int_t &nbp,
+                                                  Int_t &nbn) const {
+  //
+  // Return the number of black and gray nucleons
+  //
+  if (GetTabulatedNumbers(0, ncoll, ngp, ngn, nbp, nbn))
+    return;
+
+  // Number of collisions
+  Float_t nu = (Float_t)(ncoll);
+  Float_t mean[4];
+  MeanNumbers(nu, mean);
+
   // Actual number (including fluctuations) from binomial distribution
   Double_t p;
 
   //  gray neutrons
-  p = nGrayNeutrons / fN;
+  p = mean[SlowNucleonMultiplicityTable::kGrayNeutrons] / fN;
   ngn = gRandom->Binomial((Int_t)fN, p);
 
   //  gray protons
-  p = nGrayProtons / fP;
+  p = mean[SlowNucleonMultiplicityTable::kGrayProtons] / fP;
   ngp = gRandom->Binomial((Int_t)fP, p);
 
   //  black neutrons
-  p = nBlackNeutrons / fN;
+  p = mean[SlowNucleonMultiplicityTable::kBlackNeutrons] / fN;
   nbn = gRandom->Binomial((Int_t)fN, p);
 
   //  black protons
-  p = nBlackProtons / fP;
+  p = mean[SlowNucleonMultiplicityTable::kBlackProtons] / fP;
   nbp = gRandom->Binomial((Int_t)fP, p);
 }
 
@@ -92,6 +268,9 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons2(Int_t ncoll, Int_t &ngp,
   //
   // Return the number of black and gray nucleons
   //
+  if (GetTabulatedNumbers(1, ncoll, ngp, ngn, nbp, nbn))
+    return;
+
   // Number of collisions
 
   // based on E910 model
@@ -104,9 +283,12 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons2(Int_t ncoll, Int_t &ngp,
   if (nu < 0.)
     nu = 0.;
   //
-  Float_t poverpd = 0.843;
-  Float_t zAu2zPb = 82. / 79.;
-  Float_t nGrayp = (-0.27 + 0.63 * nu - 0.0008 * nu * nu) * poverpd * zAu2zPb;
+  Float_t mean[4];
+  MeanNumbers2(nu, mean);
+  Float_t nGrayp = mean[SlowNucleonMultiplicityTable::kGrayProtons];
+  Float_t nBlackp = mean[SlowNucleonMultiplicityTable::kBlackProtons];
+  Float_t nGrayNeutrons = mean[SlowNucleonMultiplicityTable::kGrayNeutrons];
+  Float_t nBlackNeutrons = mean[SlowNucleonMultiplicityTable::kBlackNeutrons];
 
   //  gray protons
   Double_t p;
@@ -116,10 +298,6 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons2(Int_t ncoll, Int_t &ngp,
   if (nGrayp < 0.)
     ngp = 0;
 
-  // Float_t blackovergray = 3./7.;// from spallation
-  Float_t blackovergray = 0.65; // from COSY
-  Float_t nBlackp = blackovergray * nGrayp;
-
   //  black protons
   p = nBlackp / fP;
   nbp = gRandom->Binomial((Int_t)fP, p);
@@ -127,34 +305,6 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons2(Int_t ncoll, Int_t &ngp,
   if (nBlackp < 0.)
     nbp = 0;
 
-  if (nu < 3.) {
-    nGrayp = -0.836 + 0.9112 * nu - 0.05381 * nu * nu;
-    nBlackp = blackovergray * nGrayp;
-  }
-
-  // printf(" \t Using LCP parameter %f   Slown parameters = {%f, %f,
-  // %f}\n\n",fLCPparam,fSlownparam[0],fSlownparam[1],fSlownparam[2]);
-  Float_t nGrayNeutrons = 0.;
-  Float_t nBlackNeutrons = 0.;
-  Float_t cp = (nGrayp + nBlackp) / fLCPparam;
-
-  if (cp > 0.) {
-    Float_t nSlow = fSlownparam[0] + fSlownparam[1] / (-fSlownparam[2] - cp);
-    Float_t paramRetta =
-        fSlownparam[0] + fSlownparam[1] / (-fSlownparam[2] - 3);
-    if (cp < 3.)
-      nSlow = 0. + (paramRetta - 0.) / (3. - 0.) * (cp - 0.);
-
-    nGrayNeutrons = nSlow * 0.1;
-    nBlackNeutrons = nSlow - nGrayNeutrons;
-  } else {
-    // Sikler "pasturato" (qui non entra mai!!!!)
-    nGrayNeutrons = 0.47 * fAlphaGray * nu;
-    nBlackNeutrons = 0.88 * fAlphaBlack * nu;
-    // printf("nslowp=0 -> ncoll = %1.0f -> ngrayn = %1.0f  nblackn = %1.0f \n",
-    // nu, nGrayNeutrons, nBlackNeutrons);
-  }
-
   //  gray neutrons
   p = nGrayNeutrons / fN;
   //    ngn = gRandom->Binomial((Int_t) fN, p);
@@ -172,6 +322,9 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons2s(Int_t ncoll, Int_t &ngp,
   //
   // Return the number of black and gray nucleons
   //
+  if (GetTabulatedNumbers(2, ncoll, ngp, ngn, nbp, nbn))
+    return;
+
   // Number of collisions
 
   // based on E910 model
@@ -179,71 +332,100 @@ void SlowNucleonModelExp::GetNumberOfSlowNucleons2s(Int_t ncoll, Int_t &ngp,
 
   Float_t nu = (Float_t)(ncoll);
   //
-  Float_t poverpd = 0.843;
-  Float_t zAu2zPb = 82. / 79.;
-  Float_t grayp = (-0.27 + 0.63 * nu - 0.0008 * nu * nu) * poverpd * zAu2zPb;
+  Float_t grayp = MeanGrayProtons2(nu);
   Float_t nGrayp = gRandom->Gaus(grayp, fSigmaSmear);
   if (nGrayp < 0.)
     nGrayp = 0.;
 
+  Float_t mean[4];
+  MeanNumbers2s(nu, nGrayp, mean);
+  Float_t nBlackp = mean[SlowNucleonMultiplicityTable::kBlackProtons];
+  Float_t nGrayNeutrons = mean[SlowNucleonMultiplicityTable::kGrayNeutrons];
+  Float_t nBlackNeutrons = mean[SlowNucleonMultiplicityTable::kBlackNeutrons];
+
   //  gray protons
   Double_t p = 0.;
   p = nGrayp / fP;
   ngp = gRandom->Binomial((Int_t)fP, p);
   // ngp = gRandom->Gaus(nGrayp, TMath::Sqrt(fP*p*(1-p)));
-  if (nGrayp < 0.)
-    ngp = 0;
-
-  // Float_t blackovergray = 3./7.;// from spallation
-  Float_t blackovergray = 0.65; // from COSY
-  // Float_t blackp  = blackovergray*grayp;
-  // Float_t nBlackp = gRandom->Gaus(nblackp, fSigmaSmear);
-  Float_t nBlackp = blackovergray * nGrayp;
-  if (nBlackp < 0.)
-    nBlackp = 0.;
 
   //  black protons
   p = nBlackp / fP;
   nbp = gRandom->Binomial((Int_t)fP, p);
   // nbp = gRandom->Gaus(nBlackp, TMath::Sqrt(fP*p*(1-p)));
-  if (nBlackp < 0.)
-    nbp = 0;
-
-  Float_t nGrayNeutrons = 0.;
-  Float_t nBlackNeutrons = 0.;
-  Float_t cp = (nGrayp + nBlackp) / fLCPparam;
-
-  if (cp > 0.) {
-    Float_t nSlow = fSlownparam[0] + fSlownparam[1] / (-fSlownparam[2] - cp);
-
-    nGrayNeutrons = nSlow * 0.1;
-    nBlackNeutrons = nSlow - nGrayNeutrons;
-  } else {
-    // Sikler "pasturato" (qui non entra mai!!!!)
-    nGrayNeutrons = 0.47 * fAlphaGray * nu;
-    nBlackNeutrons = 0.88 * fAlphaBlack * nu;
-    // printf("nslowp=0 -> ncoll = %1.0f -> ngrayn = %1.0f  nblackn = %1.0f \n",
-    // nu, nGrayNeutrons, nBlackNeutrons);
-  }
-  //
-  if (nGrayNeutrons < 0.)
-    nGrayNeutrons = 0.;
-  if (nBlackNeutrons < 0.)
-    nBlackNeutrons = 0.;
 
   //  gray neutrons
   p = nGrayNeutrons / fN;
   //    ngn = gRandom->Binomial((Int_t) fN, p);
   ngn = gRandom->Gaus(nGrayNeutrons, TMath::Sqrt(fN * p * (1 - p)));
-  if (nGrayNeutrons < 0.)
-    ngn = 0;
 
   //  black neutrons
   p = nBlackNeutrons / fN;
   //    nbn = gRandom->Binomial((Int_t) fN, p);
   nbn = gRandom->Gaus(nBlackNeutrons, TMath::Sqrt(fN * p * (1 - p)));
-  if (nBlackNeutrons < 0.)
-    nbn = 0;
+}
+
+Bool_t SlowNucleonModelExp::GetComponents(
+    Int_t smearMode, Int_t ncoll,
+    std::vector<SlowNucleonMultiplicityComponent> &comp) const {
+  //
+  // P(ngp, ngn, nbp, nbn | ncoll) of the three models: the smeared input
+  // (nu for the 2nd, the gray protons for the 3rd model) is integrated over
+  // kNLatent nodes, for fixed input the numbers are independent
+  //
+  Float_t nu = (Float_t)(ncoll);
+  Float_t mean[4];
+  std::vector<std::pair<Double_t, Double_t>> nodes;
+  comp.clear();
+  switch (smearMode) {
+  case 0:
+    MeanNumbers(nu, mean);
+    AddComponent(1., mean, kFALSE, comp);
+    return kTRUE;
+  case 1:
+    LatentNodes(nu, 0.5, nodes);
+    for (const auto &node : nodes) {
+      MeanNumbers2(node.first, mean);
+      AddComponent(node.second, mean, kTRUE, comp);
+    }
+    return kTRUE;
+  case 2:
+    LatentNodes(MeanGrayProtons2(nu), fSigmaSmear, nodes);
+    for (const auto &node : nodes) {
+      MeanNumbers2s(nu, node.first, mean);
+      AddComponent(node.second, mean, kTRUE, comp);
+    }
+    return kTRUE;
+  default:
+    return kFALSE;
+  }
+}
+
+void SlowNucleonModelExp::AddComponent(
+    Double_t weight, const Float_t *mean, Bool_t gausNeutrons,
+    std::vector<SlowNucleonMultiplicityComponent> &comp) const {
+  // Distributions of the numbers for given means as drawn in
+  // GetNumberOfSlowNucleons...: binomial for protons, binomial or gaussian
+  // truncated to integer for neutrons
+  if (weight <= 0.)
+    return;
+  comp.emplace_back();
+  auto &c = comp.back();
+  c.fWeight = weight;
+  for (Int_t i : {SlowNucleonMultiplicityTable::kGrayProtons,
+                  SlowNucleonMultiplicityTable::kBlackProtons}) {
+    Double_t p = mean[i] / fP;
+    BinomialProbs((Int_t)fP, p, c.fMin[i], c.fProb[i]);
+  }
+  for (Int_t i : {SlowNucleonMultiplicityTable::kGrayNeutrons,
+                  SlowNucleonMultiplicityTable::kBlackNeutrons}) {
+    Double_t p = mean[i] / fN;
+    if (gausNeutrons)
+      TruncatedGausProbs(mean[i], TMath::Sqrt(fN * p * (1 - p)), c.fMin[i],
+                         c.fProb[i]);
+    else
+      BinomialProbs((Int_t)fN, p, c.fMin[i], c.fProb[i]);
+  }
 }
 
 void SlowNucleonModelExp::SetParameters(Float_t alpha1, Float_t alpha2) {
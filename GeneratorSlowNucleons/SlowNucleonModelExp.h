@@ -46,6 +46,18 @@ public:
   }
 
 protected:
+  // Mean numbers (ngp, ngn, nbp, nbn) of the three models for the (smeared)
+  // number of collisions nu and, in the 3rd model, the smeared gray protons
+  Float_t MeanGrayProtons2(Float_t nu) const;
+  void MeanNumbers(Float_t nu, Float_t *mean) const;
+  void MeanNumbers2(Float_t nu, Float_t *mean) const;
+  void MeanNumbers2s(Float_t nu, Float_t nGrayp, Float_t *mean) const;
+  virtual Bool_t
+  GetComponents(Int_t smearMode, Int_t ncoll,
+                std::vector<SlowNucleonMultiplicityComponent> &comp) const;
+  void AddComponent(Double_t weight, const Float_t *mean, Bool_t gausNeutrons,
+                    std::vector<SlowNucleonMultiplicityComponent> &comp) const;
+
   Float_t fP;          // Number of protons  in the target
   Float_t fN;          // Number of neutrons in the target
   Float_t fAlphaGray;  // Proportionality between gray   particles and number of
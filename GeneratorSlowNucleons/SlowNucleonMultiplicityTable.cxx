@@ -0,0 +1,138 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "SlowNucleonMultiplicityTable.h"
+#include <TMath.h>
+#include <algorithm>
+
+//____________________________________________________________
+Bool_t SlowNucleonMultiplicityTable::Set(
+    Int_t ncoll,
+    const std::vector<SlowNucleonMultiplicityComponent> &components) {
+  if (ncoll < 0 || components.empty()) {
+    printf("SlowNucleonMultiplicityTable: ERROR: Nothing to tabulate for "
+           "ncoll=%d\n",
+           ncoll);
+    return kFALSE;
+  }
+  if (ncoll >= (Int_t)fTables.size())
+    fTables.resize(ncoll + 1);
+  Table &table = fTables[ncoll];
+  table = Table();
+
+  // cumulatives of the components with non-zero weight
+  Double_t total = 0.;
+  for (const auto &c : components) {
+    if (!(c.fWeight > 0.))
+      continue;
+    Bool_t empty = kFALSE;
+    for (Int_t i = 0; i < 4; i++) {
+      Marginal m;
+      m.fMin = c.fMin[i];
+      Double_t sum = 0.;
+      for (auto p : c.fProb[i])
+        m.fCum.push_back(sum += p);
+      if (!(sum > 0.)) {
+        empty = kTRUE;
+        break;
+      }
+      for (auto &f : m.fCum)
+        f /= sum;
+      table.fComp.push_back(m);
+    }
+    if (empty) {
+      table.fComp.resize(table.fWeight.size() * 4);
+      continue;
+    }
+    table.fWeight.push_back(c.fWeight);
+    total += c.fWeight;
+  }
+  Int_t n = table.fWeight.size();
+  if (n == 0) {
+    printf("SlowNucleonMultiplicityTable: ERROR: Empty distribution for "
+           "ncoll=%d\n",
+           ncoll);
+    table = Table();
+    return kFALSE;
+  }
+  for (auto &w : table.fWeight)
+    w /= total;
+
+  // Walker alias table of the components
+  table.fAccept.assign(n, 1.);
+  table.fAlias.resize(n);
+  std::vector<Double_t> scaled(n);
+  std::vector<Int_t> small, large;
+  for (Int_t i = 0; i < n; i++) {
+    table.fAlias[i] = i;
+    scaled[i] = table.fWeight[i] * n;
+    if (scaled[i] < 1.)
+      small.push_back(i);
+    else
+      large.push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    Int_t s = small.back();
+    small.pop_back();
+    Int_t l = large.back();
+    table.fAccept[s] = scaled[s];
+    table.fAlias[s] = l;
+    scaled[l] -= 1. - scaled[s];
+    if (scaled[l] < 1.) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  return kTRUE;
+}
+
+//____________________________________________________________
+void SlowNucleonMultiplicityTable::Sample(Int_t ncoll, const Double_t *r,
+                                          Int_t *n) const {
+  //
+  // r[0] selects the component, r[1..4] the four numbers: recycling one
+  // random number through all stages would leave too few bits for the
+  // last ones
+  //
+  const Table &table = fTables[ncoll];
+  Int_t ncomp = table.fWeight.size();
+  Double_t x = r[0] * ncomp;
+  Int_t ic = TMath::Min(Int_t(x), ncomp - 1);
+  if (x - ic >= table.fAccept[ic])
+    ic = table.fAlias[ic];
+  for (Int_t i = 0; i < 4; i++) {
+    const Marginal &m = table.fComp[4 * ic + i];
+    Int_t last = m.fCum.size() - 1;
+    Int_t k = std::upper_bound(m.fCum.begin(), m.fCum.end(), r[i + 1]) - m.fCum.begin();
+    n[i] = m.fMin + TMath::Min(k, last);
+  }
+}
+
+//____________________________________________________________
+Double_t SlowNucleonMultiplicityTable::GetProbability(Int_t ncoll,
+                                                      const Int_t *n) const {
+  if (!IsTabulated(ncoll))
+    return 0.;
+  const Table &table = fTables[ncoll];
+  Double_t prob = 0.;
+  for (UInt_t ic = 0; ic < table.fWeight.size(); ic++) {
+    Double_t p = table.fWeight[ic];
+    for (Int_t i = 0; i < 4 && p > 0.; i++) {
+      const Marginal &m = table.fComp[4 * ic + i];
+      Int_t k = n[i] - m.fMin;
+      if (k < 0 || k >= (Int_t)m.fCum.size())
+        p = 0.;
+      else
+        p *= m.fCum[k] - (k > 0 ? m.fCum[k - 1] : 0.);
+    }
+    prob += p;
+  }
+  return prob;
+}
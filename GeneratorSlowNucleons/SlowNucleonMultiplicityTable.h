@@ -0,0 +1,66 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_SLOWNUCLEONMULTIPLICITYTABLE_H
+#define O2_SLOWNUCLEONMULTIPLICITYTABLE_H
+
+//
+// Joint distribution P(ngp, ngn, nbp, nbn | ncoll) of the numbers of gray
+// and black protons and neutrons, tabulated per ncoll. The distribution is
+// a mixture of components (values of the smeared input of a model) within
+// which the four numbers are independent; it is stored in this factorised
+// form, since the joint has O(1e6) populated cells per ncoll. One random
+// number selects the component from a Walker alias table, one each gives
+// the four numbers by inversion of their cumulatives.
+//
+#include <Rtypes.h>
+#include <vector>
+
+struct SlowNucleonMultiplicityComponent {
+  Double_t fWeight = 1.;            // probability of the component
+  Int_t fMin[4] = {0, 0, 0, 0};     // smallest number listed in fProb
+  std::vector<Double_t> fProb[4];   // P(fMin[i]), P(fMin[i] + 1), ...
+};
+
+class SlowNucleonMultiplicityTable {
+public:
+  enum { kGrayProtons, kGrayNeutrons, kBlackProtons, kBlackNeutrons };
+
+  SlowNucleonMultiplicityTable() = default;
+
+  // Tabulate the mixture for ncoll
+  Bool_t Set(Int_t ncoll,
+             const std::vector<SlowNucleonMultiplicityComponent> &components);
+  Bool_t IsTabulated(Int_t ncoll) const {
+    return ncoll >= 0 && ncoll < (Int_t)fTables.size() &&
+           !fTables[ncoll].fComp.empty();
+  }
+  // Numbers n[4] (ngp, ngn, nbp, nbn) for the random numbers r[5] in [0, 1)
+  void Sample(Int_t ncoll, const Double_t *r, Int_t *n) const;
+  Double_t GetProbability(Int_t ncoll, const Int_t *n) const;
+  Int_t GetNComponents(Int_t ncoll) const {
+    return IsTabulated(ncoll) ? fTables[ncoll].fComp.size() / 4 : 0;
+  }
+
+private:
+  struct Marginal {
+    Int_t fMin = 0;             // smallest number
+    std::vector<Double_t> fCum; // P(n <= fMin + k), normalised to 1
+  };
+  struct Table {
+    std::vector<Marginal> fComp;   // 4 marginals per component
+    std::vector<Double_t> fWeight; // normalised weights of the components
+    std::vector<Double_t> fAccept; // alias table: acceptance of the column
+    std::vector<Int_t> fAlias;     // alias table: alias of the column
+  };
+
+  std::vector<Table> fTables; // by ncoll
+};
+#endif
@@ -19,6 +19,7 @@
 #include <TParticle.h>
 #include <TParticlePDG.h>
 #include <TRandom.h>
+#include <algorithm>
 #include <assert.h>
 
 #include "GeneratorSpectators.h"
@@ -29,7 +30,10 @@ ClassImp(GeneratorSpectators)
 GeneratorSpectators::GeneratorSpectators()
    :TGenerator("GeneratorSpectators", "GeneratorSpectators"), fDebug(0),
    fPDGcode(0), fPmax(0), fPseudoRapidity(0), fCosx(0), fCosy(0), fCosz(0),
-   fFermiflag(1),fBeamDiv(0), fBeamCrossAngle(0), fBeamCrossPlane(0) {
+   fFermiflag(1),fBeamDiv(0), fBeamDivMode(GeneratorBeamEffects::kPerParticle),
+   fBeamCrossAngle(0), fBeamCrossPlane(0), fA(208), fZ(82), fFullEvent(kFALSE),
+   fFermiTables(), fMomenta(), fRndm(), fBeamEffects(), fBeamEffectsC() {
+  for(Int_t i=0; i<4; i++) fNSpectators[i] = 0;
   //
   // Default constructor
 }
@@ -48,7 +52,11 @@ GeneratorSpectators::GeneratorSpectators(Int_t npart)
   SetDirection();
   SetFermi();
   SetDivergence();
+  SetDivergenceMode();
   SetCrossing();
+  SetNucleus();
+  fFullEvent = kFALSE;
+  for(Int_t i=0; i<4; i++) fNSpectators[i] = 0;
 
   for(Int_t i=0; i<201; i++){
      fProbintp[i] = 0;
@@ -67,16 +75,25 @@ void GeneratorSpectators::Init()
   printf("   Fermi flag: %d, Beam divergence: %f, Crossing angle: %f, plane: %d\n\n",
              fFermiflag, fBeamDiv, fBeamCrossAngle, fBeamCrossPlane);
 
-  FermiTwoGaussian(208.);
+  FermiTwoGaussian(fA);
+  // the crossing angle kicks both beams to the same side: the beam
+  // towards C, along -z, is rotated by the opposite angle
+  fBeamEffects.Configure(fBeamCrossAngle, fBeamCrossPlane, fBeamDiv, fBeamDivMode);
+  fBeamEffectsC.Configure(-fBeamCrossAngle, fBeamCrossPlane, fBeamDiv, fBeamDivMode);
 }
 
 //_____________________________________________________________________________
 void GeneratorSpectators::GenerateEvent()
 {
   //
-  // Generate one trigger particle (n or p)
+  // Generate one trigger particle (n or p), or all spectators in full
+  // event mode
   //
   //printf("GeneratorSpectators::GenerateEvent()\n");
+  if(fFullEvent){
+    GenerateSpectators(fNSpectators[0], fNSpectators[1], fNSpectators[2], fNSpectators[3]);
+    return;
+  }
   fParticles->Clear();
 
   Double_t pLab[3] = {0.,0.,0.};
@@ -97,15 +114,12 @@ void GeneratorSpectators::GenerateEvent()
  if(fDebug==1) printf("\n Particle momentum before divergence and crossing: ");
  if(fDebug==1) printf(" 	pLab = (%f, %f, %f)\n", pLab[0], pLab[1], pLab[2]);
 
-  // Beam divergence and crossing angle
-  if(TMath::Abs(fBeamCrossAngle)>0.) {
-    BeamCrossing(pLab);
-    for(int i=0; i<3; i++) fP[i] = pLab[i];
-  }
-  if(TMath::Abs(fBeamDiv)>0.) {
-    BeamDivergence(pLab);
-    for(int i=0; i<3; i++) fP[i] = pLab[i];
-  }
+  // Beam divergence and crossing angle of the beam the particle moves with
+  GeneratorBeamEffects &beam = pLab[2] < 0. ? fBeamEffectsC : fBeamEffects;
+  beam.NewEvent(gRandom);
+  beam.Apply(1, pLab, gRandom);
+  for(int i=0; i<3; i++) fP[i] = pLab[i];
+ if(fDebug==1) printf(" After divergence and crossing: p = (%f, %f, %f)\n", pLab[0], pLab[1], pLab[2]);
 
   Double_t mass = TDatabasePDG::Instance()->GetParticle(fPDGcode)->Mass();
   Double_t ddp[3] = {0.,0.,0.}, dddp[3] = {0.,0.,0.};
@@ -149,6 +163,128 @@ int GeneratorSpectators::ImportParticles(TClonesArray *particles, Option_t *opti
   return numpart;
 }
 
+//_____________________________________________________________________________
+void GeneratorSpectators::GenerateSpectators(Int_t nProtonsA, Int_t nNeutronsA,
+                                             Int_t nProtonsC, Int_t nNeutronsC)
+{
+  //
+  // Generate the spectator protons and neutrons of one collision. Fermi
+  // momenta in the rest frame of the nucleus are boosted with the beam
+  // momentum per nucleon, then the crossing angle and divergence of the
+  // beam are applied to all nucleons of a side at once. The crossing angle
+  // gives both sides the same transverse kick.
+  //
+  fParticles->Clear();
+  const FermiTable &fermi = GetFermiTable(fA);
+  const Int_t nspec[4] = {nProtonsA, nNeutronsA, nProtonsC, nNeutronsC};
+  const Int_t pdg[2] = {kProton, kNeutron};
+  Double_t mass[2];
+  for(Int_t j=0; j<2; j++) mass[j] = TDatabasePDG::Instance()->GetParticle(pdg[j])->Mass();
+
+  Int_t ntot = 0;
+  for(Int_t is=0; is<4; is++) ntot += TMath::Max(nspec[is], 0);
+  fMomenta.resize(3*ntot);
+
+  Int_t k = 0;
+  for(Int_t side=0; side<2; side++){
+    Double_t dir = side==0 ? 1. : -1.;
+    Int_t first = k;
+    for(Int_t j=0; j<2; j++){
+      Int_t n = TMath::Max(nspec[2*side+j], 0);
+      Double_t *p = fMomenta.data() + 3*k;
+      k += n;
+      if(fFermiflag!=1){
+        for(Int_t i=0; i<n; i++){
+          p[3*i] = p[3*i+1] = 0.;
+          p[3*i+2] = dir*fPmax;
+        }
+        continue;
+      }
+      // boost along dir*z from the rest frame of the nucleus
+      Double_t m = mass[j];
+      Double_t gamma = TMath::Sqrt(fPmax*fPmax + m*m)/m;
+      Double_t betagamma = dir*fPmax/m;
+      fRndm.resize(3*n);
+      gRandom->RndmArray(3*n, fRndm.data());
+      for(Int_t i=0; i<n; i++){
+        Double_t pext = SampleFermi(fermi, pdg[j], fRndm[3*i]);
+        Double_t phi = TMath::TwoPi()*fRndm[3*i+1];
+        Double_t cost = 1.-2.*fRndm[3*i+2];
+        Double_t sint = TMath::Sqrt((1.-cost)*(1.+cost));
+        Double_t pz = pext*cost;
+        p[3*i] = pext*sint*TMath::Cos(phi);
+        p[3*i+1] = pext*sint*TMath::Sin(phi);
+        p[3*i+2] = gamma*pz + betagamma*TMath::Sqrt(pext*pext + m*m);
+      }
+    }
+    // each beam has its own divergence, the crossing angle is mirrored for C
+    GeneratorBeamEffects &beam = side==0 ? fBeamEffects : fBeamEffectsC;
+    beam.NewEvent(gRandom);
+    beam.Apply(k-first, fMomenta.data() + 3*first, gRandom);
+  }
+
+  k = 0;
+  for(Int_t is=0; is<4; is++){
+    Double_t m = mass[is%2];
+    for(Int_t i=0; i<nspec[is]; i++, k++){
+      const Double_t *p = fMomenta.data() + 3*k;
+      Double_t energy = TMath::Sqrt(p[0]*p[0]+p[1]*p[1]+p[2]*p[2]+m*m);
+      auto part = new TParticle(pdg[is%2], 1, -1, -1, -1, -1, p[0], p[1], p[2], energy,
+                                0., 0., 0., 0.);
+      fParticles->Add(part);
+    }
+  }
+}
+
+//_____________________________________________________________________________
+const GeneratorSpectators::FermiTable &GeneratorSpectators::GetFermiTable(Int_t a)
+{
+//
+// Momenta distributions according to the "double-gaussian"
+// distribution (Ilinov) - equal for protons and neutrons - of the
+// nucleus of mass number a, computed on first use
+//
+  for(const auto &table : fFermiTables)
+    if(table.fA == a) return table;
+
+  Float_t A = a;
+  Double_t sig1 = 0.113;
+  Double_t sig2 = 0.250;
+  Double_t alfa = 0.18*(TMath::Power((A/12.), (Float_t)1/3));
+  Double_t xk = (2*TMath::TwoPi())/((1.+alfa)*(TMath::Power(TMath::TwoPi(),1.5)));
+
+  FermiTable table;
+  table.fA = a;
+  std::vector<Double_t> &cum = table.fCum[0];
+  cum.assign(201, 0.);
+  for(Int_t i=1; i<201; i++){
+    Double_t p = i*0.005;
+    Double_t e1 = (p*p)/(2.*sig1*sig1);
+    Double_t e2 = (p*p)/(2.*sig2*sig2);
+    Double_t f1 = TMath::Exp(-(e1));
+    Double_t f2 = TMath::Exp(-(e2));
+    Double_t probp = xk*p*p*(f1/(TMath::Power(sig1,3.))+
+                    alfa*f2/(TMath::Power(sig2,3.)))*0.005;
+    cum[i] = cum[i-1] + probp;
+  }
+  table.fCum[1] = cum;
+  fFermiTables.push_back(table);
+  return fFermiTables.back();
+}
+
+//_____________________________________________________________________________
+Double_t GeneratorSpectators::SampleFermi(const FermiTable &table, Int_t id, Double_t r) const
+{
+  //
+  // Fermi momentum at the random number r: lower edge of the bin
+  // cum[i-1] <= r < cum[i], found by binary search
+  //
+  const std::vector<Double_t> &cum = table.fCum[id==kProton ? 0 : 1];
+  Int_t index = std::upper_bound(cum.begin(), cum.end(), r) - cum.begin() - 1;
+  if(index<0) index = 0;
+  return index*0.005+0.001;
+}
+
 //_____________________________________________________________________________
 void GeneratorSpectators::FermiTwoGaussian(Float_t A)
 {
@@ -156,23 +292,12 @@ void GeneratorSpectators::FermiTwoGaussian(Float_t A)
 // Momenta distributions according to the "double-gaussian"
 // distribution (Ilinov) - equal for protons and neutrons
 //
-   Double_t sig1 = 0.113;
-   Double_t sig2 = 0.250;
-   Double_t alfa = 0.18*(TMath::Power((A/12.), (Float_t)1/3));
-   Double_t xk = (2*TMath::TwoPi())/((1.+alfa)*(TMath::Power(TMath::TwoPi(),1.5)));
-
-   for(Int_t i=1; i<201; i++){
-      Double_t p = i*0.005;
-      fPp[i] = p;
-      Double_t e1 = (p*p)/(2.*sig1*sig1);
-      Double_t e2 = (p*p)/(2.*sig2*sig2);
-      Double_t f1 = TMath::Exp(-(e1));
-      Double_t f2 = TMath::Exp(-(e2));
-      Double_t probp = xk*p*p*(f1/(TMath::Power(sig1,3.))+
-                      alfa*f2/(TMath::Power(sig2,3.)))*0.005;
-      fProbintp[i] = fProbintp[i-1] + probp;
-      fProbintn[i] = fProbintp[i];
-   }
+  const FermiTable &table = GetFermiTable(Int_t(A));
+  for(Int_t i=0; i<201; i++){
+     fPp[i] = i*0.005;
+     fProbintp[i] = table.fCum[0][i];
+     fProbintn[i] = table.fCum[1][i];
+  }
   if(fDebug==1) printf("		Initialization of Fermi momenta distribution \n");
 }
 //_____________________________________________________________________________
@@ -181,22 +306,9 @@ void GeneratorSpectators::ExtractFermi(Int_t id, Double_t *ddp)
   //
   // Compute Fermi momentum for spectator nucleons
   //
-  Int_t index=0;
   Float_t xx = gRandom->Rndm();
   assert ( id==kProton || id==kNeutron );
-  if(id==kProton){
-    for(Int_t i=1; i<201; i++){
-       if((xx>=fProbintp[i-1]) && (xx<fProbintp[i])) break;
-       index = i;
-    }
-  }
-  else {
-    for(Int_t i=1; i<201; i++){
-       if((xx>=fProbintn[i-1]) && (xx<fProbintn[i])) break;
-       index = i;
-    }
-  }
-  Float_t pext = fPp[index]+0.001;
+  Float_t pext = SampleFermi(GetFermiTable(fA), id, xx);
   Float_t phi = TMath::TwoPi()*(gRandom->Rndm());
   Float_t cost = (1.-2.*(gRandom->Rndm()));
   Float_t tet = TMath::ACos(cost);
@@ -206,86 +318,3 @@ void GeneratorSpectators::ExtractFermi(Int_t id, Double_t *ddp)
 
  if(fDebug==1) printf(" Fermi momentum: p = (%f, %f, %f )\n\n",ddp[0],ddp[1],ddp[2]);
 }
-//_____________________________________________________________________________
-void GeneratorSpectators::BeamCrossing(Double_t *pLab)
-{
-  // Applying beam crossing angle
-  //
-  pLab[1] = pLab[2]*TMath::Sin(fBeamCrossAngle)+pLab[1]*TMath::Cos(fBeamCrossAngle);
-  pLab[2] = pLab[2]*TMath::Cos(fBeamCrossAngle)-pLab[1]*TMath::Sin(fBeamCrossAngle);
-  //
- if(fDebug==1) printf(" Beam crossing angle = %f mrad -> ", fBeamCrossAngle*1000.);
- if(fDebug==1) printf("  p = (%f, %f, %f)\n",pLab[0],pLab[1],pLab[2]);
-
-}
-//_____________________________________________________________________________
-void GeneratorSpectators::BeamDivergence(Double_t *pLab)
-{
-  // Applying beam divergence and crossing angle
-  //
-  Double_t pmq = 0.;
-  for(int i=0; i<3; i++) pmq = pmq+pLab[i]*pLab[i];
-  Double_t pmod = TMath::Sqrt(pmq);
-
-  Double_t rvec = gRandom->Gaus(0.0,1.0);
-  Double_t tetdiv = fBeamDiv * TMath::Abs(rvec);
-  Double_t fidiv = (gRandom->Rndm())*TMath::TwoPi();
-
-  Double_t tetpart = TMath::ATan2(TMath::Sqrt(pLab[0]*pLab[0]+pLab[1]*pLab[1]),pLab[2]);
-  Double_t fipart = 0.;
-  if(pLab[1]!=0. || pLab[0]!=0.) fipart = TMath::ATan2(pLab[1],pLab[0]);
-  else fipart = 0.;
-  if(fipart<0.) {fipart = fipart+TMath::TwoPi();}
-  tetdiv = tetdiv*TMath::RadToDeg();
-  fidiv = fidiv*TMath::RadToDeg();
-  tetpart = tetpart*TMath::RadToDeg();
-  fipart = fipart*TMath::RadToDeg();
-  Double_t angleSum[2] = {0., 0.};
-  AddAngle(tetpart,fipart,tetdiv,fidiv,angleSum);
-  Double_t tetsum = angleSum[0];
-  Double_t fisum  = angleSum[1];
-  tetsum = tetsum*TMath::DegToRad();
-  fisum = fisum*TMath::DegToRad();
-  pLab[0] = pmod*TMath::Sin(tetsum)*TMath::Cos(fisum);
-  pLab[1] = pmod*TMath::Sin(tetsum)*TMath::Sin(fisum);
-  pLab[2] = pmod*TMath::Cos(tetsum);
-  //
- if(fDebug==1) printf(" Beam divergence = %f mrad -> ", fBeamDiv*1000.);
- if(fDebug==1) printf("  p = (%f, %f, %f)\n",pLab[0],pLab[1],pLab[2]);
-}
-
-//_____________________________________________________________________________
-void  GeneratorSpectators::AddAngle(Double_t theta1, Double_t phi1, Double_t theta2,
-  	       Double_t phi2, Double_t *angleSum)
-{
-  // Calculating the sum of 2 angles
-  Double_t temp = -1.;
-  Double_t conv = 180./TMath::ACos(temp);
-  Double_t ct1 = TMath::Cos(theta1/conv);
-  Double_t st1 = TMath::Sin(theta1/conv);
-  Double_t cp1 = TMath::Cos(phi1/conv);
-  Double_t sp1 = TMath::Sin(phi1/conv);
-  Double_t ct2 = TMath::Cos(theta2/conv);
-  Double_t st2 = TMath::Sin(theta2/conv);
-  Double_t cp2 = TMath::Cos(phi2/conv);
-  Double_t sp2 = TMath::Sin(phi2/conv);
-  Double_t cx = ct1*cp1*st2*cp2+st1*cp1*ct2-sp1*st2*sp2;
-  Double_t cy = ct1*sp1*st2*cp2+st1*sp1*ct2+cp1*st2*sp2;
-  Double_t cz = ct1*ct2-st1*st2*cp2;
-
-  Double_t rtetsum = TMath::ACos(cz);
-  Double_t tetsum = conv*rtetsum;
-  Double_t fisum = 0;
-  if (tetsum == 0. || tetsum == 180.)
-  {
-    fisum = 0.;
-    return;
-  }
-  temp = cx/TMath::Sin(rtetsum);
-  if(temp>1.) temp=1.;
-  else if (temp < -1.) temp = -1.;
-  fisum = conv*TMath::ACos(temp);
-  if(cy<0) {fisum = 360.-fisum;}
-  angleSum[0] = tetsum;
-  angleSum[1] = fisum;
-}
@@ -14,7 +14,9 @@
 //
 //
 
+#include "GeneratorBeamEffects.h"
 #include <TGenerator.h>
+#include <vector>
 
 class GeneratorSpectators : public TGenerator {
 
@@ -26,13 +28,14 @@ public:
   virtual void GenerateEvent();
   virtual int ImportParticles(TClonesArray *particles, Option_t *option);
 
+  // Full event: all spectator protons and neutrons of the nuclei moving
+  // towards A (+z) and C (-z) with the momentum per nucleon fPmax
+  void GenerateSpectators(Int_t nProtonsA, Int_t nNeutronsA, Int_t nProtonsC,
+                          Int_t nNeutronsC);
+
   // Fermi smearing, beam divergence and crossing angle
   void FermiTwoGaussian(Float_t A);
   void ExtractFermi(Int_t id, Double_t *ddp);
-  void BeamDivergence(Double_t *pLab);
-  void BeamCrossing(Double_t *pLab);
-  void AddAngle(Double_t theta1, Double_t phi1, Double_t theta2,
-  	            Double_t phi2, Double_t *angle);
 
   // Parameters that could be set for generation
   void SetDebug() { fDebug = kTRUE; }
@@ -41,7 +44,13 @@ public:
   void SetDirection(Float_t eta = 0, Float_t cosx = 0, Float_t cosy = 0, Float_t cosz = 1)
                    { fPseudoRapidity = eta; fCosx = cosx; fCosy = cosy; fCosz = cosz; };
   void SetFermi(Int_t Fflag = 1) { fFermiflag = Fflag; };
+  void SetNucleus(Int_t a = 208, Int_t z = 82) { fA = a; fZ = z; };
+  // Numbers of spectators for GenerateEvent in full event mode
+  void SetSpectators(Int_t nProtonsA, Int_t nNeutronsA, Int_t nProtonsC, Int_t nNeutronsC)
+             { fNSpectators[0] = nProtonsA; fNSpectators[1] = nNeutronsA;
+               fNSpectators[2] = nProtonsC; fNSpectators[3] = nNeutronsC; fFullEvent = kTRUE; };
   void SetDivergence(Float_t bmdiv = 0.000032) { fBeamDiv = bmdiv; };
+  void SetDivergenceMode(Int_t mode = GeneratorBeamEffects::kPerParticle) { fBeamDivMode = mode; };
   void SetCrossing(Float_t xingangle = 0.0001, Int_t xingplane = 2)
              { fBeamCrossAngle = xingangle; fBeamCrossPlane = xingplane; };
 
@@ -51,6 +60,15 @@ public:
   Float_t GetZDirection() const {return fCosz; }
 
 protected:
+  // Cumulative Fermi momentum distributions of a nucleus, which depend on
+  // its mass number only
+  struct FermiTable {
+    Int_t fA;                        // mass number
+    std::vector<Double_t> fCum[2];   // protons, neutrons
+  };
+  const FermiTable &GetFermiTable(Int_t a);
+  Double_t SampleFermi(const FermiTable &table, Int_t id, Double_t r) const;
+
   Int_t    fDebug;              // debugging Fflag
   Int_t    fPDGcode;            // Particle to be generated - can be n (2112) or p (2212)
   Float_t  fPmax;               // Maximum slow nucleon momentum
@@ -60,18 +78,28 @@ protected:
   Float_t  fCosz;               // Director cos of the track - z direction
   Int_t    fFermiflag;          // Fermi momentum flag (=1 -> Fermi smearing)
   Float_t  fBeamDiv;            // Beam divergence (angle in rad)
+  Int_t    fBeamDivMode;        // Divergence per event or per particle
   Float_t  fBeamCrossAngle;     // Beam crossing angle (angle in rad)
   Int_t    fBeamCrossPlane;     // Beam crossing plane
                                 // (=1 -> horizontal, =2 -> vertical plane)
   Double_t fProbintp[201];      // Protons momentum distribution due to Fermi
   Double_t fProbintn[201];      // Neutrons momentum distribution due to Fermi
   Double_t fPp[201];            // Spectator momenta
+  Int_t    fA;                  // Mass number of the nuclei
+  Int_t    fZ;                  // Charge of the nuclei
+  Bool_t   fFullEvent;          // Generate all spectators of a collision
+  Int_t    fNSpectators[4];     // Spectator p, n towards A and p, n towards C
+  std::vector<FermiTable> fFermiTables; //! Fermi distributions by nucleus
+  std::vector<Double_t> fMomenta;       //! Momenta of the current event
+  std::vector<Double_t> fRndm;          //! Random numbers of the current event
+  GeneratorBeamEffects fBeamEffects;  //! Crossing angle and divergence, beam towards A
+  GeneratorBeamEffects fBeamEffectsC; //! Same for the beam towards C, mirrored crossing
 
  private:
   GeneratorSpectators(const GeneratorSpectators &gen);
   GeneratorSpectators & operator=(const GeneratorSpectators &gen);
 
-   ClassDef(GeneratorSpectators,1)  	// Generator for spectators
+   ClassDef(GeneratorSpectators,2)  	// Generator for spectators
 };
 
 #endif
@@ -64,11 +64,13 @@ extern "C" {
 ClassImp(TEpEmGen)
 
 //------------------------------------------------------------------------------
-TEpEmGen::TEpEmGen() : TGenerator("TEpEmGen","TEpEmGen")
+TEpEmGen::TEpEmGen() : TGenerator("TEpEmGen","TEpEmGen"), fNative(kFALSE),
+  fSurrogateCheck(0.01), fSurrogateEnvelope(1.)
 {
 // TEpEmGen constructor: creates a TClonesArray in which it will store all
 // particles. Note that there may be only one functional TEpEmGen object
-// at a time, so it's not use to create more than one instance of it.
+// at a time with the fortran generator, so it's not use to create more
+// than one instance of it unless SetNativeGenerator is used.
 
 }
 
@@ -88,20 +90,82 @@ void TEpEmGen::GenerateEvent(Double_t ymin, Double_t ymax, Double_t ptmin, Doubl
 			     Double_t &phi12,     Double_t &weight)
 {
   //produce one event
+  if (fNative) {
+    fSampler.Generate(1,gRandom,&yElectron,&yPositron,&xElectron,&xPositron,&phi12,&weight);
+    return;
+  }
   ee_event(ymin,ymax,ptmin,ptmax,
 	   yElectron,yPositron,xElectron,xPositron,
 	   phi12,weight);
 }
 
+//______________________________________________________________________________
+void TEpEmGen::GenerateEvents(Int_t n, Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
+			      Double_t *yElectron, Double_t *yPositron,
+			      Double_t *xElectron, Double_t *xPositron,
+			      Double_t *phi12,     Double_t *weight)
+{
+  //produce n events, in one go with the C++ sampler
+  if (fNative) {
+    fSampler.Generate(n,gRandom,yElectron,yPositron,xElectron,xPositron,phi12,weight);
+    return;
+  }
+  for (Int_t i=0; i<n; i++)
+    ee_event(ymin,ymax,ptmin,ptmax,
+	     yElectron[i],yPositron[i],xElectron[i],xPositron[i],
+	     phi12[i],weight[i]);
+}
+
+//______________________________________________________________________________
+void TEpEmGen::GenerateEvents(Int_t n, Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
+			      Double_t wmax, const Double_t *u,
+			      Double_t *yElectron, Double_t *yPositron,
+			      Double_t *xElectron, Double_t *xPositron,
+			      Double_t *phi12,     Double_t *weight, Double_t *h)
+{
+  //produce n events for the test u*wmax < weight, with the surrogate if any
+  if (HasSurrogate()) {
+    fSampler.Generate(n,gRandom,fSurrogate,wmax,fSurrogateCheck,fSurrogateEnvelope,u,
+		      yElectron,yPositron,xElectron,xPositron,phi12,weight,h);
+    return;
+  }
+  GenerateEvents(n,ymin,ymax,ptmin,ptmax,yElectron,yPositron,xElectron,xPositron,phi12,weight);
+  for (Int_t i=0; i<n; i++) h[i] = 1;
+}
+
 //______________________________________________________________________________
 void TEpEmGen::Initialize(Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax, Double_t cm_energy, Double_t Z)
 {
   // Initialize EpEmGen
   Double_t ptminMeV = ptmin*1000;
   Double_t ptmaxMeV = ptmax*1000;
+  if (fNative) {
+    fSampler.Init(ymin,ymax,ptminMeV,ptmaxMeV,cm_energy,Z);
+    return;
+  }
   ee_init(ymin,ymax,ptminMeV,ptmaxMeV,cm_energy,Z);
 }
 
+//______________________________________________________________________________
+Bool_t TEpEmGen::InitSurrogate(Double_t eps, Int_t maxNodes, const char *file)
+{
+  // Tabulate the cross section, or read the table from file. The envelope
+  // factor starts at 1.5 times the largest ratio of the exact cross section
+  // to the table found in the check of the table.
+  if (!fNative || !fSampler.IsInitialised()) {
+    printf("TEpEmGen: surrogate needs the initialised C++ sampler\n");
+    return kFALSE;
+  }
+  const Int_t kNCheck = 10000;
+  Bool_t done = file && file[0] && fSurrogate.Read(file,fSampler,eps,maxNodes);
+  if (!done) {
+    if (!fSurrogate.Build(fSampler,gRandom,eps,maxNodes,kNCheck)) return kFALSE;
+    if (file && file[0]) fSurrogate.Write(file);
+  }
+  fSurrogateEnvelope = 1.5*(1+fSurrogate.GetMaxRelError());
+  return kTRUE;
+}
+
 //______________________________________________________________________________
 Int_t TEpEmGen::ImportParticles(TClonesArray *particles, Option_t *option)
 {
@@ -121,6 +185,7 @@ Int_t TEpEmGen::ImportParticles(TClonesArray *particles, Option_t *option)
 Double_t TEpEmGen::GetXsection()
 {
   // Return cross section accumulated so far
+  if (fNative) return fSampler.GetXsection();
   return EEVENT.Xsecttot;
 }
 
@@ -128,5 +193,6 @@ Double_t TEpEmGen::GetXsection()
 Double_t TEpEmGen::GetDsection()
 {
   // Return cross section error accumulated so far
+  if (fNative) return fSampler.GetDsection();
   return EEVENT.Dsecttot;
 }
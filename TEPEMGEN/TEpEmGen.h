@@ -14,6 +14,8 @@
 //------------------------------------------------------------------------
 
 #include "TGenerator.h"
+#include "TEpEmPairSampler.h"
+#include "TEpEmSurrogate.h"
 
 // c++ interface to the f77 program - event generator of
 // e+e- pair production in ultraperipheral ion collisions
@@ -30,16 +32,53 @@ class TEpEmGen : public TGenerator {
   void Initialize(Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmaxm, Double_t cm_energy = 5160., Double_t Z = 82.);
   virtual void GenerateEvent() {TGenerator::GenerateEvent();};
   Int_t ImportParticles(TClonesArray *particles, Option_t *option);
+  // Use the C++ implementation TEpEmPairSampler instead of the fortran
+  // code, to be set before Initialize
+  void SetNativeGenerator(Bool_t native = kTRUE) {fNative = native;}
+  Bool_t IsNativeGenerator() const {return fNative;}
+  // Tabulate the cross section in a TEpEmSurrogate to skip the exact cross
+  // section of pairs that cannot pass the accept-reject test (C++ sampler
+  // only, after Initialize). eps is the precision aimed at, maxNodes the
+  // size limit of the table. If file is given the table is read from it
+  // when it was made for the same range and parameters, otherwise the new
+  // table is written to it.
+  Bool_t InitSurrogate(Double_t eps = 0.05, Int_t maxNodes = 300000, const char *file = 0);
+  Bool_t HasSurrogate() const {return fNative && fSurrogate.IsValid();}
+  // Fraction of the pairs below the surrogate envelope whose cross section
+  // is still computed, to find where the envelope is too low; such pairs
+  // are accepted with weight 1/check
+  void SetSurrogateCheck(Double_t check) {fSurrogateCheck = check>0 && check<=1 ? check : 0.01;}
+  Double_t GetSurrogateEnvelope() const {return fSurrogateEnvelope;}
+  Long64_t GetNSurrogateMissed() const {return fSampler.GetNMissed();}
 
  protected:
   void GenerateEvent (Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
 	       	      Double_t &yElectron, Double_t &yPositron,
 		      Double_t &xElectron, Double_t &xPositron,
 		      Double_t &phi12,     Double_t &weight);
+  // n pairs at once, one array per variable
+  void GenerateEvents(Int_t n, Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
+		      Double_t *yElectron, Double_t *yPositron,
+		      Double_t *xElectron, Double_t *xPositron,
+		      Double_t *phi12,     Double_t *weight);
+  // n pairs for the test u[i]*wmax < weight[i], see TEpEmPairSampler::Generate;
+  // without surrogate all weights are computed and h[i] = 1. An accepted
+  // pair carries the weight h[i].
+  void GenerateEvents(Int_t n, Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
+		      Double_t wmax, const Double_t *u,
+		      Double_t *yElectron, Double_t *yPositron,
+		      Double_t *xElectron, Double_t *xPositron,
+		      Double_t *phi12,     Double_t *weight, Double_t *h);
   Double_t GetXsection();
   Double_t GetDsection();
 
-  ClassDef(TEpEmGen,1);  //Interface to EpEmGen Event Generator
+  Bool_t           fNative;   // use the C++ pair sampler
+  TEpEmPairSampler fSampler;  //! C++ pair sampler
+  TEpEmSurrogate   fSurrogate; //! tabulated cross section
+  Double_t         fSurrogateCheck;    // fraction of pairs checked below the envelope
+  Double_t         fSurrogateEnvelope; // factor between the weight and the surrogate
+
+  ClassDef(TEpEmGen,3);  //Interface to EpEmGen Event Generator
 };
 
 #endif
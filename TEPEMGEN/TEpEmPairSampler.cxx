@@ -0,0 +1,1130 @@
+/**************************************************************************
+ * Copyright(c) 1998-2002, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ *                                                                        *
+ *                                                                        *
+ * Copyright(c) 1997, 1998, 2002, Adrian Alscher and Kai Hencken          *
+ * See $ALICE_ROOT/EpEmGen/diffcross.f for full Copyright notice          *
+ *                                                                        *
+ *                                                                        *
+ * Copyright(c) 2002 Kai Hencken, Yuri Kharlov, Serguei Sadovsky          *
+ * See $ALICE_ROOT/EpEmGen/epemgen.f for full Copyright notice            *
+ *                                                                        *
+ **************************************************************************/
+//------------------------------------------------------------------------
+// TEpEmPairSampler: C++ version of the e+e- pair generator of epemgen.f,
+// diffcross.f and dtrint.f, see the Fortran sources for comments on the
+// algorithm. Routines and variables keep their Fortran names.
+// Constants which are single precision in the Fortran code (DATA
+// statements of the parametrisations, cuts and normalisations) are kept
+// as float, so that the same random numbers give the same pairs.
+//------------------------------------------------------------------------
+
+#include "TEpEmPairSampler.h"
+#include "TEpEmSurrogate.h"
+#include "TMath.h"
+#include "TRandom.h"
+
+namespace {
+
+const Double_t kPi = TMath::Pi();
+
+// parametrisations of the cross section (COMMON parPh, parYp, ...)
+const Double_t kParPhi[7] = {5.4825f, 226.00f, 11.602f, 68.173f, 1.9509f, 0.11864E+04f, 109.61f};
+const Double_t kParYpY[6] = {-4.8584f, 0.11403E-01f, 4.0649f, 0.38920E-04f, 4.0283f, 0.19238E-01f};
+const Double_t kParYmY[6] = {1.80f, 8.f, 1.7438f, 0.17867f, 24.188f, 1.3097f};
+const Double_t kParXpX[5] = {8.3668f, 1.2004f, 0.47225f, 9.6951f, 2.3814f};
+const Double_t kParXmX[4] = {9.5038f, 39.040f, 1.9492f, 3.5660f};
+
+inline Double_t sq(Double_t x) {return x*x;}
+inline Double_t p3(Double_t x) {return x*x*x;}
+inline Double_t p4(Double_t x) {return sq(x)*sq(x);}
+inline Double_t p6(Double_t x) {return sq(p3(x));}
+
+Double_t DsdYY(Double_t yp, Double_t ye)
+{
+  return TEpEmPairSampler::DsdYpY(yp+ye)*TEpEmPairSampler::DsdYmY(yp-ye);
+}
+
+Double_t DsdXX(Double_t xp, Double_t xe)
+{
+  return TEpEmPairSampler::DsdXpX(xp+xe)*TEpEmPairSampler::DsdXmX(xp-xe);
+}
+
+// Dtrint: abscissae and weights of the 7, 25 and 64 point formulae
+const Int_t kJZ[3] = {2, 5, 8};
+const Int_t kJZ0[3] = {2, 10, 32};
+const Int_t kJZ1[3] = {3, 5, 0};
+const Int_t kIZ[3][3] = {{1, 0, 1}, {5, 5, 1}, {8, 24, 8}};
+
+const Double_t kU[3][8] = {
+  {0.898713492676543661, 0.529857935894884910},
+  {0.098535085798826426, 0.304535726646363905, 0.562025189752613856,
+   0.801986582126391827, 0.960190142948531258},
+  {0.044633955289969851, 0.144366257042145571, 0.286824757144430519,
+   0.454813315196573351, 0.628067835416727698, 0.785691520604369242,
+   0.908676392100206044, 0.982220084852636548}};
+
+const Double_t kV[3][32] = {
+  {0.696140478029630984, -0.410426192315345269},
+  {0.089290508868733569, 0.275964137855221135, 0.509295899863672021,
+   0.726744077436169444, 0.870104955808923811, 0.053058119671298357,
+   0.163983142629800463, 0.302633316188105613, 0.431845161591612961,
+   0.517032923843772854},
+  {0.042861534520322596, 0.138633452258088400, 0.275434904878165863,
+   0.436752613183286138, 0.603127171543047645, 0.754491597572500770,
+   0.872592722172605828, 0.943215984332136212, 0.035558375933897592,
+   0.115011757455156297, 0.228503668909272431, 0.362334521698467603,
+   0.500360590018245933, 0.625934096053638777, 0.723912020403394633,
+   0.782501815044463514, 0.023456590087635536, 0.075869146973958963,
+   0.150735705845778370, 0.239019137597290126, 0.330070003137485188,
+   0.412906358274039218, 0.477538894174496369, 0.516188488260827229,
+   0.008187413631782437, 0.026481772748961059, 0.052613596785690189,
+   0.083428517875344723, 0.115209398852684066, 0.144123043193925944,
+   0.166682729129138200, 0.180173190116990201}};
+
+const Double_t kW[3][32] = {
+  {0.125939180544827153, 0.132394152788506181},
+  {0.00373110433375567687, 0.01751099836432766347, 0.03468301286273140026,
+   0.03960816626409470756, 0.02293016070318509559, 0.00753740339065524076,
+   0.03537490422096693175, 0.07006500900674344063, 0.08001457477232084819,
+   0.04632244385899677269},
+  {0.00033356740649541982, 0.00180621091903715084, 0.00459975580349141419,
+   0.00801725953139149525, 0.01073501897315861631, 0.01138879740461651588,
+   0.00922384539091829977, 0.00450981271607921752, 0.00073278808164919485,
+   0.00396792315028907586, 0.01010484287631233624, 0.01761248886339488637,
+   0.02358292149241093797, 0.02501915606833984265, 0.02026314273463824614,
+   0.00990725395965271520, 0.00103372345487338862, 0.00559743714493508001,
+   0.01425461651279275399, 0.02484544071160746855, 0.03326776143285232482,
+   0.03529381699382226192, 0.02858464328063470277, 0.01397588340742566299,
+   0.00119511249923079556, 0.00647133144172490169, 0.01648010431210239366,
+   0.02872441038592530995, 0.03846165753750813161, 0.04080402900410874571,
+   0.03304739223018237768, 0.01615785427839833562}};
+
+const Double_t kUU[3][5] = {
+  {0.202573014646912678, 0.940284128210230180, 0.666666666666666667},
+  {0.098535085798826426, 0.304535726646363905, 0.562025189752613856,
+   0.801986582126391827, 0.960190142948531258},
+  {0.}};
+
+const Double_t kWW[3][5] = {
+  {0.125939180544827153, 0.132394152788506181, 0.225000000000000000},
+  {0.00895881359456271712, 0.04204593497464415024, 0.08327793043038993562,
+   0.09510379411590801948, 0.05505797132893962198},
+  {0.}};
+
+// Dtrint: integral of f over the triangle (c1,d1), (c2,d2), (c3,d3) with
+// formula m
+Double_t TriangleRule(Double_t (*f)(Double_t, Double_t), Int_t m,
+                      Double_t c1, Double_t d1, Double_t c2, Double_t d2,
+                      Double_t c3, Double_t d3)
+{
+  Double_t a11 = 0.5*(c2+c3)-c1;
+  Double_t a12 = 0.5*(c3-c2);
+  Double_t a21 = 0.5*(d2+d3)-d1;
+  Double_t a22 = 0.5*(d3-d2);
+  Double_t g1[32], g2[32];
+  for (Int_t j = 0; j < kJZ[m]; j++) {
+    g1[j] = a11*kU[m][j]+c1;
+    g2[j] = a21*kU[m][j]+d1;
+    for (Int_t i = kIZ[m][0]; i <= kIZ[m][1]; i += kIZ[m][2]) {
+      g1[j+i] = g1[j];
+      g2[j+i] = g2[j];
+    }
+  }
+  Double_t s = 0;
+  for (Int_t j = 0; j < kJZ0[m]; j++) {
+    Double_t h1 = a12*kV[m][j];
+    Double_t h2 = a22*kV[m][j];
+    s = s+kW[m][j]*(f(g1[j]+h1,g2[j]+h2)+f(g1[j]-h1,g2[j]-h2));
+  }
+  for (Int_t j = 0; j < kJZ1[m]; j++)
+    s = s+kWW[m][j]*f(a11*kUU[m][j]+c1,a21*kUU[m][j]+d1);
+  return 0.5*TMath::Abs(c1*(d2-d3)+c2*(d3-d1)+c3*(d1-d2))*s;
+}
+
+// Dgauss: Gauss-Legendre abscissae and weights, 8 point (0-3) and 16
+// point (4-11) formula
+const Double_t kGaussX[12] = {
+  9.6028985649753623e-1, 7.9666647741362674e-1, 5.2553240991632899e-1,
+  1.8343464249564980e-1, 9.8940093499164993e-1, 9.4457502307323258e-1,
+  8.6563120238783174e-1, 7.5540440835500303e-1, 6.1787624440264375e-1,
+  4.5801677765722739e-1, 2.8160355077925891e-1, 9.5012509837637440e-2};
+const Double_t kGaussW[12] = {
+  1.0122853629037626e-1, 2.2238103445337447e-1, 3.1370664587788729e-1,
+  3.6268378337836198e-1, 2.7152459411754095e-2, 6.2253523938647893e-2,
+  9.5158511682492785e-2, 1.2462897125553387e-1, 1.4959598881657673e-1,
+  1.6915651939500254e-1, 1.8260341504492359e-1, 1.8945061045506850e-1};
+
+// The transverse integrals of Diffcross (Iz0 ... Iv2). fSetZero replaces
+// the COMMON setzparam and is set if a logarithm is undefined.
+struct DiffcrossIntegrals {
+  Bool_t fSetZero = kFALSE;
+
+  Double_t Iz0(const Double_t *x, Double_t u, Double_t v)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t s = TMath::Sqrt(sq(tepxx+u+v) - 4*u*v);
+    Double_t arg = sq(tepxx+u+v+s)/(4*u*v);
+    if (arg < 0) {
+      fSetZero = kTRUE;
+      return 0;
+    }
+    return kPi*TMath::Log(sq(tepxx+u+v+s)/(4*u*v))/s;
+  }
+
+  Double_t Iz1(const Double_t *x, Double_t u, Double_t v)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t s = TMath::Sqrt(sq(tepxx+u+v) - 4*u*v);
+    Double_t a = (2*(tepxx+u-v+s))/(sq(s)*(tepxx+u+v+s)) - 1/(s*u);
+    Double_t b = -Iz0(x,u,v)/kPi*(tepxx+u-v)/sq(s);
+    return -kPi*(a+b);
+  }
+
+  Double_t Iz2(const Double_t *x, Double_t u, Double_t v)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t s = TMath::Sqrt(sq(tepxx+u+v) - 4*u*v);
+    Double_t a = (2*(tepxx-u+v-s))/(p3(s)*(tepxx+u+v+s));
+    Double_t b = -2*(tepxx+u-v+s)*(2*(tepxx-u+v)*(tepxx+u+v+s) + s*(tepxx-u+v+s))/
+                 (p4(s)*sq(tepxx+u+v+s));
+    Double_t c = (tepxx-u+v)/(u*p3(s));
+    Double_t d = (Iz1(x,v,u)/kPi)*(tepxx+u-v)/sq(s);
+    Double_t e = (Iz0(x,u,v)/kPi)*(1/sq(s) + (tepxx+u-v)*2*(tepxx-u+v)/p4(s));
+    return kPi*(a+b+c+d+e);
+  }
+
+  Double_t Id0(const Double_t *x, const Double_t *y, Double_t u, Double_t v, Double_t w)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t tepyy = y[0]*y[0]+y[1]*y[1];
+    Double_t tepxy = x[0]*y[0]+x[1]*y[1];
+    Double_t rx = v-u+tepxx;
+    Double_t ry = w-u+tepyy;
+    Double_t axy = x[0]*y[1]-x[1]*y[0];
+    Double_t a = sq(rx)*tepyy - 2*rx*ry*tepxy + sq(ry)*tepxx;
+    Double_t b = 4*u*sq(axy) + a;
+    Double_t c = 2*sq(axy) + (rx+ry)*tepxy - rx*tepyy - ry*tepxx;
+    Double_t d = rx*tepyy - ry*tepxy;
+    Double_t e = ry*tepxx - rx*tepxy;
+    Double_t dyx[2] = {y[0]-x[0], y[1]-x[1]};
+    return 1/b*(c*Iz0(dyx,v,w) + d*Iz0(y,u,w) + e*Iz0(x,u,v));
+  }
+
+  Double_t Id1(const Double_t *x, const Double_t *y, Double_t u, Double_t v, Double_t w)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t tepxy = x[0]*y[0]+x[1]*y[1];
+    Double_t tepyy = y[0]*y[0]+y[1]*y[1];
+    Double_t rx = v-u+tepxx;
+    Double_t ry = w-u+tepyy;
+    Double_t axy = x[0]*y[1]-x[1]*y[0];
+    Double_t a = sq(rx)*tepyy - 2*rx*ry*tepxy + sq(ry)*tepxx;
+    Double_t b = 4*u*sq(axy) + a;
+    Double_t c = -4*sq(axy) - 2*(-rx*tepyy+(rx+ry)*tepxy-ry*tepxx);
+    Double_t d = -2*tepxy + tepxx + tepyy;
+    Double_t e = -tepyy + tepxy;
+    Double_t f = rx*tepyy - ry*tepxy;
+    Double_t g = -tepxx + tepxy;
+    Double_t h = ry*tepxx - rx*tepxy;
+    Double_t dyx[2] = {y[0]-x[0], y[1]-x[1]};
+    return -((c/b)*Id0(x,y,u,v,w) + (1/b)*(d*Iz0(dyx,v,w) + e*Iz0(y,u,w) - f*Iz1(y,u,w) +
+                                           g*Iz0(x,u,v) - h*Iz1(x,u,v)));
+  }
+
+  Double_t Id2(const Double_t *x, const Double_t *y, Double_t u, Double_t v, Double_t w)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t tepxy = x[0]*y[0]+x[1]*y[1];
+    Double_t tepyy = y[0]*y[0]+y[1]*y[1];
+    Double_t mx[2] = {-x[0], -x[1]};
+    Double_t dyx[2] = {y[0]-x[0], y[1]-x[1]};
+    Double_t rx = v-u+tepxx;
+    Double_t ry = w-u+tepyy;
+    Double_t axy = x[0]*y[1]-x[1]*y[0];
+
+    Double_t a0 = sq(rx)*tepyy - 2*rx*ry*tepxy + sq(ry)*tepxx;
+    Double_t b = 4*u*sq(axy) + a0;
+    Double_t a1 = 2*(tepyy-tepxy)*b;
+    Double_t a2 = (-4*sq(axy) + 2*(rx*tepyy-(rx+ry)*tepxy+ry*tepxx))*2*2*(rx*tepyy-ry*tepxy);
+    Double_t a3 = -4*sq(axy) + 2*(rx*tepyy-(rx+ry)*tepxy+ry*tepxx);
+    Double_t a4 = -2*(rx*tepyy-ry*tepxy);
+    Double_t c1 = tepxy-tepyy;
+    Double_t d1 = 2*sq(axy)+(rx+ry)*tepxy-rx*tepyy-ry*tepxx;
+    Double_t e1 = tepyy;
+    Double_t f1 = -tepxy;
+    Double_t g1 = ry*tepxx-rx*tepxy;
+    Double_t c2 = -2*tepxy+tepxx+tepyy;
+    Double_t d2 = -tepyy + tepxy;
+    Double_t e2 = rx*tepyy - ry*tepxy;
+    Double_t f2 = -tepxx + tepxy;
+    Double_t g2 = ry*tepxx - rx*tepxy;
+    Double_t c3 = -2*tepxy+tepxx+tepyy;
+    Double_t d3 = -tepyy;
+    Double_t e3 = -tepxx+tepxy;
+    Double_t f3 = tepxy;
+    Double_t g3 = -(ry*tepxx-rx*tepxy);
+
+    return ((a1-a2)/sq(b))*Id0(x,y,u,v,w) +
+           (a3/sq(b))*(c1*Iz0(dyx,v,w) - d1*Iz1(dyx,v,w) + e1*Iz0(y,u,w) +
+                       f1*Iz0(x,u,v) - g1*Iz1(mx,v,u)) +
+           (a4/sq(b))*(c2*Iz0(dyx,v,w) + d2*Iz0(y,u,w) - e2*Iz1(y,u,w) +
+                       f2*Iz0(x,u,v) - g2*Iz1(x,u,v)) +
+           (1/b)*(-c3*Iz1(dyx,v,w) + d3*Iz1(y,u,w) - e3*Iz1(mx,v,u) +
+                  f3*Iz1(x,u,v) - g3*Iz2(mx,v,u));
+  }
+
+  Double_t Id3(const Double_t *x, const Double_t *y, Double_t u, Double_t v, Double_t w)
+  {
+    Double_t tepxx = x[0]*x[0]+x[1]*x[1];
+    Double_t tepxy = x[0]*y[0]+x[1]*y[1];
+    Double_t tepyy = y[0]*y[0]+y[1]*y[1];
+    Double_t dyx[2] = {y[0]-x[0], y[1]-x[1]};
+    Double_t mdyx[2] = {-dyx[0], -dyx[1]};
+    Double_t mx[2] = {-x[0], -x[1]};
+    Double_t my[2] = {-y[0], -y[1]};
+    Double_t rx = v-u+tepxx;
+    Double_t ry = w-u+tepyy;
+    Double_t axy = x[0]*y[1]-x[1]*y[0];
+
+    Double_t a0 = sq(rx)*tepyy - 2*rx*ry*tepxy + sq(ry)*tepxx;
+    Double_t b = 4*u*sq(axy) + a0;
+
+    Double_t a1 = 2*(tepyy-tepxy)*(-2)*2*(-rx*tepxy+ry*tepxx);
+    Double_t a2 = 2*(tepyy-tepxy);
+    Double_t c2 = tepxy-tepxx;
+    Double_t d2 = 2*sq(axy)+(rx+ry)*tepxy-rx*tepyy-ry*tepxx;
+    Double_t e2 = -tepxy;
+    Double_t f2 = rx*tepyy-ry*tepxy;
+    Double_t g2 = tepxx;
+
+    Double_t a3a = 2*(-tepxy+tepxx)*2*(rx*tepyy-ry*tepxy);
+    Double_t a3b = (-4*sq(axy) + 2*(rx*tepyy-(rx+ry)*tepxy+ry*tepxx))*2*(-tepxy);
+    Double_t a3c = (-4*sq(axy) + 2*(rx*tepyy-(rx+ry)*tepxy+ry*tepxx))*2*(rx*tepyy-ry*tepxy);
+    Double_t a3d = 3*2*(-rx*tepxy+ry*tepxx);
+
+    Double_t a4 = a3c;
+    Double_t a5a = 2*(-tepxy+tepxx);
+    Double_t a5b = -4*sq(axy) + 2*(rx*tepyy-(rx+ry)*tepxy+ry*tepxx);
+    Double_t a5c = 2*2*(-rx*tepxy+ry*tepxx);
+    Double_t a5d = -2*(rx*tepyy-ry*tepxy);
+    Double_t a5e = -2*(-tepxy);
+    Double_t a5f = -2*(rx*tepyy-ry*tepxy)*(2)*(-rx*tepxy+ry*tepxx);
+    Double_t c5 = tepxy-tepyy;
+    Double_t d5 = 2*sq(axy)+(rx+ry)*tepxy-rx*tepyy-ry*tepxx;
+    Double_t e5 = tepyy;
+    Double_t f5 = -tepxy;
+    Double_t g5 = ry*tepxx-rx*tepxy;
+
+    Double_t a6 = -2*(rx*tepyy-ry*tepxy);
+    Double_t c6 = tepxy-tepxx;
+    Double_t d6 = 2*sq(axy)+(rx+ry)*tepxy-rx*tepyy-ry*tepxx;
+    Double_t e6 = -tepxy;
+    Double_t f6 = rx*tepyy-ry*tepxy;
+    Double_t g6 = tepxx;
+
+    Double_t c7 = tepxy-tepyy;
+    Double_t d7 = -(tepxy-tepxx);
+    Double_t e7 = 2*sq(axy)+(rx+ry)*tepxy-rx*tepyy-ry*tepxx;
+    Double_t f7 = tepyy;
+    Double_t g7 = -tepxx;
+
+    Double_t a8a = -2*(-tepxy);
+    Double_t a8b = -2*(rx*tepyy-ry*tepxy);
+    Double_t a8c = 2*2*(-rx*tepxy+ry*tepxx);
+    Double_t c8 = -2*tepxy+tepxx+tepyy;
+    Double_t d8 = -tepyy + tepxy;
+    Double_t e8 = rx*tepyy - ry*tepxy;
+    Double_t f8 = -tepxx + tepxy;
+    Double_t g8 = ry*tepxx - rx*tepxy;
+
+    Double_t a9 = -2*(rx*tepyy-ry*tepxy);
+    Double_t c9 = -2*tepxy+tepxx+tepyy;
+    Double_t d9 = -tepyy+tepxy;
+    Double_t e9 = tepxy;
+    Double_t f9 = -(rx*tepyy-ry*tepxy);
+    Double_t g9 = -tepxx;
+
+    Double_t a10 = -2*(-rx*tepxy+ry*tepxx);
+    Double_t c10 = -2*tepxy+tepxx+tepyy;
+    Double_t d10 = -tepyy;
+    Double_t e10 = -tepxx+tepxy;
+    Double_t f10 = tepxy;
+    Double_t g10 = -(ry*tepxx-rx*tepxy);
+
+    Double_t c11 = -(-2*tepxy+tepyy+tepxx);
+    Double_t d11 = -tepyy;
+    Double_t e11 = tepxx;
+
+    return -((a1/sq(b))*Id0(x,y,u,v,w) +
+             (a2/sq(b))*(c2*Iz0(dyx,v,w) - d2*Iz1(mdyx,w,v) + e2*Iz0(y,u,w) -
+                         f2*Iz1(my,w,u) + g2*Iz0(x,u,v)) -
+             (((a3a+a3b)*b - a3c*a3d)/p3(b)*Id0(x,y,u,v,w) +
+              (a4/p3(b))*(c2*Iz0(dyx,v,w) - d2*Iz1(mdyx,w,v) + e2*Iz0(y,u,w) -
+                          f2*Iz1(my,w,u) + g2*Iz0(x,u,v))) +
+             (a5a*b - a5b*a5c)/p3(b)*(a5d*Id0(x,y,u,v,w) + c5*Iz0(dyx,v,w) -
+                                      d5*Iz1(dyx,v,w) + e5*Iz0(y,u,w) +
+                                      f5*Iz0(x,u,v) - g5*Iz1(mx,v,u)) +
+             a5b/sq(b)*((a5e - a5f/b)*Id0(x,y,u,v,w) +
+                        (a6/b)*(c6*Iz0(dyx,v,w) - d6*Iz1(mdyx,w,v) + e6*Iz0(y,u,w) -
+                                f6*Iz1(my,w,u) + g6*Iz0(x,u,v)) -
+                        c7*Iz1(mdyx,w,v) + d7*Iz1(dyx,v,w) + e7*Iz2(mdyx,w,v) -
+                        f7*Iz1(my,w,u) + g7*Iz1(mx,v,u)) +
+             (a8a*b - a8b*a8c)/p3(b)*(c8*Iz0(dyx,v,w) + d8*Iz0(y,u,w) - e8*Iz1(y,u,w) +
+                                      f8*Iz0(x,u,v) - g8*Iz1(x,u,v)) +
+             a9/sq(b)*(-c9*Iz1(mdyx,w,v) - d9*Iz1(my,w,u) + e9*Iz1(y,u,w) -
+                       f9*Iz2(y,u,w) + g9*Iz1(x,u,v)) +
+             a10/sq(b)*(-c10*Iz1(dyx,v,w) + d10*Iz1(y,u,w) - e10*Iz1(mx,v,u) +
+                        f10*Iz1(x,u,v) - g10*Iz2(mx,v,u)) +
+             1/b*(-c11*Iz2(dyx,v,w) - d11*Iz2(y,u,w) + e11*Iz2(x,u,v)));
+  }
+
+  Double_t Iv1(const Double_t *x, const Double_t *y, const Double_t *z,
+               Double_t u, Double_t v, Double_t w, Double_t w2)
+  {
+    Double_t dyx[2] = {y[0]-x[0], y[1]-x[1]};
+    Double_t dzx[2] = {z[0]-x[0], z[1]-x[1]};
+    Double_t rx = v-u+x[0]*x[0]+x[1]*x[1];
+    Double_t ry = w-u+y[0]*y[0]+y[1]*y[1];
+    Double_t rz = w2-u+z[0]*z[0]+z[1]*z[1];
+    Double_t axy = x[0]*y[1]-x[1]*y[0];
+    Double_t ayz = y[0]*z[1]-y[1]*z[0];
+    Double_t azx = z[0]*x[1]-z[1]*x[0];
+    Double_t a = 1/(axy*rz + ayz*rx + azx*ry);
+    Double_t b = axy+ayz+azx;
+    return -((b*sq(a))*(-(axy+ayz+azx)*Id0(dyx,dzx,v,w,w2) + axy*Id0(x,y,u,v,w) +
+                        ayz*Id0(y,z,u,w,w2) + azx*Id0(x,z,u,v,w2)) +
+             a*(-axy*Id1(x,y,u,v,w) - ayz*Id1(y,z,u,w,w2) - azx*Id1(x,z,u,v,w2)));
+  }
+
+  Double_t Iv2(const Double_t *x, const Double_t *y, const Double_t *z,
+               Double_t u, Double_t v, Double_t w, Double_t w2)
+  {
+    Double_t mx[2] = {-x[0], -x[1]};
+    Double_t dyx[2] = {y[0]-x[0], y[1]-x[1]};
+    Double_t dzx[2] = {z[0]-x[0], z[1]-x[1]};
+    Double_t rx = v-u+x[0]*x[0]+x[1]*x[1];
+    Double_t ry = w-u+y[0]*y[0]+y[1]*y[1];
+    Double_t rz = w2-u+z[0]*z[0]+z[1]*z[1];
+    Double_t axy = x[0]*y[1]-x[1]*y[0];
+    Double_t azx = z[0]*x[1]-z[1]*x[0];
+    Double_t ayz = y[0]*z[1]-y[1]*z[0];
+    Double_t a = 1/(axy*rz + ayz*rx + azx*ry);
+    Double_t b = axy+ayz+azx;
+    return (-b*2.*ayz*p3(a))*(-b*Id0(dyx,dzx,v,w,w2) + axy*Id0(x,y,u,v,w) +
+                              ayz*Id0(y,z,u,w,w2) + azx*Id0(x,z,u,v,w2)) +
+           (b*sq(a))*(b*Id1(dyx,dzx,v,w,w2) - axy*Id1(mx,dyx,v,u,w) - azx*Id1(mx,dzx,v,u,w2)) +
+           (-ayz*sq(a))*(-axy*Id1(x,y,u,v,w) - ayz*Id1(y,z,u,w,w2) - azx*Id1(x,z,u,v,w2)) +
+           a*(axy*Id2(x,y,u,v,w) + azx*Id2(x,z,u,v,w2));
+  }
+};
+
+} // namespace
+
+//______________________________________________________________________________
+TEpEmPairSampler::TEpEmPairSampler() :
+  fInit(kFALSE),
+  fYmin(0), fYmax(0), fXmin(0), fXmax(0),
+  fYpYmin(0), fYpYmax(0), fWYpYmax(0),
+  fYmYmin(0), fYmYmax(0), fYmed1(0), fYmed2(0), fSgmY1(0), fSgmY2(0),
+  fXYsect(0),
+  fGaus1(0), fGaus2(0), fGauss(0),
+  fExp1(0), fExp2(0), fExp3(0),
+  fXmXmin(0), fXmXmax(0), fXpXmin(0), fXpXmax(0),
+  fExmx1(0), fXmed(0), fSgm1(0), fAnorX(0),
+  fIcase(0),
+  fGamma(0), fBeta(0), fM(0), fW1xW1(0), fW1xW2(0), fW2xW2(0), fWl(0), fWy(0),
+  fNevnt(0), fNBad(0), fNMissed(0), fXsect2(0), fDsect2(0),
+  fNRndm(0), fNRndmFill(0)
+{
+}
+
+//______________________________________________________________________________
+Bool_t TEpEmPairSampler::Init(Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
+                              Double_t cmEnergy, Double_t Z)
+{
+  // Initialisation as ee_init
+  fInit = kFALSE;
+  if (ymin >= ymax) {
+    printf("TEpEmPairSampler: ERROR: Wrong values of Ymin,Ymax: %f %f\n", ymin, ymax);
+    return kFALSE;
+  }
+  if (ptmin <= 0 || ptmin >= ptmax) {
+    printf("TEpEmPairSampler: ERROR: Wrong values of PTmin,PTmax: %f %f\n", ptmin, ptmax);
+    return kFALSE;
+  }
+  fYmin = ymin;
+  fYmax = ymax;
+
+  // exact differential cross section (initdiffcross)
+  fGamma  = cmEnergy/(2.*0.938);
+  fBeta   = TMath::Sqrt((1.-1./fGamma)*(1.+1./fGamma));
+  fM      = 0.5109991;          // electron mass
+  fW1xW1  = 1./sq(fGamma);
+  fW2xW2  = 1./sq(fGamma);
+  fW1xW2  = 2.-1./sq(fGamma);
+  fWl     = TMath::Sqrt(fW1xW1);
+  fWy     = TMath::Log(fGamma+TMath::Sqrt((fGamma-1.)*(fGamma+1.)));
+
+  // cross sections of the parametrisations
+  const Int_t nsd = 1, npt = 25;
+  const Double_t eps = 0.00005f;
+  fXmin = TMath::Log10(ptmin);
+  fXmax = TMath::Log10(ptmax);
+  Double_t xsec1 = Dtrint(DsdXX,nsd,npt,eps,fXmin,fXmin,fXmin,fXmax,fXmax,fXmin);
+  Double_t xsec2 = Dtrint(DsdXX,nsd,npt,eps,fXmax,fXmax,fXmin,fXmax,fXmax,fXmin);
+  Double_t ysec1 = Dtrint(DsdYY,nsd,npt,eps,fYmin,fYmin,fYmin,fYmax,fYmax,fYmin);
+  Double_t ysec2 = Dtrint(DsdYY,nsd,npt,eps,fYmax,fYmax,fYmin,fYmax,fYmax,fYmin);
+  if (xsec1*xsec2 <= 0 || ysec1*ysec2 <= 0) {
+    printf("TEpEmPairSampler: ERROR: insufficient accuracy of XY-cross sections\n");
+    printf("  Xsec1,Xsec2 = %e %e, Ysec1,Ysec2 = %e %e\n", xsec1, xsec2, ysec1, ysec2);
+  }
+  fXYsect = (xsec1+xsec2)*(ysec1+ysec2);
+  fXYsect = 2371.5239f*p4(Z/137.035f)*fXYsect; // normalisation factor
+
+  // rapidity
+  fYpYmin = 2.*fYmin;
+  fYpYmax = 2.*fYmax;
+  Double_t yp0 = 0.;
+  if (fYpYmin*fYpYmax > 0.) yp0 = fYpYmin > 0. ? fYpYmin : fYpYmax;
+  fWYpYmax = DsdYpY(yp0);
+
+  fYmYmin = fYmin-fYmax;
+  fYmYmax = fYmax-fYmin;
+  fYmed1  = 0.18f;
+  fYmed2  = 4.00;
+  fSgmY1  = 1./TMath::Sqrt(2.*kParYmY[1]);
+  fSgmY2  = 1./TMath::Sqrt(2.*kParYmY[3]);
+  const Double_t epsG = 0.000001f;
+  Double_t gaus1 = Dgauss(DsdYmY, 0., fYmed1, epsG);
+  Double_t gaus2 = Dgauss(DsdYmY, fYmed1, fYmed2, epsG);
+  Double_t expon = Dgauss(DsdYmY, fYmed2, fYmYmax, epsG);
+  Double_t summ  = gaus1+gaus2+expon;
+  fGaus2 = (gaus1+gaus2)/summ;
+  fGaus1 = gaus1/summ;
+
+  // azimuthal angle
+  Double_t exp0 = kParPhi[0]*kPi;
+  Double_t exp1 = kParPhi[1]*(1.-TMath::Exp(-kParPhi[2]*kPi))/kParPhi[2];
+  Double_t exp2 = kParPhi[3]*(1.-TMath::Exp(-kParPhi[4]*kPi))/kParPhi[4];
+  Double_t exp3 = kParPhi[5]*(1.-TMath::Exp(-kParPhi[6]*kPi))/kParPhi[6];
+  summ  = exp0+exp1+exp2+exp3;
+  fExp1 = (exp1+exp2+exp3)/summ;
+  fExp2 = (exp2+exp3)/summ;
+  fExp3 = exp3/summ;
+
+  // transverse momenta
+  fXmXmin = fXmin-fXmax;
+  fXmXmax = fXmax-fXmin;
+  fXpXmin = 2.*fXmin;
+  fXpXmax = 2.*fXmax;
+  Double_t exmx1 = kParXmX[0]*(1.-TMath::Exp(-kParXmX[1]*TMath::Abs(fXmXmax)))/kParXmX[1];
+  Double_t exmx2 = kParXmX[2]*(1.-TMath::Exp(-kParXmX[3]*TMath::Abs(fXmXmax)))/kParXmX[3];
+  fExmx1 = exmx1/(exmx1+exmx2);
+
+  fIcase = 2;                   // Gauss and exponent
+  fXmed  = 0.6f;
+  if (fXpXmax < fXmed) {
+    fIcase = 1;                 // Gauss only
+    fXmed  = fXpXmax;
+  }
+  if (fXpXmin > fXmed) {
+    fIcase = 3;                 // exponent only
+    fXmed  = fXpXmin;
+  }
+  fGauss = 0;
+  if (fIcase == 2) {
+    Double_t gauss = Dgauss(DsdXpX, fXpXmin, fXmed, epsG);
+    expon = Dgauss(DsdXpX, fXmed, fXpXmax, epsG);
+    fGauss = gauss/(gauss+expon);
+  }
+  if (fIcase == 1 || fIcase == 2) fSgm1 = 1./TMath::Sqrt(2.*kParXpX[1]);
+  if (fIcase == 3 || fIcase == 2) fAnorX = 1.-TMath::Exp(-kParXpX[4]*(fXpXmax-fXmed));
+
+  printf("TEpEmPairSampler: Xmin,Xmax = %f %f, Ymin,Ymax = %f %f, XsecX*XsecY = %e\n",
+         fXmin, fXmax, fYmin, fYmax, fXYsect);
+  ResetSums();
+  fInit = kTRUE;
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::Rndm(TRandom *ran)
+{
+  // Uniform random number in (0,1) as eernd, taken from a buffer which is
+  // refilled with RndmArray
+  for (;;) {
+    if (fNRndm == fNRndmFill) {
+      ran->RndmArray(fNRndmFill, fRndm);
+      fNRndm = 0;
+    }
+    Double_t r = fRndm[fNRndm++];
+    if (0 < r && r < 1) return r;
+  }
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::Normal(TRandom *ran)
+{
+  // Standard normal random number (rnormlEP)
+  Double_t u1 = Rndm(ran);
+  Double_t u2 = Rndm(ran);
+  return TMath::Cos(2.*kPi*u1)*TMath::Sqrt(-2.*TMath::Log(u2));
+}
+
+//______________________________________________________________________________
+void TEpEmPairSampler::Generate(Int_t n, TRandom *ran, Double_t *yE, Double_t *yP,
+                                Double_t *xE, Double_t *xP, Double_t *phi, Double_t *w)
+{
+  // Produce n pairs, see the header for the meaning of the arrays.
+  // A pair takes 15-30 random numbers; those left in the buffer at the
+  // end are dropped, so that a reseeded generator takes effect in the next
+  // call.
+  if (!fInit) {
+    printf("TEpEmPairSampler: ERROR: Generate called before Init\n");
+    return;
+  }
+  fNRndmFill = n < kNRndm/32 ? 32*n : kNRndm;
+  fNRndm = fNRndmFill;
+  for (Int_t i = 0; i < n; i++)
+    GeneratePair(ran, yE[i], yP[i], xE[i], xP[i], phi[i], w[i]);
+  fNRndm = fNRndmFill;
+}
+
+//______________________________________________________________________________
+void TEpEmPairSampler::Generate(Int_t n, TRandom *ran, const TEpEmSurrogate &sur,
+                                Double_t wmax, Double_t check, Double_t &env,
+                                const Double_t *u, Double_t *yE, Double_t *yP,
+                                Double_t *xE, Double_t *xP, Double_t *phi,
+                                Double_t *w, Double_t *h)
+{
+  // Produce n pairs for the test u*wmax < w, see the header.
+  // The surrogate gives the weight up to the envelope factor env. A pair
+  // computed for the check only that passes the test was missed by the
+  // envelope; env is then raised to cover the following pairs there.
+  if (!fInit) {
+    printf("TEpEmPairSampler: ERROR: Generate called before Init\n");
+    return;
+  }
+  fNRndmFill = n < kNRndm/32 ? 32*n : kNRndm;
+  fNRndm = fNRndmFill;
+  for (Int_t i = 0; i < n; i++) {
+    Double_t ypy, ymy, xpx, xmx;
+    SampleKinematics(ran, yE[i], yP[i], xE[i], xP[i], phi[i], ypy, ymy, xpx, xmx);
+    Double_t s = sur.Eval(ypy, ymy, xpx, xmx, phi[i]);
+    if (s < 0 || u[i]*wmax < fXYsect*env*s) h[i] = 1.;
+    else if (Rndm(ran) < check) h[i] = 1./check;
+    else h[i] = 0.;
+    w[i] = h[i] > 0 ? Weight(yE[i], yP[i], xE[i], xP[i], phi[i], ypy, ymy, xpx, xmx) : 0.;
+    if (h[i] > 1. && u[i]*wmax < w[i]) {
+      fNMissed++;
+      env = TMath::Max(env, 1.2*w[i]/(fXYsect*s));
+    }
+    fNevnt++;
+    fXsect2 += h[i]*w[i];
+    fDsect2 += h[i]*h[i]*w[i]*w[i];
+  }
+  fNRndm = fNRndmFill;
+}
+
+//______________________________________________________________________________
+void TEpEmPairSampler::GeneratePair(TRandom *ran, Double_t &yE, Double_t &yP, Double_t &xE,
+                                    Double_t &xP, Double_t &phi, Double_t &w)
+{
+  // One pair as ee_event
+  Double_t ypy, ymy, xpx, xmx;
+  SampleKinematics(ran, yE, yP, xE, xP, phi, ypy, ymy, xpx, xmx);
+  w = Weight(yE, yP, xE, xP, phi, ypy, ymy, xpx, xmx);
+
+  fNevnt++;
+  fXsect2 += w;
+  fDsect2 += w*w;
+}
+
+//______________________________________________________________________________
+void TEpEmPairSampler::SampleKinematics(TRandom *ran, Double_t &yE, Double_t &yP, Double_t &xE,
+                                        Double_t &xP, Double_t &phi, Double_t &ypy,
+                                        Double_t &ymy, Double_t &xpx, Double_t &xmx)
+{
+  // Pair kinematics from the parametrisations, with the sums and differences
+  do {
+    // rapidity sum by accept-reject, difference from two gausses and an exponent
+    do {
+      ypy = fYpYmin + (fYpYmax-fYpYmin)*Rndm(ran);
+    } while (DsdYpY(ypy) < Rndm(ran)*fWYpYmax);
+
+    Double_t r1 = Rndm(ran);
+    if (r1 < fGaus1) {
+      do {
+        ymy = fSgmY1*Normal(ran);
+      } while (TMath::Abs(ymy) > fYmed1);
+    } else if (r1 < fGaus2) {
+      do {
+        ymy = fSgmY2*Normal(ran);
+      } while (TMath::Abs(ymy) < fYmed1 || TMath::Abs(ymy) > fYmed2);
+    } else {
+      do {
+        ymy = -TMath::Log(Rndm(ran))/kParYmY[5] + fYmed2;
+      } while (ymy > fYmYmax);
+      if (Rndm(ran) < 0.5) ymy = -ymy;
+    }
+    yE = 0.5*(ypy+ymy);
+    yP = 0.5*(ypy-ymy);
+  } while (yE < fYmin || yE > fYmax || yP < fYmin || yP > fYmax);
+
+  // azimuthal angle between e- and e+
+  do {
+    Double_t r1 = Rndm(ran);
+    Double_t slope = 0.;
+    if (r1 < fExp3) slope = kParPhi[6];
+    else if (r1 < fExp2) slope = kParPhi[4];
+    else if (r1 < fExp1) slope = kParPhi[2];
+    if (slope > 0.) {
+      do {
+        phi = -TMath::Log(Rndm(ran))/slope;
+      } while (phi > kPi);
+    } else {
+      phi = kPi*Rndm(ran);
+    }
+    if (Rndm(ran) > 0.5) phi = -phi;
+    phi = phi+kPi;
+  } while (phi < 0.03f || phi > 2.*kPi-0.03f);
+
+  // transverse momenta
+  xpx = 0;
+  do {
+    Int_t jcase = fIcase;
+    if (fIcase == 2) jcase = Rndm(ran) < fGauss ? 1 : 3;
+    if (jcase == 1) {
+      do {
+        xpx = fSgm1*Normal(ran)-kParXpX[2];
+      } while (xpx < fXpXmin || xpx > fXmed);
+    } else {
+      xpx = -TMath::Log(1.-Rndm(ran)*fAnorX)/kParXpX[4]+fXmed;
+    }
+
+    Double_t slope = Rndm(ran) < fExmx1 ? kParXmX[1] : kParXmX[3];
+    do {
+      xmx = -TMath::Log(Rndm(ran))/slope;
+    } while (xmx > TMath::Abs(fXmXmax));
+    if (Rndm(ran) > 0.5) xmx = -xmx;
+
+    xE = 0.5*(xpx+xmx);
+    xP = 0.5*(xpx-xmx);
+  } while (xE < fXmin || xE > fXmax || xP < fXmin || xP > fXmax);
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::Weight(Double_t yE, Double_t yP, Double_t xE, Double_t xP,
+                                  Double_t phi, Double_t ypy, Double_t ymy, Double_t xpx,
+                                  Double_t xmx)
+{
+  // Weight of a pair: exact cross section over the parametrisation
+  Double_t pte = TMath::Power(10.,xE);
+  Double_t ptp = TMath::Power(10.,xP);
+  Double_t wt = ParamWeight(ypy, ymy, xpx, xmx, phi);
+  Double_t w = (pte*ptp)*wt;
+  Bool_t bad;
+  Double_t dsigma = DiffCross(ptp, yP, pte, yE, phi, bad);
+  if (bad) fNBad++;
+  w = fXYsect*dsigma*(pte*ptp)*w;
+  return w;
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::DiffCross(Double_t ppvt, Double_t yp, Double_t pmvt, Double_t ym,
+                                     Double_t dphi, Bool_t &bad) const
+{
+  // Diffcross: ppvt, pmvt transverse momenta of e+, e- (MeV/c), yp, ym
+  // their rapidities and dphi the angle between them
+  const Double_t m = fM, wl = fWl, wy = fWy;
+  const Double_t w1xw1 = fW1xW1, w1xw2 = fW1xW2, w2xw2 = fW2xW2;
+  DiffcrossIntegrals in;
+
+  Double_t ppt[2] = {ppvt, 0.};
+  Double_t ppvl = TMath::Sqrt(sq(ppvt)+sq(m));
+  Double_t pmt[2] = {pmvt*TMath::Cos(dphi), pmvt*TMath::Sin(dphi)};
+  Double_t pmvl = TMath::Sqrt(sq(pmvt)+sq(m));
+
+  Double_t pmlxpml = sq(pmvl);
+  Double_t pplxppl = sq(ppvl);
+  Double_t pmlxppl = pmvl*ppvl*TMath::CosH(yp-ym);
+  Double_t w2xpml = wl*pmvl*TMath::CosH(ym+wy);
+  Double_t w2xppl = wl*ppvl*TMath::CosH(yp+wy);
+  Double_t w1xpml = wl*pmvl*TMath::CosH(ym-wy);
+  Double_t w1xppl = wl*ppvl*TMath::CosH(yp-wy);
+  Double_t w1xql = 0.;
+  Double_t w2xql = w2xpml+w2xppl;
+  Double_t qb = fGamma*(w2xppl+w2xpml)/TMath::SinH(2.*wy);
+  Double_t qlxql = -sq(qb);
+  Double_t pmlxql = qb*pmvl*TMath::SinH(wy-ym);
+  Double_t pplxql = qb*ppvl*TMath::SinH(wy-yp);
+
+  Double_t pmtxpmt = -sq(pmvt);
+  Double_t pmtxppt = -pmvt*ppvt*TMath::Cos(dphi);
+  Double_t pptxppt = -sq(ppvt);
+
+  // propagator terms
+  Double_t m0 = -qlxql;
+  Double_t k1[2] = {-ppt[0]-pmt[0], -pmt[1]};
+  Double_t m1 = -qlxql-pplxppl-pmlxpml+2.*(pplxql+pmlxql-pmlxppl);
+  Double_t kd[2] = {-pmt[0], -pmt[1]};
+  Double_t md = sq(m) - (qlxql+pmlxpml-2.*pmlxql);
+  Double_t kx[2] = {-ppt[0], 0.};
+  Double_t mx = sq(m) - (qlxql+pplxppl-2.*pplxql);
+
+  Double_t r1 = m1 - m0 + k1[0]*k1[0]+k1[1]*k1[1];
+  Double_t rd = md - m0 + kd[0]*kd[0]+kd[1]*kd[1];
+  Double_t rx = mx - m0 + kx[0]*kx[0]+kx[1]*kx[1];
+
+  Double_t mk1[2] = {-k1[0], -k1[1]};
+  Double_t mkd[2] = {-kd[0], -kd[1]};
+  Double_t mkx[2] = {-kx[0], -kx[1]};
+  Double_t mk1d[2] = {k1[0]-kd[0], k1[1]-kd[1]};
+  Double_t mk1x[2] = {k1[0]-kx[0], k1[1]-kx[1]};
+  Double_t mkd1[2] = {kd[0]-k1[0], kd[1]-k1[1]};
+  Double_t mkx1[2] = {kx[0]-k1[0], kx[1]-k1[1]};
+
+  // all different integrals
+  Double_t N1 = in.Id1(mkd,mk1d,md,m0,m1)*(-2*w1xw1*w2xw2);
+  Double_t N2 = in.Id1(mkx,mk1x,mx,m0,m1)*(-2*w1xw1*w2xw2);
+  Double_t N3 = in.Iv1(mk1,mkd1,mkx1,m1,m0,md,mx)*(4*w1xw1*w2xw2*pmlxpml
+    + 8*w1xw1*w2xw2*pmlxppl - 8*w1xw1*w2xw2*pmlxql + 4*w1xw1*w2xw2*pmtxpmt
+    + 8*w1xw1*w2xw2*pmtxppt + 4*w1xw1*w2xw2*pplxppl - 8*w1xw1*w2xw2*pplxql
+    + 4*w1xw1*w2xw2*pptxppt + 4*w1xw1*w2xw2*rd + 4*w1xw1*w2xw2*rx - 16*w1xw1*w2xpml*w2xppl
+    + 8*w1xw1*w2xpml*w2xql + 8*w1xw1*w2xppl*w2xql - 8*sq(w1xw2)*pmlxpml
+    - 16*sq(w1xw2)*pmlxppl + 16*sq(w1xw2)*pmlxql - 8*sq(w1xw2)*pmtxpmt
+    - 16*sq(w1xw2)*pmtxppt - 8*sq(w1xw2)*pplxppl + 16*sq(w1xw2)*pplxql - 8*sq(w1xw2)*pptxppt
+    - 8*sq(w1xw2)*rd - 8*sq(w1xw2)*rx + 16*w1xw2*w1xpml*w2xpml + 16*w1xw2*w1xpml*w2xppl
+    - 16*w1xw2*w1xpml*w2xql + 16*w1xw2*w1xppl*w2xpml + 16*w1xw2*w1xppl*w2xppl
+    - 16*w1xw2*w1xppl*w2xql - 16*w1xw2*w1xql*w2xpml - 16*w1xw2*w1xql*w2xppl
+    - 8*sq(w1xpml)*w2xw2 + 8*w1xpml*w1xql*w2xw2 - 8*sq(w1xppl)*w2xw2 + 8*w1xppl*w1xql*w2xw2);
+  Double_t N4 = in.Id1(mk1,mkd1,m1,m0,md)*(-2*w1xw1*w2xw2 + 8*sq(w1xw2));
+  Double_t N5 = in.Id2(mk1d,mkd,md,m1,m0)*(4*w1xw1*w2xw2*pmlxppl + 4*w1xw1*w2xw2*pmtxppt
+    - 4*w1xw1*w2xw2*pplxql + 4*w1xw1*w2xw2*sq(m) + 2*w1xw1*w2xw2*r1 - 2*w1xw1*w2xw2*rd
+    - 8*w1xw1*w2xpml*w2xppl + 8*w1xw1*w2xppl*w2xql);
+  Double_t N6 = in.Id1(mk1,mkx1,m1,m0,mx)*(-2*w1xw1*w2xw2 + 8*sq(w1xw2));
+  Double_t N7 = in.Id2(mk1x,mkx,mx,m1,m0)*(4*w1xw1*w2xw2*pmlxppl - 4*w1xw1*w2xw2*pmlxql
+    + 4*w1xw1*w2xw2*pmtxppt + 4*w1xw1*w2xw2*sq(m) + 2*w1xw1*w2xw2*r1 - 2*w1xw1*w2xw2*rx
+    - 8*w1xw1*w2xpml*w2xppl + 8*w1xw1*w2xpml*w2xql);
+  Double_t N8 = in.Id1(k1,kd,m0,m1,md)*(2*w1xw1*w2xw2);
+  Double_t N9 = in.Id2(kd,k1,m0,md,m1)*(-4*w1xw1*w2xw2*pmlxpml + 4*w1xw1*w2xw2*pmlxql
+    - 4*w1xw1*w2xw2*pmtxpmt + 4*w1xw1*w2xw2*sq(m) - 2*w1xw1*w2xw2*rd + 8*sq(w1xpml)*w2xw2
+    - 8*w1xpml*w1xql*w2xw2);
+  Double_t N10 = in.Id1(k1,kx,m0,m1,mx)*(2*w1xw1*w2xw2);
+  Double_t N11 = in.Id2(kx,k1,m0,mx,m1)*(-4*w1xw1*w2xw2*pplxppl + 4*w1xw1*w2xw2*pplxql
+    - 4*w1xw1*w2xw2*pptxppt + 4*w1xw1*w2xw2*sq(m) - 2*w1xw1*w2xw2*rx + 8*sq(w1xppl)*w2xw2
+    - 8*w1xppl*w1xql*w2xw2);
+  Double_t N12 = in.Iv2(k1,kd,kx,m0,m1,md,mx)*(8*w1xw1*w2xw2*pmlxpml*pplxppl
+    - 8*w1xw1*w2xw2*pmlxpml*pplxql + 8*w1xw1*w2xw2*pmlxpml*pptxppt
+    - 8*w1xw1*w2xw2*pmlxpml*sq(m) + 4*w1xw1*w2xw2*pmlxpml*rx - 8*w1xw1*w2xw2*pmlxppl*qlxql
+    - 8*w1xw1*w2xw2*pmlxppl*m0 - 8*w1xw1*w2xw2*pmlxql*pplxppl + 16*w1xw1*w2xw2*pmlxql*pplxql
+    - 8*w1xw1*w2xw2*pmlxql*pptxppt + 8*w1xw1*w2xw2*pmlxql*sq(m) - 8*w1xw1*w2xw2*pmlxql*rx
+    + 8*w1xw1*w2xw2*pmtxpmt*pplxppl - 8*w1xw1*w2xw2*pmtxpmt*pplxql
+    + 8*w1xw1*w2xw2*pmtxpmt*pptxppt - 8*w1xw1*w2xw2*pmtxpmt*sq(m) + 4*w1xw1*w2xw2*pmtxpmt*rx
+    - 8*w1xw1*w2xw2*pmtxppt*qlxql - 8*w1xw1*w2xw2*pmtxppt*m0 - 8*w1xw1*w2xw2*pplxppl*sq(m)
+    + 4*w1xw1*w2xw2*pplxppl*rd + 8*w1xw1*w2xw2*pplxql*sq(m) - 8*w1xw1*w2xw2*pplxql*rd
+    - 8*w1xw1*w2xw2*pptxppt*sq(m) + 4*w1xw1*w2xw2*pptxppt*rd - 8*w1xw1*w2xw2*qlxql*sq(m)
+    + 8*w1xw1*w2xw2*p4(m) - 8*w1xw1*w2xw2*sq(m)*m0 - 4*w1xw1*w2xw2*sq(m)*rd
+    - 4*w1xw1*w2xw2*sq(m)*rx + 4*w1xw1*w2xw2*rd*rx + 16*w1xw1*w2xpml*w2xppl*qlxql
+    + 16*w1xw1*w2xpml*w2xppl*m0 - 16*w1xw1*w2xpml*w2xql*pplxql + 8*w1xw1*w2xpml*w2xql*rx
+    - 16*w1xw1*w2xppl*w2xql*pmlxql + 8*w1xw1*w2xppl*w2xql*rd + 16*w1xw1*sq(w2xql)*pmlxppl
+    + 16*w1xw1*sq(w2xql)*pmtxppt + 16*w1xw1*sq(w2xql)*sq(m) - 16*sq(w1xw2)*pmlxpml*pplxppl
+    + 16*sq(w1xw2)*pmlxpml*pplxql - 16*sq(w1xw2)*pmlxpml*pptxppt
+    + 16*sq(w1xw2)*pmlxpml*sq(m) - 8*sq(w1xw2)*pmlxpml*rx + 16*sq(w1xw2)*pmlxppl*qlxql
+    + 16*sq(w1xw2)*pmlxppl*m0 + 16*sq(w1xw2)*pmlxql*pplxppl - 32*sq(w1xw2)*pmlxql*pplxql
+    + 16*sq(w1xw2)*pmlxql*pptxppt - 16*sq(w1xw2)*pmlxql*sq(m) + 16*sq(w1xw2)*pmlxql*rx
+    - 16*sq(w1xw2)*pmtxpmt*pplxppl + 16*sq(w1xw2)*pmtxpmt*pplxql
+    - 16*sq(w1xw2)*pmtxpmt*pptxppt + 16*sq(w1xw2)*pmtxpmt*sq(m) - 8*sq(w1xw2)*pmtxpmt*rx
+    + 16*sq(w1xw2)*pmtxppt*qlxql + 16*sq(w1xw2)*pmtxppt*m0 + 16*sq(w1xw2)*pplxppl*sq(m)
+    - 8*sq(w1xw2)*pplxppl*rd - 16*sq(w1xw2)*pplxql*sq(m) + 16*sq(w1xw2)*pplxql*rd
+    + 16*sq(w1xw2)*pptxppt*sq(m) - 8*sq(w1xw2)*pptxppt*rd + 16*sq(w1xw2)*qlxql*sq(m)
+    - 16*sq(w1xw2)*p4(m) + 16*sq(w1xw2)*sq(m)*m0 + 8*sq(w1xw2)*sq(m)*rd
+    + 8*sq(w1xw2)*sq(m)*rx - 8*sq(w1xw2)*rd*rx + 32*w1xw2*w1xpml*w2xpml*pplxppl
+    - 32*w1xw2*w1xpml*w2xpml*pplxql + 32*w1xw2*w1xpml*w2xpml*pptxppt
+    - 32*w1xw2*w1xpml*w2xpml*sq(m) + 16*w1xw2*w1xpml*w2xpml*rx
+    - 16*w1xw2*w1xpml*w2xppl*qlxql - 16*w1xw2*w1xpml*w2xppl*m0
+    - 16*w1xw2*w1xpml*w2xql*pplxppl + 32*w1xw2*w1xpml*w2xql*pplxql
+    - 16*w1xw2*w1xpml*w2xql*pptxppt + 16*w1xw2*w1xpml*w2xql*sq(m) - 16*w1xw2*w1xpml*w2xql*rx
+    - 16*w1xw2*w1xppl*w2xpml*qlxql - 16*w1xw2*w1xppl*w2xpml*m0
+    + 32*w1xw2*w1xppl*w2xppl*pmlxpml - 32*w1xw2*w1xppl*w2xppl*pmlxql
+    + 32*w1xw2*w1xppl*w2xppl*pmtxpmt - 32*w1xw2*w1xppl*w2xppl*sq(m)
+    + 16*w1xw2*w1xppl*w2xppl*rd - 16*w1xw2*w1xppl*w2xql*pmlxpml
+    + 32*w1xw2*w1xppl*w2xql*pmlxql - 16*w1xw2*w1xppl*w2xql*pmtxpmt
+    + 16*w1xw2*w1xppl*w2xql*sq(m) - 16*w1xw2*w1xppl*w2xql*rd - 16*w1xw2*w1xql*w2xpml*pplxppl
+    + 32*w1xw2*w1xql*w2xpml*pplxql - 16*w1xw2*w1xql*w2xpml*pptxppt
+    + 16*w1xw2*w1xql*w2xpml*sq(m) - 16*w1xw2*w1xql*w2xpml*rx - 16*w1xw2*w1xql*w2xppl*pmlxpml
+    + 32*w1xw2*w1xql*w2xppl*pmlxql - 16*w1xw2*w1xql*w2xppl*pmtxpmt
+    + 16*w1xw2*w1xql*w2xppl*sq(m) - 16*w1xw2*w1xql*w2xppl*rd - 32*w1xw2*w1xql*w2xql*pmlxppl
+    - 32*w1xw2*w1xql*w2xql*pmtxppt - 32*w1xw2*w1xql*w2xql*sq(m)
+    - 16*sq(w1xpml)*w2xw2*pplxppl + 16*sq(w1xpml)*w2xw2*pplxql - 16*sq(w1xpml)*w2xw2*pptxppt
+    + 16*sq(w1xpml)*w2xw2*sq(m) - 8*sq(w1xpml)*w2xw2*rx + 32*w1xpml*w1xppl*w2xw2*pmlxppl
+    - 16*w1xpml*w1xppl*w2xw2*pmlxql + 32*w1xpml*w1xppl*w2xw2*pmtxppt
+    - 16*w1xpml*w1xppl*w2xw2*pplxql + 16*w1xpml*w1xppl*w2xw2*qlxql
+    + 32*w1xpml*w1xppl*w2xw2*sq(m) + 16*w1xpml*w1xppl*w2xw2*m0 + 8*w1xpml*w1xppl*w2xw2*rd
+    + 8*w1xpml*w1xppl*w2xw2*rx - 64*w1xpml*w1xppl*w2xpml*w2xppl
+    + 32*w1xpml*w1xppl*w2xpml*w2xql + 32*w1xpml*w1xppl*w2xppl*w2xql
+    - 32*w1xpml*w1xppl*sq(w2xql) - 16*w1xpml*w1xql*w2xw2*pmlxppl
+    - 16*w1xpml*w1xql*w2xw2*pmtxppt + 16*w1xpml*w1xql*w2xw2*pplxppl
+    - 16*w1xpml*w1xql*w2xw2*pplxql + 16*w1xpml*w1xql*w2xw2*pptxppt
+    - 32*w1xpml*w1xql*w2xw2*sq(m) + 8*w1xpml*w1xql*w2xw2*rx + 32*w1xpml*w1xql*w2xpml*w2xppl
+    - 16*sq(w1xppl)*w2xw2*pmlxpml + 16*sq(w1xppl)*w2xw2*pmlxql - 16*sq(w1xppl)*w2xw2*pmtxpmt
+    + 16*sq(w1xppl)*w2xw2*sq(m) - 8*sq(w1xppl)*w2xw2*rd + 16*w1xppl*w1xql*w2xw2*pmlxpml
+    - 16*w1xppl*w1xql*w2xw2*pmlxppl - 16*w1xppl*w1xql*w2xw2*pmlxql
+    + 16*w1xppl*w1xql*w2xw2*pmtxpmt - 16*w1xppl*w1xql*w2xw2*pmtxppt
+    - 32*w1xppl*w1xql*w2xw2*sq(m) + 8*w1xppl*w1xql*w2xw2*rd + 32*w1xppl*w1xql*w2xpml*w2xppl
+    + 16*sq(w1xql)*w2xw2*pmlxppl + 16*sq(w1xql)*w2xw2*pmtxppt + 16*sq(w1xql)*w2xw2*sq(m)
+    - 32*sq(w1xql)*w2xpml*w2xppl);
+  Double_t N13 = in.Id2(k1,kd,m0,m1,md)*(4*w1xw1*w2xw2*pmlxql + 4*w1xw1*w2xw2*pplxql
+    - 2*w1xw1*w2xw2*r1 - 8*w1xw1*w2xpml*w2xql - 8*w1xw1*w2xppl*w2xql + 8*sq(w1xw2)*pmlxpml
+    - 16*sq(w1xw2)*pmlxql + 8*sq(w1xw2)*pmtxpmt - 8*sq(w1xw2)*sq(m) + 8*sq(w1xw2)*rd
+    - 16*w1xw2*w1xpml*w2xpml + 16*w1xw2*w1xpml*w2xppl + 16*w1xw2*w1xpml*w2xql
+    + 16*w1xw2*w1xql*w2xpml - 16*w1xpml*w1xppl*w2xw2);
+  Double_t N14 = in.Id3(k1,kd,m0,m1,md)*(4*w1xw1*w2xw2*pmlxpml*pmlxppl
+    + 4*w1xw1*w2xw2*pmlxpml*pmtxppt - 8*w1xw1*w2xw2*pmlxpml*pplxql
+    + 4*w1xw1*w2xw2*pmlxpml*sq(m) + 4*w1xw1*w2xw2*pmlxpml*r1 - 4*w1xw1*w2xw2*pmlxpml*rd
+    + 4*w1xw1*w2xw2*pmlxppl*pmtxpmt - 4*w1xw1*w2xw2*pmlxppl*qlxql
+    - 4*w1xw1*w2xw2*pmlxppl*sq(m) - 4*w1xw1*w2xw2*pmlxppl*m0 + 8*w1xw1*w2xw2*pmlxql*pplxql
+    - 4*w1xw1*w2xw2*pmlxql*r1 + 4*w1xw1*w2xw2*pmlxql*rd + 4*w1xw1*w2xw2*pmtxpmt*pmtxppt
+    - 8*w1xw1*w2xw2*pmtxpmt*pplxql + 4*w1xw1*w2xw2*pmtxpmt*sq(m) + 4*w1xw1*w2xw2*pmtxpmt*r1
+    - 4*w1xw1*w2xw2*pmtxpmt*rd - 4*w1xw1*w2xw2*pmtxppt*qlxql - 4*w1xw1*w2xw2*pmtxppt*sq(m)
+    - 4*w1xw1*w2xw2*pmtxppt*m0 + 8*w1xw1*w2xw2*pplxql*sq(m) - 4*w1xw1*w2xw2*pplxql*rd
+    - 4*w1xw1*w2xw2*qlxql*sq(m) - 4*w1xw1*w2xw2*p4(m) - 4*w1xw1*w2xw2*sq(m)*m0
+    - 4*w1xw1*w2xw2*sq(m)*r1 + 4*w1xw1*w2xw2*sq(m)*rd + 2*w1xw1*w2xw2*r1*rd
+    - 2*w1xw1*w2xw2*sq(rd) - 8*w1xw1*w2xpml*w2xppl*pmlxpml - 8*w1xw1*w2xpml*w2xppl*pmtxpmt
+    + 8*w1xw1*w2xpml*w2xppl*qlxql + 8*w1xw1*w2xpml*w2xppl*sq(m) + 8*w1xw1*w2xpml*w2xppl*m0
+    + 16*w1xw1*w2xppl*w2xql*pmlxpml - 16*w1xw1*w2xppl*w2xql*pmlxql
+    + 16*w1xw1*w2xppl*w2xql*pmtxpmt - 16*w1xw1*w2xppl*w2xql*sq(m) + 8*w1xw1*w2xppl*w2xql*rd
+    - 16*w1xw2*w1xpml*w2xppl*pmlxpml + 32*w1xw2*w1xpml*w2xppl*pmlxql
+    - 16*w1xw2*w1xpml*w2xppl*pmtxpmt - 16*w1xw2*w1xpml*w2xppl*qlxql
+    + 16*w1xw2*w1xpml*w2xppl*sq(m) - 16*w1xw2*w1xpml*w2xppl*m0 - 16*w1xw2*w1xpml*w2xppl*rd
+    - 16*sq(w1xpml)*w2xw2*pmlxppl - 16*sq(w1xpml)*w2xw2*pmtxppt + 16*sq(w1xpml)*w2xw2*pplxql
+    - 16*sq(w1xpml)*w2xw2*sq(m) - 8*sq(w1xpml)*w2xw2*r1 + 8*sq(w1xpml)*w2xw2*rd
+    + 32*sq(w1xpml)*w2xpml*w2xppl - 32*sq(w1xpml)*w2xppl*w2xql
+    + 8*w1xpml*w1xppl*w2xw2*pmlxpml - 16*w1xpml*w1xppl*w2xw2*pmlxql
+    + 8*w1xpml*w1xppl*w2xw2*pmtxpmt + 8*w1xpml*w1xppl*w2xw2*qlxql
+    - 8*w1xpml*w1xppl*w2xw2*sq(m) + 8*w1xpml*w1xppl*w2xw2*m0 + 8*w1xpml*w1xppl*w2xw2*rd
+    + 16*w1xpml*w1xql*w2xw2*pmlxppl + 16*w1xpml*w1xql*w2xw2*pmtxppt
+    - 16*w1xpml*w1xql*w2xw2*pplxql + 16*w1xpml*w1xql*w2xw2*sq(m) + 8*w1xpml*w1xql*w2xw2*r1
+    - 8*w1xpml*w1xql*w2xw2*rd - 32*w1xpml*w1xql*w2xpml*w2xppl
+    + 32*w1xpml*w1xql*w2xppl*w2xql);
+  Double_t N15 = in.Id2(k1,kx,m0,m1,mx)*(4*w1xw1*w2xw2*pmlxql + 4*w1xw1*w2xw2*pplxql
+    - 2*w1xw1*w2xw2*r1 - 8*w1xw1*w2xpml*w2xql - 8*w1xw1*w2xppl*w2xql + 8*sq(w1xw2)*pplxppl
+    - 16*sq(w1xw2)*pplxql + 8*sq(w1xw2)*pptxppt - 8*sq(w1xw2)*sq(m) + 8*sq(w1xw2)*rx
+    + 16*w1xw2*w1xppl*w2xpml - 16*w1xw2*w1xppl*w2xppl + 16*w1xw2*w1xppl*w2xql
+    + 16*w1xw2*w1xql*w2xppl - 16*w1xpml*w1xppl*w2xw2);
+  Double_t N16 = in.Id3(k1,kx,m0,m1,mx)*(4*w1xw1*w2xw2*pmlxppl*pplxppl
+    + 4*w1xw1*w2xw2*pmlxppl*pptxppt - 4*w1xw1*w2xw2*pmlxppl*qlxql
+    - 4*w1xw1*w2xw2*pmlxppl*sq(m) - 4*w1xw1*w2xw2*pmlxppl*m0 - 8*w1xw1*w2xw2*pmlxql*pplxppl
+    + 8*w1xw1*w2xw2*pmlxql*pplxql - 8*w1xw1*w2xw2*pmlxql*pptxppt
+    + 8*w1xw1*w2xw2*pmlxql*sq(m) - 4*w1xw1*w2xw2*pmlxql*rx + 4*w1xw1*w2xw2*pmtxppt*pplxppl
+    + 4*w1xw1*w2xw2*pmtxppt*pptxppt - 4*w1xw1*w2xw2*pmtxppt*qlxql
+    - 4*w1xw1*w2xw2*pmtxppt*sq(m) - 4*w1xw1*w2xw2*pmtxppt*m0 + 4*w1xw1*w2xw2*pplxppl*sq(m)
+    + 4*w1xw1*w2xw2*pplxppl*r1 - 4*w1xw1*w2xw2*pplxppl*rx - 4*w1xw1*w2xw2*pplxql*r1
+    + 4*w1xw1*w2xw2*pplxql*rx + 4*w1xw1*w2xw2*pptxppt*sq(m) + 4*w1xw1*w2xw2*pptxppt*r1
+    - 4*w1xw1*w2xw2*pptxppt*rx - 4*w1xw1*w2xw2*qlxql*sq(m) - 4*w1xw1*w2xw2*p4(m)
+    - 4*w1xw1*w2xw2*sq(m)*m0 - 4*w1xw1*w2xw2*sq(m)*r1 + 4*w1xw1*w2xw2*sq(m)*rx
+    + 2*w1xw1*w2xw2*r1*rx - 2*w1xw1*w2xw2*sq(rx) - 8*w1xw1*w2xpml*w2xppl*pplxppl
+    - 8*w1xw1*w2xpml*w2xppl*pptxppt + 8*w1xw1*w2xpml*w2xppl*qlxql
+    + 8*w1xw1*w2xpml*w2xppl*sq(m) + 8*w1xw1*w2xpml*w2xppl*m0 + 16*w1xw1*w2xpml*w2xql*pplxppl
+    - 16*w1xw1*w2xpml*w2xql*pplxql + 16*w1xw1*w2xpml*w2xql*pptxppt
+    - 16*w1xw1*w2xpml*w2xql*sq(m) + 8*w1xw1*w2xpml*w2xql*rx - 16*w1xw2*w1xppl*w2xpml*pplxppl
+    + 32*w1xw2*w1xppl*w2xpml*pplxql - 16*w1xw2*w1xppl*w2xpml*pptxppt
+    - 16*w1xw2*w1xppl*w2xpml*qlxql + 16*w1xw2*w1xppl*w2xpml*sq(m)
+    - 16*w1xw2*w1xppl*w2xpml*m0 - 16*w1xw2*w1xppl*w2xpml*rx + 8*w1xpml*w1xppl*w2xw2*pplxppl
+    - 16*w1xpml*w1xppl*w2xw2*pplxql + 8*w1xpml*w1xppl*w2xw2*pptxppt
+    + 8*w1xpml*w1xppl*w2xw2*qlxql - 8*w1xpml*w1xppl*w2xw2*sq(m) + 8*w1xpml*w1xppl*w2xw2*m0
+    + 8*w1xpml*w1xppl*w2xw2*rx - 16*sq(w1xppl)*w2xw2*pmlxppl + 16*sq(w1xppl)*w2xw2*pmlxql
+    - 16*sq(w1xppl)*w2xw2*pmtxppt - 16*sq(w1xppl)*w2xw2*sq(m) - 8*sq(w1xppl)*w2xw2*r1
+    + 8*sq(w1xppl)*w2xw2*rx + 32*sq(w1xppl)*w2xpml*w2xppl - 32*sq(w1xppl)*w2xpml*w2xql
+    + 16*w1xppl*w1xql*w2xw2*pmlxppl - 16*w1xppl*w1xql*w2xw2*pmlxql
+    + 16*w1xppl*w1xql*w2xw2*pmtxppt + 16*w1xppl*w1xql*w2xw2*sq(m) + 8*w1xppl*w1xql*w2xw2*r1
+    - 8*w1xppl*w1xql*w2xw2*rx - 32*w1xppl*w1xql*w2xpml*w2xppl
+    + 32*w1xppl*w1xql*w2xpml*w2xql);
+  Double_t N17 = in.Iz2(k1,m0,m1)*(-8*sq(w1xw2));
+  Double_t N18 = in.Id1(mkd1,mkx1,m1,md,mx)*(4*w1xw1*w2xw2 - 8*sq(w1xw2));
+
+  // dsigma is the sum of all terms
+  Double_t nt = N1+N2+N3+N4+N5+N6+N7+N8+N9+N10+N11+N12+N13+N14+N15+N16+N17+N18;
+  nt = nt*4./sq(fBeta);              // correction from w/u
+  nt = nt/p6(2*kPi)*sq(2*kPi);       // 1/(2pi)**6 from d3p, (2*pi)**2 from F.T.
+  nt = nt/4.;                        // from 1/2E+ 1/2E-
+  nt = nt*sq(1.9733)/10.;            // from MeV^-2 to kbarn
+
+  bad = in.fSetZero || nt < 0;
+  return bad ? 0. : nt;
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::ParamWeight(Double_t ypy, Double_t ymy, Double_t xpx, Double_t xmx,
+                                       Double_t phi)
+{
+  // Normalised inverse of the product of the parametrisations
+  Double_t wt = DsdYpY(ypy)*DsdYmY(ymy)*DsdXpX(xpx)*DsdXmX(xmx)*DsdPhi(phi);
+  return 2.2706950f/wt;
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::DsdYpY(Double_t y)
+{
+  // Parametrisation in y = yp+ye
+  return kParYpY[0]*TMath::Exp(-kParYpY[1]*sq(y))
+       + kParYpY[2]*TMath::Exp(-kParYpY[3]*p4(y))
+       + kParYpY[4]*TMath::Exp(-kParYpY[5]*sq(y));
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::DsdYmY(Double_t y)
+{
+  // Parametrisation in y = yp-ye
+  Double_t ay = TMath::Abs(y);
+  if (ay < 0.18f) return kParYmY[0]*TMath::Exp(-kParYmY[1]*sq(ay));
+  if (ay < 4.00) return kParYmY[2]*TMath::Exp(-kParYmY[3]*sq(ay));
+  return kParYmY[4]*TMath::Exp(-kParYmY[5]*ay);
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::DsdXpX(Double_t x)
+{
+  // Parametrisation in x = xp+xe
+  if (x < 0.6f) return kParXpX[0]*TMath::Exp(-kParXpX[1]*sq(x+kParXpX[2]));
+  return kParXpX[3]*TMath::Exp(-kParXpX[4]*x);
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::DsdXmX(Double_t x)
+{
+  // Parametrisation in x = xp-xe
+  return kParXmX[0]*TMath::Exp(-kParXmX[1]*TMath::Abs(x))
+       + kParXmX[2]*TMath::Exp(-kParXmX[3]*TMath::Abs(x));
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::DsdPhi(Double_t phi)
+{
+  // Parametrisation in the azimuthal angle between e+ and e- (rad)
+  return kParPhi[0]
+       + kParPhi[1]*TMath::Exp(-kParPhi[2]*TMath::Abs(phi-kPi))
+       + kParPhi[3]*TMath::Exp(-kParPhi[4]*TMath::Abs(phi-kPi))
+       + kParPhi[5]*TMath::Exp(-kParPhi[6]*TMath::Abs(phi-kPi));
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::Dgauss(Double_t (*f)(Double_t), Double_t a, Double_t b, Double_t eps)
+{
+  // Adaptive Gaussian quadrature of f from a to b (CERNLIB D103), 0 if
+  // the accuracy eps cannot be reached
+  Double_t h = 0;
+  if (b == a) return h;
+  const Double_t cnst = 0.005/TMath::Abs(b-a);
+  Double_t bb = a;
+  for (;;) {
+    Double_t aa = bb;
+    bb = b;
+    for (;;) {
+      Double_t c1 = 0.5*(bb+aa);
+      Double_t c2 = 0.5*(bb-aa);
+      Double_t s8 = 0;
+      for (Int_t i = 0; i < 4; i++) {
+        Double_t u = c2*kGaussX[i];
+        s8 = s8+kGaussW[i]*(f(c1+u)+f(c1-u));
+      }
+      Double_t s16 = 0;
+      for (Int_t i = 4; i < 12; i++) {
+        Double_t u = c2*kGaussX[i];
+        s16 = s16+kGaussW[i]*(f(c1+u)+f(c1-u));
+      }
+      s16 = c2*s16;
+      if (TMath::Abs(s16-c2*s8) <= eps*(1+TMath::Abs(s16))) {
+        h = h+s16;
+        break;
+      }
+      bb = c1;
+      if (1+cnst*TMath::Abs(c2) == 1) {
+        printf("TEpEmPairSampler: ERROR: Dgauss: too high accuracy required\n");
+        return 0;
+      }
+    }
+    if (bb == b) return h;
+  }
+}
+
+//______________________________________________________________________________
+Double_t TEpEmPairSampler::Dtrint(Double_t (*f)(Double_t, Double_t), Int_t nsd, Int_t npt,
+                                  Double_t eps, Double_t x1, Double_t y1, Double_t x2,
+                                  Double_t y2, Double_t x3, Double_t y3)
+{
+  // Integral of f over the triangle (x1,y1), (x2,y2), (x3,y3) with a 7, 25
+  // or 64 point formula (CERNLIB D105). For nsd != 0 the triangle is
+  // subdivided until the relative accuracy eps is reached, 0 on failure.
+  const Int_t kMax = 35;
+  Int_t m;
+  if (npt == 7) m = 0;
+  else if (npt == 25) m = 1;
+  else if (npt == 64) m = 2;
+  else {
+    printf("TEpEmPairSampler: ERROR: Dtrint: incorrect number of points = %d\n", npt);
+    return 0;
+  }
+  Double_t c1 = x1, d1 = y1, c2 = x2, d2 = y2, c3 = x3, d3 = y3;
+  Double_t s = TriangleRule(f, m, c1, d1, c2, d2, c3, d3);
+  if (nsd == 0) return s;
+
+  // Each step halves the current triangle (u) into the triangles
+  // (c1,c2,u3), kept on the stack, and (c1,c2,c3), which is halved next if
+  // the sum of both does not agree with the previous estimate sum0.
+  Double_t r[kMax+1], xp1[kMax+1], yp1[kMax+1], xp2[kMax+1], yp2[kMax+1];
+  Double_t xp3[kMax+1], yp3[kMax+1];
+  Double_t h = 0, sum0 = 0;
+  Double_t u1 = 0, v1 = 0, u2 = 0, v2 = 0, u3 = 0, v3 = 0;
+  Int_t k = 0;
+  Bool_t descend = kTRUE;
+  for (;;) {
+    if (descend) {
+      k++;
+      sum0 = s;
+      u1 = c1; v1 = d1;
+      u2 = c2; v2 = d2;
+      u3 = c3; v3 = d3;
+    }
+    c1 = 0.5*(u2+u3);
+    d1 = 0.5*(v2+v3);
+    c2 = u1;
+    d2 = v1;
+    c3 = u2;
+    d3 = v2;
+    xp1[k] = c1; yp1[k] = d1;
+    xp2[k] = c2; yp2[k] = d2;
+    xp3[k] = u3; yp3[k] = v3;
+    r[k] = TriangleRule(f, m, c1, d1, c2, d2, u3, v3);
+    s = TriangleRule(f, m, c1, d1, c2, d2, c3, d3);
+    Double_t sum = s+r[k];
+    if (TMath::Abs(sum0-sum) > eps*(1+TMath::Abs(sum))) {
+      if (k >= kMax) {
+        printf("TEpEmPairSampler: ERROR: Dtrint: too high accuracy required\n");
+        return 0;
+      }
+      descend = kTRUE;
+    } else {
+      h = h+sum;
+      k--;
+      if (k <= 0) return h;
+      u1 = xp1[k]; v1 = yp1[k];
+      u2 = xp2[k]; v2 = yp2[k];
+      u3 = xp3[k]; v3 = yp3[k];
+      sum0 = r[k];
+      descend = kFALSE;
+    }
+  }
+}
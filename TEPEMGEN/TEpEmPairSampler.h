@@ -0,0 +1,133 @@
+#ifndef ROOT_TEpEmPairSampler
+#define ROOT_TEpEmPairSampler
+/* Copyright(c) 1998-2002, ALICE Experiment at CERN, All rights reserved. *
+ * Copyright(c) 1997, 1998, 2002, Adrian Alscher and Kai Hencken          *
+ * Copyright(c) 2002 Kai Hencken, Yuri Kharlov, Serguei Sadovsky          *
+ * See cxx source for full Copyright notice                               */
+
+//------------------------------------------------------------------------
+// TEpEmPairSampler is a C++ implementation of the e+e- pair generator of
+// epemgen.f (ee_init, ee_event) with the exact differential cross section
+// of diffcross.f and the triangle integration of dtrint.f.
+// All state is kept in the object and random numbers are taken from the
+// TRandom given to Generate(), so independent copies can run in parallel.
+// Generate() produces n pairs into arrays, one per variable.
+//------------------------------------------------------------------------
+
+#include "Rtypes.h"
+#include "TMath.h"
+
+class TRandom;
+class TEpEmSurrogate;
+
+class TEpEmPairSampler {
+
+ public:
+  TEpEmPairSampler();
+
+  // Kinematic range (pt in MeV/c), energy per nucleon pair (GeV) and Z,
+  // as ee_init. Returns kFALSE if the range is invalid.
+  Bool_t Init(Double_t ymin, Double_t ymax, Double_t ptmin, Double_t ptmax,
+              Double_t cmEnergy, Double_t Z);
+  Bool_t IsInitialised() const {return fInit;}
+  // Range of Init in rapidity and log10(pt in MeV/c), Lorentz factor of the beams
+  Double_t GetYmin() const {return fYmin;}
+  Double_t GetYmax() const {return fYmax;}
+  Double_t GetXmin() const {return fXmin;}
+  Double_t GetXmax() const {return fXmax;}
+  Double_t GetGamma() const {return fGamma;}
+
+  // Generate n pairs as ee_event: rapidities of e-, e+ (yE, yP),
+  // log10(pt in MeV/c) of e-, e+ (xE, xP), azimuthal angle between e- and
+  // e+ (phi) and pair weight (w)
+  void Generate(Int_t n, TRandom *ran, Double_t *yE, Double_t *yP,
+                Double_t *xE, Double_t *xP, Double_t *phi, Double_t *w);
+  // Generate n pairs for the accept-reject test u[i]*wmax < w[i]. The weight
+  // is computed only where the surrogate sur times the envelope factor env
+  // reaches u[i]*wmax, and for a fraction check of the other pairs; h[i] is
+  // the inverse of the probability to compute it (1, 1/check, or 0 with
+  // w[i] = 0), so that h[i]*w[i] is unbiased, and the cross section sums
+  // use it. A pair is accepted as usual by u[i]*wmax < w[i] and then carries
+  // the weight h[i], so the accepted sample stays unbiased: where the
+  // envelope is too low it is kept with probability check and weight
+  // 1/check. Such a pair with h[i] > 1 passing the test was missed by the
+  // envelope; env is raised to cover it from then on and GetNMissed()
+  // counts it.
+  void Generate(Int_t n, TRandom *ran, const TEpEmSurrogate &sur, Double_t wmax,
+                Double_t check, Double_t &env, const Double_t *u, Double_t *yE,
+                Double_t *yP, Double_t *xE, Double_t *xP, Double_t *phi,
+                Double_t *w, Double_t *h);
+
+  // Cross section (kb) and its error accumulated so far, as in EEVENT
+  Double_t GetXsection() const {return fNevnt>0 ? fXsect2/fNevnt : 0.;}
+  Double_t GetDsection() const {return fNevnt>0 ? TMath::Sqrt(fDsect2)/fNevnt : 0.;}
+  Long64_t GetNGenerated() const {return fNevnt;}
+  Long64_t GetNBad() const {return fNBad;}
+  // Pairs passed by the check of the surrogate only, so missed by its envelope
+  Long64_t GetNMissed() const {return fNMissed;}
+  void     ResetSums() {fNevnt = 0; fNBad = 0; fNMissed = 0; fXsect2 = fDsect2 = 0.;}
+
+  // Fivefold differential cross section dsigma/dp+t dp-t dy+ dy- ddphi
+  // of Diffcross in kbarn/MeV^4/(Z alpha)^4, pt in MeV/c. bad is set if
+  // the result was negative or undefined and set to 0.
+  Double_t DiffCross(Double_t ppvt, Double_t yp, Double_t pmvt, Double_t ym,
+                     Double_t dphi, Bool_t &bad) const;
+  // Normalisation of the weights (integral of the parametrisations)
+  Double_t GetXYsect() const {return fXYsect;}
+  // Inverse of the parametrisation in the sums and differences of y and
+  // x = log10(pt), so that a pair has the weight
+  // GetXYsect()*DiffCross(...)*(pte*ptp)^2*ParamWeight(...)
+  static Double_t ParamWeight(Double_t ypy, Double_t ymy, Double_t xpx, Double_t xmx, Double_t phi);
+
+  // Parametrisations of the differential cross section used for sampling
+  static Double_t DsdYpY(Double_t y);
+  static Double_t DsdYmY(Double_t y);
+  static Double_t DsdXpX(Double_t x);
+  static Double_t DsdXmX(Double_t x);
+  static Double_t DsdPhi(Double_t phi);
+
+  // CERNLIB D103 (adaptive Gauss) and D105 (triangle, npt = 7, 25 or 64)
+  static Double_t Dgauss(Double_t (*f)(Double_t), Double_t a, Double_t b, Double_t eps);
+  static Double_t Dtrint(Double_t (*f)(Double_t, Double_t), Int_t nsd, Int_t npt, Double_t eps,
+                         Double_t x1, Double_t y1, Double_t x2, Double_t y2,
+                         Double_t x3, Double_t y3);
+
+ protected:
+  // Uniform in (0,1) from a buffer refilled with RndmArray
+  Double_t Rndm(TRandom *ran);
+  Double_t Normal(TRandom *ran);
+  void     GeneratePair(TRandom *ran, Double_t &yE, Double_t &yP, Double_t &xE,
+                        Double_t &xP, Double_t &phi, Double_t &w);
+  void     SampleKinematics(TRandom *ran, Double_t &yE, Double_t &yP, Double_t &xE,
+                            Double_t &xP, Double_t &phi, Double_t &ypy, Double_t &ymy,
+                            Double_t &xpx, Double_t &xmx);
+  Double_t Weight(Double_t yE, Double_t yP, Double_t xE, Double_t xP, Double_t phi,
+                  Double_t ypy, Double_t ymy, Double_t xpx, Double_t xmx);
+
+  Bool_t   fInit;       // initialised
+  // kinematic range and sampler parameters (COMMON eepars)
+  Double_t fYmin, fYmax;
+  Double_t fXmin, fXmax;
+  Double_t fYpYmin, fYpYmax, fWYpYmax;
+  Double_t fYmYmin, fYmYmax, fYmed1, fYmed2, fSgmY1, fSgmY2;
+  Double_t fXYsect;
+  Double_t fGaus1, fGaus2, fGauss;
+  Double_t fExp1, fExp2, fExp3;
+  Double_t fXmXmin, fXmXmax, fXpXmin, fXpXmax;
+  Double_t fExmx1, fXmed, fSgm1, fAnorX;
+  Int_t    fIcase;
+  // Diffcross constants (COMMON physparam)
+  Double_t fGamma, fBeta, fM, fW1xW1, fW1xW2, fW2xW2, fWl, fWy;
+  // accumulated sums (COMMON eevent)
+  Long64_t fNevnt;
+  Long64_t fNBad;
+  Long64_t fNMissed;
+  Double_t fXsect2, fDsect2;
+  // random number buffer, emptied at the end of Generate()
+  static const Int_t kNRndm = 256;
+  Double_t fRndm[kNRndm];   // buffered random numbers
+  Int_t    fNRndm;          // next unused entry
+  Int_t    fNRndmFill;      // numbers drawn per refill
+};
+
+#endif
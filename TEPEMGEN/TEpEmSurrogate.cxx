@@ -0,0 +1,393 @@
+/**************************************************************************
+ * Copyright(c) 1998-2002, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ *                                                                        *
+ *                                                                        *
+ * Copyright(c) 1997, 1998, 2002, Adrian Alscher and Kai Hencken          *
+ * See $ALICE_ROOT/EpEmGen/diffcross.f for full Copyright notice          *
+ *                                                                        *
+ *                                                                        *
+ * Copyright(c) 2002 Kai Hencken, Yuri Kharlov, Serguei Sadovsky          *
+ * See $ALICE_ROOT/EpEmGen/epemgen.f for full Copyright notice            *
+ *                                                                        *
+ **************************************************************************/
+//------------------------------------------------------------------------
+// TEpEmSurrogate: interpolation table of the e+e- pair weight.
+// The grid starts with kNStart nodes per axis. In each step the error of
+// linear interpolation on an interval, h^2/8 |f''| with f'' from second
+// differences of the tabulated logarithm, is estimated along every axis
+// and the intervals above the precision are halved, the worst first,
+// until none is left or the node budget is used up. Only the new nodes
+// are computed.
+//------------------------------------------------------------------------
+
+#include "TEpEmSurrogate.h"
+#include "TEpEmPairSampler.h"
+#include "TMath.h"
+#include "TRandom.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+const Int_t    kNStart   = 5;       // initial nodes per axis
+const Double_t kMinWidth = 1e-3;    // smallest interval in units of the axis range
+const Double_t kPhiMin   = 0.03;    // phi cut of the sampler
+const Float_t  kLogZero  = -700.;   // log of a vanishing weight
+const Double_t kQTMin    = 0.02;    // pair pt/max(pt of e+,e-) below which there is no surrogate
+const char     kMagic[8] = {'E','P','E','M','S','U','R','1'};
+
+// Pair transverse momentum over the larger pt, from x- - x+ and phi
+Double_t RelPairPt(Double_t xmx, Double_t phi)
+{
+  Double_t r = TMath::Power(10., -TMath::Abs(xmx));
+  return TMath::Sqrt(TMath::Max(0., 1.+r*r+2.*r*TMath::Cos(phi)));
+}
+
+struct Split {
+  Double_t fErr;
+  Int_t    fDim, fIndex;
+  bool operator<(const Split &o) const {return fErr > o.fErr;}
+};
+
+}
+
+//______________________________________________________________________________
+TEpEmSurrogate::TEpEmSurrogate():
+  fFoldY(kFALSE),
+  fMaxRelError(-1)
+{
+  for (Int_t i = 0; i < kNKey; i++) fKey[i] = 0;
+  for (Int_t k = 0; k < kNDim; k++) fStride[k] = 0;
+}
+
+//______________________________________________________________________________
+void TEpEmSurrogate::SetKey(const TEpEmPairSampler &sampler, Double_t eps, Int_t maxNodes)
+{
+  fKey[0] = sampler.GetYmin();
+  fKey[1] = sampler.GetYmax();
+  fKey[2] = sampler.GetXmin();
+  fKey[3] = sampler.GetXmax();
+  fKey[4] = sampler.GetGamma();
+  fKey[5] = eps;
+  fKey[6] = maxNodes;
+}
+
+//______________________________________________________________________________
+Bool_t TEpEmSurrogate::Build(TEpEmPairSampler &sampler, TRandom *ran, Double_t eps,
+                             Int_t maxNodes, Int_t nCheck)
+{
+  // Tabulate and check, see the header
+  fTable.clear();
+  fMaxRelError = -1;
+  if (!sampler.IsInitialised() || eps <= 0) {
+    printf("TEpEmSurrogate: ERROR: sampler not initialised or eps = %f\n", eps);
+    return kFALSE;
+  }
+  SetKey(sampler, eps, maxNodes);
+  Double_t ymin = sampler.GetYmin(), ymax = sampler.GetYmax();
+  Double_t xmin = sampler.GetXmin(), xmax = sampler.GetXmax();
+
+  // ranges of the folded variables; ymy >= 0 by charge exchange,
+  // phi <= pi, and ypy >= 0 by beam exchange if that makes it shorter
+  Double_t ypyMax = TMath::Max(TMath::Abs(2.*ymin), TMath::Abs(2.*ymax));
+  fFoldY = ypyMax < 2.*(ymax-ymin);
+  Double_t lo[kNDim] = {fFoldY ? 0. : 2.*ymin, 0., 2.*xmin, xmin-xmax, kPhiMin};
+  Double_t hi[kNDim] = {fFoldY ? ypyMax : 2.*ymax, ymax-ymin, 2.*xmax, xmax-xmin, TMath::Pi()};
+  for (Int_t k = 0; k < kNDim; k++) {
+    fAxis[k].resize(kNStart);
+    for (Int_t i = 0; i < kNStart; i++)
+      fAxis[k][i] = lo[k] + (hi[k]-lo[k])*i/(kNStart-1);
+  }
+
+  std::vector<Double_t> oldAxis[kNDim];
+  std::vector<Float_t> oldTable;
+  do {
+    Fill(sampler, oldAxis, oldTable);
+    for (Int_t k = 0; k < kNDim; k++) oldAxis[k] = fAxis[k];
+    oldTable = fTable;
+  } while (Refine(eps, maxNodes));
+
+  // largest relative error on generated pairs
+  const Int_t kBatch = 1000;
+  std::vector<Double_t> pairs(6*kBatch);
+  Double_t *yE = &pairs[0], *yP = yE+kBatch, *xE = yP+kBatch, *xP = xE+kBatch;
+  Double_t *phi = xP+kBatch, *w = phi+kBatch;
+  Double_t maxErr = 0, minErr = 0;
+  Int_t nOut = 0;
+  for (Int_t i = 0; i < nCheck; i += kBatch) {
+    Int_t nb = TMath::Min(kBatch, nCheck-i);
+    sampler.Generate(nb, ran, yE, yP, xE, xP, phi, w);
+    for (Int_t j = 0; j < nb; j++) {
+      if (w[j] <= 0) continue;
+      Double_t ypy = yE[j]+yP[j], ymy = yE[j]-yP[j];
+      Double_t xpx = xE[j]+xP[j], xmx = xE[j]-xP[j];
+      Double_t exact = w[j]/sampler.GetXYsect();
+      Double_t sur = Eval(ypy, ymy, xpx, xmx, phi[j]);
+      if (sur < 0) {
+        nOut++;
+        continue;
+      }
+      Double_t rel = exact/sur - 1.;
+      maxErr = TMath::Max(maxErr, rel);
+      minErr = TMath::Min(minErr, rel);
+    }
+  }
+  fMaxRelError = maxErr;
+  printf("TEpEmSurrogate: %d nodes (%d,%d,%d,%d,%d), relative error %e..%e in %d pairs, %d without surrogate\n",
+         GetNNodes(), (Int_t)fAxis[0].size(), (Int_t)fAxis[1].size(), (Int_t)fAxis[2].size(),
+         (Int_t)fAxis[3].size(), (Int_t)fAxis[4].size(), minErr, maxErr, nCheck, nOut);
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+void TEpEmSurrogate::Fill(const TEpEmPairSampler &sampler, const std::vector<Double_t> *oldAxis,
+                          const std::vector<Float_t> &oldTable)
+{
+  // Weight at the nodes of fAxis, taken from oldTable on the nodes
+  // of oldAxis
+  Int_t n[kNDim], oldStride[kNDim];
+  std::vector<Int_t> oldIndex[kNDim];
+  Int_t size = 1, oldSize = 1;
+  for (Int_t k = kNDim-1; k >= 0; k--) {
+    n[k] = fAxis[k].size();
+    fStride[k] = size;
+    oldStride[k] = oldSize;
+    size *= n[k];
+    oldSize *= oldAxis[k].size();
+    oldIndex[k].assign(n[k], -1);
+    for (Int_t i = 0, j = 0; i < n[k]; i++) {
+      while (j < (Int_t)oldAxis[k].size() && oldAxis[k][j] < fAxis[k][i]) j++;
+      if (j < (Int_t)oldAxis[k].size() && oldAxis[k][j] == fAxis[k][i]) oldIndex[k][i] = j;
+    }
+  }
+  fTable.resize(size);
+  Double_t ymin = sampler.GetYmin(), ymax = sampler.GetYmax();
+  Double_t xmin = sampler.GetXmin(), xmax = sampler.GetXmax();
+  Int_t idx[kNDim] = {0, 0, 0, 0, 0};
+  for (Int_t l = 0; l < size; l++) {
+    Int_t old = oldTable.empty() ? -1 : 0;
+    for (Int_t k = 0; k < kNDim && old >= 0; k++) {
+      Int_t j = oldIndex[k][idx[k]];
+      old = j < 0 ? -1 : old + j*oldStride[k];
+    }
+    if (old >= 0) {
+      fTable[l] = oldTable[old];
+    } else {
+      // nodes outside the range take the value at the nearest point inside
+      Double_t ypy = fAxis[0][idx[0]], ymy = fAxis[1][idx[1]];
+      Double_t xpx = fAxis[2][idx[2]], xmx = fAxis[3][idx[3]];
+      Double_t yE = TMath::Min(ymax, TMath::Max(ymin, 0.5*(ypy+ymy)));
+      Double_t yP = TMath::Min(ymax, TMath::Max(ymin, 0.5*(ypy-ymy)));
+      Double_t xE = TMath::Min(xmax, TMath::Max(xmin, 0.5*(xpx+xmx)));
+      Double_t xP = TMath::Min(xmax, TMath::Max(xmin, 0.5*(xpx-xmx)));
+      Double_t pte = TMath::Power(10., xE);
+      Double_t ptp = TMath::Power(10., xP);
+      // nodes below kQTMin take the value at kQTMin for the same xmx
+      Double_t phi = fAxis[4][idx[4]];
+      Double_t r = TMath::Power(10., -TMath::Abs(xE-xP));
+      if (RelPairPt(xE-xP, phi) < kQTMin)
+        phi = TMath::ACos((kQTMin*kQTMin-1.-r*r)/(2.*r));
+      // yE = yP and collinear pairs can give 0, such nodes are moved slightly
+      Bool_t bad;
+      Double_t f = sampler.DiffCross(ptp, yP, pte, yE, phi, bad);
+      for (Double_t d = 1e-6; !(f > 0) && d < 0.1; d *= 10)
+        f = sampler.DiffCross(ptp, yP, pte, yE+d < ymax ? yE+d : yE-d, phi-d, bad);
+      f *= (pte*ptp)*(pte*ptp)*TEpEmPairSampler::ParamWeight(yE+yP, yE-yP, xE+xP, xE-xP, phi);
+      fTable[l] = f > 0 ? TMath::Log(f) : kLogZero;
+    }
+    for (Int_t k = kNDim-1; k >= 0 && ++idx[k] == n[k]; k--) idx[k] = 0;
+  }
+  // vanishing nodes are raised to the smallest regular one so that the
+  // cells around them are not driven to zero
+  Float_t fmin = 0;
+  for (Int_t l = 0; l < size; l++)
+    if (fTable[l] > kLogZero && fTable[l] < fmin) fmin = fTable[l];
+  for (Int_t l = 0; l < size; l++)
+    if (fTable[l] <= kLogZero) fTable[l] = fmin;
+}
+
+//______________________________________________________________________________
+Bool_t TEpEmSurrogate::Refine(Double_t eps, Int_t maxNodes)
+{
+  // Halve the intervals whose error estimate is above eps, as far as the
+  // node budget allows. Returns kFALSE if none was halved.
+  std::vector<Split> splits;
+  Int_t size = fTable.size();
+  // nodes below kQTMin are not used, the flags depend on xmx and phi only
+  Int_t nxp = fStride[2];
+  std::vector<Bool_t> valid(nxp);
+  for (Int_t l = 0; l < nxp; l++)
+    valid[l] = RelPairPt(fAxis[3][l/fStride[3]], fAxis[4][l%fStride[3]]) >= kQTMin;
+  for (Int_t k = 0; k < kNDim; k++) {
+    const std::vector<Double_t> &a = fAxis[k];
+    Int_t n = a.size(), s = fStride[k];
+    std::vector<Double_t> err(n-1, 0.);
+    for (Int_t l = 0; l < size; l++) {
+      Int_t j = (l/s)%n;
+      if (j == 0 || j == n-1) continue;
+      if (!valid[l%nxp] || !valid[(l-s)%nxp] || !valid[(l+s)%nxp]) continue;
+      Double_t h0 = a[j]-a[j-1], h1 = a[j+1]-a[j];
+      Double_t d2 = 2.*((fTable[l+s]-fTable[l])/h1 - (fTable[l]-fTable[l-s])/h0)/(h0+h1);
+      err[j-1] = TMath::Max(err[j-1], h0*h0/8.*TMath::Abs(d2));
+      err[j]   = TMath::Max(err[j],   h1*h1/8.*TMath::Abs(d2));
+    }
+    Double_t minWidth = kMinWidth*(a[n-1]-a[0]);
+    for (Int_t j = 0; j < n-1; j++) {
+      if (err[j] > eps && a[j+1]-a[j] > 2.*minWidth) {
+        Split sp = {err[j], k, j};
+        splits.push_back(sp);
+      }
+    }
+  }
+  std::sort(splits.begin(), splits.end());
+  Int_t nNew[kNDim];
+  Double_t total = size;
+  for (Int_t k = 0; k < kNDim; k++) nNew[k] = fAxis[k].size();
+  std::vector<Double_t> add[kNDim];
+  for (const Split &sp : splits) {
+    Double_t next = total/nNew[sp.fDim]*(nNew[sp.fDim]+1);
+    if (next > maxNodes) continue;
+    total = next;
+    nNew[sp.fDim]++;
+    const std::vector<Double_t> &a = fAxis[sp.fDim];
+    add[sp.fDim].push_back(0.5*(a[sp.fIndex]+a[sp.fIndex+1]));
+  }
+  Bool_t refined = kFALSE;
+  for (Int_t k = 0; k < kNDim; k++) {
+    if (add[k].empty()) continue;
+    fAxis[k].insert(fAxis[k].end(), add[k].begin(), add[k].end());
+    std::sort(fAxis[k].begin(), fAxis[k].end());
+    refined = kTRUE;
+  }
+  return refined;
+}
+
+//______________________________________________________________________________
+Double_t TEpEmSurrogate::Eval(Double_t ypy, Double_t ymy, Double_t xpx, Double_t xmx,
+                              Double_t phi) const
+{
+  // Multilinear interpolation of the logarithm in the folded variables
+  if (RelPairPt(xmx, phi) < kQTMin) return -1;
+  if (ymy < 0) {
+    ymy = -ymy;
+    xmx = -xmx;
+  }
+  if (fFoldY && ypy < 0) {
+    ypy = -ypy;
+    xmx = -xmx;
+  }
+  if (phi > TMath::Pi()) phi = 2.*TMath::Pi()-phi;
+  const Double_t v[kNDim] = {ypy, ymy, xpx, xmx, phi};
+  Double_t t[kNDim];
+  Int_t base = 0;
+  for (Int_t k = 0; k < kNDim; k++) {
+    const std::vector<Double_t> &a = fAxis[k];
+    Int_t j = std::upper_bound(a.begin()+1, a.end()-1, v[k]) - a.begin() - 1;
+    t[k] = TMath::Min(1., TMath::Max(0., (v[k]-a[j])/(a[j+1]-a[j])));
+    base += j*fStride[k];
+  }
+  // corners of the cell, then reduce along the axes from the last one
+  Double_t c[1 << kNDim];
+  for (Int_t i = 0; i < (1 << kNDim); i++) {
+    Int_t l = base;
+    for (Int_t k = 0; k < kNDim; k++)
+      if (i & (1 << (kNDim-1-k))) l += fStride[k];
+    c[i] = fTable[l];
+  }
+  for (Int_t k = kNDim-1, m = 1 << kNDim; k >= 0; k--) {
+    m >>= 1;
+    for (Int_t i = 0; i < m; i++)
+      c[i] = c[2*i] + t[k]*(c[2*i+1]-c[2*i]);
+  }
+  return TMath::Exp(c[0]);
+}
+
+//______________________________________________________________________________
+Bool_t TEpEmSurrogate::Read(const char *fname, const TEpEmPairSampler &sampler,
+                            Double_t eps, Int_t maxNodes)
+{
+  // Binary file: magic, key, fold flag, nodes per axis, max.relative
+  // error, axes and table, in the byte order of the machine which wrote it
+  fTable.clear();
+  SetKey(sampler, eps, maxNodes);
+  FILE *f = fopen(fname, "rb");
+  if (!f) return kFALSE;
+  char magic[8];
+  Double_t key[kNKey], maxErr;
+  Int_t fold, n[kNDim];
+  Bool_t ok = fread(magic, 1, 8, f) == 8 && memcmp(magic, kMagic, 8) == 0 &&
+              fread(key, sizeof(Double_t), kNKey, f) == (size_t)kNKey &&
+              fread(&fold, sizeof(Int_t), 1, f) == 1 &&
+              fread(n, sizeof(Int_t), kNDim, f) == (size_t)kNDim &&
+              fread(&maxErr, sizeof(Double_t), 1, f) == 1;
+  for (Int_t i = 0; ok && i < kNKey; i++) ok = key[i] == fKey[i];
+  Int_t size = 1;
+  for (Int_t k = kNDim-1; ok && k >= 0; k--) {
+    ok = n[k] >= 2 && n[k] <= maxNodes;
+    fStride[k] = size;
+    size *= n[k];
+  }
+  ok = ok && size <= maxNodes;
+  for (Int_t k = 0; ok && k < kNDim; k++) {
+    fAxis[k].resize(n[k]);
+    ok = fread(&fAxis[k][0], sizeof(Double_t), n[k], f) == (size_t)n[k];
+  }
+  if (ok) {
+    fTable.resize(size);
+    ok = fread(&fTable[0], sizeof(Float_t), size, f) == (size_t)size;
+  }
+  fclose(f);
+  if (!ok) {
+    fTable.clear();
+    return kFALSE;
+  }
+  fFoldY = fold;
+  fMaxRelError = maxErr;
+  printf("TEpEmSurrogate: %d nodes with relative error %e from %s\n", size, maxErr, fname);
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TEpEmSurrogate::Write(const char *fname) const
+{
+  // Write under a temporary name and rename, so that concurrent jobs never
+  // read a partial file
+  if (!IsValid()) return kFALSE;
+  char tmp[4096];
+  snprintf(tmp, sizeof(tmp), "%s.%d", fname, (Int_t)getpid());
+  FILE *f = fopen(tmp, "wb");
+  if (!f) {
+    printf("TEpEmSurrogate: cannot write %s\n", tmp);
+    return kFALSE;
+  }
+  Int_t fold = fFoldY, n[kNDim];
+  for (Int_t k = 0; k < kNDim; k++) n[k] = fAxis[k].size();
+  Bool_t ok = fwrite(kMagic, 1, 8, f) == 8 &&
+              fwrite(fKey, sizeof(Double_t), kNKey, f) == (size_t)kNKey &&
+              fwrite(&fold, sizeof(Int_t), 1, f) == 1 &&
+              fwrite(n, sizeof(Int_t), kNDim, f) == (size_t)kNDim &&
+              fwrite(&fMaxRelError, sizeof(Double_t), 1, f) == 1;
+  for (Int_t k = 0; ok && k < kNDim; k++)
+    ok = fwrite(&fAxis[k][0], sizeof(Double_t), n[k], f) == (size_t)n[k];
+  ok = ok && fwrite(&fTable[0], sizeof(Float_t), fTable.size(), f) == fTable.size();
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp, fname) != 0) {
+    printf("TEpEmSurrogate: cannot write %s\n", fname);
+    remove(tmp);
+    return kFALSE;
+  }
+  return kTRUE;
+}
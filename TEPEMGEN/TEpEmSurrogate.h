@@ -0,0 +1,69 @@
+#ifndef ROOT_TEpEmSurrogate
+#define ROOT_TEpEmSurrogate
+/* Copyright(c) 1998-2002, ALICE Experiment at CERN, All rights reserved. *
+ * Copyright(c) 1997, 1998, 2002, Adrian Alscher and Kai Hencken          *
+ * Copyright(c) 2002 Kai Hencken, Yuri Kharlov, Serguei Sadovsky          *
+ * See cxx source for full Copyright notice                               */
+
+//------------------------------------------------------------------------
+// TEpEmSurrogate tabulates the weight of the pairs of TEpEmPairSampler,
+// the exact cross section over its parametrisation, in the variables of
+// the sampler: sums and differences of the rapidities and of log10(pt) and
+// the azimuthal angle between e- and e+. The logarithm is interpolated
+// multilinearly on a tensor grid whose nodes are refined per axis where
+// the interpolation error estimate is above the requested precision.
+// The charge and beam exchange and phi -> 2pi-phi symmetries fold the
+// table. Pairs with nearly opposite pt (pair pt below kQTMin of the larger
+// pt), where the cross section is too irregular, are not covered.
+// The largest relative error found on pairs from the sampler is kept with
+// the table. Tables can be written to and read from a file.
+//------------------------------------------------------------------------
+
+#include "Rtypes.h"
+#include <vector>
+
+class TRandom;
+class TEpEmPairSampler;
+
+class TEpEmSurrogate {
+
+ public:
+  TEpEmSurrogate();
+
+  // Tabulate for the range of the initialised sampler, refining until the
+  // error estimate is below eps or the table has maxNodes nodes. The error
+  // is then measured on nCheck pairs generated by the sampler.
+  Bool_t Build(TEpEmPairSampler &sampler, TRandom *ran, Double_t eps,
+               Int_t maxNodes, Int_t nCheck);
+  Bool_t IsValid() const {return !fTable.empty();}
+
+  // Surrogate of DiffCross(ptp,yP,pte,yE,phi)*(pte*ptp)^2*ParamWeight(...),
+  // the pair weight over GetXYsect(), with ypy = yE+yP, ymy = yE-yP,
+  // xpx = xE+xP, xmx = xE-xP (x = log10(pt)); -1 for pairs not covered
+  Double_t Eval(Double_t ypy, Double_t ymy, Double_t xpx, Double_t xmx, Double_t phi) const;
+  // Largest relative error (exact/surrogate - 1) seen in the check
+  Double_t GetMaxRelError() const {return fMaxRelError;}
+  Int_t    GetNNodes() const {return (Int_t)fTable.size();}
+
+  // Table for the same sampler range and build parameters from file;
+  // kFALSE if there is none
+  Bool_t Read(const char *fname, const TEpEmPairSampler &sampler, Double_t eps, Int_t maxNodes);
+  Bool_t Write(const char *fname) const;
+
+ protected:
+  void   SetKey(const TEpEmPairSampler &sampler, Double_t eps, Int_t maxNodes);
+  void   Fill(const TEpEmPairSampler &sampler, const std::vector<Double_t> *oldAxis,
+              const std::vector<Float_t> &oldTable);
+  Bool_t Refine(Double_t eps, Int_t maxNodes);
+
+  static const Int_t kNDim = 5;     // ypy, ymy, xpx, xmx, phi
+  static const Int_t kNKey = 7;
+  Double_t fKey[kNKey];             // y range, x range, gamma, eps, max.nodes
+  Bool_t   fFoldY;                  // table for ypy >= 0 only
+  std::vector<Double_t> fAxis[kNDim]; // nodes per axis
+  Int_t    fStride[kNDim];          // strides of the axes in fTable
+  std::vector<Float_t> fTable;      // log of the weight at the nodes
+  Double_t fMaxRelError;            // largest relative error in the check
+};
+
+#endif
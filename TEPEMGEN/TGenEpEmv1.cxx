@@ -49,6 +49,12 @@
 //                       // Sum of the selected event weights, divided by the total 
 //                       // number of generated events, gives the integral cross 
 //                       // section corresponded to the set of selected events
+//                       // (both in units of gener->GetXSection()).
+//    With gener->SetWeighting(TGenEpEmv1::kUnweighted) before Init, pairs
+//    are unweighted against a max.weight estimated in Init; the few pairs
+//    above it keep a weight>1, see SetMaxWeightTolerance.
+//    gener->SetSurrogate() in addition, with the C++ generator, tabulates
+//    the cross section in Init so that most rejected pairs are not computed.
 //%
 // The generator consists of several modules:
 // 1) $ALICE_ROOT/EpEmGen/diffcross.f:
@@ -76,9 +82,36 @@
 #include <TParticlePDG.h>
 #include <TDatabasePDG.h>
 #include <TEpEmGen.h>
+#include <TSystem.h>
+#include <TRandom3.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
 
 ClassImp(TGenEpEmv1);
 
+namespace {
+// Threshold t above which the weights w[i].first, counted w[i].second
+// times, sum up to excess, sum_i w[i].second*max(w[i].first-t,0) = excess;
+// sorts w in decreasing order
+double WeightThreshold(std::vector<std::pair<double,double> > &w, double excess)
+{
+  std::sort(w.begin(),w.end(),std::greater<std::pair<double,double> >());
+  // the weight above t between w[k] and w[k-1] is sum_{i<k} h[i]*(w[i]-t)
+  double sum = 0, count = 0;
+  for (size_t k=1; k<=w.size(); k++) {
+    sum += w[k-1].second*w[k-1].first;
+    count += w[k-1].second;
+    double next = k<w.size() ? w[k].first : 0.;
+    if (sum-count*next > excess) return (sum-excess)/count;
+  }
+  return 0;
+}
+}
+
 //------------------------------------------------------------
 
 TGenEpEmv1::TGenEpEmv1():
@@ -93,7 +126,23 @@ TGenEpEmv1::TGenEpEmv1():
   fXSection(-1.),
   fXSectionEps(1e-2),
   fMinXSTest(1000),
-  fMaxXSTest(10000000)
+  fMaxXSTest(10000000),
+  fXSectionCache(""),
+  fXSectionWorkers(1),
+  fWeighting(kWeighted),
+  fMaxWeightTol(1e-3),
+  fMaxWeightTrials(100000),
+  fMaxWeight(-1.),
+  fNTried(0),
+  fNAccepted(0),
+  fNOverflow(0),
+  fSumWeights(0.),
+  fSumOverflow(0.),
+  fOverflowExcess(0.),
+  fUseSurrogate(false),
+  fSurrogateEps(0.05),
+  fSurrogateNodes(300000),
+  fSurrogateFile("")
 {
   // Default constructor
   for (Int_t i = 0; i < 3; ++i) {
@@ -118,6 +167,9 @@ bool TGenEpEmv1::Init()
   fMass = TDatabasePDG::Instance()->GetParticle(11)->Mass();
   if (fPtMin == 0) fPtMin = 1.E-04; // avoid zero pT
   Initialize(fYMin, fYMax, fPtMin, fPtMax, fCMEnergy, fZ);
+  if (fNative && !fSampler.IsInitialised()) {
+    return false;
+  }
   fEvent = 0;
   //
   // calculate XSection
@@ -127,38 +179,283 @@ bool TGenEpEmv1::Init()
     return false;
   }
   fXSectionEps = err/fXSection;
+  //
+  fNTried = fNAccepted = fNOverflow = 0;
+  fSumWeights = fSumOverflow = 0;
+  fOverflowWeights.clear();
+  fOverflowExcess = 0;
+  fMaxWeight = -1;
+  if (fWeighting==kUnweighted) {
+    fMaxWeight = EstimateMaxWeight(fMaxWeightTrials,fMaxWeightTol);
+    if (fMaxWeight<=0) {
+      return false;
+    }
+    if (fUseSurrogate && !InitSurrogate(fSurrogateEps,fSurrogateNodes,fSurrogateFile.Data())) {
+      printf("TGenEpEmv1: no surrogate, all pairs get the exact cross section\n");
+    }
+  }
   return true;
 }
 
+//____________________________________________________________
+double TGenEpEmv1::EstimateMaxWeight(Long64_t ntri, double tol)
+{
+  // Max.weight for unweighting: the smallest weight such that at most the
+  // fraction tol of the total weight of ntri trial pairs lies above it.
+  // Pairs above it are kept with weight>1, see SelectPairs.
+  const int kBatch = 1000;
+  std::vector<double> pairs(6*kBatch);
+  std::vector<std::pair<double,double> > w;
+  w.reserve(ntri);
+  for (Long64_t i=0; i<ntri; i+=kBatch) {
+    int nb = TMath::Min(Long64_t(kBatch),ntri-i);
+    GenerateEvents(nb,fYMin,fYMax,fPtMin,fPtMax,&pairs[0],&pairs[kBatch],
+                   &pairs[2*kBatch],&pairs[3*kBatch],&pairs[4*kBatch],&pairs[5*kBatch]);
+    for (int j=0; j<nb; j++) w.push_back(std::make_pair(pairs[5*kBatch+j],1.));
+  }
+  double total = 0;
+  for (const auto &x : w) total += x.first;
+  if (total<=0) {
+    printf("TGenEpEmv1: no weight in %lld trials, cannot estimate max.weight\n",ntri);
+    return -1;
+  }
+  double wmax = WeightThreshold(w,tol*total);
+  printf("Max.weight %e kb (%.1f x mean) from %lld trials with tolerance %e\n",
+         wmax,wmax*w.size()/total,ntri,tol);
+  return wmax;
+}
+
 //____________________________________________________________
 double TGenEpEmv1::CalcXSection(double eps, int triMin, int triMax, double& err)
 {
+  // Cross section from the mean event weight. Sums of a cached estimate
+  // for the same setup are taken over and refined by further trials until
+  // the relative error is below eps; the trials run in fXSectionWorkers
+  // processes.
+  // Trials added to a cached estimate must not repeat the cached ones, as
+  // a job with the seed of the job which wrote the entry would do. They are
+  // drawn from a stream seeded with the trial count reached so far, which
+  // differs for every refinement of an entry, and gRandom is left as is.
   if (eps<1e-4) {
     eps = 1e-4;
   }
-  int ngen = 0;
+  Long64_t ngen = 0;
+  double sumw = 0, sumw2 = 0;
+  if (ReadXSectionCache(ngen,sumw,sumw2)) {
+    printf("Cached x-section after %lld trials found in %s\n",ngen,fXSectionCache.Data());
+  }
+  Long64_t ncached = ngen;
   printf("Estimating x-section with min.relative precision of %f and min/max test: %d/%d\n",
 	 eps,triMin,triMax);
-  double yElectron,yPositron,xElectron,xPositron,phi12,weight;
-  double xSect = -1;
-  err = -1;
   //
-  do {
-    TEpEmGen::GenerateEvent(fYMin,fYMax,fPtMin,fPtMax,yElectron,yPositron,xElectron,xPositron,phi12,weight);
-    if (++ngen>triMin) { // ensure min number of tests
-      xSect = TEpEmGen::GetXsection()*1000;
-      err = TEpEmGen::GetDsection()*1000;
+  while (ngen<triMax) {
+    double rel = sumw>0 ? TMath::Sqrt(sumw2)/sumw : -1;
+    Long64_t need = 0;
+    if (ngen<=triMin) {
+      need = triMin+1-ngen; // ensure min number of tests
+    } else if (rel<0) {
+      need = ngen; // no weight yet
+    } else if (rel>=eps) {
+      // the relative error scales as 1/sqrt(ngen), 10% margin
+      need = Long64_t(1.1*ngen*(rel*rel/(eps*eps)-1.))+1;
+    } else {
+      break;
     }
-  } while(!((xSect>0 && err/xSect<eps) || ngen>triMax));
+    need = TMath::Min(need, triMax-ngen);
+    if (ncached>0) {
+      TRandom *random = gRandom;
+      TRandom3 refine(UInt_t(1 + ngen%2147483646));
+      gRandom = &refine;
+      RunXSectionTrials(need,ngen,sumw,sumw2);
+      gRandom = random;
+    } else {
+      RunXSectionTrials(need,ngen,sumw,sumw2);
+    }
+  }
   //
+  double xSect = ngen>0 ? sumw/ngen*1000 : -1;
+  err = ngen>0 ? TMath::Sqrt(sumw2)/ngen*1000 : -1;
   if (xSect<=0) {
-    printf("Failed to estimate X-section after %d trials\n",ngen);
+    printf("Failed to estimate X-section after %lld trials\n",ngen);
     abort();
   }
-  printf("X-section = %e with %e error after %d trials",xSect,err,ngen);
+  if (ngen>ncached) {
+    WriteXSectionCache(ngen,sumw,sumw2);
+  }
+  printf("X-section = %e with %e error after %lld trials",xSect,err,ngen);
   return xSect;
 }
 
+//____________________________________________________________
+void TGenEpEmv1::XSectionTrials(Long64_t ntri, Long64_t &n, double &sumw, double &sumw2)
+{
+  // Accumulate the weights of ntri generated pairs, in batches
+  const int kBatch = 1000;
+  std::vector<double> pairs(6*kBatch);
+  double *w = &pairs[5*kBatch];
+  for (Long64_t i=0; i<ntri; i+=kBatch) {
+    int nb = TMath::Min(Long64_t(kBatch),ntri-i);
+    GenerateEvents(nb,fYMin,fYMax,fPtMin,fPtMax,&pairs[0],&pairs[kBatch],
+                   &pairs[2*kBatch],&pairs[3*kBatch],&pairs[4*kBatch],w);
+    for (int j=0; j<nb; j++) {
+      sumw += w[j];
+      sumw2 += w[j]*w[j];
+    }
+    n += nb;
+  }
+}
+
+//____________________________________________________________
+void TGenEpEmv1::RunXSectionTrials(Long64_t ntri, Long64_t &n, double &sumw, double &sumw2)
+{
+  // Split ntri trials over fXSectionWorkers forked processes, each with
+  // its own random seed, and add up their sums. The fortran generator
+  // keeps its state in COMMON blocks, so it cannot run in threads.
+  int nw = fXSectionWorkers;
+  if (nw<=1 || ntri<100*nw) {
+    XSectionTrials(ntri,n,sumw,sumw2);
+    return;
+  }
+  struct Sums {
+    Long64_t n;
+    double sumw, sumw2;
+  };
+  std::vector<pid_t> pids(nw,-1);
+  std::vector<int> fds(nw,-1);
+  fflush(stdout);
+  for (int iw=0; iw<nw; iw++) {
+    Long64_t share = ntri/nw + (iw < ntri%nw ? 1 : 0);
+    UInt_t seed = 1 + gRandom->Integer(2147483646);
+    int fd[2];
+    pid_t pid = -1;
+    if (pipe(fd)==0) {
+      pid = fork();
+      if (pid<0) {
+        close(fd[0]);
+        close(fd[1]);
+      }
+    }
+    if (pid==0) {
+      close(fd[0]);
+      gRandom->SetSeed(seed);
+      Sums sums = {0, 0., 0.};
+      XSectionTrials(share,sums.n,sums.sumw,sums.sumw2);
+      ssize_t nb = write(fd[1],&sums,sizeof(sums));
+      _exit(nb==sizeof(sums) ? 0 : 1);
+    }
+    if (pid<0) {
+      printf("TGenEpEmv1: cannot start x-section worker, running %lld trials here\n",share);
+      XSectionTrials(share,n,sumw,sumw2);
+      continue;
+    }
+    close(fd[1]);
+    pids[iw] = pid;
+    fds[iw] = fd[0];
+  }
+  for (int iw=0; iw<nw; iw++) {
+    if (pids[iw]<0) continue;
+    Sums sums;
+    ssize_t nb = 0, r;
+    char *buf = (char*)&sums;
+    while (nb<(ssize_t)sizeof(sums) && (r=read(fds[iw],buf+nb,sizeof(sums)-nb))>0) nb += r;
+    close(fds[iw]);
+    int status = 0;
+    waitpid(pids[iw],&status,0);
+    if (nb!=sizeof(sums)) {
+      printf("TGenEpEmv1: x-section worker %d failed, its trials are ignored\n",iw);
+      continue;
+    }
+    n += sums.n;
+    sumw += sums.sumw;
+    sumw2 += sums.sumw2;
+  }
+}
+
+//____________________________________________________________
+bool TGenEpEmv1::ReadXSectionCache(Long64_t &n, double &sumw, double &sumw2) const
+{
+  // Look up the sums for the current setup in the cache file. A line
+  // holds version, energy, Z, y range, pT range (exact, as hex floats),
+  // number of trials and the sums of weights and squared weights.
+  n = 0;
+  sumw = sumw2 = 0;
+  if (fXSectionCache.IsNull()) return false;
+  TString fname = fXSectionCache;
+  gSystem->ExpandPathName(fname);
+  FILE *f = fopen(fname.Data(),"r");
+  if (!f) return false;
+  const double key[6] = {fCMEnergy,fZ,fYMin,fYMax,fPtMin,fPtMax};
+  char line[1024];
+  bool found = false;
+  while (fgets(line,sizeof(line),f)) {
+    int version;
+    double k[6], sw, sw2;
+    Long64_t nt;
+    if (sscanf(line,"%d %la %la %la %la %la %la %lld %la %la",&version,
+               &k[0],&k[1],&k[2],&k[3],&k[4],&k[5],&nt,&sw,&sw2) != 10) continue;
+    if (version!=kXSectionVersion) continue;
+    bool match = true;
+    for (int i=0; i<6; i++) match = match && k[i]==key[i];
+    if (match && nt>n) {
+      n = nt;
+      sumw = sw;
+      sumw2 = sw2;
+      found = true;
+    }
+  }
+  fclose(f);
+  return found;
+}
+
+//____________________________________________________________
+void TGenEpEmv1::WriteXSectionCache(Long64_t n, double sumw, double sumw2) const
+{
+  // Store the sums for the current setup, replacing an entry with fewer
+  // trials. The file is rewritten under a temporary name and renamed, so
+  // concurrent jobs never see a partial file.
+  if (fXSectionCache.IsNull()) return;
+  TString fname = fXSectionCache;
+  gSystem->ExpandPathName(fname);
+  const double key[6] = {fCMEnergy,fZ,fYMin,fYMax,fPtMin,fPtMax};
+  std::vector<TString> lines;
+  bool keep = false;
+  FILE *f = fopen(fname.Data(),"r");
+  if (f) {
+    char line[1024];
+    while (fgets(line,sizeof(line),f)) {
+      int version;
+      double k[6], sw, sw2;
+      Long64_t nt;
+      if (sscanf(line,"%d %la %la %la %la %la %la %lld %la %la",&version,
+                 &k[0],&k[1],&k[2],&k[3],&k[4],&k[5],&nt,&sw,&sw2) == 10 &&
+          version==kXSectionVersion) {
+        bool match = true;
+        for (int i=0; i<6; i++) match = match && k[i]==key[i];
+        if (match) {
+          if (nt>=n) keep = true; // another job got further
+          else continue;
+        }
+      }
+      lines.push_back(line);
+    }
+    fclose(f);
+  }
+  if (keep) return;
+  TString tmp = TString::Format("%s.%d",fname.Data(),(int)getpid());
+  f = fopen(tmp.Data(),"w");
+  if (!f) {
+    printf("TGenEpEmv1: cannot write x-section cache %s\n",tmp.Data());
+    return;
+  }
+  for (const auto &line : lines) fputs(line.Data(),f);
+  fprintf(f,"%d %a %a %a %a %a %a %lld %a %a\n",kXSectionVersion,
+          key[0],key[1],key[2],key[3],key[4],key[5],n,sumw,sumw2);
+  bool ok = fclose(f)==0;
+  if (!ok || rename(tmp.Data(),fname.Data())!=0) {
+    printf("TGenEpEmv1: cannot write x-section cache %s\n",fname.Data());
+    remove(tmp.Data());
+  }
+}
 
 //____________________________________________________________
 void TGenEpEmv1::GenerateEvent()
@@ -183,6 +480,9 @@ void TGenEpEmv1::GenerateEvent()
   if (fEvent%1000 == 0) {
     printf("=====> TGenEpEmv1::Generate(): \n   Event %d, sigma=%f +- %f kb\n",
   	   fEvent, GetXsection(), GetDsection());
+    if (fWeighting==kUnweighted)
+      printf("   %lld of %lld pairs kept, %lld above max.weight (%e of the weight)\n",
+             fNAccepted, fNTried, fNOverflow, fSumWeights>0 ? fSumOverflow/fSumWeights : 0.);
   }
 }
 
@@ -201,19 +501,113 @@ void TGenEpEmv1::GeneratePair(Double_t vx, Double_t vy, Double_t vz, Double_t vt
   // On output an event weight is given (weight) which is assigned to each track.
   // The sum of event weights, divided by the total number of generated events, 
   // gives the integral cross section of the e+e- pair production in the   
-  // selected kinematics range.	  
+  // selected kinematics range, in units of GetXSection().
   //
 
+  std::vector<Double_t> pair;
+  SelectPairs(1,pair);
+  AddPair(pair[0],pair[1],pair[2],pair[3],pair[4],pair[5],vx,vy,vz,vt);
+}
+
+//____________________________________________________________
+void TGenEpEmv1::SelectPairs(Int_t n, std::vector<Double_t> &pairs)
+{
+  // Produce n pairs into pairs, in blocks of n as GenerateEvents: y of e-,
+  // e+, x of e-, e+, phi12 and the weight for the tracks.
+  // kWeighted: the pair weight divided by the mean weight.
+  // kUnweighted: candidates are accepted with probability weight/fMaxWeight
+  // and get weight 1, or weight/fMaxWeight if above fMaxWeight, so that the
+  // weighted distribution stays exact. The weights above fMaxWeight are kept;
+  // when their part above fMaxWeight exceeds twice the tolerance, fMaxWeight
+  // is raised to bring it back to the tolerance. With the surrogate most
+  // rejected pairs have no weight computed; the fraction of them computed
+  // to check its envelope is accepted as the others, with the weight
+  // multiplied by the inverse of that fraction, so that the pairs missed by
+  // the envelope keep their share of the weighted distribution.
+  pairs.resize(6*n);
+  double wnorm = fXSection>0 ? 1000./fXSection : 1.; // kb -> relative to mean
+  if (fWeighting!=kUnweighted) {
+    GenerateEvents(n,fYMin,fYMax,fPtMin,fPtMax,&pairs[0],&pairs[n],
+                   &pairs[2*n],&pairs[3*n],&pairs[4*n],&pairs[5*n]);
+    for (int i=0; i<n; i++) {
+      fSumWeights += pairs[5*n+i]*1000;
+      pairs[5*n+i] *= wnorm;
+    }
+    fNTried += n;
+    fNAccepted += n;
+    return;
+  }
+  if (fMaxWeight<=0) {
+    fMaxWeight = EstimateMaxWeight(fMaxWeightTrials,fMaxWeightTol);
+    if (fMaxWeight<=0) {
+      printf("TGenEpEmv1: no max.weight for unweighted generation\n");
+      abort();
+    }
+  }
+  // candidates per batch from the expected efficiency
+  const int kBatch = 1000;
+  double eff = TMath::Min(1.,fXSection>0 ? fXSection/1000/fMaxWeight : 1.);
+  std::vector<Double_t> cand, u;
+  int nacc = 0;
+  while (nacc<n) {
+    int nb = int(TMath::Min(double(kBatch),1.1*(n-nacc)/eff))+1;
+    cand.resize(7*nb);
+    u.resize(nb);
+    Rndm(&u[0],nb);
+    Long64_t nmissed = GetNSurrogateMissed();
+    GenerateEvents(nb,fYMin,fYMax,fPtMin,fPtMax,fMaxWeight,&u[0],&cand[0],&cand[nb],
+                   &cand[2*nb],&cand[3*nb],&cand[4*nb],&cand[5*nb],&cand[6*nb]);
+    if (GetNSurrogateMissed()>nmissed) {
+      printf("TGenEpEmv1: %lld pairs missed by the surrogate, envelope raised to %f\n",
+             GetNSurrogateMissed(),GetSurrogateEnvelope());
+    }
+    for (int j=0; j<nb && nacc<n; j++) {
+      double w = cand[5*nb+j];
+      double h = cand[6*nb+j];
+      double wt = h;
+      fNTried++;
+      if (h<=0) continue;
+      fSumWeights += h*w*1000;
+      if (w>fMaxWeight) {
+        wt = h*w/fMaxWeight;
+        fNOverflow++;
+        fSumOverflow += h*(w-fMaxWeight)*1000;
+        fOverflowWeights.push_back(std::make_pair(w,h));
+        fOverflowExcess += h*(w-fMaxWeight);
+        if (fNTried>=fMaxWeightTrials && fOverflowExcess*1000>2*fMaxWeightTol*fSumWeights) {
+          double wmax = WeightThreshold(fOverflowWeights,fMaxWeightTol*fSumWeights/1000);
+          printf("TGenEpEmv1: %lld of %lld pairs above max.weight, %e of the weight, max.weight %e -> %e kb\n",
+                 fNOverflow,fNTried,fOverflowExcess*1000/fSumWeights,fMaxWeight,wmax);
+          fMaxWeight = wmax;
+          // the max.weight only grows, weights below it are dropped for good
+          while (!fOverflowWeights.empty() && fOverflowWeights.back().first<=fMaxWeight)
+            fOverflowWeights.pop_back();
+          fOverflowExcess = 0;
+          for (const auto &x : fOverflowWeights) fOverflowExcess += x.second*(x.first-fMaxWeight);
+        }
+      } else if (u[j]*fMaxWeight>=w) {
+        continue;
+      }
+      for (int k=0; k<5; k++) pairs[k*n+nacc] = cand[k*nb+j];
+      pairs[5*n+nacc] = wt;
+      nacc++;
+      fNAccepted++;
+    }
+  }
+}
+
+//____________________________________________________________
+void TGenEpEmv1::AddPair(Double_t yElectron, Double_t yPositron, Double_t xElectron, Double_t xPositron,
+                         Double_t phi12, Double_t weight, Double_t vx, Double_t vy, Double_t vz, Double_t vt)
+{
+  // Add e- and e+ of a generated pair with the given weight to the particle list
+
   Float_t random[6];
-  Float_t polar[3]= {0,0,0};
   Float_t p[3];
 
   Double_t ptElectron,ptPositron, phiElectron,phiPositron, mt, etot;
-  Double_t phi12=0,xElectron=0,xPositron=0,yElectron=0,yPositron=0,weight=0;
-  Int_t   j, nt, id;
-  
-  TEpEmGen::GenerateEvent(fYMin,fYMax,fPtMin,fPtMax,
-			  yElectron,yPositron,xElectron,xPositron,phi12,weight);
+  Int_t   id;
+
   if (fDebug == 1)
     printf("TGenEpEmv1::Generate(): y=(%f,%f), x=(%f,%f), phi=%f\n",
 	   yElectron,yPositron,xElectron,xPositron,phi12);
@@ -234,6 +628,7 @@ void TGenEpEmv1::GeneratePair(Double_t vx, Double_t vy, Double_t vz, Double_t vt
   if (fDebug == 2)
     printf("id=%+3d, p = (%+11.4e,%+11.4e,%+11.4e) GeV\n",id,p[0],p[1],p[2]);
   TParticle *electron = new TParticle(id, 1, -1, -1, -1, -1, p[0], p[1], p[2], etot, vx, vy, vz, vt);
+  electron->SetWeight(weight);
   fParticles->Add(electron);
   
   // Produce positron
@@ -246,6 +641,7 @@ void TGenEpEmv1::GeneratePair(Double_t vx, Double_t vy, Double_t vz, Double_t vt
   if (fDebug == 2)
     printf("id=%+3d, p = (%+11.4e,%+11.4e,%+11.4e) GeV\n",id,p[0],p[1],p[2]);
   TParticle *positron = new TParticle(id, 1, -1, -1, -1, -1, p[0], p[1], p[2], etot, vx, vy, vz, vt);
+  positron->SetWeight(weight);
   fParticles->Add(positron);
 }
 
@@ -15,11 +15,16 @@
 
 #include "TEpEmGen.h"
 #include "TRandom.h"
+#include "TString.h"
+#include <utility>
+#include <vector>
 
 //-------------------------------------------------------------
 class TGenEpEmv1 : public TEpEmGen {
   
  public:
+  enum EWeighting { kWeighted, kUnweighted };
+
   TGenEpEmv1();
   ~TGenEpEmv1() override;
 
@@ -37,15 +42,56 @@ class TGenEpEmv1 : public TEpEmGen {
   void SetXSectionEps(double eps=1e-2)  {fXSectionEps = eps>0 ? eps:1e-2;}
   void SetMinMaxXSTest(int mn,int mx);
   double CalcXSection(double eps, int triMin, int triMax, double& err);
+  // File in which cross-section estimates are kept between jobs; an entry
+  // is reused if its precision suffices and refined otherwise
+  void SetXSectionCache(const char *fname) {fXSectionCache = fname ? fname : "";}
+  // Number of processes estimating the cross section when it is not cached
+  void SetXSectionWorkers(int n) {fXSectionWorkers = n>1 ? n:1;}
   double GetXSection()            const {return fXSection;}
   double GetXSectionEps()         const {return fXSectionEps;}
+  // kWeighted: every generated pair is kept, its tracks carry the pair
+  // weight relative to the mean weight. kUnweighted: pairs are accepted
+  // with probability weight/max.weight and have unit weight, except those
+  // above the max.weight, which keep weight/max.weight, and with
+  // SetSurrogate those found by the check of its envelope, which carry in
+  // addition the inverse of the fraction checked
+  void SetWeighting(Int_t mode)   {fWeighting = mode;}
+  // Fraction of the total weight allowed above the max.weight and number
+  // of trial pairs from which the max.weight is estimated in Init
+  void SetMaxWeightTolerance(double tol=1e-3) {fMaxWeightTol = tol>0 ? tol:0;}
+  void SetMaxWeightTrials(int n)  {fMaxWeightTrials = n>0 ? n:1;}
+  // kUnweighted with the C++ sampler: skip the exact cross section of the
+  // pairs that a table of it (TEpEmSurrogate with precision eps and at most
+  // maxNodes nodes, kept in file if given) shows to be rejected. A fraction
+  // of these is computed anyway to find where the table is too low, and
+  // those of them accepted have weight 1/fraction (TEpEmGen::SetSurrogateCheck)
+  void SetSurrogate(bool use=true, double eps=0.05, int maxNodes=300000, const char *file=0)
+  {fUseSurrogate = use; fSurrogateEps = eps; fSurrogateNodes = maxNodes; fSurrogateFile = file ? file : "";}
+  Int_t    GetWeighting()         const {return fWeighting;}
+  double   GetMaxWeight()         const {return fMaxWeight;}
+  // Running sums over the pairs generated since Init: number of pairs tried
+  // and kept, sum of their weights (barn) and of the weights above the
+  // max.weight, number of pairs above the max.weight
+  Long64_t GetNPairsTried()       const {return fNTried;}
+  Long64_t GetNPairsAccepted()    const {return fNAccepted;}
+  Long64_t GetNOverflows()        const {return fNOverflow;}
+  double   GetSumWeights()        const {return fSumWeights;}
+  double   GetSumOverflow()       const {return fSumOverflow;}
   
  protected:
   TGenEpEmv1(const TGenEpEmv1 & gen);
   TGenEpEmv1 & operator=(const TGenEpEmv1 & gen);
   void GeneratePair(Double_t vx, Double_t vy, Double_t vz, Double_t vt);
+  void SelectPairs(Int_t n, std::vector<Double_t> &pairs);
+  void AddPair(Double_t yElectron, Double_t yPositron, Double_t xElectron, Double_t xPositron,
+               Double_t phi12, Double_t weight, Double_t vx, Double_t vy, Double_t vz, Double_t vt);
+  double EstimateMaxWeight(Long64_t ntri, double tol);
   void Rndm(Float_t *array, Int_t n) {gRandom->RndmArray(n, array);};
   void Rndm(Double_t *array, Int_t n) {gRandom->RndmArray(n, array);};
+  void RunXSectionTrials(Long64_t ntri, Long64_t &n, double &sumw, double &sumw2);
+  void XSectionTrials(Long64_t ntri, Long64_t &n, double &sumw, double &sumw2);
+  bool ReadXSectionCache(Long64_t &n, double &sumw, double &sumw2) const;
+  void WriteXSectionCache(Long64_t n, double sumw, double sumw2) const;
   
   Float_t    fMass;    // electron mass
   Int_t      fDebug;   // debug level
@@ -62,8 +108,26 @@ class TGenEpEmv1 : public TEpEmGen {
   Double_t   fXSectionEps;  // error with wich Xsection is calculated
   int        fMinXSTest;    // min number of generator calls for Xsection estimate
   int        fMaxXSTest;    // max number of generator calls for Xsection estimate
+  TString    fXSectionCache;   // file with cached Xsection estimates
+  int        fXSectionWorkers; // number of processes for Xsection estimate
+  Int_t      fWeighting;       // EWeighting
+  double     fMaxWeightTol;    // fraction of the weight allowed above fMaxWeight
+  int        fMaxWeightTrials; // number of trials for the fMaxWeight estimate
+  double     fMaxWeight;       // max.weight for unweighting (kb, as the generator)
+  Long64_t   fNTried;          // pairs generated
+  Long64_t   fNAccepted;       // pairs kept
+  Long64_t   fNOverflow;       // pairs with weight above fMaxWeight
+  double     fSumWeights;      // sum of the weights of the generated pairs (barn)
+  double     fSumOverflow;     // sum of the weights above fMaxWeight (barn)
+  std::vector<std::pair<double,double> > fOverflowWeights; //! weights above fMaxWeight (kb) and their multiplicity
+  double     fOverflowExcess;  //! their sum above fMaxWeight (kb)
+  bool       fUseSurrogate;    // pre-test with the tabulated cross section in kUnweighted
+  double     fSurrogateEps;    // precision of the table
+  int        fSurrogateNodes;  // max.number of nodes of the table
+  TString    fSurrogateFile;   // file with the table
 
+  static const int kXSectionVersion = 1; // version of the generator for the Xsection cache
   
-  ClassDef(TGenEpEmv1,1) // Generator of single e+e- pair production in PbPb ultra-peripheral collisions
+  ClassDef(TGenEpEmv1,4) // Generator of single e+e- pair production in PbPb ultra-peripheral collisions
 };
 #endif
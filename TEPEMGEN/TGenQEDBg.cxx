@@ -49,6 +49,8 @@
 //    corresponding to requested integration time with given beam luminosity
 //    Each pair has its own vertex, and time randomly distributed at originT 
 //    and originT+ integration time                    
+//    In the default weighted mode the tracks carry the pair weight relative
+//    to the mean, with SetWeighting(TGenEpEmv1::kUnweighted) unit weight
 //
 //    For details of pair generation see AliGenEpEmv1.cxx by Yuri.Kharlov@cern.ch
 
@@ -82,6 +84,7 @@
 #include <TParticlePDG.h>
 #include <TDatabasePDG.h>
 #include <TEpEmGen.h>
+#include <vector>
 
 ClassImp(TGenQEDBg);
 
@@ -138,6 +141,9 @@ void TGenQEDBg::GenerateEvent()
   if (fDebug == 1)
     printf("<nQED>=%e -> %d pairs will be generated",fPairsInt,npairs);
   if (npairs<1) return;
+  std::vector<Double_t> pairs;
+  SelectPairs(npairs,pairs);
+  Double_t *y = &pairs[0], *x = &pairs[2*npairs], *phi12 = &pairs[4*npairs], *w = &pairs[5*npairs];
   for (int i=0;i<npairs;i++) {
     // each pair has its own vertex and time
     for (int j=0;j<3;j++) origin[j]=fOrigin[j];
@@ -148,7 +154,7 @@ void TGenQEDBg::GenerateEvent()
     }
     time = fTimeOrigin+gRandom->Rndm()*fIntTime;
     //
-    TGenEpEmv1::GeneratePair(origin[0], origin[1], origin[2], time);
+    AddPair(y[i], y[npairs+i], x[i], x[npairs+i], phi12[i], w[i], origin[0], origin[1], origin[2], time);
   }
   fEvent++;
   //